@@ -0,0 +1,245 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+// Stands in for the game when trying a reader without the engine or a device. Exports synthetic hands into the shared
+// region the same way FQHandSharedFrameWriter does: each slot made odd, written and made even again, then the write
+// count raised, with a barrier before each of those stores.
+//
+//   c++ -std=c++11 -O2 QuestHandsSharedFrameProducerMain.cpp -o QuestHandsSharedFrameProducer -lrt
+//   QuestHandsSharedFrameProducer [RegionName] [Seconds] [FramesPerSecond]
+
+#include "../../Source/QuestHands/Public/QuestHandsSharedFrameLayout.h"
+
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    using namespace QuestHandsShared;
+
+    // Hand_IndexTip in Hand Bones order
+    const uint32_t IndexTipBone = 20;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Creates the region writable, the header filled in before the magic like the engine writer does
+    */
+    class FSharedFrameProducer
+    {
+    public:
+
+        FSharedFrameProducer()
+            : Region(nullptr)
+            , NumFrames(0)
+        #ifdef _WIN32
+            , Mapping(nullptr)
+        #endif
+        {}
+
+        ~FSharedFrameProducer()
+        {
+            Close();
+        }
+
+        FSharedFrameProducer(const FSharedFrameProducer&) = delete;
+        FSharedFrameProducer& operator=(const FSharedFrameProducer&) = delete;
+
+        bool Open(const char* RegionName)
+        {
+            Close();
+
+        #ifdef _WIN32
+            Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(FRegion), RegionName);
+            if(!Mapping)
+            {
+                return false;
+            }
+            Region = static_cast<FRegion*>(MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(FRegion)));
+        #else
+            // The engine names its shm_open regions with a leading slash
+            Name = std::string("/") + RegionName;
+            const int fd = shm_open(Name.c_str(), O_CREAT | O_RDWR, 0666);
+            if(fd == -1)
+            {
+                return false;
+            }
+            if(ftruncate(fd, sizeof(FRegion)) == 0)
+            {
+                void* address = mmap(nullptr, sizeof(FRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                Region = address != MAP_FAILED ? static_cast<FRegion*>(address) : nullptr;
+            }
+            close(fd);
+        #endif
+
+            if(!Region)
+            {
+                Close();
+                return false;
+            }
+
+            NumFrames = 0;
+            memset(Region, 0, sizeof(FRegion));
+            Region->Header.Version = Version;
+            Region->Header.HeaderSize = sizeof(FHeader);
+            Region->Header.SlotSize = sizeof(FSlot);
+            Region->Header.NumSlots = NumSlots;
+            Region->Header.NumBones = NumBones;
+            Region->Header.ProducerActive = 1;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            Region->Header.Magic = Magic;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return true;
+        }
+
+        void Close()
+        {
+            if(Region)
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                Region->Header.ProducerActive = 0;
+            }
+
+        #ifdef _WIN32
+            if(Region)
+            {
+                UnmapViewOfFile(Region);
+            }
+            if(Mapping)
+            {
+                CloseHandle(Mapping);
+                Mapping = nullptr;
+            }
+        #else
+            if(Region)
+            {
+                munmap(Region, sizeof(FRegion));
+                shm_unlink(Name.c_str());
+            }
+        #endif
+            Region = nullptr;
+        }
+
+        // Write the next frame into its slot and publish it
+        void WriteFrame(double Time)
+        {
+            FSlot& slot = Region->Slots[NumFrames % NumSlots];
+
+            const uint32_t sequence = slot.Sequence;
+            slot.Sequence = sequence + 1;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            slot.Frame.FrameIndex = NumFrames + 1;
+            slot.Frame.EngineFrame = NumFrames + 1;
+            slot.Frame.Time = Time;
+            MakeHand(Time, 0, slot.Frame.Hands[0]);
+            MakeHand(Time, 1, slot.Frame.Hands[1]);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            slot.Sequence = sequence + 2;
+
+            ++NumFrames;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            Region->Header.WriteCount = NumFrames;
+        }
+
+        uint64_t GetNumFrames() const { return NumFrames; }
+
+    private:
+
+        // Both hands tracked in front of the origin, the index tips circling and the pinch going on and off each second
+        static void MakeHand(double Time, int HandIndex, FHand& HandOut)
+        {
+            const float side = HandIndex == 0 ? -1.0f : 1.0f;
+            const float angle = (float)fmod(Time, 6.283185307179586) + HandIndex * 3.14159265f;
+            const bool pinched = fmod(Time, 1.0) < 0.5;
+
+            memset(&HandOut, 0, sizeof(FHand));
+            HandOut.Flags = HandFlag_Tracked | HandFlag_InputValid | HandFlag_HighConfidence | HandFlag_BonesValid;
+            HandOut.Pinches = pinched ? 1u << 1 : 0u;
+            HandOut.PinchStrength[1] = pinched ? 1.0f : 0.0f;
+            HandOut.HandScale = 1.0f;
+
+            HandOut.RootPose.Orientation[3] = 1.0f;
+            HandOut.RootPose.Position[0] = 40.0f;
+            HandOut.RootPose.Position[1] = side * 20.0f;
+            HandOut.RootPose.Position[2] = 120.0f;
+            HandOut.PointerPose = HandOut.RootPose;
+
+            for(uint32_t boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+            {
+                FBone& bone = HandOut.Bones[boneIndex];
+                bone.Rotation[3] = 1.0f;
+                bone.Location[0] = HandOut.RootPose.Position[0];
+                bone.Location[1] = HandOut.RootPose.Position[1];
+                bone.Location[2] = HandOut.RootPose.Position[2];
+                bone.Scale = 1.0f;
+            }
+            FBone& tip = HandOut.Bones[IndexTipBone];
+            tip.Location[0] += 10.0f;
+            tip.Location[1] += 5.0f * cosf(angle);
+            tip.Location[2] += 5.0f * sinf(angle);
+        }
+
+        FRegion* Region;
+        uint64_t NumFrames;
+
+    #ifdef _WIN32
+        HANDLE Mapping;
+    #else
+        std::string Name;
+    #endif
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const char* regionName = argc > 1 ? argv[1] : DefaultName;
+    const double seconds = argc > 2 ? atof(argv[2]) : 0.0;
+    const double framesPerSecond = argc > 3 && atof(argv[3]) > 0.0 ? atof(argv[3]) : 72.0;
+
+    FSharedFrameProducer producer;
+    if(!producer.Open(regionName))
+    {
+        printf("Unable to create %s\n", regionName);
+        return 1;
+    }
+    printf("Exporting %s at %.1f fps\n", regionName, framesPerSecond);
+    fflush(stdout);
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point startTime = Clock::now();
+    const Clock::duration frameInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+    Clock::time_point nextFrameTime = startTime;
+
+    for(;;)
+    {
+        const double time = std::chrono::duration<double>(Clock::now() - startTime).count();
+        if(seconds > 0.0 && time >= seconds)
+        {
+            break;
+        }
+
+        producer.WriteFrame(time);
+        nextFrameTime += frameInterval;
+        std::this_thread::sleep_until(nextFrameTime);
+    }
+
+    printf("Exported %llu frames\n", (unsigned long long)producer.GetNumFrames());
+    return 0;
+}
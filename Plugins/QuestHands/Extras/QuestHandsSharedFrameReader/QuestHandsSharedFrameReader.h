@@ -0,0 +1,235 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+// Header only reader of the hand frames exported by UQuestHandsComponent::StartSharedFrameExport, plain C++11 without
+// the engine. Windows, Linux and Mac, link with -lrt on older Linux distributions.
+#include "../../Source/QuestHands/Public/QuestHandsSharedFrameLayout.h"
+
+#include <atomic>
+#include <string>
+#include <string.h>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace QuestHandsShared
+{
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Maps an exported region read only and copies frames out of it. The producer never waits on readers, a frame
+      * being written while it is copied is copied again and frames overwritten before they were read are counted as
+      * dropped. Reading never makes a system call, only Open and Close do.
+    */
+    class FSharedFrameReader
+    {
+    public:
+
+        FSharedFrameReader()
+            : Region(nullptr)
+            , NextFrameIndex(1)
+            , DroppedFrames(0)
+        #ifdef _WIN32
+            , Mapping(nullptr)
+        #endif
+        {}
+
+        ~FSharedFrameReader()
+        {
+            Close();
+        }
+
+        FSharedFrameReader(const FSharedFrameReader&) = delete;
+        FSharedFrameReader& operator=(const FSharedFrameReader&) = delete;
+
+        // Map the region, false while no producer has created it or when it was exported with a different layout
+        bool Open(const char* RegionName = DefaultName)
+        {
+            Close();
+
+        #ifdef _WIN32
+            Mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, RegionName);
+            if(!Mapping)
+            {
+                return false;
+            }
+            Region = static_cast<const FRegion*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, sizeof(FRegion)));
+        #else
+            // The engine names its shm_open regions with a leading slash
+            const std::string name = std::string("/") + RegionName;
+            const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if(fd == -1)
+            {
+                return false;
+            }
+            struct stat info;
+            if(fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(FRegion))
+            {
+                void* address = mmap(nullptr, sizeof(FRegion), PROT_READ, MAP_SHARED, fd, 0);
+                Region = address != MAP_FAILED ? static_cast<const FRegion*>(address) : nullptr;
+            }
+            close(fd);
+        #endif
+
+            if(!Region || !IsCompatible())
+            {
+                Close();
+                return false;
+            }
+
+            // Start at the latest frame rather than the oldest still in the ring
+            const uint64_t writeCount = LoadWriteCount();
+            NextFrameIndex = writeCount > 0 ? writeCount : 1;
+            DroppedFrames = 0;
+            return true;
+        }
+
+        void Close()
+        {
+        #ifdef _WIN32
+            if(Region)
+            {
+                UnmapViewOfFile(Region);
+            }
+            if(Mapping)
+            {
+                CloseHandle(Mapping);
+                Mapping = nullptr;
+            }
+        #else
+            if(Region)
+            {
+                munmap(const_cast<FRegion*>(Region), sizeof(FRegion));
+            }
+        #endif
+            Region = nullptr;
+        }
+
+        bool IsOpen() const { return Region != nullptr; }
+
+        // Is the producer still exporting? A closed export leaves its last frames readable.
+        bool IsProducerActive() const { return Region && Region->Header.ProducerActive != 0; }
+
+        // Frames exported so far
+        uint64_t GetWriteCount() const { return Region ? LoadWriteCount() : 0; }
+
+        // Frames overwritten before ReadNext got to them
+        uint64_t GetDroppedFrames() const { return DroppedFrames; }
+
+        // Copy the latest exported frame, false when there is none yet
+        bool ReadLatest(FFrame& FrameOut)
+        {
+            if(!Region)
+            {
+                return false;
+            }
+
+            // Retried while the producer keeps lapping the slot being copied
+            for(int attempt = 0; attempt < 8; ++attempt)
+            {
+                const uint64_t writeCount = LoadWriteCount();
+                if(writeCount == 0)
+                {
+                    return false;
+                }
+                if(ReadFrame(writeCount, FrameOut))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Copy the frame after the one ReadNext returned last, false when the reader is caught up.
+        // Skips ahead to the oldest frame still in the ring when the producer got a whole ring ahead.
+        bool ReadNext(FFrame& FrameOut)
+        {
+            if(!Region)
+            {
+                return false;
+            }
+
+            for(int attempt = 0; attempt < 8; ++attempt)
+            {
+                const uint64_t writeCount = LoadWriteCount();
+
+                // The producer opened the region again and started over
+                if(writeCount + 1 < NextFrameIndex)
+                {
+                    NextFrameIndex = writeCount > 0 ? writeCount : 1;
+                }
+                if(NextFrameIndex > writeCount)
+                {
+                    return false;
+                }
+
+                const uint64_t oldestFrameIndex = writeCount > NumSlots ? writeCount - NumSlots + 1 : 1;
+                if(NextFrameIndex < oldestFrameIndex)
+                {
+                    DroppedFrames += oldestFrameIndex - NextFrameIndex;
+                    NextFrameIndex = oldestFrameIndex;
+                }
+
+                if(ReadFrame(NextFrameIndex, FrameOut))
+                {
+                    ++NextFrameIndex;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+
+        bool IsCompatible() const
+        {
+            const FHeader& header = Region->Header;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return header.Magic == Magic && header.Version == Version && header.HeaderSize == sizeof(FHeader) &&
+                   header.SlotSize == sizeof(FSlot) && header.NumSlots == NumSlots && header.NumBones == NumBones;
+        }
+
+        uint64_t LoadWriteCount() const
+        {
+            const uint64_t writeCount = Region->Header.WriteCount;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return writeCount;
+        }
+
+        // Copy a frame out of its slot, false if it was being written or had been replaced by a later frame
+        bool ReadFrame(uint64_t FrameIndex, FFrame& FrameOut) const
+        {
+            const FSlot& slot = Region->Slots[(FrameIndex - 1) % NumSlots];
+
+            const uint32_t sequenceBefore = slot.Sequence;
+            if(sequenceBefore & 1)
+            {
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            memcpy(&FrameOut, const_cast<const FFrame*>(&slot.Frame), sizeof(FFrame));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint32_t sequenceAfter = slot.Sequence;
+            return sequenceBefore == sequenceAfter && FrameOut.FrameIndex == FrameIndex;
+        }
+
+        const FRegion* Region;
+        uint64_t NextFrameIndex;
+        uint64_t DroppedFrames;
+
+    #ifdef _WIN32
+        HANDLE Mapping;
+    #endif
+    };
+}
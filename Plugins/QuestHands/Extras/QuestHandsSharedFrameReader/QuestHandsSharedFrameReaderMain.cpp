@@ -0,0 +1,100 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+// Follows an export of hand frames and prints the frame rate, lost frames and the index fingertips once a second.
+//
+//   c++ -std=c++11 -O2 QuestHandsSharedFrameReaderMain.cpp -o QuestHandsSharedFrameReader -lrt
+//   QuestHandsSharedFrameReader [RegionName] [Seconds]
+
+#include "QuestHandsSharedFrameReader.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace
+{
+    // Hand_IndexTip in Hand Bones order
+    const uint32_t IndexTipBone = 20;
+
+    void PrintHand(const char* Label, const QuestHandsShared::FHand& Hand)
+    {
+        using namespace QuestHandsShared;
+
+        if((Hand.Flags & HandFlag_Tracked) == 0)
+        {
+            printf("  %s untracked", Label);
+            return;
+        }
+        if((Hand.Flags & HandFlag_BonesValid) == 0)
+        {
+            printf("  %s tracked, no bones", Label);
+            return;
+        }
+        const float* tip = Hand.Bones[IndexTipBone].Location;
+        printf("  %s tip (%.1f, %.1f, %.1f) pinches 0x%x", Label, tip[0], tip[1], tip[2], Hand.Pinches);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace QuestHandsShared;
+
+    const char* regionName = argc > 1 ? argv[1] : DefaultName;
+    const double seconds = argc > 2 ? atof(argv[2]) : 0.0;
+
+    FSharedFrameReader reader;
+    printf("Waiting for %s ...\n", regionName);
+    while(!reader.Open(regionName))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    }
+    printf("Reading %s, layout version %u\n", regionName, Version);
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point startTime = Clock::now();
+    Clock::time_point reportTime = startTime;
+    uint64_t framesRead = 0;
+    uint64_t framesReported = 0;
+    FFrame frame;
+    memset(&frame, 0, sizeof(frame));
+
+    for(;;)
+    {
+        // Take everything exported since the last poll, then give the producer time to make more
+        bool readAny = false;
+        while(reader.ReadNext(frame))
+        {
+            ++framesRead;
+            readAny = true;
+        }
+        if(!readAny)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const Clock::time_point now = Clock::now();
+        const double sinceReport = std::chrono::duration<double>(now - reportTime).count();
+        if(sinceReport >= 1.0)
+        {
+            printf("frame %llu (engine %llu) | %.1f fps | %llu dropped |",
+                   (unsigned long long)frame.FrameIndex, (unsigned long long)frame.EngineFrame,
+                   (framesRead - framesReported) / sinceReport, (unsigned long long)reader.GetDroppedFrames());
+            PrintHand("left", frame.Hands[0]);
+            PrintHand("right", frame.Hands[1]);
+            printf("%s\n", reader.IsProducerActive() ? "" : " | producer stopped");
+            fflush(stdout);
+            reportTime = now;
+            framesReported = framesRead;
+        }
+
+        if(seconds > 0.0 && std::chrono::duration<double>(now - startTime).count() >= seconds)
+        {
+            break;
+        }
+    }
+
+    printf("Read %llu frames, dropped %llu\n", (unsigned long long)framesRead, (unsigned long long)reader.GetDroppedFrames());
+    return 0;
+}
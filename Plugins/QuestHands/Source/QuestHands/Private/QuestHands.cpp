@@ -1,6 +1,7 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "QuestHands.h"
+#include "QuestHandsMemory.h"
 
 DEFINE_LOG_CATEGORY(LogQuestHands);
 
@@ -9,12 +10,14 @@ DEFINE_LOG_CATEGORY(LogQuestHands);
 void FQuestHandsModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	QuestHands::Memory::Startup();
 }
 
 void FQuestHandsModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	QuestHands::Memory::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,559 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsAnalyticsCommandlet.h"
+#include "QuestHands.h"
+#include "QuestHandsRecording.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+namespace QuestHands
+{
+namespace Analytics
+{
+    static constexpr int32 NumBones = (int32)EQHandBones::Hand_PinkyTip + 1;
+    static constexpr int32 NumFingers = (int32)EQHandFinger::HandFinger_Pinky + 1;
+
+    // Jitter is the spectrum of the bone angular speeds over windows of consecutive tracked samples, split into bands
+    static constexpr int32 JitterWindow = 64;
+    static constexpr int32 NumJitterBands = 4;
+    static const float JitterBandEdges[NumJitterBands - 1] = { 1.0f, 3.0f, 8.0f };
+    static const TCHAR* JitterBandNames[NumJitterBands] = { TEXT("0-1Hz"), TEXT("1-3Hz"), TEXT("3-8Hz"), TEXT("8Hz+") };
+
+    struct FPinchStats
+    {
+        int32 Count = 0;
+        double TotalSeconds = 0.0;
+        double MaxSeconds = 0.0;
+    };
+
+    struct FHandStats
+    {
+        int32 TrackedFrames = 0;
+        int32 HighConfidenceFrames = 0;
+
+        // Number of times tracking was lost after being tracked
+        int32 LossEvents = 0;
+
+        // Power of the bone angular speeds per band in (deg/s)^2, summed over NumJitterWindows windows
+        double JitterPower[NumBones][NumJitterBands] = {};
+        int32 NumJitterWindows = 0;
+
+        FPinchStats Pinches[NumFingers];
+
+        // Hand scale of the tracked frames, the sums feed a least squares fit of the scale against time for the drift
+        float ScaleFirst = 0.0f;
+        float ScaleLast = 0.0f;
+        float ScaleMin = MAX_flt;
+        float ScaleMax = -MAX_flt;
+        double ScaleCount = 0.0;
+        double ScaleSumT = 0.0;
+        double ScaleSumS = 0.0;
+        double ScaleSumTT = 0.0;
+        double ScaleSumTS = 0.0;
+
+        // RMS angular speed of a bone within a band in deg/s
+        double GetJitter(int32 Bone, int32 Band) const
+        {
+            return NumJitterWindows > 0 ? FMath::Sqrt(JitterPower[Bone][Band] / NumJitterWindows) : 0.0;
+        }
+
+        // Change of the hand scale per minute
+        double GetScaleDrift() const
+        {
+            const double denominator = ScaleCount * ScaleSumTT - ScaleSumT * ScaleSumT;
+            return FMath::Abs(denominator) > SMALL_NUMBER ? (ScaleCount * ScaleSumTS - ScaleSumT * ScaleSumS) / denominator * 60.0 : 0.0;
+        }
+    };
+
+    struct FSessionStats
+    {
+        FString FilePath;
+        bool Valid = false;
+        int32 Frames = 0;
+        double Duration = 0.0;
+        FHandStats Hands[2];
+    };
+
+    // Window function and DFT twiddles shared by every analysis, built once
+    struct FJitterTables
+    {
+        float Hann[JitterWindow];
+        float Cos[JitterWindow];
+        float Sin[JitterWindow];
+
+        // Scales a DFT bin to its share of the one sided power, compensating for the window
+        float PowerScale;
+
+        FJitterTables()
+        {
+            float hannSquaredSum = 0.0f;
+            for(int32 index = 0; index < JitterWindow; ++index)
+            {
+                const float angle = 2.0f * PI * index / JitterWindow;
+                Hann[index] = 0.5f - 0.5f * FMath::Cos(2.0f * PI * index / (JitterWindow - 1));
+                Cos[index] = FMath::Cos(angle);
+                Sin[index] = FMath::Sin(angle);
+                hannSquaredSum += Hann[index] * Hann[index];
+            }
+            PowerScale = 2.0f / (JitterWindow * hannSquaredSum);
+        }
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static const FJitterTables& GetJitterTables()
+    {
+        static const FJitterTables tables;
+        return tables;
+    }
+
+    // The running state of the analysis of one hand
+    struct FHandAnalysis
+    {
+        bool WasTracked = false;
+        double PreviousTime = 0.0;
+        TArray<FQuat> PreviousRotations;
+
+        // Bone angular speeds in deg/s of the current jitter window
+        float Window[NumBones][JitterWindow];
+        double WindowStartTime = 0.0;
+        int32 WindowCount = 0;
+
+        // When each finger started pinching, negative if it isn't
+        double PinchStart[NumFingers];
+
+        FHandAnalysis()
+        {
+            for(double& pinchStart : PinchStart)
+            {
+                pinchStart = -1.0;
+            }
+        }
+
+        //---------------------------------------------------------------------------------------------------------------------
+        /**
+        */
+        void AddFrame(double Time, const FQHandTrackingState& State, FHandStats& Stats)
+        {
+            if(!State.IsTracked || State.BoneRotations.Num() != NumBones)
+            {
+                if(WasTracked)
+                {
+                    ++Stats.LossEvents;
+                    EndPinches(Time, Stats);
+                }
+                WasTracked = false;
+                WindowCount = 0;
+                return;
+            }
+
+            ++Stats.TrackedFrames;
+            if(State.HandConfidence == EQHandTrackingConfidence::Confidence_High)
+            {
+                ++Stats.HighConfidenceFrames;
+            }
+
+            if(State.HandScale > 0.0f)
+            {
+                if(Stats.ScaleCount == 0.0)
+                {
+                    Stats.ScaleFirst = State.HandScale;
+                }
+                Stats.ScaleLast = State.HandScale;
+                Stats.ScaleMin = FMath::Min(Stats.ScaleMin, State.HandScale);
+                Stats.ScaleMax = FMath::Max(Stats.ScaleMax, State.HandScale);
+                Stats.ScaleCount += 1.0;
+                Stats.ScaleSumT += Time;
+                Stats.ScaleSumS += State.HandScale;
+                Stats.ScaleSumTT += Time * Time;
+                Stats.ScaleSumTS += Time * State.HandScale;
+            }
+
+            const int32 numPinches = FMath::Min(State.PinchState.Num(), NumFingers);
+            for(int32 finger = 0; finger < numPinches; ++finger)
+            {
+                if(State.PinchState[finger].Pinched && PinchStart[finger] < 0.0)
+                {
+                    PinchStart[finger] = Time;
+                }
+                else if(!State.PinchState[finger].Pinched && PinchStart[finger] >= 0.0)
+                {
+                    EndPinch(finger, Time, Stats);
+                }
+            }
+
+            if(WasTracked && Time > PreviousTime)
+            {
+                if(WindowCount == 0)
+                {
+                    WindowStartTime = PreviousTime;
+                }
+
+                const float invDeltaTime = 1.0f / (float)(Time - PreviousTime);
+                for(int32 bone = 0; bone < NumBones; ++bone)
+                {
+                    Window[bone][WindowCount] = FMath::RadiansToDegrees(PreviousRotations[bone].AngularDistance(State.BoneRotations[bone])) * invDeltaTime;
+                }
+
+                if(++WindowCount == JitterWindow)
+                {
+                    AddJitterWindow(JitterWindow / (Time - WindowStartTime), Stats);
+                }
+            }
+
+            PreviousRotations = State.BoneRotations;
+            PreviousTime = Time;
+            WasTracked = true;
+        }
+
+        //---------------------------------------------------------------------------------------------------------------------
+        /**
+        */
+        void Finish(double Time, FHandStats& Stats)
+        {
+            EndPinches(Time, Stats);
+        }
+
+    private:
+
+        //---------------------------------------------------------------------------------------------------------------------
+        /**
+        */
+        void EndPinch(int32 Finger, double Time, FHandStats& Stats)
+        {
+            const double duration = Time - PinchStart[Finger];
+            FPinchStats& pinch = Stats.Pinches[Finger];
+            ++pinch.Count;
+            pinch.TotalSeconds += duration;
+            pinch.MaxSeconds = FMath::Max(pinch.MaxSeconds, duration);
+            PinchStart[Finger] = -1.0;
+        }
+
+        //---------------------------------------------------------------------------------------------------------------------
+        /**
+        */
+        void EndPinches(double Time, FHandStats& Stats)
+        {
+            for(int32 finger = 0; finger < NumFingers; ++finger)
+            {
+                if(PinchStart[finger] >= 0.0)
+                {
+                    EndPinch(finger, Time, Stats);
+                }
+            }
+        }
+
+        //---------------------------------------------------------------------------------------------------------------------
+        /**
+        */
+        void AddJitterWindow(double SampleRate, FHandStats& Stats)
+        {
+            const FJitterTables& tables = GetJitterTables();
+            for(int32 bone = 0; bone < NumBones; ++bone)
+            {
+                const float* samples = Window[bone];
+
+                float mean = 0.0f;
+                for(int32 index = 0; index < JitterWindow; ++index)
+                {
+                    mean += samples[index];
+                }
+                mean /= JitterWindow;
+
+                float windowed[JitterWindow];
+                for(int32 index = 0; index < JitterWindow; ++index)
+                {
+                    windowed[index] = (samples[index] - mean) * tables.Hann[index];
+                }
+
+                for(int32 bin = 1; bin < JitterWindow / 2; ++bin)
+                {
+                    float real = 0.0f;
+                    float imaginary = 0.0f;
+                    for(int32 index = 0; index < JitterWindow; ++index)
+                    {
+                        const int32 twiddle = (bin * index) % JitterWindow;
+                        real += windowed[index] * tables.Cos[twiddle];
+                        imaginary -= windowed[index] * tables.Sin[twiddle];
+                    }
+
+                    const double frequency = bin * SampleRate / JitterWindow;
+                    int32 band = 0;
+                    while(band < NumJitterBands - 1 && frequency >= JitterBandEdges[band])
+                    {
+                        ++band;
+                    }
+                    Stats.JitterPower[bone][band] += (real * real + imaginary * imaginary) * tables.PowerScale;
+                }
+            }
+
+            ++Stats.NumJitterWindows;
+            WindowCount = 0;
+        }
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void AnalyseRecording(const FString& FilePath, FSessionStats& StatsOut)
+    {
+        StatsOut.FilePath = FilePath;
+
+        FQHandRecordingReader reader;
+        if(!reader.Open(FilePath))
+        {
+            return;
+        }
+        StatsOut.Valid = true;
+
+        FHandAnalysis analyses[2];
+        FQHandRecordingFrame frame;
+        double firstTime = 0.0;
+        double lastTime = 0.0;
+        while(reader.ReadFrame(frame))
+        {
+            if(StatsOut.Frames++ == 0)
+            {
+                firstTime = frame.Time;
+            }
+            lastTime = frame.Time;
+
+            analyses[0].AddFrame(frame.Time, frame.Hands[0], StatsOut.Hands[0]);
+            analyses[1].AddFrame(frame.Time, frame.Hands[1], StatsOut.Hands[1]);
+        }
+
+        analyses[0].Finish(lastTime, StatsOut.Hands[0]);
+        analyses[1].Finish(lastTime, StatsOut.Hands[1]);
+        StatsOut.Duration = lastTime - firstTime;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool WriteCSV(const FString& FilePath, const TArray<FSessionStats>& Sessions)
+    {
+        const UEnum* boneEnum = StaticEnum<EQHandBones>();
+        const int32 indexFinger = (int32)EQHandFinger::HandFinger_Index;
+
+        FString csv = TEXT("session,hand,frames,duration_s,tracking_loss_rate,loss_events,high_confidence_rate");
+        for(const TCHAR* bandName : JitterBandNames)
+        {
+            csv += FString::Printf(TEXT(",jitter_%s_dps"), bandName);
+        }
+        csv += TEXT(",worst_jitter_bone,index_pinches,index_pinch_mean_s,index_pinch_max_s,hand_scale_first,hand_scale_last,hand_scale_drift_per_min\n");
+
+        for(const FSessionStats& session : Sessions)
+        {
+            if(!session.Valid)
+            {
+                continue;
+            }
+
+            for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+            {
+                const FHandStats& hand = session.Hands[handIndex];
+                const float lossRate = session.Frames > 0 ? 1.0f - (float)hand.TrackedFrames / session.Frames : 0.0f;
+                const float highConfidenceRate = hand.TrackedFrames > 0 ? (float)hand.HighConfidenceFrames / hand.TrackedFrames : 0.0f;
+
+                csv += FString::Printf(TEXT("\"%s\",%s,%d,%.3f,%.4f,%d,%.4f"), *session.FilePath, handIndex == 0 ? TEXT("left") : TEXT("right"),
+                                       session.Frames, session.Duration, lossRate, hand.LossEvents, highConfidenceRate);
+
+                // Bands are averaged over the bones, the worst bone is the one with the most energy in the highest band
+                int32 worstBone = 0;
+                for(int32 band = 0; band < NumJitterBands; ++band)
+                {
+                    double bandSum = 0.0;
+                    for(int32 bone = 0; bone < NumBones; ++bone)
+                    {
+                        bandSum += hand.GetJitter(bone, band);
+                        if(band == NumJitterBands - 1 && hand.GetJitter(bone, band) > hand.GetJitter(worstBone, band))
+                        {
+                            worstBone = bone;
+                        }
+                    }
+                    csv += FString::Printf(TEXT(",%.3f"), bandSum / NumBones);
+                }
+
+                const FPinchStats& pinch = hand.Pinches[indexFinger];
+                csv += FString::Printf(TEXT(",%s,%d,%.3f,%.3f,%.4f,%.4f,%.6f\n"), *boneEnum->GetNameStringByIndex(worstBone),
+                                       pinch.Count, pinch.Count > 0 ? pinch.TotalSeconds / pinch.Count : 0.0, pinch.MaxSeconds,
+                                       hand.ScaleFirst, hand.ScaleLast, hand.GetScaleDrift());
+            }
+        }
+
+        return FFileHelper::SaveStringToFile(csv, *FilePath);
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool WriteJSON(const FString& FilePath, const TArray<FSessionStats>& Sessions, int64 TotalFrames, double Seconds, int32 NumCores)
+    {
+        const UEnum* boneEnum = StaticEnum<EQHandBones>();
+        const UEnum* fingerEnum = StaticEnum<EQHandFinger>();
+
+        FString json;
+        TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&json);
+        writer->WriteObjectStart();
+        writer->WriteValue(TEXT("recordings"), Sessions.Num());
+        writer->WriteValue(TEXT("frames"), (double)TotalFrames);
+        writer->WriteValue(TEXT("seconds"), Seconds);
+        writer->WriteValue(TEXT("cores"), NumCores);
+        writer->WriteValue(TEXT("framesPerSecondPerCore"), Seconds > 0.0 ? TotalFrames / Seconds / NumCores : 0.0);
+
+        writer->WriteArrayStart(TEXT("jitterBands"));
+        for(const TCHAR* bandName : JitterBandNames)
+        {
+            writer->WriteValue(FString(bandName));
+        }
+        writer->WriteArrayEnd();
+
+        writer->WriteArrayStart(TEXT("sessions"));
+        for(const FSessionStats& session : Sessions)
+        {
+            writer->WriteObjectStart();
+            writer->WriteValue(TEXT("file"), session.FilePath);
+            writer->WriteValue(TEXT("valid"), session.Valid);
+            writer->WriteValue(TEXT("frames"), session.Frames);
+            writer->WriteValue(TEXT("duration"), session.Duration);
+
+            writer->WriteArrayStart(TEXT("hands"));
+            for(int32 handIndex = 0; session.Valid && handIndex < 2; ++handIndex)
+            {
+                const FHandStats& hand = session.Hands[handIndex];
+                writer->WriteObjectStart();
+                writer->WriteValue(TEXT("hand"), FString(handIndex == 0 ? TEXT("left") : TEXT("right")));
+                writer->WriteValue(TEXT("trackedFrames"), hand.TrackedFrames);
+                writer->WriteValue(TEXT("trackingLossRate"), session.Frames > 0 ? 1.0 - (double)hand.TrackedFrames / session.Frames : 0.0);
+                writer->WriteValue(TEXT("lossEvents"), hand.LossEvents);
+                writer->WriteValue(TEXT("lowConfidenceFrames"), hand.TrackedFrames - hand.HighConfidenceFrames);
+                writer->WriteValue(TEXT("highConfidenceFrames"), hand.HighConfidenceFrames);
+                writer->WriteValue(TEXT("jitterWindows"), hand.NumJitterWindows);
+
+                // RMS angular speed in deg/s per band
+                writer->WriteObjectStart(TEXT("jitter"));
+                for(int32 bone = 0; bone < NumBones; ++bone)
+                {
+                    writer->WriteArrayStart(boneEnum->GetNameStringByIndex(bone));
+                    for(int32 band = 0; band < NumJitterBands; ++band)
+                    {
+                        writer->WriteValue(hand.GetJitter(bone, band));
+                    }
+                    writer->WriteArrayEnd();
+                }
+                writer->WriteObjectEnd();
+
+                writer->WriteObjectStart(TEXT("pinches"));
+                for(int32 finger = 0; finger < NumFingers; ++finger)
+                {
+                    const FPinchStats& pinch = hand.Pinches[finger];
+                    writer->WriteObjectStart(fingerEnum->GetNameStringByIndex(finger));
+                    writer->WriteValue(TEXT("count"), pinch.Count);
+                    writer->WriteValue(TEXT("meanSeconds"), pinch.Count > 0 ? pinch.TotalSeconds / pinch.Count : 0.0);
+                    writer->WriteValue(TEXT("maxSeconds"), pinch.MaxSeconds);
+                    writer->WriteObjectEnd();
+                }
+                writer->WriteObjectEnd();
+
+                writer->WriteObjectStart(TEXT("handScale"));
+                writer->WriteValue(TEXT("first"), hand.ScaleFirst);
+                writer->WriteValue(TEXT("last"), hand.ScaleLast);
+                writer->WriteValue(TEXT("min"), hand.ScaleCount > 0.0 ? hand.ScaleMin : 0.0f);
+                writer->WriteValue(TEXT("max"), hand.ScaleCount > 0.0 ? hand.ScaleMax : 0.0f);
+                writer->WriteValue(TEXT("driftPerMinute"), hand.GetScaleDrift());
+                writer->WriteObjectEnd();
+
+                writer->WriteObjectEnd();
+            }
+            writer->WriteArrayEnd();
+            writer->WriteObjectEnd();
+        }
+        writer->WriteArrayEnd();
+        writer->WriteObjectEnd();
+        writer->Close();
+
+        return FFileHelper::SaveStringToFile(json, *FilePath);
+    }
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsAnalyticsCommandlet::UQuestHandsAnalyticsCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int32 UQuestHandsAnalyticsCommandlet::Main(const FString& Params)
+{
+    using namespace QuestHands::Analytics;
+
+    FString inputParam;
+    if(!FParse::Value(*Params, TEXT("Input="), inputParam, false))
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsAnalytics : No recordings given, use -Input=<dir>[+<dir>...]"));
+        return 1;
+    }
+
+    FString outputBase = FPaths::ProjectSavedDir() / TEXT("QuestHandsAnalytics");
+    FParse::Value(*Params, TEXT("Output="), outputBase, false);
+
+    TArray<FString> files;
+    QuestHands::Recording::FindRecordings(inputParam, files);
+    if(files.Num() == 0)
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsAnalytics : No recordings found in %s"), *inputParam);
+        return 1;
+    }
+
+    TArray<FSessionStats> sessions;
+    sessions.SetNum(files.Num());
+
+    const double startTime = FPlatformTime::Seconds();
+    ParallelFor(files.Num(), [&files, &sessions](int32 index)
+    {
+        AnalyseRecording(files[index], sessions[index]);
+    });
+    const double seconds = FPlatformTime::Seconds() - startTime;
+
+    // ParallelFor runs on the task graph workers and the calling thread
+    const int32 numCores = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+    int64 totalFrames = 0;
+    int32 numInvalid = 0;
+    for(const FSessionStats& session : sessions)
+    {
+        totalFrames += session.Frames;
+        numInvalid += session.Valid ? 0 : 1;
+    }
+
+    UE_LOG(LogQuestHands, Display, TEXT("QuestHandsAnalytics : Analysed %d recordings, %lld frames in %.2f s on %d cores, %.0f frames/s per core"),
+           files.Num() - numInvalid, totalFrames, seconds, numCores, seconds > 0.0 ? totalFrames / seconds / numCores : 0.0);
+    if(numInvalid > 0)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("QuestHandsAnalytics : %d files couldn't be read as recordings"), numInvalid);
+    }
+
+    const FString csvPath = outputBase + TEXT(".csv");
+    const FString jsonPath = outputBase + TEXT(".json");
+    if(!WriteCSV(csvPath, sessions) || !WriteJSON(jsonPath, sessions, totalFrames, seconds, numCores))
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsAnalytics : Unable to write the summaries to %s"), *outputBase);
+        return 1;
+    }
+
+    UE_LOG(LogQuestHands, Display, TEXT("QuestHandsAnalytics : Wrote %s and %s"), *csvPath, *jsonPath);
+    return 0;
+}
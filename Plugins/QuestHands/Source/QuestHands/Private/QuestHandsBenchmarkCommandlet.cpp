@@ -0,0 +1,826 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsBenchmarkCommandlet.h"
+#include "QuestHands.h"
+#include "QuestHandsComponent.h"
+#include "QuestHandsDataSource.h"
+#include "QuestHandsGrabSubsystem.h"
+#include "QuestHandsPokeSubsystem.h"
+#include "QuestHandsTestWorld.h"
+#include "QuestHandsTopology.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace QuestHands
+{
+namespace Benchmark
+{
+    using namespace TestWorld;
+
+    // Frames ticked before measuring so the physics bodies and pools have settled
+    static constexpr int32 WarmupFrames = 30;
+
+    // Hands are placed on a square grid this far apart so they don't reach each other
+    static constexpr float HandSpacing = 200.0f;
+
+    struct FBenchmarkSettings
+    {
+        int32 Frames = 600;
+        float FrameRate = 72.0f;
+        int32 Seed = 0;
+        FString Params;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * A list of counts given as -Name=1+8+32, or Default when the parameter is missing
+    */
+    static TArray<int32> ParseCounts(const FString& Params, const TCHAR* Name, const TCHAR* Default)
+    {
+        FString countsParam = Default;
+        FParse::Value(*Params, *FString::Printf(TEXT("%s="), Name), countsParam, false);
+
+        TArray<FString> countStrings;
+        countsParam.ParseIntoArray(countStrings, TEXT("+"));
+        TArray<int32> counts;
+        for(const FString& countString : countStrings)
+        {
+            const int32 count = FCString::Atoi(*countString);
+            if(count > 0)
+            {
+                counts.AddUnique(count);
+            }
+        }
+        return counts;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Location of a hand placed on the grid
+    */
+    static FVector GetGridLocation(int32 Index, int32 Count)
+    {
+        const int32 gridSize = FMath::Max(FMath::CeilToInt(FMath::Sqrt((float)Count)), 1);
+        return FVector((Index % gridSize) * HandSpacing, (Index / gridSize) * HandSpacing, 100.0f);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * A static box blocking everything
+    */
+    static UBoxComponent* SpawnBox(UWorld* World, const FVector& Location, const FVector& Extent)
+    {
+        AActor* actor = World->SpawnActor<AActor>();
+        if(!actor)
+        {
+            return nullptr;
+        }
+
+        UBoxComponent* box = NewObject<UBoxComponent>(actor, TEXT("Box"));
+        box->SetBoxExtent(Extent);
+        box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+        actor->SetRootComponent(box);
+        box->SetWorldLocation(Location);
+        box->RegisterComponent();
+        return box;
+    }
+
+    // Fingertip probes per hand and their radius, as the hands component probes them by default
+    static constexpr int32 ProbesPerHand = 5;
+    static constexpr float ProbeRadius = 0.8f;
+
+    // Boxes scattered around each hand for the probes to touch
+    static constexpr int32 BoxesPerHand = 16;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Where a fingertip is at a time, circling around its hand so the probes sweep in and out of the boxes
+    */
+    static FVector GetTipLocation(const FVector& HandLocation, int32 Probe, double Time)
+    {
+        const float angle = (float)Time * (2.0f + Probe * 0.37f) + Probe * 1.3f;
+        return HandLocation + FVector(FMath::Cos(angle) * 25.0f, FMath::Sin(angle) * 25.0f, (Probe - 2) * 4.0f);
+    }
+
+    struct FProbesResult
+    {
+        double GameThreadMs = 0.0;
+        double FrameMs = 0.0;
+        double HitsPerFrame = 0.0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * The fingertip sweeps of NumHands hands for the measured frames, either issued async and collected on the next frame
+      * the way the hands component does, or run synchronously where they're needed.
+    */
+    static void RunProbes(UWorld* World, const FBenchmarkSettings& Settings, int32 NumHands, bool Async, FProbesResult& ResultOut)
+    {
+        ResultOut = FProbesResult();
+
+        const int32 numProbes = NumHands * ProbesPerHand;
+        TArray<FVector> handLocations;
+        for(int32 handIndex = 0; handIndex < NumHands; ++handIndex)
+        {
+            handLocations.Add(GetGridLocation(handIndex, NumHands));
+        }
+
+        TArray<FVector> previousTips;
+        for(int32 probeIndex = 0; probeIndex < numProbes; ++probeIndex)
+        {
+            previousTips.Add(GetTipLocation(handLocations[probeIndex / ProbesPerHand], probeIndex % ProbesPerHand, 0.0));
+        }
+        TArray<FTraceHandle> handles;
+        handles.SetNum(numProbes);
+
+        FCollisionQueryParams queryParams(SCENE_QUERY_STAT(QuestHandsProbeBenchmark), false);
+        const FCollisionShape sphere = FCollisionShape::MakeSphere(ProbeRadius);
+        const float deltaTime = 1.0f / Settings.FrameRate;
+        FApp::SetCurrentTime(0.0);
+
+        int64 numHits = 0;
+        TArray<FHitResult> hits;
+        FTraceDatum traceData;
+        for(int32 frame = -WarmupFrames; frame < Settings.Frames; ++frame)
+        {
+            const double gameThreadStart = FPlatformTime::Seconds();
+            const double time = FApp::GetCurrentTime();
+            for(int32 probeIndex = 0; probeIndex < numProbes; ++probeIndex)
+            {
+                const FVector tip = GetTipLocation(handLocations[probeIndex / ProbesPerHand], probeIndex % ProbesPerHand, time);
+                if(Async)
+                {
+                    if(handles[probeIndex].IsValid() && World->QueryTraceData(handles[probeIndex], traceData))
+                    {
+                        numHits += frame >= 0 ? traceData.OutHits.Num() : 0;
+                    }
+                    handles[probeIndex] = World->AsyncSweepByChannel(EAsyncTraceType::Multi, previousTips[probeIndex], tip, FQuat::Identity,
+                                                                     ECC_WorldDynamic, sphere, queryParams);
+                }
+                else
+                {
+                    World->SweepMultiByChannel(hits, previousTips[probeIndex], tip, FQuat::Identity, ECC_WorldDynamic, sphere, queryParams);
+                    numHits += frame >= 0 ? hits.Num() : 0;
+                }
+                previousTips[probeIndex] = tip;
+            }
+            const double frameStart = FPlatformTime::Seconds();
+
+            AdvanceFrame(World, deltaTime);
+
+            if(frame >= 0)
+            {
+                ResultOut.GameThreadMs += (frameStart - gameThreadStart) * 1000.0;
+                ResultOut.FrameMs += (FPlatformTime::Seconds() - gameThreadStart) * 1000.0;
+            }
+        }
+
+        ResultOut.GameThreadMs /= Settings.Frames;
+        ResultOut.FrameMs /= Settings.Frames;
+        ResultOut.HitsPerFrame = (double)numHits / Settings.Frames;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool RunProbesBenchmark(const FBenchmarkSettings& Settings, FString& CsvOut)
+    {
+        CsvOut = TEXT("hands,probes,mode,game_thread_ms,frame_ms,hits_per_frame\n");
+        for(int32 numHands : ParseCounts(Settings.Params, TEXT("Hands"), TEXT("1+8+32")))
+        {
+            UWorld* world = CreateTestWorld(FString::Printf(TEXT("QuestHandsProbeBenchmark_%d"), numHands));
+            if(!world->HasBegunPlay())
+            {
+                UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : The test world didn't begin play"));
+                DestroyTestWorld(world);
+                return false;
+            }
+
+            FRandomStream random(Settings.Seed);
+            for(int32 handIndex = 0; handIndex < numHands; ++handIndex)
+            {
+                const FVector handLocation = GetGridLocation(handIndex, numHands);
+                for(int32 boxIndex = 0; boxIndex < BoxesPerHand; ++boxIndex)
+                {
+                    SpawnBox(world, handLocation + random.GetUnitVector() * random.FRandRange(10.0f, 40.0f), FVector(random.FRandRange(1.0f, 6.0f)));
+                }
+            }
+
+            FProbesResult syncResult;
+            FProbesResult asyncResult;
+            RunProbes(world, Settings, numHands, false, syncResult);
+            RunProbes(world, Settings, numHands, true, asyncResult);
+            DestroyTestWorld(world);
+
+            const int32 numProbes = numHands * ProbesPerHand;
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsBenchmark : Probes | %3d hands, %4d probes | sync: game thread %.4f ms, frame %.3f ms, %.1f hits | ")
+                                           TEXT("async: game thread %.4f ms, frame %.3f ms, %.1f hits"),
+                   numHands, numProbes, syncResult.GameThreadMs, syncResult.FrameMs, syncResult.HitsPerFrame,
+                   asyncResult.GameThreadMs, asyncResult.FrameMs, asyncResult.HitsPerFrame);
+            CsvOut += FString::Printf(TEXT("%d,%d,sync,%.5f,%.4f,%.2f\n%d,%d,async,%.5f,%.4f,%.2f\n"),
+                                      numHands, numProbes, syncResult.GameThreadMs, syncResult.FrameMs, syncResult.HitsPerFrame,
+                                      numHands, numProbes, asyncResult.GameThreadMs, asyncResult.FrameMs, asyncResult.HitsPerFrame);
+        }
+        return true;
+    }
+
+    // Interactables are scattered through a cube this many world units across per cube root of their count, keeping their density
+    static constexpr float GrabSpacing = 40.0f;
+
+    // Grab queries per measured frame, two hands probing five points each
+    static constexpr int32 GrabQueriesPerFrame = 2;
+    static constexpr int32 GrabProbesPerQuery = 5;
+    static constexpr float GrabSearchRadius = 10.0f;
+
+    // Share of the interactables moved every frame
+    static constexpr float GrabMovingShare = 0.05f;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * The interactables within SearchRadius of any probe point by testing each of them, what the spatial index replaces
+    */
+    static int32 FindGrabCandidatesBruteForce(const TArray<USceneComponent*>& Components, const TArray<float>& Radii, const TArray<FVector>& ProbePoints,
+                                              float SearchRadius)
+    {
+        int32 numFound = 0;
+        for(int32 index = 0; index < Components.Num(); ++index)
+        {
+            const FVector location = Components[index]->GetComponentLocation();
+            for(const FVector& probePoint : ProbePoints)
+            {
+                if(FVector::Dist(probePoint, location) - Radii[index] <= SearchRadius)
+                {
+                    ++numFound;
+                    break;
+                }
+            }
+        }
+        return numFound;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Grab candidate queries and index updates of the grab subsystem for -Interactables= interactables, next to the same
+      * queries testing every interactable.
+    */
+    static bool RunGrabBenchmark(const FBenchmarkSettings& Settings, FString& CsvOut)
+    {
+        CsvOut = TEXT("interactables,query_us,brute_force_query_us,index_update_us_per_frame,candidates_per_query\n");
+        for(int32 numInteractables : ParseCounts(Settings.Params, TEXT("Interactables"), TEXT("100+1000+10000")))
+        {
+            UWorld* world = CreateTestWorld(FString::Printf(TEXT("QuestHandsGrabBenchmark_%d"), numInteractables));
+            UQuestHandsGrabSubsystem* grab = world->GetSubsystem<UQuestHandsGrabSubsystem>();
+            AActor* actor = world->HasBegunPlay() ? world->SpawnActor<AActor>() : nullptr;
+            if(!grab || !actor)
+            {
+                UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : The test world didn't begin play"));
+                DestroyTestWorld(world);
+                return false;
+            }
+
+            FRandomStream random(Settings.Seed);
+            const float halfSize = 0.5f * GrabSpacing * FMath::Pow((float)numInteractables, 1.0f / 3.0f);
+            auto randomPoint = [&random, halfSize]()
+            {
+                return FVector(random.FRandRange(-halfSize, halfSize), random.FRandRange(-halfSize, halfSize), random.FRandRange(-halfSize, halfSize));
+            };
+
+            TArray<USceneComponent*> components;
+            TArray<float> radii;
+            for(int32 index = 0; index < numInteractables; ++index)
+            {
+                USceneComponent* component = NewObject<USceneComponent>(actor);
+                component->SetWorldLocation(randomPoint());
+                component->RegisterComponent();
+                const float radius = random.FRandRange(2.0f, 15.0f);
+                grab->RegisterInteractable(component, radius);
+                components.Add(component);
+                radii.Add(radius);
+            }
+
+            const int32 numMoving = FMath::Max(FMath::RoundToInt(numInteractables * GrabMovingShare), 1);
+            double queryMs = 0.0;
+            double bruteForceMs = 0.0;
+            double updateMs = 0.0;
+            int64 numCandidates = 0;
+            TArray<FQHandGrabCandidate> candidates;
+            TArray<FVector> probePoints;
+            for(int32 frame = 0; frame < Settings.Frames; ++frame)
+            {
+                const double updateStart = FPlatformTime::Seconds();
+                for(int32 move = 0; move < numMoving; ++move)
+                {
+                    USceneComponent* component = components[random.RandHelper(numInteractables)];
+                    component->SetWorldLocation(component->GetComponentLocation() + random.GetUnitVector() * random.FRandRange(0.0f, 5.0f));
+                }
+                updateMs += (FPlatformTime::Seconds() - updateStart) * 1000.0;
+
+                for(int32 query = 0; query < GrabQueriesPerFrame; ++query)
+                {
+                    const FVector handLocation = randomPoint();
+                    probePoints.Reset();
+                    for(int32 probe = 0; probe < GrabProbesPerQuery; ++probe)
+                    {
+                        probePoints.Add(handLocation + random.GetUnitVector() * 8.0f);
+                    }
+
+                    const double queryStart = FPlatformTime::Seconds();
+                    grab->FindGrabCandidates(probePoints, handLocation, 0.5f, GrabSearchRadius, candidates);
+                    const double bruteForceStart = FPlatformTime::Seconds();
+                    FindGrabCandidatesBruteForce(components, radii, probePoints, GrabSearchRadius);
+                    const double bruteForceEnd = FPlatformTime::Seconds();
+
+                    queryMs += (bruteForceStart - queryStart) * 1000.0;
+                    bruteForceMs += (bruteForceEnd - bruteForceStart) * 1000.0;
+                    numCandidates += candidates.Num();
+                }
+            }
+            DestroyTestWorld(world);
+
+            const int32 numQueries = Settings.Frames * GrabQueriesPerFrame;
+            const double queryUs = queryMs * 1000.0 / numQueries;
+            const double bruteForceUs = bruteForceMs * 1000.0 / numQueries;
+            const double updateUs = updateMs * 1000.0 / Settings.Frames;
+            const double candidatesPerQuery = (double)numCandidates / numQueries;
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsBenchmark : Grab | %5d interactables | query %.2f us (brute force %.2f us) | ")
+                                           TEXT("%d moves %.2f us per frame | %.1f candidates"),
+                   numInteractables, queryUs, bruteForceUs, numMoving, updateUs, candidatesPerQuery);
+            CsvOut += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%.2f\n"), numInteractables, queryUs, bruteForceUs, updateUs, candidatesPerQuery);
+        }
+        return true;
+    }
+
+    // Panels are spread through a region this large in front of the hands, each this large
+    static constexpr float PokeRegionSize = 100.0f;
+    static const FVector2D PokePanelSize(20.0f, 12.0f);
+
+    // Fingertips tested per measured frame, the index tips of both hands
+    static constexpr int32 PokeTipsPerFrame = 2;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * The panels a fingertip is in the touch volume of, testing one panel at a time from its component transform. What the
+      * structure of arrays lanes of the poke subsystem replace.
+    */
+    static int32 CountPokeHitsScalar(const TArray<USceneComponent*>& Panels, const FVector& TipLocation, float HoverDistance, float PressDepth)
+    {
+        int32 numHits = 0;
+        for(const USceneComponent* panel : Panels)
+        {
+            const FTransform& transform = panel->GetComponentTransform();
+            const FVector delta = TipLocation - transform.GetLocation();
+            const float distance = FVector::DotProduct(delta, transform.GetUnitAxis(EAxis::X));
+            const float planeX = FVector::DotProduct(delta, transform.GetUnitAxis(EAxis::Y));
+            const float planeY = FVector::DotProduct(delta, transform.GetUnitAxis(EAxis::Z));
+            const FVector scale = transform.GetScale3D();
+            if(distance <= HoverDistance && distance >= -PressDepth &&
+               FMath::Abs(planeX) <= PokePanelSize.X * 0.5f * scale.Y && FMath::Abs(planeY) <= PokePanelSize.Y * 0.5f * scale.Z)
+            {
+                ++numHits;
+            }
+        }
+        return numHits;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Fingertip hit-testing of the poke subsystem for -Panels= panels, next to testing the panels one at a time
+    */
+    static bool RunPokeBenchmark(const FBenchmarkSettings& Settings, FString& CsvOut)
+    {
+        CsvOut = TEXT("panels,fingertip_us,scalar_fingertip_us,scalar_hits_per_frame\n");
+        for(int32 numPanels : ParseCounts(Settings.Params, TEXT("Panels"), TEXT("1+10+50+100+500")))
+        {
+            UWorld* world = CreateTestWorld(FString::Printf(TEXT("QuestHandsPokeBenchmark_%d"), numPanels));
+            UQuestHandsPokeSubsystem* poke = world->GetSubsystem<UQuestHandsPokeSubsystem>();
+            AActor* actor = world->HasBegunPlay() ? world->SpawnActor<AActor>() : nullptr;
+            if(!poke || !actor)
+            {
+                UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : The test world didn't begin play"));
+                DestroyTestWorld(world);
+                return false;
+            }
+
+            FRandomStream random(Settings.Seed);
+            auto randomPoint = [&random]()
+            {
+                return FVector(random.FRandRange(0.0f, PokeRegionSize), random.FRandRange(-0.5f, 0.5f) * PokeRegionSize,
+                               random.FRandRange(-0.5f, 0.5f) * PokeRegionSize);
+            };
+
+            TArray<USceneComponent*> panels;
+            for(int32 index = 0; index < numPanels; ++index)
+            {
+                USceneComponent* panel = NewObject<USceneComponent>(actor);
+                panel->SetWorldLocationAndRotation(randomPoint(), FRotator(random.FRandRange(-30.0f, 30.0f), 180.0f + random.FRandRange(-30.0f, 30.0f), 0.0f));
+                panel->RegisterComponent();
+                poke->RegisterPokePanel(panel, PokePanelSize);
+                panels.Add(panel);
+            }
+
+            // The tips wander through the region so some of the panels are touched every frame
+            FVector tips[PokeTipsPerFrame];
+            for(FVector& tip : tips)
+            {
+                tip = randomPoint();
+            }
+
+            double pokeMs = 0.0;
+            double scalarMs = 0.0;
+            int64 numScalarHits = 0;
+            for(int32 frame = 0; frame < Settings.Frames; ++frame)
+            {
+                for(int32 tipIndex = 0; tipIndex < PokeTipsPerFrame; ++tipIndex)
+                {
+                    const FVector velocity = random.GetUnitVector() * 50.0f;
+                    tips[tipIndex] = ClampVector(tips[tipIndex] + velocity / Settings.FrameRate, FVector(0.0f, -0.5f * PokeRegionSize, -0.5f * PokeRegionSize),
+                                                 FVector(PokeRegionSize, 0.5f * PokeRegionSize, 0.5f * PokeRegionSize));
+
+                    const double pokeStart = FPlatformTime::Seconds();
+                    poke->ProcessFingertip(tipIndex == 0 ? EControllerHand::Left : EControllerHand::Right, tips[tipIndex], velocity);
+                    const double scalarStart = FPlatformTime::Seconds();
+                    numScalarHits += CountPokeHitsScalar(panels, tips[tipIndex], poke->HoverDistance, poke->PressDepth);
+                    const double scalarEnd = FPlatformTime::Seconds();
+
+                    pokeMs += (scalarStart - pokeStart) * 1000.0;
+                    scalarMs += (scalarEnd - scalarStart) * 1000.0;
+                }
+            }
+            DestroyTestWorld(world);
+
+            const int32 numTips = Settings.Frames * PokeTipsPerFrame;
+            const double pokeUs = pokeMs * 1000.0 / numTips;
+            const double scalarUs = scalarMs * 1000.0 / numTips;
+            const double hitsPerFrame = (double)numScalarHits / Settings.Frames;
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsBenchmark : Poke | %4d panels | fingertip %.3f us (one panel at a time %.3f us) | %.2f panels touched per frame"),
+                   numPanels, pokeUs, scalarUs, hitsPerFrame);
+            CsvOut += FString::Printf(TEXT("%d,%.4f,%.4f,%.3f\n"), numPanels, pokeUs, scalarUs, hitsPerFrame);
+        }
+        return true;
+    }
+
+    struct FPhysicsHandsResult
+    {
+        double PhysicsSceneMs = 0.0;
+        double FrameMs = 0.0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * NumPawns hands pawns with synthetic hands, either simulated physics hands with the given solver iterations or, with
+      * 0 iterations, the kinematic capsules the physics hands replace.
+    */
+    static bool RunPhysicsHands(const FBenchmarkSettings& Settings, int32 NumPawns, int32 SolverIterations, FPhysicsHandsResult& ResultOut)
+    {
+        ResultOut = FPhysicsHandsResult();
+
+        UWorld* world = CreateTestWorld(FString::Printf(TEXT("QuestHandsPhysicsHandsBenchmark_%d_%d"), NumPawns, SolverIterations));
+        if(!world->HasBegunPlay())
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : The test world didn't begin play"));
+            DestroyTestWorld(world);
+            return false;
+        }
+
+        for(int32 pawnIndex = 0; pawnIndex < NumPawns; ++pawnIndex)
+        {
+            SpawnHandsPawn(world, GetGridLocation(pawnIndex, NumPawns), MakeShared<FQHandSyntheticDataSource>(Settings.Seed + pawnIndex),
+                           [SolverIterations](UQuestHandsComponent* component)
+            {
+                component->CreateHandMeshComponents = false;
+                component->UseUpdateLOD = false;
+                component->UseGovernor = false;
+                component->UsePhysicsHands = SolverIterations > 0;
+                component->PhysicsHandSettings.PositionSolverIterations = FMath::Max(SolverIterations, 1);
+            });
+        }
+
+        const float deltaTime = 1.0f / Settings.FrameRate;
+        for(int32 frame = 0; frame < WarmupFrames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+        }
+
+        FPhysicsSceneTimer physicsTimer;
+        physicsTimer.Register(world);
+        const double start = FPlatformTime::Seconds();
+        for(int32 frame = 0; frame < Settings.Frames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+        }
+        ResultOut.FrameMs = (FPlatformTime::Seconds() - start) * 1000.0 / Settings.Frames;
+        ResultOut.PhysicsSceneMs = physicsTimer.GetTotalMs() / Settings.Frames;
+        physicsTimer.Unregister();
+
+        DestroyTestWorld(world);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * The physics scene time per simulated physics hand for -Pawns= pawns and -SolverIterations= position iterations,
+      * over the kinematic capsules of the same hands.
+    */
+    static bool RunPhysicsHandsBenchmark(const FBenchmarkSettings& Settings, FString& CsvOut)
+    {
+        CsvOut = TEXT("pawns,hands,solver_iterations,physics_scene_ms,frame_ms,kinematic_physics_scene_ms,kinematic_frame_ms,")
+                 TEXT("physics_scene_ms_per_hand,frame_ms_per_hand\n");
+        const TArray<int32> solverIterations = ParseCounts(Settings.Params, TEXT("SolverIterations"), TEXT("8+4"));
+        for(int32 numPawns : ParseCounts(Settings.Params, TEXT("Pawns"), TEXT("1+4+16")))
+        {
+            FPhysicsHandsResult kinematicResult;
+            if(!RunPhysicsHands(Settings, numPawns, 0, kinematicResult))
+            {
+                return false;
+            }
+
+            const int32 numHands = numPawns * 2;
+            for(int32 iterations : solverIterations)
+            {
+                FPhysicsHandsResult result;
+                if(!RunPhysicsHands(Settings, numPawns, iterations, result))
+                {
+                    return false;
+                }
+
+                const double physicsPerHand = (result.PhysicsSceneMs - kinematicResult.PhysicsSceneMs) / numHands;
+                const double framePerHand = (result.FrameMs - kinematicResult.FrameMs) / numHands;
+                UE_LOG(LogQuestHands, Display, TEXT("QuestHandsBenchmark : PhysicsHands | %3d hands, %d iterations | physics scene %.3f ms (kinematic %.3f ms), ")
+                                               TEXT("frame %.3f ms (kinematic %.3f ms) | per hand: physics scene %.4f ms, frame %.4f ms"),
+                       numHands, iterations, result.PhysicsSceneMs, kinematicResult.PhysicsSceneMs, result.FrameMs, kinematicResult.FrameMs,
+                       physicsPerHand, framePerHand);
+                CsvOut += FString::Printf(TEXT("%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.5f,%.5f\n"), numPawns, numHands, iterations,
+                                          result.PhysicsSceneMs, result.FrameMs, kinematicResult.PhysicsSceneMs, kinematicResult.FrameMs,
+                                          physicsPerHand, framePerHand);
+            }
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Forward kinematics and capsule placement per hand, unrolled over the topology against the generic paths through
+      * the parent indices of the skeleton, for -Hands= hands posed by the synthetic data source every frame.
+    */
+    static bool RunFKBenchmark(const FBenchmarkSettings& Settings, FString& CsvOut)
+    {
+        using namespace Topology;
+
+        CsvOut = TEXT("hands,unrolled_us_per_hand,generic_us_per_hand\n");
+        for(int32 numHands : ParseCounts(Settings.Params, TEXT("Hands"), TEXT("1+8+32")))
+        {
+            FQHandSyntheticDataSource dataSource(Settings.Seed);
+            FQHandSkeleton skeleton;
+            FQHandTrackingState state;
+            dataSource.GetHandSkeleton(EControllerHand::Right, skeleton, 100.0f);
+
+            FTransform localBones[NumBones];
+            FTransform worldBones[NumBones];
+            FTransform capsules[NumBones];
+            bool hasCapsule[NumBones];
+
+            // Keeps the results alive so neither path is optimized away
+            FVector checksum = FVector::ZeroVector;
+            double unrolledMs = 0.0;
+            double genericMs = 0.0;
+            FApp::SetCurrentTime(0.0);
+            for(int32 frame = 0; frame < Settings.Frames; ++frame)
+            {
+                FApp::SetCurrentTime(FApp::GetCurrentTime() + 1.0 / Settings.FrameRate);
+                dataSource.GetTrackingState(EControllerHand::Right, EQHandUpdateStep::UpdateStep_Render, state, 100.0f);
+                for(int32 boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+                {
+                    localBones[boneIndex].SetComponents(state.BoneRotations[boneIndex], skeleton.Bones[boneIndex].Pose.Position, FVector::OneVector);
+                }
+
+                const double unrolledStart = FPlatformTime::Seconds();
+                for(int32 handIndex = 0; handIndex < numHands; ++handIndex)
+                {
+                    const FTransform rootTransform(state.RootPose.Orientation, state.RootPose.Position + GetGridLocation(handIndex, numHands));
+                    FTransform::Multiply(&worldBones[0], &localBones[0], &rootTransform);
+                    SolveFK(localBones, worldBones);
+                    PlaceCapsules(worldBones, capsules);
+                    checksum += capsules[0].GetLocation();
+                }
+                const double genericStart = FPlatformTime::Seconds();
+                for(int32 handIndex = 0; handIndex < numHands; ++handIndex)
+                {
+                    const FTransform rootTransform(state.RootPose.Orientation, state.RootPose.Position + GetGridLocation(handIndex, numHands));
+                    SolveFKGeneric(skeleton, localBones, rootTransform, worldBones);
+                    PlaceCapsulesGeneric(skeleton, worldBones, capsules, hasCapsule);
+                    checksum += capsules[0].GetLocation();
+                }
+                const double genericEnd = FPlatformTime::Seconds();
+
+                unrolledMs += (genericStart - unrolledStart) * 1000.0;
+                genericMs += (genericEnd - genericStart) * 1000.0;
+            }
+
+            const int32 numSolves = Settings.Frames * numHands;
+            const double unrolledUs = unrolledMs * 1000.0 / numSolves;
+            const double genericUs = genericMs * 1000.0 / numSolves;
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsBenchmark : FK | %3d hands | unrolled %.3f us per hand (generic %.3f us per hand) | checksum %.1f"),
+                   numHands, unrolledUs, genericUs, checksum.Size());
+            CsvOut += FString::Printf(TEXT("%d,%.4f,%.4f\n"), numHands, unrolledUs, genericUs);
+        }
+        return true;
+    }
+
+    struct FTickResult
+    {
+        double FrameMs = 0.0;
+        SIZE_T ComponentBytes = 0;
+        SIZE_T HandStateBytes = 0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * NumPawns hands pawns with synthetic hands. With ReadMirrors every Blueprint mirror of the hand state is read each
+      * frame, which copies the whole state into reflected properties every tick the way the components did before the
+      * state was kept native.
+    */
+    static bool RunTick(const FBenchmarkSettings& Settings, int32 NumPawns, bool ReadMirrors, FTickResult& ResultOut)
+    {
+        ResultOut = FTickResult();
+
+        UWorld* world = CreateTestWorld(FString::Printf(TEXT("QuestHandsTickBenchmark_%d_%d"), NumPawns, ReadMirrors ? 1 : 0));
+        if(!world->HasBegunPlay())
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : The test world didn't begin play"));
+            DestroyTestWorld(world);
+            return false;
+        }
+
+        TArray<UQuestHandsComponent*> components;
+        for(int32 pawnIndex = 0; pawnIndex < NumPawns; ++pawnIndex)
+        {
+            components.Add(SpawnHandsPawn(world, GetGridLocation(pawnIndex, NumPawns), MakeShared<FQHandSyntheticDataSource>(Settings.Seed + pawnIndex),
+                                          [](UQuestHandsComponent* component)
+            {
+                component->CreateHandMeshComponents = false;
+                component->UseUpdateLOD = false;
+                component->UseGovernor = false;
+            }));
+        }
+
+        const float deltaTime = 1.0f / Settings.FrameRate;
+        for(int32 frame = 0; frame < WarmupFrames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+        }
+
+        // Keeps the mirror reads alive
+        int32 checksum = 0;
+        const double start = FPlatformTime::Seconds();
+        for(int32 frame = 0; frame < Settings.Frames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+            if(!ReadMirrors)
+                continue;
+
+            for(const UQuestHandsComponent* component : components)
+            {
+                checksum += component->GetLeftHandSkeletonData().Bones.Num() + component->GetRightHandSkeletonData().Bones.Num();
+                checksum += component->GetLeftHandTrackingData().BoneRotations.Num() + component->GetRightHandTrackingData().BoneRotations.Num();
+                checksum += component->GetLeftHandBones().Num() + component->GetRightHandBones().Num();
+                checksum += component->GetLeftCapsules().Num() + component->GetRightCapsules().Num();
+                checksum += component->GetLeftHandFeatures().FingerCurl[0] > 0.5f ? 1 : 0;
+                checksum += component->GetRightHandFeatures().FingerCurl[0] > 0.5f ? 1 : 0;
+            }
+        }
+        ResultOut.FrameMs = (FPlatformTime::Seconds() - start) * 1000.0 / Settings.Frames;
+
+        for(const UQuestHandsComponent* component : components)
+        {
+            FQHandMemoryFootprint footprint;
+            component->GetMemoryFootprint(footprint);
+            ResultOut.ComponentBytes += footprint.GetTotal() - footprint.Capsules;
+            ResultOut.HandStateBytes += footprint.HandState + footprint.TrackingData;
+        }
+        ResultOut.ComponentBytes /= FMath::Max(NumPawns, 1);
+        ResultOut.HandStateBytes /= FMath::Max(NumPawns, 1);
+        UE_LOG(LogQuestHands, Verbose, TEXT("QuestHandsBenchmark : Tick checksum %d"), checksum);
+
+        DestroyTestWorld(world);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Frame time and memory per hands component for -Pawns= pawns with the hand state kept native, against the same
+      * pawns copying their state into the reflected properties every frame.
+    */
+    static bool RunTickBenchmark(const FBenchmarkSettings& Settings, FString& CsvOut)
+    {
+        CsvOut = TEXT("pawns,frame_ms,mirrored_frame_ms,frame_ms_saved_per_pawn,component_bytes,hand_state_bytes\n");
+        for(int32 numPawns : ParseCounts(Settings.Params, TEXT("Pawns"), TEXT("1+4+16")))
+        {
+            FTickResult nativeResult;
+            FTickResult mirroredResult;
+            if(!RunTick(Settings, numPawns, false, nativeResult) || !RunTick(Settings, numPawns, true, mirroredResult))
+            {
+                return false;
+            }
+
+            const double savedPerPawn = (mirroredResult.FrameMs - nativeResult.FrameMs) / numPawns;
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsBenchmark : Tick | %3d pawns | frame %.3f ms (mirrored every frame %.3f ms, %.4f ms per pawn) | ")
+                                           TEXT("%llu bytes per component, %llu of them hand state"),
+                   numPawns, nativeResult.FrameMs, mirroredResult.FrameMs, savedPerPawn,
+                   (uint64)nativeResult.ComponentBytes, (uint64)nativeResult.HandStateBytes);
+            CsvOut += FString::Printf(TEXT("%d,%.4f,%.4f,%.5f,%llu,%llu\n"), numPawns, nativeResult.FrameMs, mirroredResult.FrameMs, savedPerPawn,
+                                      (uint64)nativeResult.ComponentBytes, (uint64)nativeResult.HandStateBytes);
+        }
+        return true;
+    }
+
+    typedef bool (*FBenchmarkFunction)(const FBenchmarkSettings&, FString&);
+
+    struct FBenchmark
+    {
+        const TCHAR* Name;
+        FBenchmarkFunction Run;
+    };
+
+    static const FBenchmark Benchmarks[] =
+    {
+        { TEXT("Probes"), &RunProbesBenchmark },
+        { TEXT("Grab"), &RunGrabBenchmark },
+        { TEXT("Poke"), &RunPokeBenchmark },
+        { TEXT("PhysicsHands"), &RunPhysicsHandsBenchmark },
+        { TEXT("FK"), &RunFKBenchmark },
+        { TEXT("Tick"), &RunTickBenchmark },
+    };
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsBenchmarkCommandlet::UQuestHandsBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int32 UQuestHandsBenchmarkCommandlet::Main(const FString& Params)
+{
+    using namespace QuestHands::Benchmark;
+
+    FBenchmarkSettings settings;
+    settings.Params = Params;
+    FParse::Value(*Params, TEXT("Frames="), settings.Frames);
+    FParse::Value(*Params, TEXT("FrameRate="), settings.FrameRate);
+    FParse::Value(*Params, TEXT("Seed="), settings.Seed);
+    settings.Frames = FMath::Max(settings.Frames, 1);
+    settings.FrameRate = FMath::Max(settings.FrameRate, 1.0f);
+
+    // Every benchmark unless a list is given
+    TArray<FString> benchmarkNames;
+    FString benchmarksParam;
+    if(FParse::Value(*Params, TEXT("Bench="), benchmarksParam, false))
+    {
+        benchmarksParam.ParseIntoArray(benchmarkNames, TEXT("+"));
+    }
+
+    FString outputBase = FPaths::ProjectSavedDir() / TEXT("QuestHandsBenchmark");
+    FParse::Value(*Params, TEXT("Output="), outputBase, false);
+
+    const double previousTime = FApp::GetCurrentTime();
+    int32 numRun = 0;
+    for(const FBenchmark& benchmark : Benchmarks)
+    {
+        if(benchmarkNames.Num() != 0 && !benchmarkNames.Contains(benchmark.Name))
+            continue;
+
+        FString csv;
+        if(!benchmark.Run(settings, csv))
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : %s failed"), benchmark.Name);
+            return 1;
+        }
+
+        const FString csvPath = FString::Printf(TEXT("%s_%s.csv"), *outputBase, benchmark.Name);
+        if(!FFileHelper::SaveStringToFile(csv, *csvPath))
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : Unable to write the report to %s"), *csvPath);
+            return 1;
+        }
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsBenchmark : Wrote %s"), *csvPath);
+        ++numRun;
+    }
+    FApp::SetCurrentTime(previousTime);
+
+    if(numRun == 0)
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsBenchmark : No benchmark matches %s"), *benchmarksParam);
+        return 1;
+    }
+    return 0;
+}
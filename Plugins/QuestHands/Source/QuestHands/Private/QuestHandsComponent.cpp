@@ -1,15 +1,109 @@
 // Copyright(c) 2020 Sheffer Online Services
 
 #include "QuestHandsComponent.h"
+#include "QuestHandsStats.h"
+#include "QuestHandsTopology.h"
+#include "QuestHandsLatency.h"
+#include "QuestHandsMemory.h"
+#include "QuestHandsPokeSubsystem.h"
+#include "QuestHandsPoseTemplates.h"
+#include "QuestHandsRetarget.h"
 #include "GameFramework/WorldSettings.h"
-#include "UObject/ConstructorHelpers.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/Engine.h"
+#include "LatentActions.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
 
 #include "Components/PoseableMeshComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
 
-DECLARE_STATS_GROUP(TEXT("Quest Hands"), STATGROUP_QuestHands, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("RenderTick"), STAT_QuestHands_RenderTick, STATGROUP_QuestHands);
 DECLARE_CYCLE_STAT(TEXT("PhysicsTick"), STAT_QuestHands_PhysicsTick, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("BatchedCapsuleOverlaps"), STAT_QuestHands_BatchedOverlaps, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("FingertipProbes"), STAT_QuestHands_FingertipProbes, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("PointerTraces"), STAT_QuestHands_PointerTraces, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("BoneFK"), STAT_QuestHands_BoneFK, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("HandFeatures"), STAT_QuestHands_HandFeatures, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("BoneSpace"), STAT_QuestHands_BoneSpace, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("HandWaits"), STAT_QuestHands_HandWaits, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("BeginPlay"), STAT_QuestHands_BeginPlay, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("CapsuleSetup"), STAT_QuestHands_CapsuleSetup, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hands at Full LOD"), STAT_QuestHands_LODFull, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hands at Reduced LOD"), STAT_QuestHands_LODReduced, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hands at Skipped LOD"), STAT_QuestHands_LODSkipped, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hand Samples"), STAT_QuestHands_RenderSamples, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Capsule Updates at Full LOD"), STAT_QuestHands_CapsuleLODFull, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Capsule Updates at Reduced LOD"), STAT_QuestHands_CapsuleLODReduced, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Capsule Updates Skipped"), STAT_QuestHands_CapsuleLODSkipped, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Capsule Fixed Steps"), STAT_QuestHands_CapsuleSteps, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Capsule Overlap Events"), STAT_QuestHands_CapsuleOverlapEvents, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fingertip Probes Issued"), STAT_QuestHands_FingertipProbesIssued, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pointer Traces Issued"), STAT_QuestHands_PointerTracesIssued, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pointer Traces Saved"), STAT_QuestHands_PointerTracesSaved, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hand Waits Pending"), STAT_QuestHands_HandWaitsPending, STATGROUP_QuestHands);
+
+namespace QuestHands
+{
+    // A Blueprint latent action waiting on a hand wait of a hands component
+    class FHandWaitLatentAction : public FPendingLatentAction
+    {
+    public:
+        FHandWaitLatentAction(TSharedRef<FQHandWaitTask> InWait, const FLatentActionInfo& LatentInfo)
+            : Wait(InWait)
+            , ExecutionFunction(LatentInfo.ExecutionFunction)
+            , OutputLink(LatentInfo.Linkage)
+            , CallbackTarget(LatentInfo.CallbackTarget)
+        {}
+
+        virtual void UpdateOperation(FLatentResponse& Response) override
+        {
+            // Cancelled waits end without continuing the graph
+            Response.FinishAndTriggerIf(Wait->WasMet(), ExecutionFunction, OutputLink, CallbackTarget);
+            Response.DoneIf(Wait->IsDone());
+        }
+
+        virtual void NotifyObjectDestroyed() override { Wait->Cancel(); }
+        virtual void NotifyActionAborted() override { Wait->Cancel(); }
+
+#if WITH_EDITOR
+        virtual FString GetDescription() const override
+        {
+            return FString::Printf(TEXT("Waiting on hand condition %s"), *StaticEnum<EQHandWaitCondition>()->GetNameStringByValue((int64)Wait->GetCondition().Condition));
+        }
+#endif
+
+    private:
+        TSharedRef<FQHandWaitTask> Wait;
+        FName ExecutionFunction;
+        int32 OutputLink;
+        FWeakObjectPtr CallbackTarget;
+    };
+
+    // Reports the time spent in a hands tick to the governor
+    struct FScopedGovernorWork
+    {
+        FScopedGovernorWork(UQuestHandsGovernorSubsystem* InGovernor, EQHandUpdateStep InStep)
+            : Governor(InGovernor)
+            , Step(InStep)
+            , StartCycles(InGovernor ? FPlatformTime::Cycles() : 0)
+        {}
+
+        ~FScopedGovernorWork()
+        {
+            if(Governor)
+            {
+                Governor->ReportHandsWork(FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - StartCycles), Step);
+            }
+        }
+
+        UQuestHandsGovernorSubsystem* Governor;
+        EQHandUpdateStep Step;
+        uint32 StartCycles;
+    };
+}
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
@@ -45,13 +139,56 @@ FName FQuestHandsPhysicsTickFunction::DiagnosticContext(bool bDetailed)
 UQuestHandsComponent::UQuestHandsComponent() :
       CreateHandMeshComponents(true)
     , UpdateHandMeshComponents(true)
+    , LeftHandMeshAsset(FSoftObjectPath(TEXT("/QuestHands/Meshes/hand_left.hand_left")))
+    , RightHandMeshAsset(FSoftObjectPath(TEXT("/QuestHands/Meshes/hand_right.hand_right")))
     , LeftHandMesh(nullptr)
     , RightHandMesh(nullptr)
+    , UsePooledComponents(true)
+    , UseGhostHands(false)
     , UpdateHandScale(true)
     , UpdatePhysicsCapsules(true)
+    , CapsuleUpdateRate(0.0f)
+    , BatchCapsuleOverlaps(false)
+    , MaxCapsuleCreatesPerFrame(8)
+    , UsePhysicsHands(false)
+    , PoseMeshesFromPhysicsHands(false)
+    , UseFingertipProbes(false)
+    , FingertipProbeChannel(ECC_WorldDynamic)
+    , UsePointerTraces(false)
+    , PointerTraceChannel(ECC_Visibility)
+    , PointerTraceDistance(1000.0f)
+    , UsePokeInteraction(false)
+    , UseUpdateLOD(true)
+    , ForceFullUpdateLOD(false)
+    , ReducedLODDistance(500.0f)
+    , ReducedLODUpdateRate(30.0f)
+    , ReducedLODCapsuleUpdateRate(15.0f)
+    , SkippedLODRenderTimeout(0.25f)
+    , UseGovernor(true)
     , LeftHandBoneRotationOffset(0.0f, 90.0f, 90.0f)
     , RightHandBoneRotationOffset(0.0f, 90.0f, 90.0f)
+    , HandRetarget(nullptr)
+    , leftPhysicsHand(nullptr)
+    , rightPhysicsHand(nullptr)
+    , CurrentUpdateLOD(EQHandUpdateLOD::UpdateLOD_Full)
+    , RenderLODAccumulator(0.0f)
+    , CapsuleLODAccumulator(0.0f)
+    , CapsuleUpdateAccumulator(0.0f)
+    , ReportedMemoryBytes(0)
+    , Pool(nullptr)
+    , Governor(nullptr)
+    , Ghosts(nullptr)
+    , RecordingStartTime(0.0)
 {
+    FMemory::Memzero(MirrorRevisions);
+    GhostHandles[0] = GhostHandles[1] = INDEX_NONE;
+
+    FingertipProbes.Add(FQHandFingertipProbe(EQHandBones::Hand_ThumbTip, 1.0f));
+    FingertipProbes.Add(FQHandFingertipProbe(EQHandBones::Hand_IndexTip, 0.8f));
+    FingertipProbes.Add(FQHandFingertipProbe(EQHandBones::Hand_MiddleTip, 0.8f));
+    FingertipProbes.Add(FQHandFingertipProbe(EQHandBones::Hand_RingTip, 0.8f));
+    FingertipProbes.Add(FQHandFingertipProbe(EQHandBones::Hand_PinkyTip, 0.7f));
+
     PrimaryComponentTick.bCanEverTick = true;
     PrimaryComponentTick.bStartWithTickEnabled = true;
     PrimaryComponentTick.bTickEvenWhenPaused = true;
@@ -64,20 +201,6 @@ UQuestHandsComponent::UQuestHandsComponent() :
     QuestHandsPhysicsTick.bTickEvenWhenPaused = true;
     QuestHandsPhysicsTick.bHighPriority = 1;
     QuestHandsPhysicsTick.TickInterval = 0;
-
-    FString defaultLeftHandPath = TEXT("/QuestHands/Meshes/hand_left");
-#if ENGINE_MINOR_VERSION >= 25
-    LeftHandMesh = ConstructorHelpersInternal::FindOrLoadObject<USkeletalMesh>(defaultLeftHandPath, LOAD_None);
-#else
-    LeftHandMesh = ConstructorHelpersInternal::FindOrLoadObject<USkeletalMesh>(defaultLeftHandPath);
-#endif
-
-    FString defaultRightHandPath = TEXT("/QuestHands/Meshes/hand_right");
-#if ENGINE_MINOR_VERSION >= 25
-    RightHandMesh = ConstructorHelpersInternal::FindOrLoadObject<USkeletalMesh>(defaultRightHandPath, LOAD_None);
-#else
-    RightHandMesh = ConstructorHelpersInternal::FindOrLoadObject<USkeletalMesh>(defaultRightHandPath);
-#endif
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -85,51 +208,29 @@ UQuestHandsComponent::UQuestHandsComponent() :
 */
 void UQuestHandsComponent::BeginPlay()
 {
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_BeginPlay);
+    QUESTHANDS_LLM_SCOPE(LLMTag_HandState);
+
+    UWorld* world = GetWorld();
+    Pool = world ? world->GetSubsystem<UQuestHandsPoolSubsystem>() : nullptr;
+
     UpdateHandTrackingData(EQHandUpdateStep::UpdateStep_Render);
     UpdateHandTrackingData(EQHandUpdateStep::UpdateStep_Physics);
 
-    if(CreateHandMeshComponents)
+    if(UseGhostHands)
     {
-        if(LeftHandMesh)
-        {
-            UPoseableMeshComponent* leftPoseable = NewObject<UPoseableMeshComponent>(GetOwner(), UPoseableMeshComponent::StaticClass());
-            if(leftPoseable)
-            {
-                leftPoseable->AttachToComponent(this, FAttachmentTransformRules::SnapToTargetIncludingScale);
-                leftPoseable->SetSkeletalMesh(LeftHandMesh);
-                leftPoseable->RegisterComponent();
-                leftPoseables.Add(leftPoseable);
-            }
-            else
-            {
-                UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent unable to create PoseableMeshComponent!"));
-            }
-        }
-        else
-        {
-            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent has no valid LeftHandMesh assigned to create a poseable component for!"));
-        }
-
-        if(RightHandMesh)
-        {
-            UPoseableMeshComponent* rightPoseable = NewObject<UPoseableMeshComponent>(GetOwner(), UPoseableMeshComponent::StaticClass());
-            if(rightPoseable)
-            {
-                rightPoseable->AttachToComponent(this, FAttachmentTransformRules::SnapToTargetIncludingScale);
-                rightPoseable->SetSkeletalMesh(RightHandMesh);
-                rightPoseable->RegisterComponent();
-                rightPoseables.Add(rightPoseable);
-            }
-            else
-            {
-                UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent unable to create PoseableMeshComponent!"));
-            }
-        }
-        else
+        Ghosts = world ? world->GetSubsystem<UQuestHandsGhostSubsystem>() : nullptr;
+        if(Ghosts)
         {
-            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent has no valid RightHandMesh assigned to create a poseable component for!"));
+            GhostHandles[0] = Ghosts->AddGhostHand();
+            GhostHandles[1] = Ghosts->AddGhostHand();
         }
     }
+    else if(CreateHandMeshComponents)
+    {
+        RequestHandPoseable(true);
+        RequestHandPoseable(false);
+    }
     else if(LeftHandMeshComponentName.Len() != 0 && RightHandMeshComponentName.Len() != 0)
     {
         TArray<USceneComponent*> Children;
@@ -167,7 +268,7 @@ void UQuestHandsComponent::BeginPlay()
         }
     }
 
-    if(UpdateHandMeshComponents && UpdatePhysicsCapsules)
+    if(UpdateHandMeshComponents && UpdatePhysicsCapsules && !UsePhysicsHands)
     {
         SetupCapsuleComponents();
     }
@@ -181,6 +282,17 @@ void UQuestHandsComponent::BeginPlay()
         }
     }
 
+    if(UseGovernor && world)
+    {
+        Governor = world->GetSubsystem<UQuestHandsGovernorSubsystem>();
+        if(Governor)
+        {
+            Governor->RegisterHandsComponent(this);
+        }
+    }
+
+    RefreshMemoryFootprint();
+
     Super::BeginPlay();
 }
 
@@ -194,6 +306,49 @@ void UQuestHandsComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
         QuestHandsPhysicsTick.UnRegisterTickFunction();
     }
 
+    StopHandRecording();
+    StopSharedFrameExport();
+    CancelHandWaits();
+
+    if(Governor)
+    {
+        Governor->UnregisterHandsComponent(this);
+        Governor = nullptr;
+        GovernorLevel = FQHandGovernorLevel();
+    }
+
+    if(Ghosts)
+    {
+        Ghosts->RemoveGhostHand(GhostHandles[0]);
+        Ghosts->RemoveGhostHand(GhostHandles[1]);
+        GhostHandles[0] = GhostHandles[1] = INDEX_NONE;
+        Ghosts = nullptr;
+    }
+
+    // Hand the components back to the pool before the owner takes them down with it
+    if(EndPlayReason == EEndPlayReason::Destroyed || EndPlayReason == EEndPlayReason::RemovedFromWorld)
+    {
+        ReleaseHandComponents();
+    }
+
+    if(leftPhysicsHand)
+    {
+        leftPhysicsHand->Destroy();
+        leftPhysicsHand = nullptr;
+    }
+    if(rightPhysicsHand)
+    {
+        rightPhysicsHand->Destroy();
+        rightPhysicsHand = nullptr;
+    }
+
+    // Out of play the component no longer counts towards the totals, whatever it still holds is the owner's to destroy
+    if(ReportedMemoryBytes != 0)
+    {
+        QuestHands::Memory::ReportFootprint(this, ReportedMemoryBytes, 0);
+        ReportedMemoryBytes = 0;
+    }
+
     Super::EndPlay(EndPlayReason);
 }
 
@@ -205,13 +360,92 @@ void UQuestHandsComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
     SCOPE_CYCLE_COUNTER(STAT_QuestHands_RenderTick);
+    QuestHands::FScopedGovernorWork governorWork(Governor, EQHandUpdateStep::UpdateStep_Render);
 
-    if(!UQuestHandsFunctions::IsHandTrackingEnabled())
+    if(!IsTrackingEnabled())
     {
+        // The waits still see the hands, as lost
+        UpdateHandWaits();
         return;
     }
 
-    UpdateHandTrackingData(EQHandUpdateStep::UpdateStep_Render);
+    CurrentUpdateLOD = EvaluateUpdateLOD();
+    switch(CurrentUpdateLOD)
+    {
+        case EQHandUpdateLOD::UpdateLOD_Full:
+            INC_DWORD_STAT(STAT_QuestHands_LODFull);
+            break;
+        case EQHandUpdateLOD::UpdateLOD_Reduced:
+            INC_DWORD_STAT(STAT_QuestHands_LODReduced);
+            break;
+        case EQHandUpdateLOD::UpdateLOD_Skipped:
+            INC_DWORD_STAT(STAT_QuestHands_LODSkipped);
+            break;
+    }
+
+    // Below the full LOD the hands are only sampled at the reduced rate
+    bool takeSample = true;
+    const float sampleInterval = 1.0f / FMath::Max(GetEffectiveReducedLODUpdateRate(), 1.0f);
+    if(CurrentUpdateLOD == EQHandUpdateLOD::UpdateLOD_Full)
+    {
+        RenderLODAccumulator = 0.0f;
+    }
+    else
+    {
+        RenderLODAccumulator += DeltaTime;
+        takeSample = RenderLODAccumulator >= sampleInterval;
+        if(takeSample)
+        {
+            RenderLODAccumulator = FMath::Fmod(RenderLODAccumulator, sampleInterval);
+            for(FQHandRuntimeState& handState : HandStates)
+            {
+                handState.BonesPrevious = handState.Bones;
+            }
+        }
+    }
+
+    if(takeSample)
+    {
+        INC_DWORD_STAT(STAT_QuestHands_RenderSamples);
+        UpdateHandTrackingData(EQHandUpdateStep::UpdateStep_Render);
+        UpdateHandWaits();
+
+        // A wait callback may have destroyed the component
+        if(!HasBegunPlay())
+        {
+            return;
+        }
+    }
+
+    if(UsePointerTraces)
+    {
+        for(FQHandRuntimeState& handState : HandStates)
+        {
+            CollectPointerTrace(handState);
+            IssuePointerTrace(handState);
+        }
+    }
+
+    if(UsePokeInteraction)
+    {
+        UpdatePoke(EControllerHand::Left, GetHandState(EControllerHand::Left), DeltaTime);
+        UpdatePoke(EControllerHand::Right, GetHandState(EControllerHand::Right), DeltaTime);
+    }
+
+    // Nobody is looking at these hands, don't bother posing them
+    if(CurrentUpdateLOD == EQHandUpdateLOD::UpdateLOD_Skipped)
+    {
+        return;
+    }
+
+    if(CurrentUpdateLOD == EQHandUpdateLOD::UpdateLOD_Reduced)
+    {
+        const float alpha = FMath::Clamp(RenderLODAccumulator / sampleInterval, 0.0f, 1.0f);
+        for(FQHandRuntimeState& handState : HandStates)
+        {
+            InterpolateBoneTransforms(handState.BonesPrevious, handState.Bones, alpha, handState.BonesInterpolated);
+        }
+    }
 
     if(OnPreHandMeshesUpdate.IsBound())
     {
@@ -231,14 +465,50 @@ void UQuestHandsComponent::TickComponent(float DeltaTime, enum ELevelTick TickTy
 void UQuestHandsComponent::PhysicsTickComponent(FQuestHandsPhysicsTickFunction& tickFunc, float DeltaTime)
 {
     SCOPE_CYCLE_COUNTER(STAT_QuestHands_PhysicsTick);
+    QuestHands::FScopedGovernorWork governorWork(Governor, EQHandUpdateStep::UpdateStep_Physics);
+
+    // Last frames probes have completed by now. Collected every physics tick, whether or not anything below runs,
+    // as the results of async queries are only kept for the frame after they were issued.
+    if(UseFingertipProbes)
+    {
+        CollectFingertipProbes(EControllerHand::Left, GetHandState(EControllerHand::Left));
+        CollectFingertipProbes(EControllerHand::Right, GetHandState(EControllerHand::Right));
+    }
 
-    if(!UQuestHandsFunctions::IsHandTrackingEnabled())
+    if(!IsTrackingEnabled())
     {
         return;
     }
 
+    // Capsules scale with distance only, hands which aren't rendered can still be touching things
+    float sampleDeltaTime = DeltaTime;
+    if(CurrentUpdateLOD != EQHandUpdateLOD::UpdateLOD_Full)
+    {
+        const float capsuleInterval = 1.0f / FMath::Max(ReducedLODCapsuleUpdateRate, 1.0f);
+        CapsuleLODAccumulator += DeltaTime;
+        if(CapsuleLODAccumulator < capsuleInterval)
+        {
+            INC_DWORD_STAT(STAT_QuestHands_CapsuleLODSkipped);
+            return;
+        }
+        sampleDeltaTime = CapsuleLODAccumulator;
+        CapsuleLODAccumulator = FMath::Fmod(CapsuleLODAccumulator, capsuleInterval);
+        INC_DWORD_STAT(STAT_QuestHands_CapsuleLODReduced);
+    }
+    else
+    {
+        CapsuleLODAccumulator = 0.0f;
+        INC_DWORD_STAT(STAT_QuestHands_CapsuleLODFull);
+    }
+
     UpdateHandTrackingData(EQHandUpdateStep::UpdateStep_Physics);
 
+    for(FQHandRuntimeState& handState : HandStates)
+    {
+        Swap(handState.BonesPhysicsPrevious, handState.BonesPhysics);
+        handState.BonesPhysics = handState.Bones;
+    }
+
     if(OnPreCapsulesUpdate.IsBound())
     {
         OnPreCapsulesUpdate.Broadcast(DeltaTime);
@@ -247,235 +517,1318 @@ void UQuestHandsComponent::PhysicsTickComponent(FQuestHandsPhysicsTickFunction&
     // Do we have a poseable mesh to update? Do so!
     if(UpdateHandMeshComponents)
     {
-        DoUpdateHandMeshComponents(false, true);
+        if(GetEffectiveCapsuleUpdateRate() > 0.0f && UpdatePhysicsCapsules && !UsePhysicsHands)
+        {
+            StepCapsules(sampleDeltaTime);
+        }
+        else
+        {
+            DoUpdateHandMeshComponents(false, true);
+        }
+    }
+
+    // Issue the fingertip probes for the new hand state, they run alongside the rest of the frame
+    if(UseFingertipProbes)
+    {
+        for(FQHandRuntimeState& handState : HandStates)
+        {
+            IssueFingertipProbes(handState);
+        }
     }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-bool UQuestHandsComponent::IsHandTrackingAvailable()
+void UQuestHandsComponent::IssueFingertipProbes(FQHandRuntimeState& handState)
 {
-    return UQuestHandsFunctions::IsHandTrackingEnabled();
-}
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_FingertipProbes);
 
-//---------------------------------------------------------------------------------------------------------------------
-/**
-*/
-void UQuestHandsComponent::SaveHandDataDump()
-{
-    UQuestHandsDataDump *tmpTracking = GetMutableDefault<UQuestHandsDataDump>();
-    tmpTracking->LeftHandSkeletonData = LeftHandSkeletonData;
-    tmpTracking->LeftHandTrackingData = LeftHandTrackingData;
-    tmpTracking->RightHandSkeletonData = RightHandSkeletonData;
-    tmpTracking->RightHandTrackingData = RightHandTrackingData;
-    tmpTracking->SaveConfig(CPF_Config, *(FPaths::ProjectSavedDir() / TEXT("HandTrackingDump.txt")));
-    UE_LOG(LogQuestHands, Log, TEXT("Saving Hand Data Dump to %s"), *(FPaths::ProjectSavedDir() / TEXT("HandTrackingDump.txt")));
+    const TArray<FTransform>& bones = handState.Bones;
+    TArray<FVector>& previousProbePositions = handState.FingertipProbePositions;
+    TArray<FTraceHandle>& probeHandles = handState.FingertipProbeHandles;
+
+    probeHandles.SetNum(FingertipProbes.Num());
+    if(previousProbePositions.Num() != FingertipProbes.Num())
+    {
+        previousProbePositions.Init(FVector::ZeroVector, FingertipProbes.Num());
+        for(int32 probeIndex = 0; probeIndex < FingertipProbes.Num(); ++probeIndex)
+        {
+            const int32 boneIndex = (int32)FingertipProbes[probeIndex].Bone;
+            if(bones.IsValidIndex(boneIndex))
+            {
+                previousProbePositions[probeIndex] = bones[boneIndex].GetLocation();
+            }
+        }
+    }
+
+    FCollisionQueryParams queryParams(SCENE_QUERY_STAT(QuestHandsFingertipProbe), false, GetOwner());
+    for(int32 probeIndex = 0; probeIndex < FingertipProbes.Num(); ++probeIndex)
+    {
+        const FQHandFingertipProbe& probe = FingertipProbes[probeIndex];
+        const int32 boneIndex = (int32)probe.Bone;
+        if(!bones.IsValidIndex(boneIndex))
+        {
+            probeHandles[probeIndex] = FTraceHandle();
+            continue;
+        }
+
+        // Sweep from the last probe position so fast pokes don't pass straight through thin surfaces
+        const FVector tipPosition = bones[boneIndex].GetLocation();
+        probeHandles[probeIndex] = GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Multi, previousProbePositions[probeIndex], tipPosition, FQuat::Identity, 
+                                                                   FingertipProbeChannel, FCollisionShape::MakeSphere(probe.Radius), queryParams);
+        previousProbePositions[probeIndex] = tipPosition;
+        INC_DWORD_STAT(STAT_QuestHands_FingertipProbesIssued);
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-bool UQuestHandsComponent::LoadHandDataDump()
+void UQuestHandsComponent::CollectFingertipProbes(EControllerHand hand, FQHandRuntimeState& handState)
 {
-    FString dataPath = FPaths::ProjectSavedDir() / TEXT("HandTrackingDump.txt");
-    if(FPaths::FileExists(dataPath))
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_FingertipProbes);
+
+    TArray<FTraceHandle>& probeHandles = handState.FingertipProbeHandles;
+    TArray<FQHandFingertipContact>& contacts = handState.FingertipContacts;
+
+    if(probeHandles.Num() == 0)
     {
-        UQuestHandsDataDump *tmpTracking = GetMutableDefault<UQuestHandsDataDump>();
-        tmpTracking->LoadConfig(NULL, *dataPath);
+        return;
+    }
 
-        LeftHandSkeletonData = tmpTracking->LeftHandSkeletonData;
-        LeftHandTrackingData = tmpTracking->LeftHandTrackingData;
-        RightHandSkeletonData = tmpTracking->RightHandSkeletonData;
-        RightHandTrackingData = tmpTracking->RightHandTrackingData;
+    TArray<FQHandFingertipContact> newContacts;
+    FTraceDatum traceData;
+    for(int32 probeIndex = 0; probeIndex < probeHandles.Num() && probeIndex < FingertipProbes.Num(); ++probeIndex)
+    {
+        if(!probeHandles[probeIndex].IsValid())
+            continue;
 
-        SetupCapsuleComponents();
+        // A probe whose results are gone can't tell whether the touch ended, keep its contacts until the next probe does
+        if(!GetWorld()->QueryTraceData(probeHandles[probeIndex], traceData))
+        {
+            const EQHandBones bone = FingertipProbes[probeIndex].Bone;
+            for(const FQHandFingertipContact& contact : contacts)
+            {
+                if(contact.Bone == bone)
+                {
+                    newContacts.AddUnique(contact);
+                }
+            }
+            continue;
+        }
 
-        SetupBoneTransforms(LeftHandSkeletonData, LeftHandTrackingData, leftHandBones, true);
-        SetupBoneTransforms(RightHandSkeletonData, RightHandTrackingData, rightHandBones, false);
+        for(const FHitResult& hit : traceData.OutHits)
+        {
+            UPrimitiveComponent* hitComponent = hit.GetComponent();
+            if(hitComponent)
+            {
+                newContacts.AddUnique(FQHandFingertipContact(FingertipProbes[probeIndex].Bone, hitComponent));
+            }
+        }
+    }
+    probeHandles.Reset();
 
-        DoUpdateHandMeshComponents(true, true);
-        return true;
+    for(const FQHandFingertipContact& contact : contacts)
+    {
+        if(!newContacts.Contains(contact) && OnFingertipTouchEnd.IsBound())
+        {
+            OnFingertipTouchEnd.Broadcast(hand, contact.Bone, contact.Component);
+        }
     }
-    return false;
+    for(const FQHandFingertipContact& contact : newContacts)
+    {
+        if(!contacts.Contains(contact) && OnFingertipTouchBegin.IsBound())
+        {
+            OnFingertipTouchBegin.Broadcast(hand, contact.Bone, contact.Component);
+        }
+    }
+
+    contacts = MoveTemp(newContacts);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-void UQuestHandsComponent::UpdateHandTrackingData(const EQHandUpdateStep Step)
+void UQuestHandsComponent::UpdatePoke(EControllerHand hand, FQHandRuntimeState& handState, float DeltaTime)
 {
-    checkf(GetWorld(), TEXT("UQuestHandsComponent : Invalid world!?"));
+    const FQHandTrackingState& trackingState = handState.TrackingState;
+    const TArray<FTransform>& bones = handState.Bones;
+    FVector& previousTipLocation = handState.PokeTipPrevious;
 
-    if(!UQuestHandsFunctions::IsHandTrackingEnabled())
+    UQuestHandsPokeSubsystem* pokeSubsystem = GetWorld()->GetSubsystem<UQuestHandsPokeSubsystem>();
+    if(!pokeSubsystem || !bones.IsValidIndex((int32)EQHandBones::Hand_IndexTip))
     {
         return;
     }
 
-    float worldToMeters = 100.0f;
-    AWorldSettings* worldSettings = GetWorld()->GetWorldSettings();
-    if(worldSettings)
-    {
-        worldToMeters = worldSettings->WorldToMeters;
-    }
-
-    // Get the latest hand skeleton and tracking data
-    UQuestHandsFunctions::GetHandSkeleton_Internal(EControllerHand::Left, LeftHandSkeletonData, worldToMeters);
-    UQuestHandsFunctions::GetHandSkeleton_Internal(EControllerHand::Right, RightHandSkeletonData, worldToMeters);
-    UQuestHandsFunctions::GetTrackingState_Internal(EControllerHand::Left, Step, LeftHandTrackingData, worldToMeters);
-    UQuestHandsFunctions::GetTrackingState_Internal(EControllerHand::Right, Step, RightHandTrackingData, worldToMeters);
+    // An untracked hand is moved out of reach so it releases everything it was touching
+    const FVector tipLocation = trackingState.IsTracked ? bones[(int32)EQHandBones::Hand_IndexTip].GetLocation() : FVector(BIG_NUMBER);
+    const FVector tipVelocity = (trackingState.IsTracked && DeltaTime > SMALL_NUMBER) ? (tipLocation - previousTipLocation) / DeltaTime : FVector::ZeroVector;
+    previousTipLocation = tipLocation;
 
-    // Update our cached skeleton bone transforms
-    SetupBoneTransforms(LeftHandSkeletonData, LeftHandTrackingData, leftHandBones, true);
-    SetupBoneTransforms(RightHandSkeletonData, RightHandTrackingData, rightHandBones, false);
+    pokeSubsystem->ProcessFingertip(hand, tipLocation, tipVelocity);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-void UQuestHandsComponent::SetupBoneTransforms(const FQHandSkeleton& skeleton, const FQHandTrackingState& trackingState, TArray<FTransform>& boneTransforms, bool leftHand)
+void UQuestHandsComponent::IssuePointerTrace(FQHandRuntimeState& handState)
 {
-    // Don't do anything if we aren't tracked, but make sure we at least have a base line if it hasn't been established yet.
-    if(!trackingState.IsTracked && boneTransforms.Num() == skeleton.Bones.Num())
-        return;
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PointerTraces);
 
-    // Ensure the array size is correct
-    boneTransforms.SetNum(skeleton.Bones.Num());
+    const FQHandTrackingState& trackingState = handState.TrackingState;
+    FTraceHandle& traceHandle = handState.PointerTraceHandle;
 
-    for(int32 boneIndex = 0; boneIndex < skeleton.Bones.Num(); ++boneIndex)
+    // The pointer pose is only meaningful while the input is valid
+    if(!trackingState.IsTracked || !trackingState.InputValid)
     {
-        const FQHandBone& bone = skeleton.Bones[boneIndex];
-        if((int32)bone.BoneId != boneIndex)
-        {
-            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent::SetupBoneTransforms - bone ID mismatch!"));
-        }
+        traceHandle = FTraceHandle();
+        handState.PointerTrace = FQHandPointerTrace();
+        return;
+    }
 
-        FQuat rotationIn = bone.Pose.Orientation;
-        if(trackingState.IsTracked)
-        {
-            rotationIn = trackingState.BoneRotations[boneIndex];
-        }
+    const FTransform pointerTransform = FTransform(trackingState.PointerPose.Orientation, trackingState.PointerPose.Position) * GetComponentTransform();
+    const FVector start = pointerTransform.GetLocation();
+    const FVector end = start + pointerTransform.GetRotation().GetForwardVector() * PointerTraceDistance;
 
-        boneTransforms[boneIndex].SetComponents(rotationIn, 
-                                                bone.Pose.Position, 
-                                                FVector::OneVector);
-        if(bone.ParentBoneIndex != -1)
-        {
-            // Apply our parents transform which converts us into world space and applies the root scale, etc
-            boneTransforms[boneIndex] *= boneTransforms[bone.ParentBoneIndex];
-        }
-        else
-        {
-            // Apply our VR root transform AND our rootPose transform
-            FTransform rootTransform(trackingState.RootPose.Orientation, 
-                                     trackingState.RootPose.Position, 
-                                     FVector(UpdateHandScale ? trackingState.HandScale : 1.0f));
-            rootTransform *= GetComponentTransform();
-            boneTransforms[boneIndex] *= rootTransform;
-        }
-    }
+    FCollisionQueryParams queryParams(SCENE_QUERY_STAT(QuestHandsPointerTrace), false, GetOwner());
+    traceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, start, end, PointerTraceChannel, queryParams);
+    INC_DWORD_STAT(STAT_QuestHands_PointerTracesIssued);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-void UQuestHandsComponent::UpdatePoseableWithBoneTransforms(UPoseableMeshComponent* poseable, const TArray<FTransform>& boneTransforms)
+void UQuestHandsComponent::CollectPointerTrace(FQHandRuntimeState& handState)
 {
-    if(!poseable)
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PointerTraces);
+
+    FQHandPointerTrace& pointerTrace = handState.PointerTrace;
+    FTraceHandle& traceHandle = handState.PointerTraceHandle;
+
+    FTraceDatum traceData;
+    if(!traceHandle.IsValid() || !GetWorld()->QueryTraceData(traceHandle, traceData))
     {
         return;
     }
+    traceHandle = FTraceHandle();
 
-    bool isLeftHand = leftPoseables.Contains(poseable);
-    FQuat rotationOffset = isLeftHand ? LeftHandBoneRotationOffset.Quaternion() : RightHandBoneRotationOffset.Quaternion();
-
-    for(int32 boneIndex = 0; boneIndex < boneTransforms.Num(); ++boneIndex)
+    pointerTrace.Valid = true;
+    pointerTrace.Start = traceData.Start;
+    pointerTrace.Hit = traceData.OutHits.Num() != 0 && traceData.OutHits[0].bBlockingHit;
+    if(pointerTrace.Hit)
+    {
+        pointerTrace.HitResult = traceData.OutHits[0];
+        pointerTrace.End = pointerTrace.HitResult.ImpactPoint;
+    }
+    else
     {
-        FString boneName = UQuestHandsFunctions::GetHandBoneName((EQHandBones)boneIndex, isLeftHand);
+        pointerTrace.HitResult = FHitResult();
+        pointerTrace.End = traceData.End;
+    }
+}
 
-        FTransform transSet = boneTransforms[boneIndex];
-        transSet.SetRotation(transSet.GetRotation() * rotationOffset);
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandPointerTrace& UQuestHandsComponent::GetPointerTrace(EControllerHand Hand) const
+{
+    const FQHandRuntimeState& handState = GetHandState(Hand);
 
-        poseable->SetBoneTransformByName(FName(*boneName), transSet, EBoneSpaces::WorldSpace);
+    // Every read after the first this frame would have been its own trace
+    if(handState.PointerTraceReadFrame == GFrameCounter)
+    {
+        INC_DWORD_STAT(STAT_QuestHands_PointerTracesSaved);
     }
+    handState.PointerTraceReadFrame = GFrameCounter;
+
+    return handState.PointerTrace;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-void UQuestHandsComponent::DoUpdateHandMeshComponents(bool visualComponents, bool physicsComponents)
+bool UQuestHandsComponent::FindGrabCandidates(EControllerHand Hand, float SearchRadius, TArray<FQHandGrabCandidate>& CandidatesOut)
 {
-    if(visualComponents)
+    CandidatesOut.Reset();
+
+    UQuestHandsGrabSubsystem* grabSubsystem = GetWorld()->GetSubsystem<UQuestHandsGrabSubsystem>();
+    const TArray<FTransform>& bones = GetHandState(Hand).Bones;
+    const FQHandTrackingState& trackingState = GetHandState(Hand).TrackingState;
+    if(!grabSubsystem || bones.Num() <= (int32)EQHandBones::Hand_PinkyTip)
     {
-        if(leftPoseables.Num())
-        {
-            for(UPoseableMeshComponent* leftPoseable : leftPoseables)
-            {
-                if(!leftPoseable)
-                    continue;
+        return false;
+    }
 
-                if(UpdateHandScale)
-                {
-                    leftPoseable->SetRelativeScale3D(FVector(LeftHandTrackingData.HandScale));
-                }
+    TArray<FVector> probePoints;
+    probePoints.Reserve(6);
+    probePoints.Add(bones[(int32)EQHandBones::Hand_Wrist].GetLocation());
+    for(int32 boneIndex = (int32)EQHandBones::Hand_ThumbTip; boneIndex <= (int32)EQHandBones::Hand_PinkyTip; ++boneIndex)
+    {
+        probePoints.Add(bones[boneIndex].GetLocation());
+    }
 
-                FTransform rootPose(LeftHandTrackingData.RootPose.Orientation, LeftHandTrackingData.RootPose.Position, FVector::OneVector);
-                leftPoseable->SetRelativeTransform(rootPose);
-                UpdatePoseableWithBoneTransforms(leftPoseable, leftHandBones);
-            }
-        }
-        if(rightPoseables.Num())
+    const FVector pinchPoint = (bones[(int32)EQHandBones::Hand_ThumbTip].GetLocation() + bones[(int32)EQHandBones::Hand_IndexTip].GetLocation()) * 0.5f;
+    const float pinchStrength = trackingState.PinchState.IsValidIndex((int32)EQHandFinger::HandFinger_Index) ? 
+                                trackingState.PinchState[(int32)EQHandFinger::HandFinger_Index].Strength : 0.0f;
+
+    grabSubsystem->FindGrabCandidates(probePoints, pinchPoint, pinchStrength, SearchRadius, CandidatesOut);
+    return CandidatesOut.Num() != 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const TArray<FQHandFingertipContact>& UQuestHandsComponent::GetFingertipContacts(EControllerHand Hand) const
+{
+    return GetHandState(Hand).FingertipContacts;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandFeatures& UQuestHandsComponent::GetHandFeatures(EControllerHand Hand) const
+{
+    return GetHandState(Hand).Features;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+float UQuestHandsComponent::GetFingerCurl(EControllerHand Hand, EQHandFinger Finger) const
+{
+    const int32 finger = FMath::Clamp((int32)Finger, 0, 4);
+    return GetHandFeatures(Hand).FingerCurl[finger];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+float UQuestHandsComponent::GetFingerSplay(EControllerHand Hand, EQHandFinger Finger) const
+{
+    // Splay is stored between neighbors starting at the thumb
+    const int32 splay = (int32)Finger;
+    return splay >= 0 && splay < 4 ? GetHandFeatures(Hand).FingerSplay[splay] : 0.0f;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+float UQuestHandsComponent::GetTipToThumbDistance(EControllerHand Hand, EQHandFinger Finger) const
+{
+    // Distances are stored from the index finger on
+    const int32 tip = (int32)Finger - 1;
+    return tip >= 0 && tip < 4 ? GetHandFeatures(Hand).TipToThumbDistance[tip] : 0.0f;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+SIZE_T FQHandRuntimeState::GetAllocatedSize() const
+{
+    SIZE_T boneSpacesSize = 0;
+    for(const FQHandBoneSpaceBuffer& boneSpace : BoneSpaces)
+    {
+        boneSpacesSize += boneSpace.GetAllocatedSize();
+    }
+
+    return boneSpacesSize + TrackingState.BoneRotations.GetAllocatedSize() + TrackingState.PinchState.GetAllocatedSize() +
+           Bones.GetAllocatedSize() + BonesPrevious.GetAllocatedSize() + BonesInterpolated.GetAllocatedSize() +
+           BonesPhysics.GetAllocatedSize() + BonesPhysicsPrevious.GetAllocatedSize() + BonesCapsuleTarget.GetAllocatedSize() + BonesPhysicsHand.GetAllocatedSize() +
+           Capsules.GetAllocatedSize() +
+           FingertipProbeHandles.GetAllocatedSize() + FingertipProbePositions.GetAllocatedSize() + FingertipContacts.GetAllocatedSize() +
+           Skeleton.Bones.GetAllocatedSize() + Skeleton.BoneCapsules.GetAllocatedSize();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+SIZE_T FQHandRuntimeState::GetTrackingDataAllocatedSize() const
+{
+    return TrackingState.BoneRotations.GetAllocatedSize() + TrackingState.PinchState.GetAllocatedSize() +
+           Skeleton.Bones.GetAllocatedSize() + Skeleton.BoneCapsules.GetAllocatedSize();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    for(const FQHandRuntimeState& handState : HandStates)
+    {
+        CumulativeResourceSize.AddDedicatedSystemMemoryBytes(handState.GetAllocatedSize());
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::GetMemoryFootprint(FQHandMemoryFootprint& FootprintOut) const
+{
+    FootprintOut = FQHandMemoryFootprint();
+    FootprintOut.HandState = GetClass()->GetStructureSize();
+    for(const FQHandRuntimeState& handState : HandStates)
+    {
+        const SIZE_T trackingData = handState.GetTrackingDataAllocatedSize();
+        FootprintOut.TrackingData += trackingData;
+        FootprintOut.HandState += handState.GetAllocatedSize() - trackingData;
+
+        for(const UCapsuleComponent* capsule : handState.Capsules)
+        {
+            FootprintOut.Capsules += QuestHands::Memory::GetObjectSize(capsule);
+        }
+    }
+
+    // Poseables found by name belong to the owner rather than to this component
+    if(CreateHandMeshComponents)
+    {
+        for(const UPoseableMeshComponent* poseable : leftPoseables)
+        {
+            FootprintOut.Poseables += QuestHands::Memory::GetObjectSize(poseable);
+        }
+        for(const UPoseableMeshComponent* poseable : rightPoseables)
+        {
+            FootprintOut.Poseables += QuestHands::Memory::GetObjectSize(poseable);
+        }
+    }
+
+    FootprintOut.PhysicsHands = QuestHands::Memory::GetObjectSize(leftPhysicsHand) + QuestHands::Memory::GetObjectSize(rightPhysicsHand);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int64 UQuestHandsComponent::GetMemoryFootprintBytes() const
+{
+    FQHandMemoryFootprint footprint;
+    GetMemoryFootprint(footprint);
+    return (int64)footprint.GetTotal();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::RefreshMemoryFootprint(FQHandMemoryFootprint* FootprintOut)
+{
+    FQHandMemoryFootprint footprint;
+    GetMemoryFootprint(footprint);
+
+    const int64 previousBytes = ReportedMemoryBytes;
+    ReportedMemoryBytes = (int64)footprint.GetTotal();
+    if(ReportedMemoryBytes != previousBytes)
+    {
+        QuestHands::Memory::ReportFootprint(this, previousBytes, ReportedMemoryBytes);
+    }
+
+    if(FootprintOut)
+    {
+        *FootprintOut = footprint;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+    UQuestHandsComponent* This = CastChecked<UQuestHandsComponent>(InThis);
+
+    // The native hand state holds objects outside of the reflected properties
+    for(FQHandRuntimeState& handState : This->HandStates)
+    {
+        Collector.AddReferencedObjects(handState.Capsules, This);
+        for(FQHandFingertipContact& contact : handState.FingertipContacts)
+        {
+            Collector.AddReferencedObject(contact.Component, This);
+        }
+    }
+    for(const TSharedRef<FQHandWaitTask>& wait : This->HandWaits)
+    {
+        Collector.AddReferencedObject(wait->Condition.PoseTemplates, This);
+    }
+
+    Super::AddReferencedObjects(InThis, Collector);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+template<typename T>
+const T& UQuestHandsComponent::RefreshMirror(EControllerHand Hand, EHandMirror Mirror, const T& Source, T& MirrorProperty) const
+{
+    const FQHandRuntimeState& handState = GetHandState(Hand);
+    uint32& mirrorRevision = MirrorRevisions[Hand == EControllerHand::Left ? 0 : 1][Mirror];
+    if(mirrorRevision != handState.Revision)
+    {
+        // The mirror properties are mutable, they're only a cache of the native state
+        MirrorProperty = Source;
+        mirrorRevision = handState.Revision;
+    }
+    return MirrorProperty;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+template<typename T>
+void UQuestHandsComponent::WriteMirror(EControllerHand Hand, EHandMirror Mirror, T& Target, T& MirrorProperty, const T& Value)
+{
+    FQHandRuntimeState& handState = GetHandState(Hand);
+    Target = Value;
+    MirrorProperty = Value;
+    ++handState.Revision;
+    MirrorRevisions[Hand == EControllerHand::Left ? 0 : 1][Mirror] = handState.Revision;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandSkeleton& UQuestHandsComponent::GetLeftHandSkeletonData() const
+{
+    return RefreshMirror(EControllerHand::Left, HandMirror_Skeleton, HandStates[0].Skeleton, LeftHandSkeletonData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SetLeftHandSkeletonData(const FQHandSkeleton& SkeletonData)
+{
+    WriteMirror(EControllerHand::Left, HandMirror_Skeleton, HandStates[0].Skeleton, LeftHandSkeletonData, SkeletonData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandSkeleton& UQuestHandsComponent::GetRightHandSkeletonData() const
+{
+    return RefreshMirror(EControllerHand::Right, HandMirror_Skeleton, HandStates[1].Skeleton, RightHandSkeletonData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SetRightHandSkeletonData(const FQHandSkeleton& SkeletonData)
+{
+    WriteMirror(EControllerHand::Right, HandMirror_Skeleton, HandStates[1].Skeleton, RightHandSkeletonData, SkeletonData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandTrackingState& UQuestHandsComponent::GetLeftHandTrackingData() const
+{
+    return RefreshMirror(EControllerHand::Left, HandMirror_TrackingState, HandStates[0].TrackingState, LeftHandTrackingData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SetLeftHandTrackingData(const FQHandTrackingState& TrackingData)
+{
+    WriteMirror(EControllerHand::Left, HandMirror_TrackingState, HandStates[0].TrackingState, LeftHandTrackingData, TrackingData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandTrackingState& UQuestHandsComponent::GetRightHandTrackingData() const
+{
+    return RefreshMirror(EControllerHand::Right, HandMirror_TrackingState, HandStates[1].TrackingState, RightHandTrackingData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SetRightHandTrackingData(const FQHandTrackingState& TrackingData)
+{
+    WriteMirror(EControllerHand::Right, HandMirror_TrackingState, HandStates[1].TrackingState, RightHandTrackingData, TrackingData);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandFeatures& UQuestHandsComponent::GetLeftHandFeatures() const
+{
+    return RefreshMirror(EControllerHand::Left, HandMirror_Features, HandStates[0].Features, LeftHandFeatures);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandFeatures& UQuestHandsComponent::GetRightHandFeatures() const
+{
+    return RefreshMirror(EControllerHand::Right, HandMirror_Features, HandStates[1].Features, RightHandFeatures);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const TArray<FTransform>& UQuestHandsComponent::GetLeftHandBones() const
+{
+    return RefreshMirror(EControllerHand::Left, HandMirror_Bones, HandStates[0].Bones, leftHandBones);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SetLeftHandBones(const TArray<FTransform>& Bones)
+{
+    WriteMirror(EControllerHand::Left, HandMirror_Bones, HandStates[0].Bones, leftHandBones, Bones);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const TArray<FTransform>& UQuestHandsComponent::GetRightHandBones() const
+{
+    return RefreshMirror(EControllerHand::Right, HandMirror_Bones, HandStates[1].Bones, rightHandBones);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SetRightHandBones(const TArray<FTransform>& Bones)
+{
+    WriteMirror(EControllerHand::Right, HandMirror_Bones, HandStates[1].Bones, rightHandBones, Bones);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const TArray<UCapsuleComponent*>& UQuestHandsComponent::GetLeftCapsules() const
+{
+    return RefreshMirror(EControllerHand::Left, HandMirror_Capsules, HandStates[0].Capsules, leftCapsules);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const TArray<UCapsuleComponent*>& UQuestHandsComponent::GetRightCapsules() const
+{
+    return RefreshMirror(EControllerHand::Right, HandMirror_Capsules, HandStates[1].Capsules, rightCapsules);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandBoneSpaceBuffer& UQuestHandsComponent::GetBoneSpace(EControllerHand Hand, EQHandBoneSpace Space) const
+{
+    check(Space < EQHandBoneSpace::BoneSpace_Max);
+
+    const FQHandRuntimeState& handState = GetHandState(Hand);
+    FQHandBoneSpaceBuffer& buffer = handState.BoneSpaces[(int32)Space];
+
+    // The component can move without the hand state changing, so the spaces are also refreshed every frame
+    if(buffer.Revision != handState.Revision || buffer.Frame != GFrameCounter)
+    {
+        FillBoneSpace(handState, Space, buffer);
+        buffer.Revision = handState.Revision;
+        buffer.Frame = GFrameCounter;
+    }
+    return buffer;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::FillBoneSpace(const FQHandRuntimeState& handState, EQHandBoneSpace space, FQHandBoneSpaceBuffer& buffer) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_BoneSpace);
+
+    const TArray<FTransform>& bones = handState.Bones;
+    const int32 numBones = bones.Num();
+    buffer.Rotations.SetNumUninitialized(numBones, false);
+    buffer.Translations.SetNumUninitialized(numBones, false);
+    buffer.Scales.SetNumUninitialized(numBones, false);
+
+    const FTransform& componentTransform = GetComponentTransform();
+    const bool topologySkeleton = numBones == QuestHands::Topology::NumBones && QuestHands::Topology::MatchesSkeleton(handState.Skeleton);
+    for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+    {
+        FTransform transform;
+        switch(space)
+        {
+            case EQHandBoneSpace::BoneSpace_Local:
+            {
+                int32 parentIndex = -1;
+                if(topologySkeleton)
+                {
+                    parentIndex = QuestHands::Topology::BoneParents[boneIndex];
+                }
+                else if(handState.Skeleton.Bones.IsValidIndex(boneIndex))
+                {
+                    parentIndex = handState.Skeleton.Bones[boneIndex].ParentBoneIndex;
+                }
+                transform = bones[boneIndex].GetRelativeTransform(bones.IsValidIndex(parentIndex) ? bones[parentIndex] : componentTransform);
+                break;
+            }
+            case EQHandBoneSpace::BoneSpace_Component:
+                transform = bones[boneIndex].GetRelativeTransform(componentTransform);
+                break;
+            case EQHandBoneSpace::BoneSpace_Wrist:
+                transform = bones[boneIndex].GetRelativeTransform(bones[(int32)EQHandBones::Hand_Wrist]);
+                break;
+            default:
+                transform = bones[boneIndex];
+                break;
+        }
+
+        buffer.Rotations[boneIndex] = transform.GetRotation();
+        buffer.Translations[boneIndex] = transform.GetTranslation();
+        buffer.Scales[boneIndex] = transform.GetScale3D();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FTransform UQuestHandsComponent::GetBoneTransform(EControllerHand Hand, EQHandBones Bone, EQHandBoneSpace Space) const
+{
+    const FQHandBoneSpaceBuffer& buffer = GetBoneSpace(Hand, Space);
+    const int32 boneIndex = (int32)Bone;
+    return boneIndex < buffer.Num() ? buffer.GetTransform(boneIndex) : FTransform::Identity;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::GetBoneTransforms(EControllerHand Hand, EQHandBoneSpace Space, TArray<FTransform>& TransformsOut) const
+{
+    const FQHandBoneSpaceBuffer& buffer = GetBoneSpace(Hand, Space);
+    TransformsOut.SetNumUninitialized(buffer.Num());
+    for(int32 boneIndex = 0; boneIndex < buffer.Num(); ++boneIndex)
+    {
+        TransformsOut[boneIndex] = buffer.GetTransform(boneIndex);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::GetBoneLocations(EControllerHand Hand, const TArray<EQHandBones>& Bones, EQHandBoneSpace Space, TArray<FVector>& LocationsOut) const
+{
+    const FQHandBoneSpaceBuffer& buffer = GetBoneSpace(Hand, Space);
+    LocationsOut.SetNumUninitialized(Bones.Num());
+    for(int32 index = 0; index < Bones.Num(); ++index)
+    {
+        const int32 boneIndex = (int32)Bones[index];
+        LocationsOut[index] = boneIndex < buffer.Num() ? buffer.Translations[boneIndex] : FVector::ZeroVector;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::StepCapsules(float SampleDeltaTime)
+{
+    if(NeedsCapsuleSetup())
+    {
+        SetupCapsuleComponents();
+    }
+
+    const float stepInterval = 1.0f / GetEffectiveCapsuleUpdateRate();
+    CapsuleUpdateAccumulator += SampleDeltaTime;
+
+    // The capsules hold their pose through physics ticks which no fixed update lands in
+    const int32 numSteps = FMath::FloorToInt(CapsuleUpdateAccumulator / stepInterval);
+    if(numSteps == 0)
+    {
+        return;
+    }
+
+    // Physics keeps one kinematic target per simulation, so only the last update landing in this tick is a move. Earlier ones
+    // would be overwritten before the scene steps, the substeps interpolate the path to the target instead.
+    const float remainder = CapsuleUpdateAccumulator - numSteps * stepInterval;
+    const float alpha = SampleDeltaTime > SMALL_NUMBER ? FMath::Clamp(1.0f - remainder / SampleDeltaTime, 0.0f, 1.0f) : 1.0f;
+    for(FQHandRuntimeState& handState : HandStates)
+    {
+        InterpolateBoneTransforms(handState.BonesPhysicsPrevious, handState.BonesPhysics, alpha, handState.BonesCapsuleTarget);
+        UpdateCapsules(handState.BonesCapsuleTarget, handState);
+    }
+    INC_DWORD_STAT(STAT_QuestHands_CapsuleSteps);
+
+    // Drop any time we couldn't catch up on rather than spiralling after a hitch
+    CapsuleUpdateAccumulator = FMath::Min(remainder, stepInterval);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsComponent::IsHandTrackingAvailable()
+{
+    return IsTrackingEnabled();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SaveHandDataDump()
+{
+    UQuestHandsDataDump *tmpTracking = GetMutableDefault<UQuestHandsDataDump>();
+    tmpTracking->LeftHandSkeletonData = HandStates[0].Skeleton;
+    tmpTracking->LeftHandTrackingData = HandStates[0].TrackingState;
+    tmpTracking->RightHandSkeletonData = HandStates[1].Skeleton;
+    tmpTracking->RightHandTrackingData = HandStates[1].TrackingState;
+    tmpTracking->SaveConfig(CPF_Config, *(FPaths::ProjectSavedDir() / TEXT("HandTrackingDump.txt")));
+    UE_LOG(LogQuestHands, Log, TEXT("Saving Hand Data Dump to %s"), *(FPaths::ProjectSavedDir() / TEXT("HandTrackingDump.txt")));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsComponent::LoadHandDataDump()
+{
+    FString dataPath = FPaths::ProjectSavedDir() / TEXT("HandTrackingDump.txt");
+    if(FPaths::FileExists(dataPath))
+    {
+        UQuestHandsDataDump *tmpTracking = GetMutableDefault<UQuestHandsDataDump>();
+        tmpTracking->LoadConfig(NULL, *dataPath);
+
+        HandStates[0].Skeleton = tmpTracking->LeftHandSkeletonData;
+        HandStates[0].TrackingState = tmpTracking->LeftHandTrackingData;
+        HandStates[1].Skeleton = tmpTracking->RightHandSkeletonData;
+        HandStates[1].TrackingState = tmpTracking->RightHandTrackingData;
+
+        // The capsules are placed right below, create all of them now
+        if(!UsePhysicsHands)
+        {
+            SetupCapsuleComponents(false);
+        }
+
+        for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+        {
+            FQHandRuntimeState& handState = HandStates[handIndex];
+            SetupBoneTransforms(handState.Skeleton, handState.TrackingState, handState.Bones, handIndex == 0);
+            ++handState.Revision;
+        }
+
+        DoUpdateHandMeshComponents(true, true);
+        return true;
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsComponent::StartHandRecording(const FString& RecordingName)
+{
+    if(RecordingName.IsEmpty())
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent : A recording needs a name"));
+        return false;
+    }
+
+    StopHandRecording();
+
+    const FString recordingsDir = QuestHands::Recording::GetRecordingsDir();
+    IFileManager::Get().MakeDirectory(*recordingsDir, true);
+
+    const FString recordingPath = recordingsDir / FPaths::SetExtension(RecordingName, QuestHands::Recording::FileExtension);
+    if(!Recorder.Open(recordingPath, HandStates[0].Skeleton, HandStates[1].Skeleton))
+    {
+        return false;
+    }
+
+    RecordingStartTime = FPlatformTime::Seconds();
+    UE_LOG(LogQuestHands, Log, TEXT("Recording hand tracking to %s"), *recordingPath);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::StopHandRecording()
+{
+    if(Recorder.IsOpen())
+    {
+        UE_LOG(LogQuestHands, Log, TEXT("Recorded %d hand tracking frames to %s"), Recorder.GetNumFrames(), *Recorder.GetFilePath());
+        Recorder.Close();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsComponent::StartSharedFrameExport(const FString& RegionName)
+{
+    StopSharedFrameExport();
+
+    const FString regionName = RegionName.IsEmpty() ? FString(ANSI_TO_TCHAR(QuestHandsShared::DefaultName)) : RegionName;
+    if(!SharedFrameWriter.Open(regionName))
+    {
+        return false;
+    }
+
+    UE_LOG(LogQuestHands, Log, TEXT("Exporting hand tracking to the shared memory region %s"), *regionName);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::StopSharedFrameExport()
+{
+    if(SharedFrameWriter.IsOpen())
+    {
+        UE_LOG(LogQuestHands, Log, TEXT("Exported %llu hand tracking frames to %s"), SharedFrameWriter.GetNumFrames(), *SharedFrameWriter.GetRegionName());
+        SharedFrameWriter.Close();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+TSharedRef<FQHandWaitTask> UQuestHandsComponent::StartHandWait(const FQHandWaitCondition& Condition, TFunction<void(bool)> OnDone)
+{
+    TSharedRef<FQHandWaitTask> wait = MakeShared<FQHandWaitTask>(Condition, MoveTemp(OnDone));
+    HandWaits.Add(wait);
+    return wait;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::CancelHandWaits()
+{
+    // Callbacks may start new waits while the old ones are cancelled
+    TArray<TSharedRef<FQHandWaitTask>> waits = MoveTemp(HandWaits);
+    HandWaits.Reset();
+    for(const TSharedRef<FQHandWaitTask>& wait : waits)
+    {
+        wait->Cancel();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::UpdateHandWaits()
+{
+    if(HandWaits.Num() == 0)
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_HandWaits);
+    INC_DWORD_STAT_BY(STAT_QuestHands_HandWaitsPending, HandWaits.Num());
+
+    // Real time so holds still complete while the game is paused, the component ticks when paused
+    const double time = GetWorld()->GetRealTimeSeconds();
+
+    // Without tracking the last sample is stale, the hands count as lost so waits on them can't complete on it
+    const bool trackingEnabled = IsTrackingEnabled();
+    FQHandTrackingState lostStates[2];
+    if(!trackingEnabled)
+    {
+        for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+        {
+            lostStates[handIndex] = HandStates[handIndex].TrackingState;
+            lostStates[handIndex].IsTracked = false;
+            lostStates[handIndex].InputValid = false;
+        }
+    }
+
+    // Waits started by the callbacks are first evaluated on the next sample, so a met condition can't restart itself forever.
+    // The callbacks run inside Update and may end play for the component, which cancels and empties HandWaits.
+    const TArray<TSharedRef<FQHandWaitTask>> waits = HandWaits;
+    for(const TSharedRef<FQHandWaitTask>& wait : waits)
+    {
+        if(!HasBegunPlay() || IsBeingDestroyed())
+        {
+            return;
+        }
+
+        const EControllerHand hand = wait->GetCondition().Hand;
+        wait->Update(trackingEnabled ? GetHandState(hand).TrackingState : lostStates[hand == EControllerHand::Left ? 0 : 1], time);
+    }
+
+    HandWaits.RemoveAll([](const TSharedRef<FQHandWaitTask>& wait) { return wait->IsDone(); });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::WaitForHandCondition(const FQHandWaitCondition& Condition, FLatentActionInfo LatentInfo)
+{
+    UWorld* world = GetWorld();
+    if(!world)
+    {
+        return;
+    }
+
+    FLatentActionManager& latentManager = world->GetLatentActionManager();
+    if(latentManager.FindExistingAction<QuestHands::FHandWaitLatentAction>(LatentInfo.CallbackTarget, LatentInfo.UUID))
+    {
+        return;
+    }
+
+    latentManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, new QuestHands::FHandWaitLatentAction(StartHandWait(Condition), LatentInfo));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::WaitForHandTracked(EControllerHand Hand, FLatentActionInfo LatentInfo)
+{
+    FQHandWaitCondition condition;
+    condition.Condition = EQHandWaitCondition::WaitCondition_Tracked;
+    condition.Hand = Hand;
+    WaitForHandCondition(condition, LatentInfo);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::WaitForPinch(EControllerHand Hand, EQHandFinger Finger, float HoldTime, FLatentActionInfo LatentInfo)
+{
+    FQHandWaitCondition condition;
+    condition.Condition = EQHandWaitCondition::WaitCondition_Pinched;
+    condition.Hand = Hand;
+    condition.Finger = Finger;
+    condition.HoldTime = HoldTime;
+    WaitForHandCondition(condition, LatentInfo);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::UpdateHandTrackingData(const EQHandUpdateStep Step)
+{
+    checkf(GetWorld(), TEXT("UQuestHandsComponent : Invalid world!?"));
+
+    if(!IsTrackingEnabled())
+    {
+        return;
+    }
+
+    QUESTHANDS_LLM_SCOPE(LLMTag_HandState);
+
+    float worldToMeters = 100.0f;
+    AWorldSettings* worldSettings = GetWorld()->GetWorldSettings();
+    if(worldSettings)
+    {
+        worldToMeters = worldSettings->WorldToMeters;
+    }
+
+    // Get the latest hand skeleton and tracking data
+    for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+    {
+        FQHandRuntimeState& handState = HandStates[handIndex];
+        const EControllerHand hand = handIndex == 0 ? EControllerHand::Left : EControllerHand::Right;
+        if(DataSource.IsValid())
+        {
+            DataSource->GetHandSkeleton(hand, handState.Skeleton, worldToMeters);
+        }
+        else
+        {
+            UQuestHandsFunctions::GetHandSkeleton_Internal(hand, handState.Skeleton, worldToMeters);
+        }
+        // The latency of a sample counts from when the runtime sampled the hand, data sources are sampled as they're read
+        double sampleTime = FPlatformTime::Seconds();
+        if(DataSource.IsValid())
+        {
+            DataSource->GetTrackingState(hand, Step, handState.TrackingState, worldToMeters);
+        }
+        else
+        {
+            UQuestHandsFunctions::GetTrackingState_Internal(hand, Step, handState.TrackingState, worldToMeters, &sampleTime);
+        }
+#if QUESTHANDS_LATENCY_TRACING
+        handState.SampleTime = sampleTime;
+        handState.SampleFrame = GFrameCounter;
+#endif
+        if(handState.TrackingState.IsTracked)
+        {
+            QUESTHANDS_LATENCY_RECORD(Stage_Convert, handState.SampleTime, handState.SampleFrame);
+        }
+
+        // Update our cached skeleton bone transforms
+        SetupBoneTransforms(handState.Skeleton, handState.TrackingState, handState.Bones, handIndex == 0);
+        if(handState.TrackingState.IsTracked)
+        {
+            QUESTHANDS_LATENCY_RECORD(Stage_FK, handState.SampleTime, handState.SampleFrame);
+        }
+
+        // Derive the hand features once here so every consumer reads the same values
+        {
+            SCOPE_CYCLE_COUNTER(STAT_QuestHands_HandFeatures);
+            UQuestHandsFunctions::ComputeHandFeatures(handState.Bones, handState.TrackingState, GetComponentTransform(), handIndex == 0, handState.Features);
+        }
+
+        ++handState.Revision;
+    }
+
+    // Only the render samples are recorded, the physics samples would double the frames at the same time
+    if(Recorder.IsOpen() && Step == EQHandUpdateStep::UpdateStep_Render)
+    {
+        FQHandRecordingFrame frame;
+        frame.Time = FPlatformTime::Seconds() - RecordingStartTime;
+        frame.Hands[0] = HandStates[0].TrackingState;
+        frame.Hands[1] = HandStates[1].TrackingState;
+        Recorder.WriteFrame(frame);
+    }
+
+    if(SharedFrameWriter.IsOpen() && Step == EQHandUpdateStep::UpdateStep_Render)
+    {
+        SharedFrameWriter.WriteFrame(FPlatformTime::Seconds(), HandStates[0].TrackingState, HandStates[0].Bones,
+                                     HandStates[1].TrackingState, HandStates[1].Bones);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::SetupBoneTransforms(const FQHandSkeleton& skeleton, const FQHandTrackingState& trackingState, TArray<FTransform>& boneTransforms, bool leftHand)
+{
+    // Don't do anything if we aren't tracked, but make sure we at least have a base line if it hasn't been established yet.
+    if(!trackingState.IsTracked && boneTransforms.Num() == skeleton.Bones.Num())
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_BoneFK);
+
+    // Ensure the array size is correct
+    boneTransforms.SetNum(skeleton.Bones.Num());
+    if(skeleton.Bones.Num() == 0)
+        return;
+
+    // Apply our VR root transform AND our rootPose transform
+    FTransform rootTransform(trackingState.RootPose.Orientation, 
+                             trackingState.RootPose.Position, 
+                             FVector(UpdateHandScale ? trackingState.HandScale : 1.0f));
+    rootTransform *= GetComponentTransform();
+
+    // Skeletons not matching the topology, such as hand edited dumps, take the generic path through their parent indices
+    if(!QuestHands::Topology::MatchesSkeleton(skeleton))
+    {
+        TArray<FTransform, TInlineAllocator<QuestHands::Topology::NumBones>> localBones;
+        localBones.SetNumUninitialized(skeleton.Bones.Num());
+        for(int32 boneIndex = 0; boneIndex < skeleton.Bones.Num(); ++boneIndex)
+        {
+            const FQHandBone& bone = skeleton.Bones[boneIndex];
+            const bool useTracked = trackingState.IsTracked && trackingState.BoneRotations.IsValidIndex(boneIndex);
+            localBones[boneIndex].SetComponents(useTracked ? trackingState.BoneRotations[boneIndex] : bone.Pose.Orientation, 
+                                                bone.Pose.Position, 
+                                                FVector::OneVector);
+        }
+        QuestHands::Topology::SolveFKGeneric(skeleton, localBones.GetData(), rootTransform, boneTransforms.GetData());
+        return;
+    }
+
+    // The skeleton only supplies the rest offsets, the hierarchy is the compile time topology
+    FTransform localBones[QuestHands::Topology::NumBones];
+    for(int32 boneIndex = 0; boneIndex < QuestHands::Topology::NumBones; ++boneIndex)
+    {
+        const FQHandBone& bone = skeleton.Bones[boneIndex];
+        localBones[boneIndex].SetComponents(trackingState.IsTracked ? trackingState.BoneRotations[boneIndex] : bone.Pose.Orientation, 
+                                            bone.Pose.Position, 
+                                            FVector::OneVector);
+    }
+
+    FTransform* worldBones = boneTransforms.GetData();
+    FTransform::Multiply(&worldBones[0], &localBones[0], &rootTransform);
+    QuestHands::Topology::SolveFK(localBones, worldBones);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::UpdatePoseableWithBoneTransforms(UPoseableMeshComponent* poseable, const TArray<FTransform>& boneTransforms)
+{
+    if(!poseable)
+    {
+        return;
+    }
+
+    bool isLeftHand = leftPoseables.Contains(poseable);
+    if(HandRetarget && HandRetarget->CanApply(poseable, isLeftHand))
+    {
+        HandRetarget->Apply(poseable, boneTransforms, isLeftHand);
+        return;
+    }
+
+    FQuat rotationOffset = isLeftHand ? LeftHandBoneRotationOffset.Quaternion() : RightHandBoneRotationOffset.Quaternion();
+
+    const int32 numBones = FMath::Min(boneTransforms.Num(), QuestHands::Topology::NumBones);
+    for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+    {
+        FTransform transSet = boneTransforms[boneIndex];
+        transSet.SetRotation(transSet.GetRotation() * rotationOffset);
+
+        poseable->SetBoneTransformByName(QuestHands::Topology::GetBoneFName(boneIndex, isLeftHand), transSet, EBoneSpaces::WorldSpace);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::DoUpdateHandMeshComponents(bool visualComponents, bool physicsComponents)
+{
+    if(visualComponents)
+    {
+        for(int32 handIndex = 0; handIndex < 2; ++handIndex)
         {
-            for(UPoseableMeshComponent* rightPoseable : rightPoseables)
+            FQHandRuntimeState& handState = HandStates[handIndex];
+            const TArray<UPoseableMeshComponent*>& poseables = handIndex == 0 ? leftPoseables : rightPoseables;
+            if(poseables.Num() == 0 && !Ghosts)
+                continue;
+
+            // At the reduced LOD the meshes are posed from the interpolated samples
+            const bool useInterpolated = CurrentUpdateLOD == EQHandUpdateLOD::UpdateLOD_Reduced;
+            const TArray<FTransform>* bones = (useInterpolated && handState.BonesInterpolated.Num() == handState.Bones.Num()) ? 
+                                              &handState.BonesInterpolated : &handState.Bones;
+
+            // Or they follow the simulated hands
+            UQuestHandsPhysicsHand* physicsHand = handIndex == 0 ? leftPhysicsHand : rightPhysicsHand;
+            if(UsePhysicsHands && PoseMeshesFromPhysicsHands && physicsHand && physicsHand->IsBuilt())
+            {
+                physicsHand->GetBoneTransforms(*bones, handState.BonesPhysicsHand);
+                bones = &handState.BonesPhysicsHand;
+            }
+
+            // Ghost hands take the world space bones as they are, the segments follow the bone scale
+            if(Ghosts)
+            {
+                if(handState.TrackingState.IsTracked)
+                {
+                    Ghosts->UpdateGhostHand(GhostHandles[handIndex], *bones);
+                }
+                else
+                {
+                    Ghosts->HideGhostHand(GhostHandles[handIndex]);
+                }
+            }
+
+            for(UPoseableMeshComponent* poseable : poseables)
             {
-                if(!rightPoseable)
+                if(!poseable)
                     continue;
 
                 if(UpdateHandScale)
                 {
-                    rightPoseable->SetRelativeScale3D(FVector(RightHandTrackingData.HandScale));
+                    poseable->SetRelativeScale3D(FVector(handState.TrackingState.HandScale));
                 }
 
-                FTransform rootPose(RightHandTrackingData.RootPose.Orientation, RightHandTrackingData.RootPose.Position, FVector::OneVector);
-                rightPoseable->SetRelativeTransform(rootPose);
-                UpdatePoseableWithBoneTransforms(rightPoseable, rightHandBones);
+                FTransform rootPose(handState.TrackingState.RootPose.Orientation, handState.TrackingState.RootPose.Position, FVector::OneVector);
+                poseable->SetRelativeTransform(rootPose);
+                UpdatePoseableWithBoneTransforms(poseable, *bones);
+            }
+
+            if(handState.TrackingState.IsTracked)
+            {
+                QUESTHANDS_LATENCY_RECORD(Stage_PoseApply, handState.SampleTime, handState.SampleFrame);
+                QUESTHANDS_LATENCY_RECORD_RENDER_SUBMIT(handState.SampleTime, handState.SampleFrame);
+            }
+        }
+    }
+
+    if(physicsComponents)
+    {
+        if(UpdatePhysicsCapsules && UsePhysicsHands)
+        {
+            UpdatePhysicsHand(leftPhysicsHand, HandStates[0]);
+            UpdatePhysicsHand(rightPhysicsHand, HandStates[1]);
+        }
+        else if(UpdatePhysicsCapsules)
+        {
+            if(NeedsCapsuleSetup())
+            {
+                SetupCapsuleComponents();
+            }
+            for(FQHandRuntimeState& handState : HandStates)
+            {
+                UpdateCapsules(handState.Bones, handState);
             }
         }
     }
+}
 
-    if(physicsComponents)
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::UpdatePhysicsHand(UQuestHandsPhysicsHand*& physicsHand, const FQHandRuntimeState& handState)
+{
+    const FQHandTrackingState& trackingState = handState.TrackingState;
+    const TArray<FTransform>& bones = handState.Bones;
+
+    if(!physicsHand)
+    {
+        QUESTHANDS_LLM_SCOPE(LLMTag_Physics);
+        physicsHand = NewObject<UQuestHandsPhysicsHand>(this);
+    }
+
+    // Wait for a tracked pose to build from
+    if(!physicsHand->IsBuilt())
     {
-        if(UpdatePhysicsCapsules)
+        QUESTHANDS_LLM_SCOPE(LLMTag_Physics);
+        if(!trackingState.IsTracked || !physicsHand->Build(this, handState.Skeleton, bones, CapsuleBodyData, PhysicsHandSettings))
         {
-            if(leftCapsules.Num() == 0 && LeftHandSkeletonData.BoneCapsules.Num() != 0 &&
-               rightCapsules.Num() == 0 && RightHandSkeletonData.BoneCapsules.Num() != 0)
-            {
-                SetupCapsuleComponents();
-            }
-            UpdateCapsules(leftHandBones, leftCapsules, LeftHandSkeletonData);
-            UpdateCapsules(rightHandBones, rightCapsules, RightHandSkeletonData);
+            return;
         }
+        RefreshMemoryFootprint();
     }
+
+    physicsHand->SetTargets(bones, trackingState.IsTracked);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-void UQuestHandsComponent::SetupCapsuleComponents()
+void UQuestHandsComponent::SetupCapsuleComponents(bool useCreateBudget)
 {
-    if(leftCapsules.Num() != LeftHandSkeletonData.BoneCapsules.Num())
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_CapsuleSetup);
+    QUESTHANDS_LLM_SCOPE(LLMTag_Components);
+
+    // Creating and registering the capsules is costly, they are spread over a few frames and updated as they appear
+    int32 createBudget = useCreateBudget && MaxCapsuleCreatesPerFrame > 0 ? MaxCapsuleCreatesPerFrame : MAX_int32;
+    UQuestHandsPoolSubsystem* pool = UsePooledComponents ? Pool : nullptr;
+    bool created = false;
+
+    for(FQHandRuntimeState& handState : HandStates)
     {
-        leftCapsules.SetNum(LeftHandSkeletonData.BoneCapsules.Num());
-        for(int32 capsuleIndex = 0; capsuleIndex < leftCapsules.Num(); ++capsuleIndex)
+        TArray<UCapsuleComponent*>& capsules = handState.Capsules;
+        if(capsules.Num() < handState.Skeleton.BoneCapsules.Num())
+        {
+            handState.NumMissingCapsules += handState.Skeleton.BoneCapsules.Num() - capsules.Num();
+            capsules.SetNumZeroed(handState.Skeleton.BoneCapsules.Num());
+        }
+
+        for(int32 capsuleIndex = 0; capsuleIndex < capsules.Num() && handState.NumMissingCapsules > 0 && createBudget > 0; ++capsuleIndex)
         {
-            UCapsuleComponent* capsuleComp = NewObject<UCapsuleComponent>(GetOwner(), UCapsuleComponent::StaticClass());
+            if(capsules[capsuleIndex])
+                continue;
+
+            UCapsuleComponent* capsuleComp = nullptr;
+            if(pool)
+            {
+                capsuleComp = pool->AcquireCapsule(this, CapsuleBodyData, true, true);
+            }
+            else
+            {
+                capsuleComp = NewObject<UCapsuleComponent>(GetOwner(), UCapsuleComponent::StaticClass());
+                if(capsuleComp)
+                {
+                    capsuleComp->AttachToComponent(this, FAttachmentTransformRules::SnapToTargetIncludingScale);
+                    capsuleComp->BodyInstance = CapsuleBodyData;
+                    // Kinematic whatever the body data says, the capsules follow the hands through kinematic targets
+                    capsuleComp->BodyInstance.bSimulatePhysics = false;
+                    capsuleComp->SetGenerateOverlapEvents(true);
+                    capsuleComp->ShapeColor = FColor::Blue;
+                    capsuleComp->RegisterComponent();
+                }
+            }
+
+            // A failed create still costs budget, the slot stays empty and is tried again with the next setup
+            --createBudget;
             if(capsuleComp)
             {
-                leftCapsules[capsuleIndex] = capsuleComp;
-                capsuleComp->AttachToComponent(this, FAttachmentTransformRules::SnapToTargetIncludingScale);
-                capsuleComp->BodyInstance = CapsuleBodyData;
-                capsuleComp->ShapeColor = FColor::Blue;
-                capsuleComp->RegisterComponent();
+                capsules[capsuleIndex] = capsuleComp;
+                --handState.NumMissingCapsules;
+                ++handState.Revision;
+                created = true;
             }
             else
             {
@@ -484,33 +1837,162 @@ void UQuestHandsComponent::SetupCapsuleComponents()
         }
     }
 
-    if(rightCapsules.Num() != RightHandSkeletonData.BoneCapsules.Num())
+    if(created)
+    {
+        RefreshMemoryFootprint();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsComponent::NeedsCapsuleSetup() const
+{
+    for(const FQHandRuntimeState& handState : HandStates)
+    {
+        if(handState.NumMissingCapsules > 0 || handState.Capsules.Num() < handState.Skeleton.BoneCapsules.Num())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::ReleaseHandComponents()
+{
+    if(!UsePooledComponents || !Pool)
+    {
+        return;
+    }
+
+    // Only the poseables this component created go back to the pool
+    if(CreateHandMeshComponents)
     {
-        rightCapsules.SetNum(RightHandSkeletonData.BoneCapsules.Num());
-        for(int32 capsuleIndex = 0; capsuleIndex < rightCapsules.Num(); ++capsuleIndex)
+        for(UPoseableMeshComponent* poseable : leftPoseables)
         {
-            UCapsuleComponent* capsuleComp = NewObject<UCapsuleComponent>(GetOwner(), UCapsuleComponent::StaticClass());
-            if(capsuleComp)
-            {
-                rightCapsules[capsuleIndex] = capsuleComp;
-                capsuleComp->AttachToComponent(this, FAttachmentTransformRules::SnapToTargetIncludingScale);
-                capsuleComp->BodyInstance = CapsuleBodyData;
-                capsuleComp->ShapeColor = FColor::Blue;
-                capsuleComp->RegisterComponent();
-            }
-            else
+            Pool->ReleasePoseable(poseable);
+        }
+        for(UPoseableMeshComponent* poseable : rightPoseables)
+        {
+            Pool->ReleasePoseable(poseable);
+        }
+        leftPoseables.Empty();
+        rightPoseables.Empty();
+    }
+
+    for(FQHandRuntimeState& handState : HandStates)
+    {
+        for(UCapsuleComponent* capsule : handState.Capsules)
+        {
+            Pool->ReleaseCapsule(capsule);
+        }
+        handState.Capsules.Empty();
+        handState.NumMissingCapsules = 0;
+        ++handState.Revision;
+    }
+
+    // The mirrors would keep the released capsules referenced until read, while the pool hands them to other components
+    leftCapsules.Empty();
+    rightCapsules.Empty();
+
+    RefreshMemoryFootprint();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::RequestHandPoseable(bool leftHand)
+{
+    USkeletalMesh* mesh = leftHand ? LeftHandMesh : RightHandMesh;
+    const TSoftObjectPtr<USkeletalMesh>& meshAsset = leftHand ? LeftHandMeshAsset : RightHandMeshAsset;
+    if(!mesh && !meshAsset.IsNull())
+    {
+        mesh = meshAsset.Get();
+        if(!mesh)
+        {
+            if(Pool)
             {
-                UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent unable to create UCapsuleComponent!"));
+                Pool->RequestMeshLoad(meshAsset, FStreamableDelegate::CreateUObject(this, &UQuestHandsComponent::OnHandMeshLoaded, leftHand));
+                return;
             }
+            mesh = meshAsset.LoadSynchronous();
+        }
+    }
+
+    CreateHandPoseable(leftHand, mesh);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::OnHandMeshLoaded(bool leftHand)
+{
+    // Play may have ended while the mesh was loading
+    if(!HasBegunPlay() || IsBeingDestroyed())
+    {
+        return;
+    }
+
+    CreateHandPoseable(leftHand, leftHand ? LeftHandMeshAsset.Get() : RightHandMeshAsset.Get());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::CreateHandPoseable(bool leftHand, USkeletalMesh* mesh)
+{
+    QUESTHANDS_LLM_SCOPE(LLMTag_Components);
+
+    if(!mesh)
+    {
+        if(leftHand)
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent has no valid LeftHandMesh assigned to create a poseable component for!"));
+        }
+        else
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent has no valid RightHandMesh assigned to create a poseable component for!"));
+        }
+        return;
+    }
+
+    UPoseableMeshComponent* poseable = nullptr;
+    if(UsePooledComponents && Pool)
+    {
+        poseable = Pool->AcquirePoseable(this, mesh);
+    }
+    else
+    {
+        poseable = NewObject<UPoseableMeshComponent>(GetOwner(), UPoseableMeshComponent::StaticClass());
+        if(poseable)
+        {
+            poseable->AttachToComponent(this, FAttachmentTransformRules::SnapToTargetIncludingScale);
+            poseable->SetSkeletalMesh(mesh);
+            poseable->RegisterComponent();
         }
     }
+
+    if(!poseable)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent unable to create PoseableMeshComponent!"));
+        return;
+    }
+
+    (leftHand ? leftPoseables : rightPoseables).Add(poseable);
+    RefreshMemoryFootprint();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-void UQuestHandsComponent::UpdateCapsules(const TArray<FTransform>& bones, TArray<UCapsuleComponent*>& capsules, const FQHandSkeleton& skeleton)
+void UQuestHandsComponent::UpdateCapsules(const TArray<FTransform>& bones, FQHandRuntimeState& handState)
 {
+    const TArray<UCapsuleComponent*>& capsules = handState.Capsules;
+    const FQHandSkeleton& skeleton = handState.Skeleton;
+
     float worldToMeters = 100.0f;
     AWorldSettings* worldSettings = GetWorld()->GetWorldSettings();
     if(worldSettings)
@@ -525,25 +2007,277 @@ void UQuestHandsComponent::UpdateCapsules(const TArray<FTransform>& bones, TArra
         return;
     }
 
-    TSet<int32> usedindices;
-    for(int32 boneIndex = 0; boneIndex < bones.Num(); ++boneIndex)
+    if(bones.Num() != skeleton.Bones.Num())
+    {
+        return;
+    }
+
+    // Each capsule runs from its bone towards the first child of the bone
+    TArray<FTransform, TInlineAllocator<QuestHands::Topology::NumBones>> capsuleTransforms;
+    TArray<bool, TInlineAllocator<QuestHands::Topology::NumBones>> hasCapsule;
+    capsuleTransforms.SetNumUninitialized(bones.Num());
+    hasCapsule.SetNumUninitialized(bones.Num());
+    if(QuestHands::Topology::MatchesSkeleton(skeleton))
+    {
+        QuestHands::Topology::PlaceCapsules(bones.GetData(), capsuleTransforms.GetData());
+        for(int32 boneIndex = 0; boneIndex < bones.Num(); ++boneIndex)
+        {
+            hasCapsule[boneIndex] = QuestHands::Topology::HasCapsule(boneIndex);
+        }
+    }
+    else
+    {
+        QuestHands::Topology::PlaceCapsulesGeneric(skeleton, bones.GetData(), capsuleTransforms.GetData(), hasCapsule.GetData());
+    }
+
+    for(int32 capsuleIndex = 0; capsuleIndex < capsules.Num(); ++capsuleIndex)
+    {
+        UCapsuleComponent* capsule = capsules[capsuleIndex];
+        if(!capsule || !hasCapsule.IsValidIndex(capsuleIndex) || !hasCapsule[capsuleIndex])
+            continue;
+
+        const FQHandBoneCapsule& boneCapsule = skeleton.BoneCapsules[capsuleIndex];
+        float halfHeight = ((boneCapsule.PointB - boneCapsule.PointA).Size() * worldToMeters) / 2.0f;
+        float radius = boneCapsule.Radius * worldToMeters * 0.8f;
+
+        if(!FMath::IsNearlyEqual(capsule->GetUnscaledCapsuleRadius(), radius) || !FMath::IsNearlyEqual(capsule->GetUnscaledCapsuleHalfHeight(), halfHeight))
+        {
+            capsule->SetCapsuleSize(radius, halfHeight);
+        }
+
+        // Move to a kinematic target rather than teleporting, physics substeps interpolate towards it and collide along the way
+        if(BatchCapsuleOverlaps)
+        {
+            // Update the transform and the physics target without the overlap query of a component move,
+            // ResolveBatchedCapsuleOverlaps updates the overlaps of all the capsules afterwards
+            const USceneComponent* parent = capsule->GetAttachParent();
+            const FTransform relative = parent ? capsuleTransforms[capsuleIndex].GetRelativeTransform(parent->GetSocketTransform(capsule->GetAttachSocketName()))
+                                               : capsuleTransforms[capsuleIndex];
+            capsule->SetRelativeLocation_Direct(relative.GetLocation());
+            capsule->SetRelativeRotation_Direct(relative.Rotator());
+            capsule->SetRelativeScale3D_Direct(relative.GetScale3D());
+            capsule->UpdateComponentToWorld(EUpdateTransformFlags::None, ETeleportType::None);
+        }
+        else
+        {
+            capsule->SetWorldTransform(capsuleTransforms[capsuleIndex], false, nullptr, ETeleportType::None);
+        }
+    }
+
+    if(handState.TrackingState.IsTracked)
+    {
+        QUESTHANDS_LATENCY_RECORD(Stage_CapsuleApply, handState.SampleTime, handState.SampleFrame);
+    }
+
+    if(BatchCapsuleOverlaps)
+    {
+        ResolveBatchedCapsuleOverlaps(handState);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::ResolveBatchedCapsuleOverlaps(FQHandRuntimeState& handState)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_BatchedOverlaps);
+
+    const TArray<UCapsuleComponent*>& capsules = handState.Capsules;
+
+    // One query over the bounds of the whole hand gathers every candidate
+    FBox handBounds(ForceInit);
+    for(const UCapsuleComponent* capsule : capsules)
+    {
+        if(capsule && capsule->IsCollisionEnabled())
+        {
+            handBounds += capsule->Bounds.GetBox();
+        }
+    }
+
+    TArray<FOverlapResult> candidates;
+    if(handBounds.IsValid)
+    {
+        FCollisionQueryParams queryParams(SCENE_QUERY_STAT(QuestHandsCapsuleOverlaps), false);
+        for(const FQHandRuntimeState& ignoredHandState : HandStates)
+        {
+            for(const UCapsuleComponent* capsule : ignoredHandState.Capsules)
+            {
+                queryParams.AddIgnoredComponent(capsule);
+            }
+        }
+        GetWorld()->OverlapMultiByChannel(candidates, handBounds.GetCenter(), FQuat::Identity, CapsuleBodyData.GetObjectType(),
+                                          FCollisionShape::MakeBox(handBounds.GetExtent()), queryParams, 
+                                          FCollisionResponseParams(CapsuleBodyData.GetResponseToChannels()));
+    }
+
+    // Narrow phase each candidate against the individual capsules, giving the overlaps of each capsule at its new location
+    TArray<TArray<FOverlapInfo, TInlineAllocator<4>>, TInlineAllocator<QuestHands::Topology::NumBones>> capsuleOverlaps;
+    capsuleOverlaps.SetNum(capsules.Num());
+    TSet<const UPrimitiveComponent*, DefaultKeyFuncs<const UPrimitiveComponent*>, TInlineSetAllocator<16>> testedCandidates;
+    for(const FOverlapResult& candidate : candidates)
+    {
+        UPrimitiveComponent* other = candidate.GetComponent();
+        AActor* otherActor = candidate.GetActor();
+        if(!other || !other->GetGenerateOverlapEvents() || !otherActor || !otherActor->IsActorInitialized())
+            continue;
+
+        bool alreadyTested = false;
+        testedCandidates.Add(other, &alreadyTested);
+        if(alreadyTested)
+            continue;
+
+        for(int32 capsuleIndex = 0; capsuleIndex < capsules.Num(); ++capsuleIndex)
+        {
+            UCapsuleComponent* capsule = capsules[capsuleIndex];
+            if(capsule && capsule->IsCollisionEnabled() &&
+               other->OverlapComponent(capsule->GetComponentLocation(), capsule->GetComponentQuat(), capsule->GetCollisionShape()))
+            {
+                capsuleOverlaps[capsuleIndex].Add(FOverlapInfo(other));
+            }
+        }
+    }
+
+    // Hand the overlaps to the engine as the overlaps at the end of the move. It keeps OverlappingComponents on both sides
+    // and broadcasts the component and actor begin and end overlap events from the difference, without querying again.
+    for(int32 capsuleIndex = 0; capsuleIndex < capsules.Num(); ++capsuleIndex)
     {
-        int32 parentBoneIndex = skeleton.Bones[boneIndex].ParentBoneIndex;
-        if(parentBoneIndex == -1 || usedindices.Contains(parentBoneIndex) || !capsules[parentBoneIndex])
+        UCapsuleComponent* capsule = capsules[capsuleIndex];
+        if(!capsule || !capsule->GetGenerateOverlapEvents())
             continue;
 
-        FVector bonePos = bones[boneIndex].GetLocation();
-        FVector parentBonePos = bones[parentBoneIndex].GetLocation();
+        const TArray<FOverlapInfo, TInlineAllocator<4>>& overlapsAtEnd = capsuleOverlaps[capsuleIndex];
+        const TArray<FOverlapInfo>& overlapsBefore = capsule->GetOverlapInfos();
+        int32 numEvents = 0;
+        for(const FOverlapInfo& overlap : overlapsAtEnd)
+        {
+            numEvents += overlapsBefore.Contains(overlap) ? 0 : 1;
+        }
+        for(const FOverlapInfo& overlap : overlapsBefore)
+        {
+            numEvents += overlapsAtEnd.Contains(overlap) ? 0 : 1;
+        }
+
+        if(numEvents > 0)
+        {
+            const TOverlapArrayView overlapsAtEndView(overlapsAtEnd);
+            capsule->UpdateOverlaps(nullptr, true, &overlapsAtEndView);
+            INC_DWORD_STAT_BY(STAT_QuestHands_CapsuleOverlapEvents, numEvents);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+EQHandUpdateLOD UQuestHandsComponent::EvaluateUpdateLOD() const
+{
+    if(!UseUpdateLOD || ForceFullUpdateLOD || IsLocallyControlled())
+    {
+        return EQHandUpdateLOD::UpdateLOD_Full;
+    }
+
+    if(!WereHandMeshesRecentlyRendered())
+    {
+        return EQHandUpdateLOD::UpdateLOD_Skipped;
+    }
+
+    APlayerController* playerController = GEngine->GetFirstLocalPlayerController(GetWorld());
+    if(playerController)
+    {
+        FVector viewLocation;
+        FRotator viewRotation;
+        playerController->GetPlayerViewPoint(viewLocation, viewRotation);
+        if(FVector::DistSquared(viewLocation, GetComponentLocation()) > FMath::Square(ReducedLODDistance * GovernorLevel.ReducedLODDistanceScale))
+        {
+            return EQHandUpdateLOD::UpdateLOD_Reduced;
+        }
+    }
+
+    return EQHandUpdateLOD::UpdateLOD_Full;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+float UQuestHandsComponent::GetEffectiveCapsuleUpdateRate() const
+{
+    // A capsule rate of 0 updates once per physics tick, the governor caps it to a fixed rate
+    if(GovernorLevel.CapsuleUpdateRate > 0.0f)
+    {
+        return CapsuleUpdateRate > 0.0f ? FMath::Min(CapsuleUpdateRate, GovernorLevel.CapsuleUpdateRate) : GovernorLevel.CapsuleUpdateRate;
+    }
+    return CapsuleUpdateRate;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+float UQuestHandsComponent::GetEffectiveReducedLODUpdateRate() const
+{
+    if(GovernorLevel.ReducedLODUpdateRate > 0.0f)
+    {
+        return FMath::Min(ReducedLODUpdateRate, GovernorLevel.ReducedLODUpdateRate);
+    }
+    return ReducedLODUpdateRate;
+}
 
-        FVector capsuleLocation = parentBonePos + (bonePos - parentBonePos) / 2.8f;
-        FQuat capsuleRotation = bones[parentBoneIndex].GetRotation() * FRotator(0.0f, 0.0f, 90.0f).Quaternion();
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsComponent::IsLocallyControlled() const
+{
+    AActor* owner = GetOwner();
+    if(!owner)
+    {
+        return false;
+    }
+
+    APawn* pawn = Cast<APawn>(owner);
+    if(!pawn)
+    {
+        pawn = owner->GetInstigator();
+    }
+    return pawn && pawn->IsLocallyControlled();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsComponent::WereHandMeshesRecentlyRendered() const
+{
+    // Without meshes there is nothing to skip
+    if(leftPoseables.Num() == 0 && rightPoseables.Num() == 0)
+    {
+        return true;
+    }
 
-        float halfHeight = ((skeleton.BoneCapsules[parentBoneIndex].PointB - skeleton.BoneCapsules[parentBoneIndex].PointA).Size() * worldToMeters) / 2.0f;
-        float radius = skeleton.BoneCapsules[parentBoneIndex].Radius * worldToMeters * 0.8f;
+    for(const UPoseableMeshComponent* poseable : leftPoseables)
+    {
+        if(poseable && poseable->WasRecentlyRendered(SkippedLODRenderTimeout))
+            return true;
+    }
+    for(const UPoseableMeshComponent* poseable : rightPoseables)
+    {
+        if(poseable && poseable->WasRecentlyRendered(SkippedLODRenderTimeout))
+            return true;
+    }
+    return false;
+}
 
-        capsules[parentBoneIndex]->SetCapsuleSize(radius, halfHeight);
-        capsules[parentBoneIndex]->SetWorldLocationAndRotation(capsuleLocation, capsuleRotation);
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsComponent::InterpolateBoneTransforms(const TArray<FTransform>& fromBones, const TArray<FTransform>& toBones, float alpha, TArray<FTransform>& bonesOut)
+{
+    if(fromBones.Num() != toBones.Num())
+    {
+        bonesOut = toBones;
+        return;
+    }
 
-        usedindices.Add(parentBoneIndex);
+    bonesOut.SetNum(toBones.Num());
+    for(int32 boneIndex = 0; boneIndex < toBones.Num(); ++boneIndex)
+    {
+        bonesOut[boneIndex].Blend(fromBones[boneIndex], toBones[boneIndex], alpha);
     }
 }
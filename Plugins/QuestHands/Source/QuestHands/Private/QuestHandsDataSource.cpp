@@ -0,0 +1,227 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsDataSource.h"
+#include "QuestHands.h"
+#include "QuestHandsTopology.h"
+#include "Misc/App.h"
+#include "Algo/BinarySearch.h"
+
+namespace QuestHands
+{
+namespace Synthetic
+{
+    // Rest positions of the bones of a generic right hand relative to their parents, in centimeters
+    static const FVector BonePositions[Topology::NumBones] =
+    {
+        FVector(0.0f, 0.0f, 0.0f),      // Hand_Wrist
+        FVector(0.0f, 0.0f, 0.0f),      // Hand_Forearm_Stub
+        FVector(2.0f, -1.5f, 1.0f),     // Hand_Thumb0
+        FVector(3.2f, 0.0f, 0.0f),      // Hand_Thumb1
+        FVector(3.4f, 0.0f, 0.0f),      // Hand_Thumb2
+        FVector(2.8f, 0.0f, 0.0f),      // Hand_Thumb3
+        FVector(9.5f, -2.2f, 0.0f),     // Hand_Index1
+        FVector(3.8f, 0.0f, 0.0f),      // Hand_Index2
+        FVector(2.4f, 0.0f, 0.0f),      // Hand_Index3
+        FVector(9.5f, -0.3f, 0.0f),     // Hand_Middle1
+        FVector(4.3f, 0.0f, 0.0f),      // Hand_Middle2
+        FVector(2.8f, 0.0f, 0.0f),      // Hand_Middle3
+        FVector(8.9f, 1.6f, 0.0f),      // Hand_Ring1
+        FVector(3.9f, 0.0f, 0.0f),      // Hand_Ring2
+        FVector(2.7f, 0.0f, 0.0f),      // Hand_Ring3
+        FVector(3.4f, 2.0f, 0.0f),      // Hand_Pinky0
+        FVector(4.7f, 0.6f, 0.0f),      // Hand_Pinky1
+        FVector(3.0f, 0.0f, 0.0f),      // Hand_Pinky2
+        FVector(2.0f, 0.0f, 0.0f),      // Hand_Pinky3
+        FVector(2.6f, 0.0f, 0.0f),      // Hand_ThumbTip
+        FVector(2.2f, 0.0f, 0.0f),      // Hand_IndexTip
+        FVector(2.3f, 0.0f, 0.0f),      // Hand_MiddleTip
+        FVector(2.3f, 0.0f, 0.0f),      // Hand_RingTip
+        FVector(2.1f, 0.0f, 0.0f),      // Hand_PinkyTip
+    };
+
+    static constexpr float CapsuleRadius = 0.8f;
+
+    // The finger each bone curls with, -1 for bones which don't
+    static constexpr int32 BoneFingers[Topology::NumBones] =
+    {
+        -1, -1, 0, 0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, -1, 4, 4, 4, -1, -1, -1, -1, -1
+    };
+
+    // Motion channels, the first five are the finger curls
+    enum EChannel
+    {
+        Channel_Drift = 5,
+        Channel_Turn,
+        Channel_Dropout
+    };
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FQHandSyntheticDataSource::FQHandSyntheticDataSource(int32 Seed)
+{
+    FRandomStream random(Seed);
+    for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+    {
+        for(int32 channel = 0; channel < 8; ++channel)
+        {
+            Phases[handIndex][channel] = random.FRandRange(0.0f, 2.0f * PI);
+            Rates[handIndex][channel] = random.FRandRange(0.3f, 1.5f);
+        }
+        HandScales[handIndex] = random.FRandRange(0.9f, 1.1f);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandSyntheticDataSource::GetHandSkeleton(EControllerHand Hand, FQHandSkeleton& SkeletonOut, float WorldToMeters)
+{
+    using namespace QuestHands;
+
+    // The left hand mirrors the right across the palm
+    const FVector mirror = Hand == EControllerHand::Left ? FVector(1.0f, -1.0f, 1.0f) : FVector::OneVector;
+    const float scale = WorldToMeters / 100.0f;
+
+    SkeletonOut.Bones.SetNum(Topology::NumBones);
+    SkeletonOut.BoneCapsules.Reset();
+    for(int32 boneIndex = 0; boneIndex < Topology::NumBones; ++boneIndex)
+    {
+        FQHandBone& bone = SkeletonOut.Bones[boneIndex];
+        bone.BoneId = (EQHandBones)boneIndex;
+        bone.ParentBoneIndex = Topology::BoneParents[boneIndex];
+        bone.Pose.Orientation = FQuat::Identity;
+        bone.Pose.Position = Synthetic::BonePositions[boneIndex] * mirror * scale;
+
+        const int32 childBone = Topology::CapsuleChildBones[boneIndex];
+        if(childBone != -1)
+        {
+            FQHandBoneCapsule& capsule = SkeletonOut.BoneCapsules.AddDefaulted_GetRef();
+            capsule.BoneIndex = boneIndex;
+            capsule.PointA = FVector::ZeroVector;
+            capsule.PointB = Synthetic::BonePositions[childBone] * mirror * scale;
+            capsule.Radius = Synthetic::CapsuleRadius * scale;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandSyntheticDataSource::GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters)
+{
+    using namespace QuestHands;
+
+    const int32 handIndex = Hand == EControllerHand::Left ? 0 : 1;
+    const float time = (float)FApp::GetCurrentTime();
+    auto wave = [this, handIndex, time](int32 channel)
+    {
+        return FMath::Sin(time * Rates[handIndex][channel] + Phases[handIndex][channel]);
+    };
+
+    // Drop tracking for a short while every now and then
+    StateOut.IsTracked = wave(Synthetic::Channel_Dropout) < 0.97f;
+    StateOut.InputValid = StateOut.IsTracked;
+    StateOut.SystemGestureInProgress = false;
+    StateOut.HandConfidence = StateOut.IsTracked ? EQHandTrackingConfidence::Confidence_High : EQHandTrackingConfidence::Confidence_Low;
+    StateOut.HandScale = HandScales[handIndex];
+
+    // Drift around half a meter in front of the tracking origin
+    const float side = handIndex == 0 ? -1.0f : 1.0f;
+    const float scale = WorldToMeters / 100.0f;
+    const float drift = wave(Synthetic::Channel_Drift);
+    StateOut.RootPose.Position = FVector(40.0f + 8.0f * drift, side * 20.0f + 6.0f * wave(Synthetic::Channel_Turn), 6.0f * drift) * scale;
+    StateOut.RootPose.Orientation = FQuat(FRotator(20.0f * drift, 30.0f * wave(Synthetic::Channel_Turn), side * 10.0f));
+    StateOut.PointerPose = StateOut.RootPose;
+
+    float curls[5];
+    for(int32 finger = 0; finger < 5; ++finger)
+    {
+        curls[finger] = 0.5f + 0.5f * wave(finger);
+    }
+
+    StateOut.BoneRotations.SetNum(Topology::NumBones);
+    for(int32 boneIndex = 0; boneIndex < Topology::NumBones; ++boneIndex)
+    {
+        const int32 finger = Synthetic::BoneFingers[boneIndex];
+        const float curlDegrees = finger == -1 ? 0.0f : curls[finger] * (finger == 0 ? 35.0f : 70.0f);
+        StateOut.BoneRotations[boneIndex] = FQuat(FVector::RightVector, FMath::DegreesToRadians(curlDegrees));
+    }
+
+    StateOut.PinchState.SetNum(5);
+    for(int32 finger = 0; finger < 5; ++finger)
+    {
+        FQHandPinchState& pinch = StateOut.PinchState[finger];
+        pinch.Finger = (EQHandFinger)finger;
+        pinch.Strength = finger == 0 ? 0.0f : FMath::Min(curls[0], curls[finger]);
+        pinch.Pinched = StateOut.InputValid && pinch.Strength > 0.8f;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandRecordingClip::Load(const FString& FilePath)
+{
+    FQHandRecordingReader reader;
+    if(!reader.Open(FilePath))
+    {
+        return false;
+    }
+
+    Skeletons[0] = reader.GetSkeleton(0);
+    Skeletons[1] = reader.GetSkeleton(1);
+    Frames.Reset();
+
+    FQHandRecordingFrame frame;
+    while(reader.ReadFrame(frame))
+    {
+        Frames.Add(frame);
+    }
+    return Frames.Num() > 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FQHandRecordingDataSource::FQHandRecordingDataSource(TSharedRef<const FQHandRecordingClip> InClip, double InTimeOffset)
+    : Clip(InClip)
+    , TimeOffset(InTimeOffset)
+    , StartTime(FApp::GetCurrentTime())
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandRecordingDataSource::GetHandSkeleton(EControllerHand Hand, FQHandSkeleton& SkeletonOut, float WorldToMeters)
+{
+    // Recordings are in the world units they were recorded in
+    SkeletonOut = Clip->Skeletons[Hand == EControllerHand::Left ? 0 : 1];
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandRecordingDataSource::GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters)
+{
+    const TArray<FQHandRecordingFrame>& frames = Clip->Frames;
+    if(frames.Num() == 0)
+    {
+        return false;
+    }
+
+    const double duration = Clip->GetDuration();
+    double playTime = FApp::GetCurrentTime() - StartTime + TimeOffset;
+    playTime = frames[0].Time + (duration > 0.0 ? playTime - FMath::FloorToDouble(playTime / duration) * duration : 0.0);
+
+    // The last frame sampled at or before the play time
+    const int32 frameIndex = FMath::Max(Algo::UpperBoundBy(frames, playTime, &FQHandRecordingFrame::Time) - 1, 0);
+    StateOut = frames[frameIndex].Hands[Hand == EControllerHand::Left ? 0 : 1];
+    return true;
+}
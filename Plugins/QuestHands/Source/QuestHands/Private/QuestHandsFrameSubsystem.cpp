@@ -0,0 +1,214 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsFrameSubsystem.h"
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+#include "QuestHandsTopology.h"
+#include "QuestHandsComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Components/SceneComponent.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("HandsFrameFill"), STAT_QuestHands_HandsFrameFill, STATGROUP_QuestHands);
+
+namespace QuestHands
+{
+namespace HandsFrame
+{
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Times the four call pattern against GetHandsFrame, both filling and reading the shared frame.
+      * QuestHands.BenchmarkHandsFrame [Iterations]
+    */
+    static void Benchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        UQuestHandsFrameSubsystem* frames = World ? World->GetSubsystem<UQuestHandsFrameSubsystem>() : nullptr;
+        if(!frames)
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("QuestHands.BenchmarkHandsFrame needs a game world"));
+            return;
+        }
+        if(!UQuestHandsFunctions::IsHandTrackingEnabled())
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("QuestHands.BenchmarkHandsFrame needs hand tracking, the calls would only measure the early outs"));
+            return;
+        }
+
+        const int32 iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+
+        FQHandSkeleton skeleton;
+        FQHandTrackingState trackingState;
+        double startTime = FPlatformTime::Seconds();
+        for(int32 iteration = 0; iteration < iterations; ++iteration)
+        {
+            UQuestHandsFunctions::GetHandSkeleton(World, EControllerHand::Left, skeleton);
+            UQuestHandsFunctions::GetTrackingState(World, EControllerHand::Left, EQHandUpdateStep::UpdateStep_Render, trackingState);
+            UQuestHandsFunctions::GetHandSkeleton(World, EControllerHand::Right, skeleton);
+            UQuestHandsFunctions::GetTrackingState(World, EControllerHand::Right, EQHandUpdateStep::UpdateStep_Render, trackingState);
+        }
+        const double fourCallUs = (FPlatformTime::Seconds() - startTime) * 1000000.0 / iterations;
+
+        startTime = FPlatformTime::Seconds();
+        for(int32 iteration = 0; iteration < iterations; ++iteration)
+        {
+            frames->InvalidateHandsFrames();
+            frames->GetHandsFrame(EQHandUpdateStep::UpdateStep_Render);
+        }
+        const double fillUs = (FPlatformTime::Seconds() - startTime) * 1000000.0 / iterations;
+
+        FQHandsFrame frameCopy;
+        startTime = FPlatformTime::Seconds();
+        for(int32 iteration = 0; iteration < iterations; ++iteration)
+        {
+            UQuestHandsFunctions::GetHandsFrame(World, EQHandUpdateStep::UpdateStep_Render, frameCopy);
+        }
+        const double sharedUs = (FPlatformTime::Seconds() - startTime) * 1000000.0 / iterations;
+
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHands.BenchmarkHandsFrame over %d iterations: four calls %.2f us, hands frame fill %.2f us (includes the bones), ")
+                                       TEXT("shared hands frame from Blueprint %.2f us"),
+               iterations, fourCallUs, fillUs, sharedUs);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+        TEXT("QuestHands.BenchmarkHandsFrame"),
+        TEXT("Compare reading both hands with GetHandSkeleton and GetTrackingState per hand to GetHandsFrame. Optional iteration count."),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Benchmark));
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandsFrame& UQuestHandsFrameSubsystem::GetHandsFrame(EQHandUpdateStep Step)
+{
+    FQHandsFrame& frame = Frames[Step == EQHandUpdateStep::UpdateStep_Render ? 0 : 1];
+    if(frame.FrameNumber != GFrameCounter)
+    {
+        FillHandsFrame(Step, frame);
+        frame.FrameNumber = GFrameCounter;
+    }
+    return frame;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsFrameSubsystem::SetTrackingOrigin(USceneComponent* Origin)
+{
+    TrackingOrigin = Origin;
+    InvalidateHandsFrames();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsFrameSubsystem::InvalidateHandsFrames()
+{
+    // No engine frame is numbered zero once the engine ticks
+    Frames[0].FrameNumber = 0;
+    Frames[1].FrameNumber = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FTransform UQuestHandsFrameSubsystem::GetTrackingToWorld(bool& UseHandScaleOut) const
+{
+    UseHandScaleOut = true;
+    if(TrackingOrigin.IsValid())
+    {
+        return TrackingOrigin->GetComponentTransform();
+    }
+
+    const APlayerController* playerController = GetWorld()->GetFirstPlayerController();
+    const APawn* pawn = playerController ? playerController->GetPawn() : nullptr;
+    if(!pawn)
+    {
+        return FTransform::Identity;
+    }
+
+    // The bones are placed the way the hands component places its own, relative to the component including any offset
+    const UQuestHandsComponent* handsComponent = pawn->FindComponentByClass<UQuestHandsComponent>();
+    if(handsComponent)
+    {
+        UseHandScaleOut = handsComponent->UpdateHandScale;
+        return handsComponent->GetComponentTransform();
+    }
+    return pawn->GetActorTransform();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsFrameSubsystem::FillHandsFrame(EQHandUpdateStep Step, FQHandsFrame& Frame)
+{
+    using namespace QuestHands;
+
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_HandsFrameFill);
+
+    Frame.Step = Step;
+    Frame.Valid = UQuestHandsFunctions::IsHandTrackingEnabled();
+    if(!Frame.Valid)
+    {
+        Frame.LeftHand.TrackingState.IsTracked = false;
+        Frame.RightHand.TrackingState.IsTracked = false;
+        Frame.LeftHand.Bones.Reset();
+        Frame.RightHand.Bones.Reset();
+        return;
+    }
+
+    const AWorldSettings* worldSettings = GetWorld()->GetWorldSettings();
+    const float worldToMeters = worldSettings ? worldSettings->WorldToMeters : 100.0f;
+    bool useHandScale = true;
+    const FTransform trackingToWorld = GetTrackingToWorld(useHandScale);
+
+    for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+    {
+        const EControllerHand hand = handIndex == 0 ? EControllerHand::Left : EControllerHand::Right;
+        FQHandFrame& handFrame = handIndex == 0 ? Frame.LeftHand : Frame.RightHand;
+        FQHandSkeleton& skeleton = Skeletons[handIndex];
+
+        const bool wasTracked = handFrame.TrackingState.IsTracked;
+        UQuestHandsFunctions::GetTrackingState_Internal(hand, Step, handFrame.TrackingState, worldToMeters);
+
+        // The skeleton only changes when the runtime starts tracking a hand again
+        if(skeleton.Bones.Num() == 0 || (handFrame.TrackingState.IsTracked && !wasTracked))
+        {
+            UQuestHandsFunctions::GetHandSkeleton_Internal(hand, skeleton, worldToMeters);
+        }
+        handFrame.Skeleton = &skeleton;
+
+        // No bones rather than the bones of the last tracked frame
+        const int32 numBones = skeleton.Bones.Num();
+        if(!handFrame.TrackingState.IsTracked || numBones == 0 || handFrame.TrackingState.BoneRotations.Num() != numBones)
+        {
+            handFrame.Bones.Reset();
+            continue;
+        }
+
+        TArray<FTransform, TInlineAllocator<Topology::NumBones>> localBones;
+        localBones.SetNumUninitialized(numBones);
+        for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+        {
+            localBones[boneIndex].SetComponents(handFrame.TrackingState.BoneRotations[boneIndex], skeleton.Bones[boneIndex].Pose.Position, FVector::OneVector);
+        }
+
+        FTransform rootTransform(handFrame.TrackingState.RootPose.Orientation, handFrame.TrackingState.RootPose.Position, FVector(useHandScale ? handFrame.TrackingState.HandScale : 1.0f));
+        rootTransform *= trackingToWorld;
+
+        handFrame.Bones.SetNumUninitialized(numBones, false);
+        FTransform* worldBones = handFrame.Bones.GetData();
+        if(Topology::MatchesSkeleton(skeleton))
+        {
+            FTransform::Multiply(&worldBones[0], &localBones[0], &rootTransform);
+            Topology::SolveFK(localBones.GetData(), worldBones);
+        }
+        else
+        {
+            Topology::SolveFKGeneric(skeleton, localBones.GetData(), rootTransform, worldBones);
+        }
+    }
+}
@@ -1,9 +1,15 @@
 // Copyright(c) 2020 Sheffer Online Services
 
 #include "QuestHandsFunctions.h"
+#include "QuestHandsTopology.h"
+#include "QuestHandsFrameSubsystem.h"
+#include "QuestHandsPoseConversion.h"
+#include "QuestHandsStats.h"
 #include "IOculusInputModule.h"
 #include "Engine/World.h"
 #include "GameFramework/WorldSettings.h"
+#include "HAL/ThreadSafeBool.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
 #if OCULUS_INPUT_SUPPORTED_PLATFORMS
 
@@ -13,10 +19,94 @@
 static_assert(ovrpBoneId_Max == (int32)EQHandBones::Hand_PinkyTip + 1, "EQHandBones needs to be aligned with the Oculus enum ovrpBoneId");
 static_assert(ovrpHandFinger_Max == (int32)EQHandFinger::HandFinger_Pinky + 1, "EQHandFinger needs to be aligned with the Oculus enum ovrpHandFinger");
 
+// The batched pose conversion reads the OVR poses through plain layouts
+static_assert(sizeof(ovrpQuatf) == sizeof(QuestHands::FRawQuat) && STRUCT_OFFSET(ovrpQuatf, w) == STRUCT_OFFSET(QuestHands::FRawQuat, W), "FRawQuat needs to match ovrpQuatf");
+static_assert(sizeof(ovrpPosef) == sizeof(QuestHands::FRawPose) && STRUCT_OFFSET(ovrpPosef, Position) == STRUCT_OFFSET(QuestHands::FRawPose, Position), "FRawPose needs to match ovrpPosef");
+static_assert(sizeof(ovrpHandState) == sizeof(QuestHands::FRawHandState) && STRUCT_OFFSET(ovrpHandState, PointerPose) == STRUCT_OFFSET(QuestHands::FRawHandState, PointerPose) &&
+              STRUCT_OFFSET(ovrpHandState, SampleTimeStamp) == STRUCT_OFFSET(QuestHands::FRawHandState, SampleTimeStamp), "FRawHandState needs to match ovrpHandState");
+static_assert(sizeof(ovrpBone) == sizeof(QuestHands::FRawBone) && sizeof(ovrpBoneCapsule) == sizeof(QuestHands::FRawBoneCapsule), "FRawBone and FRawBoneCapsule need to match ovrpBone and ovrpBoneCapsule");
+static_assert(sizeof(ovrpSkeleton) == sizeof(QuestHands::FRawSkeleton) && STRUCT_OFFSET(ovrpSkeleton, BoneCapsules) == STRUCT_OFFSET(QuestHands::FRawSkeleton, BoneCapsules), "FRawSkeleton needs to match ovrpSkeleton");
+static_assert(QuestHands::RawHandStatus_HandTracked == ovrpHandStatus_HandTracked && QuestHands::RawHandStatus_InputValid == ovrpHandStatus_InputValid &&
+              QuestHands::RawHandStatus_SystemGestureInProgress == ovrpHandStatus_SystemGestureInProgress, "The raw hand status flags need to match ovrpHandStatus");
+static_assert(QuestHands::RawTrackingConfidence_High == ovrpTrackingConfidence_High, "RawTrackingConfidence_High needs to match ovrpTrackingConfidence_High");
+
+// Runtime sample stamps that couldn't be moved onto the FPlatformTime clock and were taken as now
+DECLARE_DWORD_COUNTER_STAT(TEXT("Runtime Stamp Fallbacks"), STAT_QuestHands_RuntimeStampFallbacks, STATGROUP_QuestHands);
+
 #endif // OCULUS_INPUT_SUPPORTED_PLATFORMS
 
 namespace QuestHands
 {
+#if OCULUS_INPUT_SUPPORTED_PLATFORMS
+    // Runtime time stamps further in the past than this, once moved onto the FPlatformTime clock, are taken as wrong
+    static constexpr double MaxRuntimeSampleAge = 1.0;
+
+    // Converted stamps this far ahead of now are measurement error of the clock offset and taken as now
+    static constexpr double MaxRuntimeSampleLead = 0.002;
+
+    // FPlatformTime::Seconds minus the runtime clock, measured when the first stamp is converted and again after a fallback
+    static double RuntimeClockOffset = 0.0;
+    static FThreadSafeBool RuntimeClockOffsetValid;
+    static FThreadSafeBool RuntimeClockFallbackLogged;
+
+    /**
+     * Measure the offset between the runtime clock and FPlatformTime::Seconds. On Android FPlatformTime::Seconds is offset
+     * from the CLOCK_MONOTONIC VrApi stamps its samples with, over Link the runtime has a clock of its own.
+    */
+    static bool MeasureRuntimeClockOffset()
+    {
+        const double before = FPlatformTime::Seconds();
+        double runtimeNow = 0.0;
+        if(!OVRP_SUCCESS(FOculusHMDModule::GetPluginWrapper().GetTimeInSeconds(&runtimeNow)) || runtimeNow <= 0.0)
+        {
+            return false;
+        }
+        const double after = FPlatformTime::Seconds();
+
+        RuntimeClockOffset = (before + after) * 0.5 - runtimeNow;
+        RuntimeClockOffsetValid = true;
+
+        // Measured again after every fallback, only the first measurement is worth a log line
+        if(!RuntimeClockFallbackLogged)
+        {
+            UE_LOG(LogQuestHands, Log, TEXT("QuestHands runtime clock is %.6f s behind FPlatformTime::Seconds, measured within %.3f ms"),
+                   RuntimeClockOffset, (after - before) * 1000.0);
+        }
+        return true;
+    }
+
+    /**
+     * Runtime time stamps in FPlatformTime::Seconds. Stamps that can't be moved onto that clock fall back to now, which
+     * hides the time the runtime held the sample, so the first fallback is logged and the offset measured again.
+    */
+    static double ConvertRuntimeTime(double RuntimeSeconds)
+    {
+        if(!RuntimeClockOffsetValid)
+        {
+            MeasureRuntimeClockOffset();
+        }
+
+        const double now = FPlatformTime::Seconds();
+        const double converted = RuntimeSeconds + RuntimeClockOffset;
+        if(RuntimeClockOffsetValid && RuntimeSeconds > 0.0 && converted <= now + MaxRuntimeSampleLead && now - converted < MaxRuntimeSampleAge)
+        {
+            return FMath::Min(converted, now);
+        }
+
+        INC_DWORD_STAT(STAT_QuestHands_RuntimeStampFallbacks);
+        CSV_CUSTOM_STAT_GLOBAL(QuestHandsRuntimeStampFallbacks, 1, ECsvCustomStatOp::Accumulate);
+        if(!RuntimeClockFallbackLogged)
+        {
+            RuntimeClockFallbackLogged = true;
+            UE_LOG(LogQuestHands, Warning, TEXT("QuestHands runtime sample stamp %.6f s is %.3f ms from now on the FPlatformTime clock, ")
+                                           TEXT("using now as the sample time, the latencies won't include the runtime"),
+                   RuntimeSeconds, (now - converted) * 1000.0);
+        }
+        RuntimeClockOffsetValid = false;
+        return now;
+    }
+#endif
+
     bool IsOVRAvailable()
     {
     #if OCULUS_INPUT_SUPPORTED_PLATFORMS
@@ -58,27 +148,6 @@ bool UQuestHandsFunctions::IsHandTrackingEnabled()
 }
 
 
-#if OCULUS_INPUT_SUPPORTED_PLATFORMS
-namespace QuestHands
-{
-    //---------------------------------------------------------------------------------------------------------------------
-    /**
-     * Transform to scene
-    */
-    FVector TransformVectorToUnrealScene(const FVector& InVec, OculusHMD::FSettings* Settings, float worldToMeters)
-    {
-        return (InVec - Settings->BaseOffset) * worldToMeters;
-    }
-
-    FQuat TransformQuatToUnrealScene(const FQuat& InQuat, OculusHMD::FSettings* Settings, float worldToMeters)
-    {
-        FQuat quatOut = Settings->BaseOrientation.Inverse() * InQuat;
-        quatOut.Normalize();
-        return quatOut;
-    }
-}
-#endif
-
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
@@ -113,7 +182,8 @@ bool UQuestHandsFunctions::GetTrackingState(const UObject* WorldContextObject, c
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-bool UQuestHandsFunctions::GetTrackingState_Internal(const EControllerHand Hand, const EQHandUpdateStep Step, FQHandTrackingState& stateOut, const float worldToMeters)
+bool UQuestHandsFunctions::GetTrackingState_Internal(const EControllerHand Hand, const EQHandUpdateStep Step, FQHandTrackingState& stateOut, const float worldToMeters, 
+                                                     double* sampleTimeOut)
 {
 #if OCULUS_INPUT_SUPPORTED_PLATFORMS
     if(!GEngine->XRSystem.IsValid())
@@ -149,50 +219,12 @@ bool UQuestHandsFunctions::GetTrackingState_Internal(const EControllerHand Hand,
     ovrpHandState handState;
     if(OVRP_SUCCESS(FOculusHMDModule::GetPluginWrapper().GetHandState(step, hand, &handState)))
     {
-        // Status Out
-        stateOut.IsTracked = (handState.Status & ovrpHandStatus_HandTracked) != 0;
-        stateOut.InputValid = (handState.Status & ovrpHandStatus_InputValid) != 0;
-        stateOut.SystemGestureInProgress = (handState.Status & ovrpHandStatus_SystemGestureInProgress) != 0;
-
-        // Root Pose
-        OculusHMD::FPose poseOut;
-        if(!OculusHMD->ConvertPose_Internal(handState.RootPose, poseOut, Settings, worldToMeters))
-        {
-            UE_LOG(LogQuestHands, Warning, TEXT("Calling QuestHandsFunctions::GetTrackingState_Internal, RootPose not convertable!"));
-        }
-        stateOut.RootPose.Orientation = poseOut.Orientation;
-        stateOut.RootPose.Position = poseOut.Position;
-
-        // Bone Rotations
-        stateOut.BoneRotations.AddDefaulted(((int32)EQHandBones::Hand_PinkyTip + 1) - stateOut.BoneRotations.Num());
-        for(int32 boneIndex = 0; boneIndex < (int32)EQHandBones::Hand_PinkyTip + 1; ++boneIndex)
-        {
-            stateOut.BoneRotations[boneIndex] = OculusHMD::ToFQuat(handState.BoneRotations[boneIndex]);
-        }
-
-        // Pinch State
-        stateOut.PinchState.AddDefaulted(((int32)EQHandFinger::HandFinger_Pinky + 1) - stateOut.PinchState.Num());
-        for(int32 pinchIndex = 0; pinchIndex < (int32)EQHandFinger::HandFinger_Pinky + 1; ++pinchIndex)
-        {
-            stateOut.PinchState[pinchIndex].Finger = (EQHandFinger)pinchIndex;
-            stateOut.PinchState[pinchIndex].Pinched = (handState.Pinches & (1 << pinchIndex)) != 0;
-            stateOut.PinchState[pinchIndex].Strength = handState.PinchStrength[pinchIndex];
-        }
+        QuestHands::FPoseConversion(Settings->BaseOrientation, Settings->BaseOffset, worldToMeters).ConvertHandState(*reinterpret_cast<const QuestHands::FRawHandState*>(&handState), stateOut);
 
-        // Pointer Pose
-        if(!OculusHMD->ConvertPose_Internal(handState.PointerPose, poseOut, Settings, worldToMeters))
+        if(sampleTimeOut)
         {
-            UE_LOG(LogQuestHands, Warning, TEXT("Calling QuestHandsFunctions::GetTrackingState_Internal, RootPose not convertable!"));
+            *sampleTimeOut = QuestHands::ConvertRuntimeTime(handState.SampleTimeStamp);
         }
-        stateOut.PointerPose.Orientation = poseOut.Orientation;
-        stateOut.PointerPose.Position = poseOut.Position;
-
-        // Hand Scale
-        stateOut.HandScale = handState.HandScale;
-
-        // Hand Confidence
-        stateOut.HandConfidence = handState.HandConfidence == ovrpTrackingConfidence_High ?
-            EQHandTrackingConfidence::Confidence_High : EQHandTrackingConfidence::Confidence_Low;
 
         return true;
     }
@@ -279,31 +311,12 @@ bool UQuestHandsFunctions::GetHandSkeleton_Internal(const EControllerHand Hand,
     ovrpSkeleton skeleton;
     if(OVRP_SUCCESS(FOculusHMDModule::GetPluginWrapper().GetSkeleton(hand, &skeleton)))
     {
-        OculusHMD::FPose poseOut;
+        QuestHands::FPoseConversion(Settings->BaseOrientation, Settings->BaseOffset, worldToMeters).ConvertSkeleton(*reinterpret_cast<const QuestHands::FRawSkeleton*>(&skeleton), skeletonOut);
 
-        // Bones
-        skeletonOut.Bones.AddDefaulted(skeleton.NumBones - skeletonOut.Bones.Num());
-        for(int32 boneIndex = 0; boneIndex < (int32)skeleton.NumBones; ++boneIndex)
+        if(!QuestHands::Topology::MatchesSkeleton(skeletonOut))
         {
-            skeletonOut.Bones[boneIndex].BoneId = (EQHandBones)skeleton.Bones[boneIndex].BoneId;
-            skeletonOut.Bones[boneIndex].ParentBoneIndex = skeleton.Bones[boneIndex].ParentBoneIndex;
-
-            if(!OculusHMD->ConvertPose_Internal(skeleton.Bones[boneIndex].Pose, poseOut, Settings, worldToMeters))
-            {
-                UE_LOG(LogQuestHands, Warning, TEXT("Calling QuestHandsFunctions::GetHandSkeleton_Internal, bone pose %d not convertable!"), boneIndex);
-            }
-            skeletonOut.Bones[boneIndex].Pose.Orientation = poseOut.Orientation;
-            skeletonOut.Bones[boneIndex].Pose.Position = poseOut.Position;
-        }
-
-        // Capsules
-        skeletonOut.BoneCapsules.AddDefaulted(skeleton.NumBoneCapsules - skeletonOut.BoneCapsules.Num());
-        for(int32 capsuleIndex = 0; capsuleIndex < (int32)skeleton.NumBoneCapsules; ++capsuleIndex)
-        {
-            skeletonOut.BoneCapsules[capsuleIndex].BoneIndex = skeleton.BoneCapsules[capsuleIndex].BoneIndex;
-            skeletonOut.BoneCapsules[capsuleIndex].PointA = OculusHMD::ToFVector(skeleton.BoneCapsules[capsuleIndex].Points[0]);
-            skeletonOut.BoneCapsules[capsuleIndex].PointB = OculusHMD::ToFVector(skeleton.BoneCapsules[capsuleIndex].Points[1]);
-            skeletonOut.BoneCapsules[capsuleIndex].Radius = skeleton.BoneCapsules[capsuleIndex].Radius;
+            UE_LOG(LogQuestHands, Warning, TEXT("Calling QuestHandsFunctions::GetHandSkeleton_Internal, the %d bone skeleton doesn't match the hand topology, using the slower generic path!"), 
+                   skeletonOut.Bones.Num());
         }
 
         return true;
@@ -316,53 +329,151 @@ bool UQuestHandsFunctions::GetHandSkeleton_Internal(const EControllerHand Hand,
 //---------------------------------------------------------------------------------------------------------------------
 /**
 */
-FString UQuestHandsFunctions::GetHandBoneName(const EQHandBones bone, bool left)
+bool UQuestHandsFunctions::GetHandsFrame(const UObject* WorldContextObject, const EQHandUpdateStep Step, FQHandsFrame& frameOut)
 {
-    if((uint8)bone > (uint8)EQHandBones::Hand_PinkyTip)
+    UWorld* const World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+    UQuestHandsFrameSubsystem* frames = World ? World->GetSubsystem<UQuestHandsFrameSubsystem>() : nullptr;
+    if(!frames)
     {
-        UE_LOG(LogQuestHands, Error, TEXT("Invalid bone index %d passed into GetHandBoneName"), (int32)bone);
-        return TEXT("");
+        frameOut = FQHandsFrame();
+        return false;
     }
 
-    FString nameOut;
-    if(bone > EQHandBones::Hand_Pinky3)
+    frameOut = frames->GetHandsFrame(Step);
+    return frameOut.Valid;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsFunctions::ComputeHandFeatures(const TArray<FTransform>& Bones, const FQHandTrackingState& TrackingState, const FTransform& TrackingToWorld, 
+                                               bool Left, FQHandFeatures& FeaturesOut)
+{
+    FeaturesOut.Valid = TrackingState.IsTracked && Bones.Num() == (int32)EQHandBones::Hand_PinkyTip + 1;
+    if(!FeaturesOut.Valid)
     {
-        nameOut = left ? TEXT("l_") : TEXT("r_");
-        switch(bone)
-        {
-            case EQHandBones::Hand_ThumbTip:
-                nameOut += TEXT("thumb_finger_tip_marker");
-                break;
-            case EQHandBones::Hand_IndexTip:
-                nameOut += TEXT("index_finger_tip_marker");
-                break;
-            case EQHandBones::Hand_MiddleTip:
-                nameOut += TEXT("middle_finger_tip_marker");
-                break;
-            case EQHandBones::Hand_RingTip:
-                nameOut += TEXT("ring_finger_tip_marker");
-                break;
-            case EQHandBones::Hand_PinkyTip:
-                nameOut += TEXT("pinky_finger_tip_marker");
-                break;
-            default:
-                UE_LOG(LogQuestHands, Error, TEXT("Invalid bone index %d passed into GetHandBoneName"), (int32)bone);
-                return TEXT("");
-        }
+        return;
     }
-    else
+
+    auto bonePos = [&Bones](EQHandBones bone) { return Bones[(int32)bone].GetLocation(); };
+
+    // Palm frame
+    const FVector wrist = bonePos(EQHandBones::Hand_Wrist);
+    const FVector indexKnuckle = bonePos(EQHandBones::Hand_Index1);
+    const FVector middleKnuckle = bonePos(EQHandBones::Hand_Middle1);
+    const FVector pinkyKnuckle = bonePos(EQHandBones::Hand_Pinky1);
+    const FVector palmForward = (middleKnuckle - wrist).GetSafeNormal();
+    const FVector palmSide = (indexKnuckle - pinkyKnuckle).GetSafeNormal();
+    FeaturesOut.PalmNormal = (Left ? FVector::CrossProduct(palmSide, palmForward) : FVector::CrossProduct(palmForward, palmSide)).GetSafeNormal();
+    FeaturesOut.PalmCenter = (wrist + middleKnuckle) * 0.5f;
+    FeaturesOut.AimDirection = (FTransform(TrackingState.PointerPose.Orientation, TrackingState.PointerPose.Position) * TrackingToWorld).GetRotation().GetForwardVector();
+
+    // The four fingers go through the kernel together, one finger per lane: proximal, intermediate, distal and tip positions
+    static const EQHandBones fingerJoints[4][4] =
+    {
+        { EQHandBones::Hand_Index1, EQHandBones::Hand_Index2, EQHandBones::Hand_Index3, EQHandBones::Hand_IndexTip },
+        { EQHandBones::Hand_Middle1, EQHandBones::Hand_Middle2, EQHandBones::Hand_Middle3, EQHandBones::Hand_MiddleTip },
+        { EQHandBones::Hand_Ring1, EQHandBones::Hand_Ring2, EQHandBones::Hand_Ring3, EQHandBones::Hand_RingTip },
+        { EQHandBones::Hand_Pinky1, EQHandBones::Hand_Pinky2, EQHandBones::Hand_Pinky3, EQHandBones::Hand_PinkyTip },
+    };
+
+    VectorRegister jointX[4], jointY[4], jointZ[4];
+    for(int32 joint = 0; joint < 4; ++joint)
     {
-        const UEnum* const QHandBonesTypeEnum = StaticEnum<EQHandBones>();
-        FString boneName = QHandBonesTypeEnum->GetNameStringByValue((uint8)bone);
+        const FVector f0 = bonePos(fingerJoints[0][joint]);
+        const FVector f1 = bonePos(fingerJoints[1][joint]);
+        const FVector f2 = bonePos(fingerJoints[2][joint]);
+        const FVector f3 = bonePos(fingerJoints[3][joint]);
+        jointX[joint] = MakeVectorRegister(f0.X, f1.X, f2.X, f3.X);
+        jointY[joint] = MakeVectorRegister(f0.Y, f1.Y, f2.Y, f3.Y);
+        jointZ[joint] = MakeVectorRegister(f0.Z, f1.Z, f2.Z, f3.Z);
+    }
 
+    // Normalized segment directions per lane
+    VectorRegister segX[3], segY[3], segZ[3];
+    for(int32 segment = 0; segment < 3; ++segment)
+    {
+        segX[segment] = VectorSubtract(jointX[segment + 1], jointX[segment]);
+        segY[segment] = VectorSubtract(jointY[segment + 1], jointY[segment]);
+        segZ[segment] = VectorSubtract(jointZ[segment + 1], jointZ[segment]);
+
+        VectorRegister lengthSq = VectorMultiply(segX[segment], segX[segment]);
+        lengthSq = VectorMultiplyAdd(segY[segment], segY[segment], lengthSq);
+        lengthSq = VectorMultiplyAdd(segZ[segment], segZ[segment], lengthSq);
+        const VectorRegister invLength = VectorReciprocalSqrtAccurate(VectorMax(lengthSq, VectorSetFloat1(SMALL_NUMBER)));
+        segX[segment] = VectorMultiply(segX[segment], invLength);
+        segY[segment] = VectorMultiply(segY[segment], invLength);
+        segZ[segment] = VectorMultiply(segZ[segment], invLength);
+    }
 
-        FString boneNameStr;
-        boneName.Split(TEXT("_"), nullptr, &boneNameStr);
-        boneNameStr.ToLowerInline();
-        nameOut = FString::Printf(TEXT("b_%s_%s"), left ? TEXT("l") : TEXT("r"), *boneNameStr);
+    auto dot3 = [](const VectorRegister& ax, const VectorRegister& ay, const VectorRegister& az, const VectorRegister& bx, const VectorRegister& by, const VectorRegister& bz)
+    {
+        return VectorMultiplyAdd(az, bz, VectorMultiplyAdd(ay, by, VectorMultiply(ax, bx)));
+    };
+
+    // Curl is the bend at the knuckle and both finger joints, each contributing up to a third at 90 degrees
+    const VectorRegister palmX = VectorSetFloat1(palmForward.X);
+    const VectorRegister palmY = VectorSetFloat1(palmForward.Y);
+    const VectorRegister palmZ = VectorSetFloat1(palmForward.Z);
+    VectorRegister bendSum = dot3(palmX, palmY, palmZ, segX[0], segY[0], segZ[0]);
+    bendSum = VectorAdd(bendSum, dot3(segX[0], segY[0], segZ[0], segX[1], segY[1], segZ[1]));
+    bendSum = VectorAdd(bendSum, dot3(segX[1], segY[1], segZ[1], segX[2], segY[2], segZ[2]));
+    VectorRegister curl = VectorMultiply(VectorSubtract(VectorSetFloat1(3.0f), bendSum), VectorSetFloat1(1.0f / 3.0f));
+    curl = VectorMin(VectorMax(curl, VectorZero()), VectorOne());
+
+    // Thumb tip to finger tip distances
+    const FVector thumbTip = bonePos(EQHandBones::Hand_ThumbTip);
+    const VectorRegister tipDeltaX = VectorSubtract(jointX[3], VectorSetFloat1(thumbTip.X));
+    const VectorRegister tipDeltaY = VectorSubtract(jointY[3], VectorSetFloat1(thumbTip.Y));
+    const VectorRegister tipDeltaZ = VectorSubtract(jointZ[3], VectorSetFloat1(thumbTip.Z));
+    const VectorRegister tipDistanceSq = dot3(tipDeltaX, tipDeltaY, tipDeltaZ, tipDeltaX, tipDeltaY, tipDeltaZ);
+
+    float curlOut[4], tipDistanceSqOut[4];
+    VectorStore(curl, curlOut);
+    VectorStore(tipDistanceSq, tipDistanceSqOut);
+
+    // The thumb has one joint less and bends across the palm, handle it separately
+    const FVector thumbSeg0 = (bonePos(EQHandBones::Hand_Thumb3) - bonePos(EQHandBones::Hand_Thumb2)).GetSafeNormal();
+    const FVector thumbSeg1 = (thumbTip - bonePos(EQHandBones::Hand_Thumb3)).GetSafeNormal();
+    const FVector thumbBase = (bonePos(EQHandBones::Hand_Thumb2) - bonePos(EQHandBones::Hand_Thumb1)).GetSafeNormal();
+    FeaturesOut.FingerCurl[(int32)EQHandFinger::HandFinger_Thumb] = 
+        FMath::Clamp((2.0f - FVector::DotProduct(thumbBase, thumbSeg0) - FVector::DotProduct(thumbSeg0, thumbSeg1)) * 0.5f, 0.0f, 1.0f);
+
+    for(int32 finger = 0; finger < 4; ++finger)
+    {
+        FeaturesOut.FingerCurl[finger + 1] = curlOut[finger];
+        FeaturesOut.TipToThumbDistance[finger] = FMath::Sqrt(tipDistanceSqOut[finger]);
     }
 
-    return nameOut;
+    // Splay between the proximal directions projected into the palm plane
+    float segX0[4], segY0[4], segZ0[4];
+    VectorStore(segX[0], segX0);
+    VectorStore(segY[0], segY0);
+    VectorStore(segZ[0], segZ0);
+    FVector proximal[5];
+    proximal[0] = FVector::VectorPlaneProject(thumbSeg0, FeaturesOut.PalmNormal).GetSafeNormal();
+    for(int32 finger = 0; finger < 4; ++finger)
+    {
+        proximal[finger + 1] = FVector::VectorPlaneProject(FVector(segX0[finger], segY0[finger], segZ0[finger]), FeaturesOut.PalmNormal).GetSafeNormal();
+    }
+    for(int32 splay = 0; splay < 4; ++splay)
+    {
+        FeaturesOut.FingerSplay[splay] = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(FVector::DotProduct(proximal[splay], proximal[splay + 1]), -1.0f, 1.0f)));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FString UQuestHandsFunctions::GetHandBoneName(const EQHandBones bone, bool left)
+{
+    if((uint8)bone > (uint8)EQHandBones::Hand_PinkyTip)
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("Invalid bone index %d passed into GetHandBoneName"), (int32)bone);
+        return TEXT("");
+    }
+
+    return left ? QuestHands::Topology::LeftBoneNames[(int32)bone] : QuestHands::Topology::RightBoneNames[(int32)bone];
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -376,3 +487,15 @@ bool UQuestHandsFunctions::SetDynamicFixedFoveatedEnabled(bool enabled)
     return false;
 #endif
 }
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsFunctions::SetFixedFoveatedLevel(int32 level)
+{
+#if OCULUS_INPUT_SUPPORTED_PLATFORMS
+    return OVRP_SUCCESS(FOculusHMDModule::GetPluginWrapper().SetVrApiPropertyInt(QuestHands::VRAPI_FOVEATION_LEVEL, FMath::Clamp(level, 0, 4)));
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,262 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsGhostSubsystem.h"
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+#include "QuestHandsTopology.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Materials/MaterialInterface.h"
+
+DECLARE_CYCLE_STAT(TEXT("GhostHandUpdate"), STAT_QuestHands_GhostHandUpdate, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("GhostHandsFlush"), STAT_QuestHands_GhostHandsFlush, STATGROUP_QuestHands);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ghost Hands"), STAT_QuestHands_GhostHands, STATGROUP_QuestHands);
+
+namespace QuestHands
+{
+namespace Ghosts
+{
+    // Instances of free slots and untracked hands are scaled away
+    static const FTransform HiddenTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsGhostSubsystem::UQuestHandsGhostSubsystem()
+    : SegmentMesh(nullptr)
+    , SegmentMaterial(nullptr)
+    , SegmentRadius(0.8f)
+    , InstancesActor(nullptr)
+    , Instances(nullptr)
+    , MeshOrigin(FVector::ZeroVector)
+    , MeshSizeInv(FVector::OneVector)
+    , NumSlots(0)
+    , InstancesDirty(false)
+    , TotalFlushMs(0.0)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGhostSubsystem::Deinitialize()
+{
+    // The instances go with the actor when the world is torn down
+    SET_DWORD_STAT(STAT_QuestHands_GhostHands, 0);
+    InstancesActor = nullptr;
+    Instances = nullptr;
+    InstanceTransforms.Empty();
+    FreeSlots.Empty();
+    NumSlots = 0;
+    InstancesDirty = false;
+    Super::Deinitialize();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsGhostSubsystem::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !IsTemplate() && world && world->IsGameWorld() && InstancesDirty;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+TStatId UQuestHandsGhostSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UQuestHandsGhostSubsystem, STATGROUP_Tickables);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGhostSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_GhostHandsFlush);
+
+    InstancesDirty = false;
+    if(!Instances || Instances->IsPendingKill() || InstanceTransforms.Num() == 0)
+    {
+        return;
+    }
+
+    // Every hand updated this frame goes to the render thread in one batch, the instances are never updated one by one.
+    // The render state is sent here rather than with the end of frame updates so the flush time covers all of it.
+    const double startTime = FPlatformTime::Seconds();
+    Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, false, true, true);
+    Instances->DoDeferredRenderUpdates_Concurrent();
+    TotalFlushMs += (FPlatformTime::Seconds() - startTime) * 1000.0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UInstancedStaticMeshComponent* UQuestHandsGhostSubsystem::GetInstances()
+{
+    if(Instances && !Instances->IsPendingKill())
+    {
+        return Instances;
+    }
+
+    UWorld* world = GetWorld();
+    if(!world)
+    {
+        return nullptr;
+    }
+
+    if(!SegmentMesh)
+    {
+        SegmentMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cylinder.Cylinder"));
+        if(!SegmentMesh)
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsGhostSubsystem has no SegmentMesh and the engine cylinder couldn't be loaded!"));
+            return nullptr;
+        }
+    }
+
+    FActorSpawnParameters spawnParams;
+    spawnParams.ObjectFlags |= RF_Transient;
+    spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    InstancesActor = world->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, spawnParams);
+    if(!InstancesActor)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsGhostSubsystem unable to spawn the ghost hands actor!"));
+        return nullptr;
+    }
+
+#if WITH_EDITOR
+    InstancesActor->SetActorLabel(TEXT("QuestHandsGhosts"));
+#endif
+
+    // The actor stays at the origin so the world space bones are the instance transforms as they are
+    Instances = NewObject<UInstancedStaticMeshComponent>(InstancesActor, TEXT("GhostHands"));
+    Instances->SetMobility(EComponentMobility::Movable);
+    Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    Instances->SetStaticMesh(SegmentMesh);
+    if(SegmentMaterial)
+    {
+        Instances->SetMaterial(0, SegmentMaterial);
+    }
+    InstancesActor->SetRootComponent(Instances);
+    Instances->RegisterComponent();
+
+    // Segments are stretched from the bounds of the mesh, which runs along Z
+    const FBox meshBox = SegmentMesh->GetBoundingBox();
+    const FVector meshSize = meshBox.GetSize();
+    MeshOrigin = meshBox.GetCenter();
+    MeshSizeInv = FVector(meshSize.X > KINDA_SMALL_NUMBER ? 2.0f / meshSize.X : 1.0f,
+                          meshSize.Y > KINDA_SMALL_NUMBER ? 2.0f / meshSize.Y : 1.0f,
+                          meshSize.Z > KINDA_SMALL_NUMBER ? 1.0f / meshSize.Z : 1.0f);
+
+    // Bring back the instances of the slots from before the component was lost
+    for(int32 instanceIndex = 0; instanceIndex < InstanceTransforms.Num(); ++instanceIndex)
+    {
+        Instances->AddInstance(InstanceTransforms[instanceIndex]);
+    }
+    return Instances;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int32 UQuestHandsGhostSubsystem::AddGhostHand()
+{
+    using namespace QuestHands;
+
+    UInstancedStaticMeshComponent* instances = GetInstances();
+    if(!instances)
+    {
+        return INDEX_NONE;
+    }
+
+    INC_DWORD_STAT(STAT_QuestHands_GhostHands);
+    if(FreeSlots.Num() > 0)
+    {
+        return FreeSlots.Pop(false);
+    }
+
+    for(int32 capsuleIndex = 0; capsuleIndex < Topology::NumCapsules; ++capsuleIndex)
+    {
+        InstanceTransforms.Add(Ghosts::HiddenTransform);
+        instances->AddInstance(Ghosts::HiddenTransform);
+    }
+    return NumSlots++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGhostSubsystem::RemoveGhostHand(int32 Handle)
+{
+    if(Handle < 0 || Handle >= NumSlots || FreeSlots.Contains(Handle))
+    {
+        return;
+    }
+
+    // The instances stay allocated, removing them would shift the slots after them
+    HideGhostHand(Handle);
+    FreeSlots.Add(Handle);
+    DEC_DWORD_STAT(STAT_QuestHands_GhostHands);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGhostSubsystem::HideGhostHand(int32 Handle)
+{
+    using namespace QuestHands;
+
+    if(Handle < 0 || Handle >= NumSlots)
+    {
+        return;
+    }
+
+    FTransform* segments = InstanceTransforms.GetData() + Handle * Topology::NumCapsules;
+    for(int32 capsuleIndex = 0; capsuleIndex < Topology::NumCapsules; ++capsuleIndex)
+    {
+        segments[capsuleIndex] = Ghosts::HiddenTransform;
+    }
+    InstancesDirty = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGhostSubsystem::UpdateGhostHand(int32 Handle, const TArray<FTransform>& Bones)
+{
+    using namespace QuestHands;
+
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_GhostHandUpdate);
+
+    if(Handle < 0 || Handle >= NumSlots || Bones.Num() < Topology::NumBones)
+    {
+        return;
+    }
+
+    const FTransform* bones = Bones.GetData();
+    FTransform* segments = InstanceTransforms.GetData() + Handle * Topology::NumCapsules;
+    int32 capsuleIndex = 0;
+    for(int32 boneIndex = 0; boneIndex < Topology::NumBones; ++boneIndex)
+    {
+        if(!Topology::HasCapsule(boneIndex))
+        {
+            continue;
+        }
+
+        // A segment from the bone to its child, as thick as the bone is scaled
+        const FVector start = bones[boneIndex].GetLocation();
+        const FVector segment = bones[Topology::CapsuleChildBones[boneIndex]].GetLocation() - start;
+        const float length = segment.Size();
+        const float radius = SegmentRadius * bones[boneIndex].GetScale3D().X;
+        const FQuat rotation = length > KINDA_SMALL_NUMBER ? FQuat::FindBetweenNormals(FVector::UpVector, segment / length) : bones[boneIndex].GetRotation();
+        const FVector scale = FVector(radius, radius, length) * MeshSizeInv;
+
+        segments[capsuleIndex++].SetComponents(rotation, start + segment * 0.5f - rotation.RotateVector(MeshOrigin * scale), scale);
+    }
+    InstancesDirty = true;
+}
@@ -0,0 +1,287 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsGovernorSubsystem.h"
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+#include "QuestHandsComponent.h"
+#include "QuestHandsFunctions.h"
+#include "UnrealClient.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Governor Level"), STAT_QuestHands_GovernorLevel, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Frame Time (ms)"), STAT_QuestHands_GovernorFrameTime, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Hands Time (ms)"), STAT_QuestHands_GovernorHandsTime, STATGROUP_QuestHands);
+
+namespace QuestHands
+{
+    // Reads the engine thread timings and sets the foveation through the OVR API
+    class FDefaultPerformancePlatform : public IQuestHandsPerformancePlatform
+    {
+    public:
+        virtual float GetFrameTimeMs() const override
+        {
+            return FPlatformTime::ToMilliseconds(FMath::Max3(GGameThreadTime, GRenderThreadTime, GGPUFrameTime));
+        }
+
+        virtual bool SetFoveationLevel(int32 Level) override
+        {
+            return UQuestHandsFunctions::SetFixedFoveatedLevel(Level);
+        }
+    };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsGovernorSubsystem::UQuestHandsGovernorSubsystem()
+    : Enabled(false)
+    , TargetFrameTime(1000.0f / 72.0f)
+    , OverBudgetMargin(0.05f)
+    , UnderBudgetMargin(0.2f)
+    , RaiseDelay(0.5f)
+    , LowerDelay(3.0f)
+    , Cooldown(1.0f)
+    , SmoothingFactor(0.1f)
+    , Level(0)
+    , SmoothedFrameTime(0.0f)
+    , SmoothedHandsTime(0.0f)
+    , HandsWorkThisFrame(0.0f)
+    , OverBudgetTime(0.0f)
+    , UnderBudgetTime(0.0f)
+    , TimeSinceLevelChange(0.0f)
+    , AppliedFoveationLevel(-1)
+    , FoveationPending(true)
+{
+    TotalHandsWork[0] = 0.0;
+    TotalHandsWork[1] = 0.0;
+
+    // Full quality leaves the foveation to the project, only the cheaper levels set it
+    Levels.Add(FQHandGovernorLevel(0.0f, 1.0f, 0.0f, -1));
+    Levels.Add(FQHandGovernorLevel(45.0f, 0.75f, 30.0f, 2));
+    Levels.Add(FQHandGovernorLevel(30.0f, 0.5f, 20.0f, 3));
+    Levels.Add(FQHandGovernorLevel(20.0f, 0.25f, 15.0f, 4));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+    SetPlatform(nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::Deinitialize()
+{
+    HandsComponents.Empty();
+    Platform.Reset();
+    Super::Deinitialize();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::SetPlatform(TSharedPtr<IQuestHandsPerformancePlatform> InPlatform)
+{
+    Platform = InPlatform.IsValid() ? InPlatform : MakeShared<QuestHands::FDefaultPerformancePlatform>();
+    SmoothedFrameTime = 0.0f;
+    OverBudgetTime = UnderBudgetTime = 0.0f;
+    AppliedFoveationLevel = -1;
+    FoveationPending = true;
+    LevelHandsTime.Reset();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::RegisterHandsComponent(UQuestHandsComponent* Component)
+{
+    if(!Component)
+    {
+        return;
+    }
+
+    HandsComponents.AddUnique(Component);
+    Component->SetGovernorLevel(GetCurrentLevelSettings());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::UnregisterHandsComponent(UQuestHandsComponent* Component)
+{
+    HandsComponents.RemoveSingleSwap(Component);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsGovernorSubsystem::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !IsTemplate() && world && world->IsGameWorld() && Platform.IsValid();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+TStatId UQuestHandsGovernorSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UQuestHandsGovernorSubsystem, STATGROUP_Tickables);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+const FQHandGovernorLevel& UQuestHandsGovernorSubsystem::GetCurrentLevelSettings() const
+{
+    static const FQHandGovernorLevel fullQuality;
+    return Levels.IsValidIndex(Level) ? Levels[Level] : fullQuality;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::Tick(float DeltaTime)
+{
+    const float frameTime = Platform->GetFrameTimeMs();
+    const float handsTime = HandsWorkThisFrame;
+    HandsWorkThisFrame = 0.0f;
+
+    if(SmoothedFrameTime <= 0.0f)
+    {
+        SmoothedFrameTime = frameTime;
+        SmoothedHandsTime = handsTime;
+    }
+    else
+    {
+        SmoothedFrameTime = FMath::Lerp(SmoothedFrameTime, frameTime, SmoothingFactor);
+        SmoothedHandsTime = FMath::Lerp(SmoothedHandsTime, handsTime, SmoothingFactor);
+    }
+
+    SET_FLOAT_STAT(STAT_QuestHands_GovernorFrameTime, SmoothedFrameTime);
+    SET_FLOAT_STAT(STAT_QuestHands_GovernorHandsTime, SmoothedHandsTime);
+    SET_DWORD_STAT(STAT_QuestHands_GovernorLevel, Level);
+
+    if(!Enabled || Levels.Num() == 0)
+    {
+        return;
+    }
+
+    // The initial level is applied on the first tick so a disabled governor never touches the foveation
+    if(FoveationPending)
+    {
+        ApplyFoveation();
+    }
+
+    TimeSinceLevelChange += DeltaTime;
+
+    // A better level brings back the hands time it cost when it was left, the frame has to stay under the band with it
+    float betterLevelFrameTime = SmoothedFrameTime;
+    if(Level > 0 && LevelHandsTime.IsValidIndex(Level - 1))
+    {
+        betterLevelFrameTime += FMath::Max(LevelHandsTime[Level - 1] - SmoothedHandsTime, 0.0f);
+    }
+
+    // Track how long the frame time stayed on either side of the hysteresis band
+    if(SmoothedFrameTime > TargetFrameTime * (1.0f + OverBudgetMargin))
+    {
+        OverBudgetTime += DeltaTime;
+        UnderBudgetTime = 0.0f;
+    }
+    else if(betterLevelFrameTime < TargetFrameTime * (1.0f - UnderBudgetMargin))
+    {
+        UnderBudgetTime += DeltaTime;
+        OverBudgetTime = 0.0f;
+    }
+    else
+    {
+        OverBudgetTime = UnderBudgetTime = 0.0f;
+    }
+
+    if(TimeSinceLevelChange < Cooldown)
+    {
+        return;
+    }
+
+    if(OverBudgetTime >= RaiseDelay && Level < Levels.Num() - 1)
+    {
+        LevelHandsTime.SetNumZeroed(Levels.Num());
+        LevelHandsTime[Level] = SmoothedHandsTime;
+        SetLevel(Level + 1);
+    }
+    else if(UnderBudgetTime >= LowerDelay && Level > 0)
+    {
+        SetLevel(Level - 1);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::SetLevel(int32 NewLevel)
+{
+    NewLevel = FMath::Clamp(NewLevel, 0, FMath::Max(Levels.Num() - 1, 0));
+    if(NewLevel == Level)
+    {
+        return;
+    }
+
+    Level = NewLevel;
+    TimeSinceLevelChange = 0.0f;
+    OverBudgetTime = UnderBudgetTime = 0.0f;
+    ApplyLevel();
+
+    UE_LOG(LogQuestHands, Log, TEXT("QuestHands governor changed to level %d at %.2fms smoothed frame time"), Level, SmoothedFrameTime);
+    OnLevelChanged.Broadcast(Level);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::ApplyLevel()
+{
+    const FQHandGovernorLevel& levelSettings = GetCurrentLevelSettings();
+
+    for(int32 componentIndex = HandsComponents.Num() - 1; componentIndex >= 0; --componentIndex)
+    {
+        if(HandsComponents[componentIndex])
+        {
+            HandsComponents[componentIndex]->SetGovernorLevel(levelSettings);
+        }
+        else
+        {
+            HandsComponents.RemoveAtSwap(componentIndex);
+        }
+    }
+
+    // A disabled governor never touches the foveation, the level's foveation is applied once it is enabled
+    if(Enabled)
+    {
+        ApplyFoveation();
+    }
+    else
+    {
+        FoveationPending = true;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGovernorSubsystem::ApplyFoveation()
+{
+    // Tried once per level, platforms without foveation keep failing
+    FoveationPending = false;
+
+    const FQHandGovernorLevel& levelSettings = GetCurrentLevelSettings();
+    if(levelSettings.FoveationLevel >= 0 && levelSettings.FoveationLevel != AppliedFoveationLevel && Platform.IsValid())
+    {
+        if(Platform->SetFoveationLevel(levelSettings.FoveationLevel))
+        {
+            AppliedFoveationLevel = levelSettings.FoveationLevel;
+        }
+    }
+}
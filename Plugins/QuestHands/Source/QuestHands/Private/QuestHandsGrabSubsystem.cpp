@@ -0,0 +1,355 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsGrabSubsystem.h"
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("GrabCandidateQuery"), STAT_QuestHands_GrabQuery, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("GrabIndexUpdate"), STAT_QuestHands_GrabIndexUpdate, STATGROUP_QuestHands);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Grab Interactables"), STAT_QuestHands_GrabInteractables, STATGROUP_QuestHands);
+
+namespace QuestHands
+{
+    // Interactables spanning more cells than this on an axis aren't hashed, keeps huge objects from flooding the hash
+    static const int32 MaxCellsPerAxis = 8;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsGrabSubsystem::UQuestHandsGrabSubsystem()
+    : CellSize(20.0f)
+    , QueryStamp(0)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::Deinitialize()
+{
+    for(FInteractable& interactable : Interactables)
+    {
+        if(USceneComponent* component = interactable.Component.Get())
+        {
+            component->TransformUpdated.Remove(interactable.TransformUpdatedHandle);
+        }
+    }
+    DEC_DWORD_STAT_BY(STAT_QuestHands_GrabInteractables, Interactables.Num());
+
+    Interactables.Empty();
+    ComponentToInteractable.Empty();
+    Cells.Empty();
+    LargeInteractables.Empty();
+
+    Super::Deinitialize();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::RegisterInteractable(USceneComponent* Component, float Radius)
+{
+    if(!Component)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsGrabSubsystem::RegisterInteractable called with an invalid component!"));
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_GrabIndexUpdate);
+
+    if(const int32* existingIndex = ComponentToInteractable.Find(Component))
+    {
+        RemoveFromCells(*existingIndex);
+        Interactables[*existingIndex].Radius = FMath::Max(Radius, 0.0f);
+        Interactables[*existingIndex].Location = Component->GetComponentLocation();
+        AddToCells(*existingIndex);
+        return;
+    }
+
+    FInteractable interactable;
+    interactable.Component = Component;
+    interactable.Location = Component->GetComponentLocation();
+    interactable.Radius = FMath::Max(Radius, 0.0f);
+    interactable.QueryStamp = 0;
+    interactable.Large = false;
+    interactable.TransformUpdatedHandle = Component->TransformUpdated.AddUObject(this, &UQuestHandsGrabSubsystem::OnTransformUpdated);
+
+    const int32 interactableIndex = Interactables.Add(interactable);
+    ComponentToInteractable.Add(Component, interactableIndex);
+    AddToCells(interactableIndex);
+
+    INC_DWORD_STAT(STAT_QuestHands_GrabInteractables);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::UnregisterInteractable(USceneComponent* Component)
+{
+    int32 interactableIndex = INDEX_NONE;
+    if(!ComponentToInteractable.RemoveAndCopyValue(Component, interactableIndex))
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_GrabIndexUpdate);
+
+    if(Component)
+    {
+        Component->TransformUpdated.Remove(Interactables[interactableIndex].TransformUpdatedHandle);
+    }
+    RemoveFromCells(interactableIndex);
+    Interactables.RemoveAt(interactableIndex);
+
+    DEC_DWORD_STAT(STAT_QuestHands_GrabInteractables);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::SetCellSize(float NewCellSize)
+{
+    NewCellSize = FMath::Max(NewCellSize, 1.0f);
+    if(NewCellSize == CellSize)
+    {
+        return;
+    }
+
+    CellSize = NewCellSize;
+    Cells.Reset();
+    LargeInteractables.Reset();
+    for(auto it = Interactables.CreateIterator(); it; ++it)
+    {
+        AddToCells(it.GetIndex());
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::FindGrabCandidates(const TArray<FVector>& ProbePoints, const FVector& PinchPoint, float PinchStrength, float SearchRadius,
+                                                  TArray<FQHandGrabCandidate>& CandidatesOut)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_GrabQuery);
+
+    CandidatesOut.Reset();
+    if(ProbePoints.Num() == 0)
+    {
+        return;
+    }
+
+    PinchStrength = FMath::Clamp(PinchStrength, 0.0f, 1.0f);
+    SearchRadius = FMath::Max(SearchRadius, 0.0f);
+    ++QueryStamp;
+
+    TArray<int32, TInlineAllocator<64>> visited;
+    for(int32 interactableIndex : LargeInteractables)
+    {
+        VisitInteractable(interactableIndex, visited);
+    }
+
+    // Searching more cells than there are interactables is slower than testing them all, and huge radii would overflow the cells
+    const float queryCellsPerAxis = 2.0f * SearchRadius / CellSize + 1.0f;
+    if(queryCellsPerAxis * queryCellsPerAxis * queryCellsPerAxis * ProbePoints.Num() > Interactables.Num())
+    {
+        for(auto it = Interactables.CreateIterator(); it; ++it)
+        {
+            VisitInteractable(it.GetIndex(), visited);
+        }
+    }
+    else
+    {
+        // Gather the interactables from the cells around every probe, the radius stored per interactable already spans its cells
+        for(const FVector& probePoint : ProbePoints)
+        {
+            const FIntVector minCell = GetCell(probePoint - FVector(SearchRadius));
+            const FIntVector maxCell = GetCell(probePoint + FVector(SearchRadius));
+            for(int32 x = minCell.X; x <= maxCell.X; ++x)
+            {
+                for(int32 y = minCell.Y; y <= maxCell.Y; ++y)
+                {
+                    for(int32 z = minCell.Z; z <= maxCell.Z; ++z)
+                    {
+                        const TArray<int32>* cell = Cells.Find(FIntVector(x, y, z));
+                        if(!cell)
+                            continue;
+
+                        for(int32 interactableIndex : *cell)
+                        {
+                            VisitInteractable(interactableIndex, visited);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for(int32 interactableIndex : visited)
+    {
+        const FInteractable& interactable = Interactables[interactableIndex];
+        USceneComponent* component = interactable.Component.Get();
+        if(!component)
+            continue;
+
+        float closestDistance = BIG_NUMBER;
+        for(const FVector& probePoint : ProbePoints)
+        {
+            closestDistance = FMath::Min(closestDistance, FVector::Dist(probePoint, interactable.Location) - interactable.Radius);
+        }
+        closestDistance = FMath::Max(closestDistance, 0.0f);
+        if(closestDistance > SearchRadius)
+            continue;
+
+        const float pinchDistance = FMath::Max(FVector::Dist(PinchPoint, interactable.Location) - interactable.Radius, 0.0f);
+
+        FQHandGrabCandidate& candidate = CandidatesOut.AddDefaulted_GetRef();
+        candidate.Component = component;
+        candidate.Distance = closestDistance;
+        candidate.Score = FMath::Lerp(closestDistance, pinchDistance, PinchStrength);
+    }
+
+    CandidatesOut.Sort([](const FQHandGrabCandidate& A, const FQHandGrabCandidate& B)
+    {
+        return A.Score < B.Score;
+    });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FIntVector UQuestHandsGrabSubsystem::GetCell(const FVector& Location) const
+{
+    return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * The cells a sphere covers, false if it covers more than MaxCellsPerAxis on an axis
+*/
+bool UQuestHandsGrabSubsystem::GetCellRange(const FVector& Location, float Radius, FIntVector& MinCellOut, FIntVector& MaxCellOut) const
+{
+    if(2.0f * Radius / CellSize >= QuestHands::MaxCellsPerAxis)
+    {
+        MinCellOut = FIntVector::ZeroValue;
+        MaxCellOut = FIntVector(-1);
+        return false;
+    }
+
+    MinCellOut = GetCell(Location - FVector(Radius));
+    MaxCellOut = GetCell(Location + FVector(Radius));
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::VisitInteractable(int32 InteractableIndex, TArray<int32, TInlineAllocator<64>>& VisitedOut)
+{
+    FInteractable& interactable = Interactables[InteractableIndex];
+    if(interactable.QueryStamp != QueryStamp)
+    {
+        interactable.QueryStamp = QueryStamp;
+        VisitedOut.Add(InteractableIndex);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::AddToCells(int32 InteractableIndex)
+{
+    FInteractable& interactable = Interactables[InteractableIndex];
+    interactable.Large = !GetCellRange(interactable.Location, interactable.Radius, interactable.MinCell, interactable.MaxCell);
+    if(interactable.Large)
+    {
+        LargeInteractables.Add(InteractableIndex);
+        return;
+    }
+
+    for(int32 x = interactable.MinCell.X; x <= interactable.MaxCell.X; ++x)
+    {
+        for(int32 y = interactable.MinCell.Y; y <= interactable.MaxCell.Y; ++y)
+        {
+            for(int32 z = interactable.MinCell.Z; z <= interactable.MaxCell.Z; ++z)
+            {
+                Cells.FindOrAdd(FIntVector(x, y, z)).Add(InteractableIndex);
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::RemoveFromCells(int32 InteractableIndex)
+{
+    const FInteractable& interactable = Interactables[InteractableIndex];
+    if(interactable.Large)
+    {
+        LargeInteractables.RemoveSingleSwap(InteractableIndex, false);
+        return;
+    }
+
+    for(int32 x = interactable.MinCell.X; x <= interactable.MaxCell.X; ++x)
+    {
+        for(int32 y = interactable.MinCell.Y; y <= interactable.MaxCell.Y; ++y)
+        {
+            for(int32 z = interactable.MinCell.Z; z <= interactable.MaxCell.Z; ++z)
+            {
+                const FIntVector cellKey(x, y, z);
+                TArray<int32>* cell = Cells.Find(cellKey);
+                if(!cell)
+                    continue;
+
+                cell->RemoveSingleSwap(InteractableIndex, false);
+                if(cell->Num() == 0)
+                {
+                    Cells.Remove(cellKey);
+                }
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+    const int32* interactableIndex = ComponentToInteractable.Find(Component);
+    if(!interactableIndex)
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_GrabIndexUpdate);
+
+    FInteractable& interactable = Interactables[*interactableIndex];
+    interactable.Location = Component->GetComponentLocation();
+
+    // Only touch the hash when the interactable moved into different cells, large interactables aren't in any
+    FIntVector minCell, maxCell;
+    GetCellRange(interactable.Location, interactable.Radius, minCell, maxCell);
+    if(minCell != interactable.MinCell || maxCell != interactable.MaxCell)
+    {
+        RemoveFromCells(*interactableIndex);
+        AddToCells(*interactableIndex);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsGrabSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T cellsSize = Cells.GetAllocatedSize();
+    for(const TPair<FIntVector, TArray<int32>>& cell : Cells)
+    {
+        cellsSize += cell.Value.GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Interactables.GetAllocatedSize() + ComponentToInteractable.GetAllocatedSize() + cellsSize +
+                                                         LargeInteractables.GetAllocatedSize());
+}
@@ -0,0 +1,217 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsLatency.h"
+
+#if QUESTHANDS_LATENCY_TRACING
+
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "RenderingThread.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Convert (ms)"), STAT_QuestHands_LatencyConvert, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency FK (ms)"), STAT_QuestHands_LatencyFK, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Pose Apply (ms)"), STAT_QuestHands_LatencyPoseApply, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Capsule Apply (ms)"), STAT_QuestHands_LatencyCapsuleApply, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Render Submit (ms)"), STAT_QuestHands_LatencyRenderSubmit, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Convert p95 (ms)"), STAT_QuestHands_LatencyConvertP95, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Convert p99 (ms)"), STAT_QuestHands_LatencyConvertP99, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency FK p95 (ms)"), STAT_QuestHands_LatencyFKP95, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency FK p99 (ms)"), STAT_QuestHands_LatencyFKP99, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Pose Apply p95 (ms)"), STAT_QuestHands_LatencyPoseApplyP95, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Pose Apply p99 (ms)"), STAT_QuestHands_LatencyPoseApplyP99, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Capsule Apply p95 (ms)"), STAT_QuestHands_LatencyCapsuleApplyP95, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Capsule Apply p99 (ms)"), STAT_QuestHands_LatencyCapsuleApplyP99, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Render Submit p95 (ms)"), STAT_QuestHands_LatencyRenderSubmitP95, STATGROUP_QuestHands);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Latency Render Submit p99 (ms)"), STAT_QuestHands_LatencyRenderSubmitP99, STATGROUP_QuestHands);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Latency Pose Apply (frames)"), STAT_QuestHands_LatencyPoseApplyFrames, STATGROUP_QuestHands);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Latency Capsule Apply (frames)"), STAT_QuestHands_LatencyCapsuleApplyFrames, STATGROUP_QuestHands);
+
+CSV_DEFINE_CATEGORY(QuestHands, true);
+
+namespace QuestHands
+{
+namespace Latency
+{
+    static const TCHAR* StageNames[Stage_Max] =
+    {
+        TEXT("Convert"), TEXT("FK"), TEXT("PoseApply"), TEXT("CapsuleApply"), TEXT("RenderSubmit")
+    };
+
+    // Histogram of the latencies of a stage in quarter millisecond buckets, the last bucket collects everything beyond
+    struct FHistogram
+    {
+        static constexpr int32 NumBuckets = 128;
+        static constexpr double BucketMs = 0.25;
+
+        uint32 Buckets[NumBuckets];
+        uint64 Count;
+        double TotalMs;
+        double MaxMs;
+
+        FHistogram() { Reset(); }
+
+        void Reset()
+        {
+            FMemory::Memzero(Buckets);
+            Count = 0;
+            TotalMs = 0.0;
+            MaxMs = 0.0;
+        }
+
+        void Add(double Ms)
+        {
+            ++Buckets[FMath::Clamp((int32)(Ms / BucketMs), 0, NumBuckets - 1)];
+            ++Count;
+            TotalMs += Ms;
+            MaxMs = FMath::Max(MaxMs, Ms);
+        }
+
+        double Percentile(double Fraction) const
+        {
+            const uint64 target = (uint64)FMath::CeilToDouble(Count * Fraction);
+            uint64 seen = 0;
+            for(int32 bucketIndex = 0; bucketIndex < NumBuckets; ++bucketIndex)
+            {
+                seen += Buckets[bucketIndex];
+                if(seen >= target && seen != 0)
+                {
+                    return (bucketIndex + 1) * BucketMs;
+                }
+            }
+            return MaxMs;
+        }
+    };
+
+    static FHistogram Histograms[Stage_Max];
+    static FCriticalSection HistogramsLock;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void Record(EStage Stage, double SampleTime, uint64 SampleFrame)
+    {
+        if(Stage < 0 || Stage >= Stage_Max)
+        {
+            return;
+        }
+
+        const float latencyMs = (float)((FPlatformTime::Seconds() - SampleTime) * 1000.0);
+        const uint32 latencyFrames = (uint32)(GFrameCounter - SampleFrame);
+
+        // The percentiles since the last reset are published with the latest latency, QuestHands.DumpLatency has the rest
+        float p95Ms = 0.0f;
+        float p99Ms = 0.0f;
+        {
+            FScopeLock lock(&HistogramsLock);
+            FHistogram& histogram = Histograms[Stage];
+            histogram.Add(latencyMs);
+            p95Ms = (float)histogram.Percentile(0.95);
+            p99Ms = (float)histogram.Percentile(0.99);
+        }
+
+        switch(Stage)
+        {
+            case Stage_Convert:
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyConvert, latencyMs);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyConvertP95, p95Ms);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyConvertP99, p99Ms);
+                CSV_CUSTOM_STAT(QuestHands, LatencyConvert, latencyMs, ECsvCustomStatOp::Max);
+                CSV_CUSTOM_STAT(QuestHands, LatencyConvertP95, p95Ms, ECsvCustomStatOp::Set);
+                CSV_CUSTOM_STAT(QuestHands, LatencyConvertP99, p99Ms, ECsvCustomStatOp::Set);
+                break;
+            case Stage_FK:
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyFK, latencyMs);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyFKP95, p95Ms);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyFKP99, p99Ms);
+                CSV_CUSTOM_STAT(QuestHands, LatencyFK, latencyMs, ECsvCustomStatOp::Max);
+                CSV_CUSTOM_STAT(QuestHands, LatencyFKP95, p95Ms, ECsvCustomStatOp::Set);
+                CSV_CUSTOM_STAT(QuestHands, LatencyFKP99, p99Ms, ECsvCustomStatOp::Set);
+                break;
+            case Stage_PoseApply:
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyPoseApply, latencyMs);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyPoseApplyP95, p95Ms);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyPoseApplyP99, p99Ms);
+                SET_DWORD_STAT(STAT_QuestHands_LatencyPoseApplyFrames, latencyFrames);
+                CSV_CUSTOM_STAT(QuestHands, LatencyPoseApply, latencyMs, ECsvCustomStatOp::Max);
+                CSV_CUSTOM_STAT(QuestHands, LatencyPoseApplyP95, p95Ms, ECsvCustomStatOp::Set);
+                CSV_CUSTOM_STAT(QuestHands, LatencyPoseApplyP99, p99Ms, ECsvCustomStatOp::Set);
+                break;
+            case Stage_CapsuleApply:
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyCapsuleApply, latencyMs);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyCapsuleApplyP95, p95Ms);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyCapsuleApplyP99, p99Ms);
+                SET_DWORD_STAT(STAT_QuestHands_LatencyCapsuleApplyFrames, latencyFrames);
+                CSV_CUSTOM_STAT(QuestHands, LatencyCapsuleApply, latencyMs, ECsvCustomStatOp::Max);
+                CSV_CUSTOM_STAT(QuestHands, LatencyCapsuleApplyP95, p95Ms, ECsvCustomStatOp::Set);
+                CSV_CUSTOM_STAT(QuestHands, LatencyCapsuleApplyP99, p99Ms, ECsvCustomStatOp::Set);
+                break;
+            case Stage_RenderSubmit:
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyRenderSubmit, latencyMs);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyRenderSubmitP95, p95Ms);
+                SET_FLOAT_STAT(STAT_QuestHands_LatencyRenderSubmitP99, p99Ms);
+                CSV_CUSTOM_STAT(QuestHands, LatencyRenderSubmit, latencyMs, ECsvCustomStatOp::Max);
+                CSV_CUSTOM_STAT(QuestHands, LatencyRenderSubmitP95, p95Ms, ECsvCustomStatOp::Set);
+                CSV_CUSTOM_STAT(QuestHands, LatencyRenderSubmitP99, p99Ms, ECsvCustomStatOp::Set);
+                break;
+            default:
+                break;
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void RecordRenderSubmit(double SampleTime, uint64 SampleFrame)
+    {
+        ENQUEUE_RENDER_COMMAND(QuestHandsLatencyRenderSubmit)(
+            [SampleTime, SampleFrame](FRHICommandListImmediate& RHICmdList)
+            {
+                Record(Stage_RenderSubmit, SampleTime, SampleFrame);
+            });
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void DumpLatency()
+    {
+        FScopeLock lock(&HistogramsLock);
+        UE_LOG(LogQuestHands, Log, TEXT("QuestHands sample to apply latency (ms):"));
+        for(int32 stageIndex = 0; stageIndex < Stage_Max; ++stageIndex)
+        {
+            const FHistogram& histogram = Histograms[stageIndex];
+            if(histogram.Count == 0)
+            {
+                UE_LOG(LogQuestHands, Log, TEXT("  %-12s no samples"), StageNames[stageIndex]);
+                continue;
+            }
+
+            UE_LOG(LogQuestHands, Log, TEXT("  %-12s samples %8llu  avg %6.2f  p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f"),
+                   StageNames[stageIndex], histogram.Count, histogram.TotalMs / histogram.Count,
+                   histogram.Percentile(0.5), histogram.Percentile(0.95), histogram.Percentile(0.99), histogram.MaxMs);
+        }
+    }
+
+    static FAutoConsoleCommand DumpLatencyCommand(
+        TEXT("QuestHands.DumpLatency"),
+        TEXT("Log the sample to apply latency histograms of the hand pipeline stages"),
+        FConsoleCommandDelegate::CreateStatic(&DumpLatency));
+
+    static FAutoConsoleCommand ResetLatencyCommand(
+        TEXT("QuestHands.ResetLatency"),
+        TEXT("Clear the sample to apply latency histograms of the hand pipeline stages"),
+        FConsoleCommandDelegate::CreateLambda([]()
+        {
+            FScopeLock lock(&HistogramsLock);
+            for(FHistogram& histogram : Histograms)
+            {
+                histogram.Reset();
+            }
+        }));
+}
+}
+
+#endif
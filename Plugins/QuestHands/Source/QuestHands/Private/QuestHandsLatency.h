@@ -0,0 +1,60 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#ifndef QUESTHANDS_LATENCY_TRACING
+#define QUESTHANDS_LATENCY_TRACING 0
+#endif
+
+/**
+  * Sample to apply latency tracing of the hand pipeline. Every tracking sample is tagged with the time the runtime sampled
+  * the hand and the frame it was read in, each stage records how old the sample is when the stage is done with it. The latencies are reported as
+  * stats and CSV profiler stats, the latest and the 95th and 99th percentiles of each stage since the last
+  * QuestHands.ResetLatency, with the full histograms dumped by QuestHands.DumpLatency.
+  * Compiled out entirely when QUESTHANDS_LATENCY_TRACING is 0.
+*/
+#if QUESTHANDS_LATENCY_TRACING
+
+namespace QuestHands
+{
+namespace Latency
+{
+    enum EStage
+    {
+        // The tracking state was read and converted from the runtime, the age includes the time the runtime held the sample
+        Stage_Convert,
+
+        // The bone transforms were solved
+        Stage_FK,
+
+        // The bone transforms were applied to the hand meshes
+        Stage_PoseApply,
+
+        // The capsules were moved to the bone transforms
+        Stage_CapsuleApply,
+
+        // The render thread picked up the frame the hand meshes were posed in
+        Stage_RenderSubmit,
+
+        Stage_Max
+    };
+
+    // Record the age of a sample at the end of a stage, safe to call from the game and render threads
+    void Record(EStage Stage, double SampleTime, uint64 SampleFrame);
+
+    // Record the render submit stage once the render thread reaches the commands enqueued this frame
+    void RecordRenderSubmit(double SampleTime, uint64 SampleFrame);
+}
+}
+
+#define QUESTHANDS_LATENCY_RECORD(Stage, SampleTime, SampleFrame) QuestHands::Latency::Record(QuestHands::Latency::Stage, SampleTime, SampleFrame)
+#define QUESTHANDS_LATENCY_RECORD_RENDER_SUBMIT(SampleTime, SampleFrame) QuestHands::Latency::RecordRenderSubmit(SampleTime, SampleFrame)
+
+#else
+
+#define QUESTHANDS_LATENCY_RECORD(Stage, SampleTime, SampleFrame)
+#define QUESTHANDS_LATENCY_RECORD_RENDER_SUBMIT(SampleTime, SampleFrame)
+
+#endif
@@ -0,0 +1,104 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsLoadTestActors.h"
+#include "QuestHandsComponent.h"
+#include "Components/BoxComponent.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+AQuestHandsPollingWaiter::AQuestHandsPollingWaiter()
+    : Hands(nullptr)
+    , NumTicks(0)
+    , NumCompletions(0)
+    , WaitingForRelease(false)
+{
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void AQuestHandsPollingWaiter::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    ++NumTicks;
+    if(!Hands)
+    {
+        return;
+    }
+
+    const bool met = Condition.IsMet(Hands->GetHandTrackingState(Condition.Hand));
+    if(!WaitingForRelease && met)
+    {
+        ++NumCompletions;
+        WaitingForRelease = true;
+    }
+    else if(WaitingForRelease && !met)
+    {
+        WaitingForRelease = false;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+AQuestHandsOverlapCounter::AQuestHandsOverlapCounter()
+    : NumComponentBeginOverlaps(0)
+    , NumComponentEndOverlaps(0)
+    , NumActorBeginOverlaps(0)
+    , NumActorEndOverlaps(0)
+{
+    Box = CreateDefaultSubobject<UBoxComponent>(TEXT("Box"));
+    Box->SetCollisionProfileName(TEXT("OverlapAllDynamic"));
+    Box->SetGenerateOverlapEvents(true);
+    RootComponent = Box;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void AQuestHandsOverlapCounter::BeginPlay()
+{
+    Super::BeginPlay();
+
+    Box->OnComponentBeginOverlap.AddDynamic(this, &AQuestHandsOverlapCounter::OnBoxBeginOverlap);
+    Box->OnComponentEndOverlap.AddDynamic(this, &AQuestHandsOverlapCounter::OnBoxEndOverlap);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void AQuestHandsOverlapCounter::NotifyActorBeginOverlap(AActor* OtherActor)
+{
+    Super::NotifyActorBeginOverlap(OtherActor);
+    ++NumActorBeginOverlaps;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void AQuestHandsOverlapCounter::NotifyActorEndOverlap(AActor* OtherActor)
+{
+    Super::NotifyActorEndOverlap(OtherActor);
+    ++NumActorEndOverlaps;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void AQuestHandsOverlapCounter::OnBoxBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, 
+                                                  int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+    ++NumComponentBeginOverlaps;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void AQuestHandsOverlapCounter::OnBoxEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+    ++NumComponentEndOverlaps;
+}
@@ -0,0 +1,70 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "QuestHandsWaits.h"
+
+#include "QuestHandsLoadTestActors.generated.h"
+
+class UBoxComponent;
+class UPrimitiveComponent;
+class UQuestHandsComponent;
+struct FHitResult;
+
+// Waits for a hand condition by polling the hand state every tick, what Blueprints had to do before hand waits.
+// The baseline the QuestHandsLoadTest commandlet compares hand waits with.
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class AQuestHandsPollingWaiter : public AActor
+{
+    GENERATED_BODY()
+public:
+
+    AQuestHandsPollingWaiter();
+
+    virtual void Tick(float DeltaSeconds) override;
+
+    // The hands polled for the condition
+    UPROPERTY(Transient)
+    UQuestHandsComponent* Hands;
+
+    // The condition waited for, once met the waiter waits for it to stop being met and starts over
+    FQHandWaitCondition Condition;
+
+    int64 NumTicks;
+    int64 NumCompletions;
+
+private:
+    bool WaitingForRelease;
+};
+
+// A box counting the overlap events it gets, at component and actor level. Compares the overlap modes of the hands capsules.
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class AQuestHandsOverlapCounter : public AActor
+{
+    GENERATED_BODY()
+public:
+
+    AQuestHandsOverlapCounter();
+
+    virtual void BeginPlay() override;
+    virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
+    virtual void NotifyActorEndOverlap(AActor* OtherActor) override;
+
+    UPROPERTY(Transient)
+    UBoxComponent* Box;
+
+    int32 NumComponentBeginOverlaps;
+    int32 NumComponentEndOverlaps;
+    int32 NumActorBeginOverlaps;
+    int32 NumActorEndOverlaps;
+
+private:
+    UFUNCTION()
+    void OnBoxBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, 
+                           bool bFromSweep, const FHitResult& SweepResult);
+
+    UFUNCTION()
+    void OnBoxEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+};
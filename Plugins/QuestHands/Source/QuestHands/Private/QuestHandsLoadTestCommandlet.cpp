@@ -0,0 +1,705 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsLoadTestCommandlet.h"
+#include "QuestHands.h"
+#include "QuestHandsComponent.h"
+#include "QuestHandsDataSource.h"
+#include "QuestHandsGhostSubsystem.h"
+#include "QuestHandsGovernorSubsystem.h"
+#include "QuestHandsLoadTestActors.h"
+#include "QuestHandsPoolSubsystem.h"
+#include "QuestHandsTestWorld.h"
+#include "QuestHandsTopology.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/AsyncLoadingFlush.h"
+
+namespace QuestHands
+{
+namespace LoadTest
+{
+    using namespace TestWorld;
+
+    // Pawns are spawned on a square grid this far apart so the hands don't overlap
+    static constexpr float PawnSpacing = 200.0f;
+
+    // Frames ticked before measuring so the meshes, pools and physics bodies have settled
+    static constexpr int32 WarmupFrames = 30;
+
+    struct FLoadTestSettings
+    {
+        float Duration = 10.0f;
+        float FrameRate = 72.0f;
+        int32 Seed = 0;
+        bool UseLOD = true;
+        bool UseGhostHands = false;
+        FString ExportRegion;
+        TSharedPtr<const FQHandRecordingClip> Clip;
+    };
+
+    // The measurements of one pawn count
+    struct FLoadTestResult
+    {
+        int32 NumPawns = 0;
+        int32 Frames = 0;
+        double FrameMs = 0.0;
+        double FrameP95Ms = 0.0;
+        double RenderStepMs = 0.0;
+
+        // The hands work of the physics step, the PrePhysics tick of the hands components
+        double PhysicsTickMs = 0.0;
+
+        // The physics scene simulating, see TestWorld::FPhysicsSceneTimer
+        double PhysicsSceneMs = 0.0;
+        double GhostFlushMs = 0.0;
+        int64 ComponentBytes = 0;
+        int64 ProcessBytes = 0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static TSharedPtr<IQuestHandsDataSource> MakeDataSource(const FLoadTestSettings& Settings, int32 PawnIndex)
+    {
+        if(Settings.Clip.IsValid())
+        {
+            // Start every pawn somewhere else in the recording so they don't move in lockstep
+            FRandomStream random(Settings.Seed + PawnIndex);
+            const double offset = random.FRandRange(0.0f, (float)Settings.Clip->GetDuration());
+            return MakeShared<FQHandRecordingDataSource>(Settings.Clip.ToSharedRef(), offset);
+        }
+        return MakeShared<FQHandSyntheticDataSource>(Settings.Seed + PawnIndex);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static UQuestHandsComponent* SpawnHandsPawn(UWorld* World, const FLoadTestSettings& Settings, int32 PawnIndex, const FVector& Location)
+    {
+        UQuestHandsComponent* handsComponent = TestWorld::SpawnHandsPawn(World, Location, MakeDataSource(Settings, PawnIndex), [&Settings](UQuestHandsComponent* component)
+        {
+            component->UseUpdateLOD = Settings.UseLOD;
+            component->UseGhostHands = Settings.UseGhostHands;
+        });
+
+        // Only the first pawn is exported, for reading the live hands from another process during the test
+        if(handsComponent && PawnIndex == 0 && !Settings.ExportRegion.IsEmpty())
+        {
+            handsComponent->StartSharedFrameExport(Settings.ExportRegion);
+        }
+        return handsComponent;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool RunPawnCount(const FLoadTestSettings& Settings, int32 NumPawns, FLoadTestResult& ResultOut)
+    {
+        ResultOut = FLoadTestResult();
+        ResultOut.NumPawns = NumPawns;
+
+        const int64 startProcessBytes = (int64)FPlatformMemory::GetStats().UsedPhysical;
+
+        UWorld* world = CreateTestWorld(FString::Printf(TEXT("QuestHandsLoadTest_%d"), NumPawns));
+        if(!world->HasBegunPlay())
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : The test world didn't begin play"));
+            DestroyTestWorld(world);
+            return false;
+        }
+
+        // The load is measured at full quality, the governor would otherwise step the levels as the load grows
+        UQuestHandsGovernorSubsystem* governor = world->GetSubsystem<UQuestHandsGovernorSubsystem>();
+        if(governor)
+        {
+            governor->Enabled = false;
+        }
+
+        TArray<UQuestHandsComponent*> components;
+        components.Reserve(NumPawns);
+
+        const int32 gridSize = FMath::Max(FMath::CeilToInt(FMath::Sqrt((float)NumPawns)), 1);
+        for(int32 pawnIndex = 0; pawnIndex < NumPawns; ++pawnIndex)
+        {
+            const FVector location((pawnIndex % gridSize) * PawnSpacing, (pawnIndex / gridSize) * PawnSpacing, 0.0f);
+            if(UQuestHandsComponent* handsComponent = SpawnHandsPawn(world, Settings, pawnIndex, location))
+            {
+                components.Add(handsComponent);
+            }
+        }
+
+        // Hand meshes load asynchronously, wait for them so the warm up sees the full cost
+        FlushAsyncLoading();
+
+        FPhysicsSceneTimer physicsTimer;
+        physicsTimer.Register(world);
+
+        const float deltaTime = 1.0f / Settings.FrameRate;
+        for(int32 frame = 0; frame < WarmupFrames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+        }
+
+        const double startRenderMs = governor ? governor->GetTotalHandsWorkMs(EQHandUpdateStep::UpdateStep_Render) : 0.0;
+        const double startPhysicsMs = governor ? governor->GetTotalHandsWorkMs(EQHandUpdateStep::UpdateStep_Physics) : 0.0;
+        const double startPhysicsSceneMs = physicsTimer.GetTotalMs();
+        UQuestHandsGhostSubsystem* ghosts = world->GetSubsystem<UQuestHandsGhostSubsystem>();
+        const double startGhostFlushMs = ghosts ? ghosts->GetTotalFlushMs() : 0.0;
+
+        const int32 numFrames = FMath::Max(FMath::RoundToInt(Settings.Duration * Settings.FrameRate), 1);
+        TArray<double> frameTimes;
+        frameTimes.SetNumUninitialized(numFrames);
+        for(int32 frame = 0; frame < numFrames; ++frame)
+        {
+            const double frameStart = FPlatformTime::Seconds();
+            AdvanceFrame(world, deltaTime);
+            frameTimes[frame] = (FPlatformTime::Seconds() - frameStart) * 1000.0;
+        }
+
+        ResultOut.Frames = numFrames;
+        for(double frameTime : frameTimes)
+        {
+            ResultOut.FrameMs += frameTime;
+        }
+        ResultOut.FrameMs /= numFrames;
+
+        frameTimes.Sort();
+        ResultOut.FrameP95Ms = frameTimes[FMath::Min(FMath::FloorToInt(numFrames * 0.95f), numFrames - 1)];
+
+        if(governor)
+        {
+            ResultOut.RenderStepMs = (governor->GetTotalHandsWorkMs(EQHandUpdateStep::UpdateStep_Render) - startRenderMs) / numFrames;
+            ResultOut.PhysicsTickMs = (governor->GetTotalHandsWorkMs(EQHandUpdateStep::UpdateStep_Physics) - startPhysicsMs) / numFrames;
+        }
+        ResultOut.PhysicsSceneMs = (physicsTimer.GetTotalMs() - startPhysicsSceneMs) / numFrames;
+        physicsTimer.Unregister();
+        if(ghosts)
+        {
+            ResultOut.GhostFlushMs = (ghosts->GetTotalFlushMs() - startGhostFlushMs) / numFrames;
+        }
+
+        for(const UQuestHandsComponent* handsComponent : components)
+        {
+            ResultOut.ComponentBytes += handsComponent->GetMemoryFootprintBytes();
+        }
+        ResultOut.ProcessBytes = (int64)FPlatformMemory::GetStats().UsedPhysical - startProcessBytes;
+
+        components.Reset();
+        DestroyTestWorld(world);
+        return true;
+    }
+
+    // The measurements of the waiters of one wait benchmark run
+    struct FWaitBenchmarkResult
+    {
+        int64 ActorTicks = 0;
+        int64 Completions = 0;
+        double FrameMs = 0.0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Waiters wait for the index pinch of one hands pawn over and over, either polling the hand state from their own
+      * tick the way Blueprints did before waits, or through hand waits with their tick disabled.
+    */
+    static bool RunWaitBenchmark(const FLoadTestSettings& Settings, int32 NumWaiters, bool Polling, FWaitBenchmarkResult& ResultOut)
+    {
+        ResultOut = FWaitBenchmarkResult();
+
+        UWorld* world = CreateTestWorld(Polling ? TEXT("QuestHandsWaitBenchmark_Polling") : TEXT("QuestHandsWaitBenchmark_Waits"));
+        UQuestHandsComponent* handsComponent = world->HasBegunPlay() ? SpawnHandsPawn(world, Settings, 0, FVector::ZeroVector) : nullptr;
+        if(!handsComponent)
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : Unable to set up the wait benchmark world"));
+            DestroyTestWorld(world);
+            return false;
+        }
+        FlushAsyncLoading();
+
+        FQHandWaitCondition condition;
+        condition.Condition = EQHandWaitCondition::WaitCondition_Pinched;
+        condition.Hand = EControllerHand::Right;
+        condition.Finger = EQHandFinger::HandFinger_Index;
+
+        TArray<AQuestHandsPollingWaiter*> pollingWaiters;
+        int64 waitCompletions = 0;
+
+        // Each waiter restarts its wait once the pinch is released, like a Blueprint looping on the wait node
+        TFunction<void(bool)> waitForPinch;
+        TFunction<void(bool)> waitForRelease;
+        waitForPinch = [handsComponent, &condition, &waitCompletions, &waitForRelease](bool met)
+        {
+            if(met)
+            {
+                ++waitCompletions;
+                FQHandWaitCondition releaseCondition = condition;
+                releaseCondition.Condition = EQHandWaitCondition::WaitCondition_Released;
+                handsComponent->StartHandWait(releaseCondition, waitForRelease);
+            }
+        };
+        waitForRelease = [handsComponent, &condition, &waitForPinch](bool met)
+        {
+            if(met)
+            {
+                handsComponent->StartHandWait(condition, waitForPinch);
+            }
+        };
+
+        for(int32 waiterIndex = 0; waiterIndex < NumWaiters; ++waiterIndex)
+        {
+            if(Polling)
+            {
+                AQuestHandsPollingWaiter* waiter = world->SpawnActor<AQuestHandsPollingWaiter>();
+                if(waiter)
+                {
+                    waiter->Hands = handsComponent;
+                    waiter->Condition = condition;
+                    pollingWaiters.Add(waiter);
+                }
+            }
+            else
+            {
+                // The waiting actor never ticks, the wait lives on the hands component
+                AActor* waiter = world->SpawnActor<AActor>();
+                if(waiter)
+                {
+                    waiter->SetActorTickEnabled(false);
+                    handsComponent->StartHandWait(condition, waitForPinch);
+                }
+            }
+        }
+
+        const float deltaTime = 1.0f / Settings.FrameRate;
+        for(int32 frame = 0; frame < WarmupFrames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+        }
+
+        int64 startTicks = 0;
+        int64 startCompletions = waitCompletions;
+        for(const AQuestHandsPollingWaiter* waiter : pollingWaiters)
+        {
+            startTicks += waiter->NumTicks;
+            startCompletions += waiter->NumCompletions;
+        }
+
+        const int32 numFrames = FMath::Max(FMath::RoundToInt(Settings.Duration * Settings.FrameRate), 1);
+        const double startTime = FPlatformTime::Seconds();
+        for(int32 frame = 0; frame < numFrames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+        }
+        ResultOut.FrameMs = (FPlatformTime::Seconds() - startTime) * 1000.0 / numFrames;
+
+        ResultOut.Completions = waitCompletions;
+        for(const AQuestHandsPollingWaiter* waiter : pollingWaiters)
+        {
+            ResultOut.ActorTicks += waiter->NumTicks;
+            ResultOut.Completions += waiter->NumCompletions;
+        }
+        ResultOut.ActorTicks -= startTicks;
+        ResultOut.Completions -= startCompletions;
+
+        // The callbacks reference locals of this function, drop them before it returns
+        handsComponent->CancelHandWaits();
+        pollingWaiters.Reset();
+        DestroyTestWorld(world);
+        return true;
+    }
+
+    // Where the components of the joining pawns come from in a spawn hitch run
+    enum class ESpawnPool : uint8
+    {
+        // Created for the pawns, the pool isn't used
+        Unpooled,
+
+        // Released to the pool by the same number of pawns leaving just before
+        Respawned,
+
+        // Created ahead by UQuestHandsPoolSubsystem::Prewarm, a few per frame
+        Prewarmed,
+    };
+
+    static const TCHAR* GetSpawnPoolName(ESpawnPool Pool)
+    {
+        return Pool == ESpawnPool::Unpooled ? TEXT("unpooled") : (Pool == ESpawnPool::Respawned ? TEXT("respawned") : TEXT("prewarmed"));
+    }
+
+    // The measurements of one spawn hitch run
+    struct FSpawnHitchResult
+    {
+        ESpawnPool Pool = ESpawnPool::Unpooled;
+        int32 CapsuleBudget = 0;
+        int32 PooledPoseables = 0;
+        int32 PooledCapsules = 0;
+        double SpawnFrameMs = 0.0;
+        double MaxFrameMs = 0.0;
+        double BaselineFrameMs = 0.0;
+        int32 FramesToCapsules = 0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool AreCapsulesComplete(const TArray<UQuestHandsComponent*>& Components)
+    {
+        for(const UQuestHandsComponent* handsComponent : Components)
+        {
+            for(EControllerHand hand : { EControllerHand::Left, EControllerHand::Right })
+            {
+                const TArray<UCapsuleComponent*>& capsules = handsComponent->GetHandCapsules(hand);
+                if(capsules.Num() == 0 || capsules.Num() < handsComponent->GetHandSkeleton(hand).BoneCapsules.Num() || capsules.Contains(nullptr))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Spawn NumPawns hands pawns at once on the grid
+    */
+    static void SpawnHitchPawns(UWorld* World, const FLoadTestSettings& Settings, int32 NumPawns, int32 MaxCapsuleCreatesPerFrame, bool UsePool,
+                                TArray<UQuestHandsComponent*>& ComponentsOut)
+    {
+        // The hand meshes finish loading asynchronously later on, the hitch is the setup of the components. Exports aren't part of it.
+        FLoadTestSettings spawnSettings = Settings;
+        spawnSettings.ExportRegion.Empty();
+
+        ComponentsOut.Reset();
+        const int32 gridSize = FMath::Max(FMath::CeilToInt(FMath::Sqrt((float)NumPawns)), 1);
+        for(int32 pawnIndex = 0; pawnIndex < NumPawns; ++pawnIndex)
+        {
+            const FVector location((pawnIndex % gridSize) * PawnSpacing, (pawnIndex / gridSize) * PawnSpacing, 0.0f);
+            UQuestHandsComponent* handsComponent = TestWorld::SpawnHandsPawn(World, location, MakeDataSource(spawnSettings, pawnIndex),
+                                                                             [&Settings, MaxCapsuleCreatesPerFrame, UsePool](UQuestHandsComponent* component)
+            {
+                component->UseUpdateLOD = Settings.UseLOD;
+                component->UseGhostHands = Settings.UseGhostHands;
+                component->MaxCapsuleCreatesPerFrame = MaxCapsuleCreatesPerFrame;
+                component->UsePooledComponents = UsePool;
+            });
+            if(handsComponent)
+            {
+                ComponentsOut.Add(handsComponent);
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * NumPawns hands pawns joining a running world in the same frame, the way players join or replay ghosts appear.
+      * Reports the frame they were spawned in, the worst frame of the second after it and how many frames it took until
+      * all of their capsules were set up, with capsule creation spread over frames by MaxCapsuleCreatesPerFrame. Pool
+      * decides whether the components are created for them, taken from pawns that just left or prewarmed.
+    */
+    static bool RunSpawnHitch(const FLoadTestSettings& Settings, int32 NumPawns, int32 MaxCapsuleCreatesPerFrame, ESpawnPool Pool, FSpawnHitchResult& ResultOut)
+    {
+        ResultOut = FSpawnHitchResult();
+        ResultOut.Pool = Pool;
+        ResultOut.CapsuleBudget = MaxCapsuleCreatesPerFrame;
+
+        UWorld* world = CreateTestWorld(FString::Printf(TEXT("QuestHandsSpawnHitch_%s_%d"), GetSpawnPoolName(Pool), MaxCapsuleCreatesPerFrame));
+        if(!world->HasBegunPlay())
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : The test world didn't begin play"));
+            DestroyTestWorld(world);
+            return false;
+        }
+
+        if(UQuestHandsGovernorSubsystem* governor = world->GetSubsystem<UQuestHandsGovernorSubsystem>())
+        {
+            governor->Enabled = false;
+        }
+
+        // Room in the pool for every component of the pawns
+        UQuestHandsPoolSubsystem* pool = world->GetSubsystem<UQuestHandsPoolSubsystem>();
+        if(Pool != ESpawnPool::Unpooled)
+        {
+            if(!pool)
+            {
+                UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : The test world has no component pool"));
+                DestroyTestWorld(world);
+                return false;
+            }
+            pool->MaxPooledPoseables = FMath::Max(pool->MaxPooledPoseables, NumPawns * 2);
+            pool->MaxPooledCapsules = FMath::Max(pool->MaxPooledCapsules, NumPawns * 2 * Topology::NumCapsules);
+        }
+
+        const float deltaTime = 1.0f / Settings.FrameRate;
+        const int32 numFrames = FMath::Max(FMath::RoundToInt(Settings.FrameRate), 1);
+        TArray<UQuestHandsComponent*> components;
+
+        if(Pool == ESpawnPool::Respawned)
+        {
+            // The pawns that leave, set up completely before they go so all of their components are released
+            SpawnHitchPawns(world, Settings, NumPawns, 0, true, components);
+            for(int32 frame = 0; frame < numFrames && !AreCapsulesComplete(components); ++frame)
+            {
+                AdvanceFrame(world, deltaTime);
+            }
+            for(UQuestHandsComponent* handsComponent : components)
+            {
+                world->DestroyActor(handsComponent->GetOwner());
+            }
+            components.Reset();
+        }
+        else if(Pool == ESpawnPool::Prewarmed)
+        {
+            pool->Prewarm(NumPawns * 2, NumPawns * 2 * Topology::NumCapsules);
+        }
+
+        // Also lets the prewarm finish, it creates MaxCreatesPerFrame components a frame
+        const int32 settleFrames = Pool == ESpawnPool::Prewarmed ?
+            WarmupFrames + FMath::DivideAndRoundUp(NumPawns * 2 * (Topology::NumCapsules + 1), FMath::Max(pool->MaxCreatesPerFrame, 1)) : WarmupFrames;
+        for(int32 frame = 0; frame < settleFrames; ++frame)
+        {
+            AdvanceFrame(world, deltaTime);
+        }
+
+        // The baseline only once the world settled, the prewarm frames aren't part of it
+        for(int32 frame = 0; frame < WarmupFrames; ++frame)
+        {
+            const double frameStart = FPlatformTime::Seconds();
+            AdvanceFrame(world, deltaTime);
+            ResultOut.BaselineFrameMs += (FPlatformTime::Seconds() - frameStart) * 1000.0 / WarmupFrames;
+        }
+
+        if(pool)
+        {
+            ResultOut.PooledPoseables = pool->GetNumPooledPoseables();
+            ResultOut.PooledCapsules = pool->GetNumPooledCapsules();
+        }
+
+        ResultOut.FramesToCapsules = -1;
+        for(int32 frame = 0; frame < numFrames; ++frame)
+        {
+            const double frameStart = FPlatformTime::Seconds();
+            if(frame == 0)
+            {
+                SpawnHitchPawns(world, Settings, NumPawns, MaxCapsuleCreatesPerFrame, Pool != ESpawnPool::Unpooled, components);
+            }
+            AdvanceFrame(world, deltaTime);
+            const double frameMs = (FPlatformTime::Seconds() - frameStart) * 1000.0;
+
+            ResultOut.SpawnFrameMs = frame == 0 ? frameMs : ResultOut.SpawnFrameMs;
+            ResultOut.MaxFrameMs = FMath::Max(ResultOut.MaxFrameMs, frameMs);
+            if(ResultOut.FramesToCapsules < 0 && AreCapsulesComplete(components))
+            {
+                ResultOut.FramesToCapsules = frame + 1;
+            }
+        }
+
+        components.Reset();
+        DestroyTestWorld(world);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool WriteCSV(const FString& FilePath, const TArray<FLoadTestResult>& Results)
+    {
+        // The first result is the empty world every other count is compared with
+        const FLoadTestResult& baseline = Results[0];
+
+        FString csv = TEXT("pawns,hands,frames,frame_ms,frame_p95_ms,render_step_ms,physics_tick_ms,physics_scene_ms,component_bytes,process_bytes,"
+                           "frame_ms_per_hand,render_step_ms_per_hand,physics_tick_ms_per_hand,physics_scene_ms_per_hand,component_bytes_per_hand,"
+                           "process_bytes_per_hand,ghost_flush_ms,ghost_flush_ms_per_hand\n");
+        for(const FLoadTestResult& result : Results)
+        {
+            const int32 numHands = result.NumPawns * 2;
+            const double perHand = numHands > 0 ? 1.0 / numHands : 0.0;
+            csv += FString::Printf(TEXT("%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%lld,%lld,%.5f,%.5f,%.5f,%.5f,%.0f,%.0f,%.4f,%.5f\n"),
+                                   result.NumPawns, numHands, result.Frames, result.FrameMs, result.FrameP95Ms, result.RenderStepMs, result.PhysicsTickMs,
+                                   result.PhysicsSceneMs, result.ComponentBytes, result.ProcessBytes,
+                                   (result.FrameMs - baseline.FrameMs) * perHand, result.RenderStepMs * perHand, result.PhysicsTickMs * perHand,
+                                   (result.PhysicsSceneMs - baseline.PhysicsSceneMs) * perHand, result.ComponentBytes * perHand, (result.ProcessBytes - baseline.ProcessBytes) * perHand,
+                                   result.GhostFlushMs, result.GhostFlushMs * perHand);
+        }
+        return FFileHelper::SaveStringToFile(csv, *FilePath);
+    }
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsLoadTestCommandlet::UQuestHandsLoadTestCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int32 UQuestHandsLoadTestCommandlet::Main(const FString& Params)
+{
+    using namespace QuestHands::LoadTest;
+
+    FLoadTestSettings settings;
+    FParse::Value(*Params, TEXT("Duration="), settings.Duration);
+    FParse::Value(*Params, TEXT("FrameRate="), settings.FrameRate);
+    FParse::Value(*Params, TEXT("Seed="), settings.Seed);
+    settings.UseLOD = !FParse::Param(*Params, TEXT("NoLOD"));
+    settings.UseGhostHands = FParse::Param(*Params, TEXT("Ghosts"));
+    FParse::Value(*Params, TEXT("Export="), settings.ExportRegion, false);
+    settings.Duration = FMath::Max(settings.Duration, 0.1f);
+    settings.FrameRate = FMath::Max(settings.FrameRate, 1.0f);
+
+    FString pawnsParam = TEXT("1+8+32+64+128+256");
+    FParse::Value(*Params, TEXT("Pawns="), pawnsParam, false);
+
+    // Always measure an empty world first to take the cost of the world itself out of the per hand costs
+    TArray<int32> pawnCounts;
+    pawnCounts.Add(0);
+    TArray<FString> pawnStrings;
+    pawnsParam.ParseIntoArray(pawnStrings, TEXT("+"));
+    for(const FString& pawnString : pawnStrings)
+    {
+        const int32 numPawns = FCString::Atoi(*pawnString);
+        if(numPawns > 0)
+        {
+            pawnCounts.AddUnique(numPawns);
+        }
+    }
+
+    FString recordingPath;
+    if(FParse::Value(*Params, TEXT("Recording="), recordingPath, false))
+    {
+        TSharedRef<FQHandRecordingClip> clip = MakeShared<FQHandRecordingClip>();
+        if(!clip->Load(recordingPath))
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : Unable to load the recording %s"), *recordingPath);
+            return 1;
+        }
+        settings.Clip = clip;
+    }
+
+    FString outputBase = FPaths::ProjectSavedDir() / TEXT("QuestHandsLoadTest");
+    FParse::Value(*Params, TEXT("Output="), outputBase, false);
+
+    // Compare waiters polling the hands from their tick with hand waits instead of the pawn counts
+    int32 numWaiters = 0;
+    if(FParse::Value(*Params, TEXT("Waiters="), numWaiters) && numWaiters > 0)
+    {
+        FWaitBenchmarkResult pollingResult;
+        FWaitBenchmarkResult waitsResult;
+        if(!RunWaitBenchmark(settings, numWaiters, true, pollingResult) || !RunWaitBenchmark(settings, numWaiters, false, waitsResult))
+        {
+            return 1;
+        }
+
+        const int32 numFrames = FMath::Max(FMath::RoundToInt(settings.Duration * settings.FrameRate), 1);
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : %d waiters polling | %lld actor ticks (%.1f per frame), %lld pinches seen, frame %.3f ms"),
+               numWaiters, pollingResult.ActorTicks, (double)pollingResult.ActorTicks / numFrames, pollingResult.Completions, pollingResult.FrameMs);
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : %d waiters on hand waits | %lld actor ticks (%.1f per frame), %lld pinches seen, frame %.3f ms"),
+               numWaiters, waitsResult.ActorTicks, (double)waitsResult.ActorTicks / numFrames, waitsResult.Completions, waitsResult.FrameMs);
+
+        const FString csvPath = outputBase + TEXT("_Waits.csv");
+        const FString csv = FString::Printf(TEXT("mode,waiters,frames,actor_ticks,completions,frame_ms\npolling,%d,%d,%lld,%lld,%.4f\nwaits,%d,%d,%lld,%lld,%.4f\n"),
+                                            numWaiters, numFrames, pollingResult.ActorTicks, pollingResult.Completions, pollingResult.FrameMs,
+                                            numWaiters, numFrames, waitsResult.ActorTicks, waitsResult.Completions, waitsResult.FrameMs);
+        if(!FFileHelper::SaveStringToFile(csv, *csvPath))
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : Unable to write the report to %s"), *csvPath);
+            return 1;
+        }
+
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : Wrote %s"), *csvPath);
+        return 0;
+    }
+
+    // Compare the hitch of pawns joining with all their capsules created at once and spread over frames, with the
+    // components created for them, taken back from pawns that left and prewarmed
+    int32 numSpawnPawns = 0;
+    if(FParse::Value(*Params, TEXT("SpawnHitch="), numSpawnPawns) && numSpawnPawns > 0)
+    {
+        int32 capsuleBudget = 8;
+        FParse::Value(*Params, TEXT("CapsuleBudget="), capsuleBudget);
+        capsuleBudget = FMath::Max(capsuleBudget, 1);
+
+        TArray<FSpawnHitchResult> results;
+        for(ESpawnPool pool : { ESpawnPool::Unpooled, ESpawnPool::Respawned, ESpawnPool::Prewarmed })
+        {
+            for(int32 budget : { 0, capsuleBudget })
+            {
+                if(!RunSpawnHitch(settings, numSpawnPawns, budget, pool, results.AddDefaulted_GetRef()))
+                {
+                    return 1;
+                }
+            }
+        }
+
+        FString csv = TEXT("pawns,pool,capsule_budget,pooled_poseables,pooled_capsules,baseline_frame_ms,spawn_frame_ms,max_frame_ms,frames_to_capsules\n");
+        for(const FSpawnHitchResult& result : results)
+        {
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : %d pawns joining, %-9s (%d poseables, %d capsules pooled), capsule budget %d | ")
+                                           TEXT("spawn frame %.3f ms, worst frame %.3f ms (%.3f ms before) | capsules set up after %d frames"),
+                   numSpawnPawns, GetSpawnPoolName(result.Pool), result.PooledPoseables, result.PooledCapsules, result.CapsuleBudget,
+                   result.SpawnFrameMs, result.MaxFrameMs, result.BaselineFrameMs, result.FramesToCapsules);
+            csv += FString::Printf(TEXT("%d,%s,%d,%d,%d,%.4f,%.4f,%.4f,%d\n"), numSpawnPawns, GetSpawnPoolName(result.Pool), result.CapsuleBudget,
+                                   result.PooledPoseables, result.PooledCapsules, result.BaselineFrameMs, result.SpawnFrameMs, result.MaxFrameMs,
+                                   result.FramesToCapsules);
+        }
+
+        // The pooled spawn next to the unpooled one for each budget
+        for(int32 resultIndex = 0; resultIndex < 2; ++resultIndex)
+        {
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : capsule budget %d spawn frame | unpooled %.3f ms, respawned %.3f ms, prewarmed %.3f ms"),
+                   results[resultIndex].CapsuleBudget, results[resultIndex].SpawnFrameMs, results[resultIndex + 2].SpawnFrameMs, results[resultIndex + 4].SpawnFrameMs);
+        }
+
+        const FString csvPath = outputBase + TEXT("_SpawnHitch.csv");
+        if(!FFileHelper::SaveStringToFile(csv, *csvPath))
+        {
+            UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : Unable to write the report to %s"), *csvPath);
+            return 1;
+        }
+
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : Wrote %s"), *csvPath);
+        return 0;
+    }
+
+    UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : %s hands, %.1f s at %.0f Hz per pawn count, update LOD %s, %s"),
+           settings.Clip.IsValid() ? *FString::Printf(TEXT("Recorded (%s)"), *recordingPath) : TEXT("Synthetic"),
+           settings.Duration, settings.FrameRate, settings.UseLOD ? TEXT("on") : TEXT("off"),
+           settings.UseGhostHands ? TEXT("ghost hands") : TEXT("hand meshes"));
+
+    TArray<FLoadTestResult> results;
+    for(int32 numPawns : pawnCounts)
+    {
+        FLoadTestResult& result = results.AddDefaulted_GetRef();
+        if(!RunPawnCount(settings, numPawns, result))
+        {
+            return 1;
+        }
+
+        const FLoadTestResult& baseline = results[0];
+        const int32 numHands = numPawns * 2;
+        const double perHand = numHands > 0 ? 1.0 / numHands : 0.0;
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : %4d pawns | frame %7.3f ms (p95 %7.3f) | render step %7.3f ms | physics tick %7.3f ms | ")
+                                       TEXT("physics scene %7.3f ms | per hand: frame %.4f ms, render %.4f ms, physics tick %.4f ms, physics scene %.4f ms, ")
+                                       TEXT("ghost flush %.4f ms, %.1f KB"),
+               numPawns, result.FrameMs, result.FrameP95Ms, result.RenderStepMs, result.PhysicsTickMs, result.PhysicsSceneMs,
+               (result.FrameMs - baseline.FrameMs) * perHand, result.RenderStepMs * perHand, result.PhysicsTickMs * perHand,
+               (result.PhysicsSceneMs - baseline.PhysicsSceneMs) * perHand,
+               result.GhostFlushMs * perHand, (result.ProcessBytes - baseline.ProcessBytes) * perHand / 1024.0);
+    }
+
+    const FString csvPath = outputBase + TEXT(".csv");
+    if(!WriteCSV(csvPath, results))
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsLoadTest : Unable to write the report to %s"), *csvPath);
+        return 1;
+    }
+
+    UE_LOG(LogQuestHands, Display, TEXT("QuestHandsLoadTest : Wrote %s"), *csvPath);
+    return 0;
+}
@@ -0,0 +1,391 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsMemory.h"
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+#include "QuestHandsComponent.h"
+#include "QuestHandsGrabSubsystem.h"
+#include "QuestHandsPokeSubsystem.h"
+#include "QuestHandsPoolSubsystem.h"
+#include "QuestHandsGovernorSubsystem.h"
+#include "QuestHandsPhysicsHand.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/LowLevelMemStats.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_MEMORY_STAT(TEXT("Hand State"), STAT_QuestHands_MemHandState, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Tracking Data"), STAT_QuestHands_MemTrackingData, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Poseables"), STAT_QuestHands_MemPoseables, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Capsules"), STAT_QuestHands_MemCapsules, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Physics Hands"), STAT_QuestHands_MemPhysicsHands, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Pool"), STAT_QuestHands_MemPool, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Subsystems"), STAT_QuestHands_MemSubsystems, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Total"), STAT_QuestHands_MemTotal, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Peak Total"), STAT_QuestHands_MemPeakTotal, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Largest Pawn"), STAT_QuestHands_MemLargestPawn, STATGROUP_QuestHandsMemory);
+DECLARE_MEMORY_STAT(TEXT("Peak Largest Pawn"), STAT_QuestHands_MemPeakLargestPawn, STATGROUP_QuestHandsMemory);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hands Components"), STAT_QuestHands_MemComponents, STATGROUP_QuestHandsMemory);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pawns Over Budget"), STAT_QuestHands_MemPawnsOverBudget, STATGROUP_QuestHandsMemory);
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("QuestHands"), STAT_QuestHandsLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("QuestHands"), STAT_QuestHandsSummaryLLM, STATGROUP_LLM);
+DECLARE_LLM_MEMORY_STAT(TEXT("QuestHands HandState"), STAT_QuestHandsHandStateLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("QuestHands Components"), STAT_QuestHandsComponentsLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("QuestHands Physics"), STAT_QuestHandsPhysicsLLM, STATGROUP_LLMFULL);
+
+#if STATS
+#define QUESTHANDS_LLM_STATNAME(Stat) GET_STATFNAME(Stat)
+#else
+#define QUESTHANDS_LLM_STATNAME(Stat) NAME_None
+#endif
+#endif
+
+namespace QuestHands
+{
+namespace Memory
+{
+    static TAutoConsoleVariable<int32> CVarMemoryBudgetPerPawnKB(
+        TEXT("QuestHands.MemoryBudgetPerPawnKB"),
+        0,
+        TEXT("Memory budget of the hands components of a pawn in KB, pawns over it are warned about. 0 disables the check."),
+        ECVF_Default);
+
+    static TAutoConsoleVariable<int32> CVarGatherMemory(
+        TEXT("QuestHands.GatherMemory"),
+        1,
+        TEXT("Gather the memory stats of the hands components and check the pawn budget once a second. Not available in shipping builds."),
+        ECVF_Default);
+
+    // How often the footprint is gathered, walking every hands component isn't free
+    static constexpr float GatherInterval = 1.0f;
+
+    static FDelegateHandle TickerHandle;
+    static int32 PawnsOverBudget = 0;
+    static SIZE_T PeakTotal = 0;
+    static SIZE_T PeakLargestPawn = 0;
+
+    // The sum of the footprints the hands components reported, and the pool and subsystems at the last gather
+    static int64 LiveTotal = 0;
+    static SIZE_T LastSubsystemsSize = 0;
+
+    // Pawns already warned about, so a pawn staying over budget doesn't spam the log
+    static TSet<FObjectKey> WarnedPawns;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    SIZE_T GetObjectSize(const UObject* Object)
+    {
+        if(!Object)
+        {
+            return 0;
+        }
+
+        return Object->GetClass()->GetStructureSize() +
+               const_cast<UObject*>(Object)->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    int32 GetPawnsOverBudget()
+    {
+        return PawnsOverBudget;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void ReportFootprint(const UQuestHandsComponent* Component, int64 PreviousBytes, int64 Bytes)
+    {
+        LiveTotal += Bytes - PreviousBytes;
+        if(Bytes <= PreviousBytes)
+        {
+            return;
+        }
+
+        // Only growth can raise the peaks, they are checked right away rather than at the next gather
+        PeakTotal = FMath::Max(PeakTotal, (SIZE_T)FMath::Max<int64>(LiveTotal, 0) + LastSubsystemsSize);
+
+        const AActor* owner = Component ? Component->GetOwner() : nullptr;
+        if(owner)
+        {
+            int64 pawnBytes = 0;
+            for(const UActorComponent* ownerComponent : owner->GetComponents())
+            {
+                const UQuestHandsComponent* handsComponent = Cast<UQuestHandsComponent>(ownerComponent);
+                if(handsComponent)
+                {
+                    pawnBytes += handsComponent->GetReportedMemoryBytes();
+                }
+            }
+            PeakLargestPawn = FMath::Max(PeakLargestPawn, (SIZE_T)pawnBytes);
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    int64 GetLiveTotal()
+    {
+        return LiveTotal;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    SIZE_T GetPeakTotal()
+    {
+        return PeakTotal;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    SIZE_T GetPeakLargestPawn()
+    {
+        return PeakLargestPawn;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void ResetPeaks()
+    {
+        PeakTotal = (SIZE_T)FMath::Max<int64>(LiveTotal, 0) + LastSubsystemsSize;
+        PeakLargestPawn = 0;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool IsGatheredComponent(const UQuestHandsComponent* Component)
+    {
+        if(Component->IsPendingKill() || Component->IsTemplate())
+        {
+            return false;
+        }
+
+        const UWorld* world = Component->GetWorld();
+        return world && world->IsGameWorld();
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static SIZE_T GetSubsystemsSize(const UWorld* World, SIZE_T& PoolSizeOut)
+    {
+        PoolSizeOut = GetObjectSize(World->GetSubsystem<UQuestHandsPoolSubsystem>());
+        return GetObjectSize(World->GetSubsystem<UQuestHandsGrabSubsystem>()) +
+               GetObjectSize(World->GetSubsystem<UQuestHandsPokeSubsystem>()) +
+               GetObjectSize(World->GetSubsystem<UQuestHandsGovernorSubsystem>());
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void Gather()
+    {
+        FQHandMemoryFootprint sum;
+        TMap<const AActor*, SIZE_T> pawnSizes;
+        TSet<const UWorld*> worlds;
+        uint32 numComponents = 0;
+
+        for(TObjectIterator<UQuestHandsComponent> it; it; ++it)
+        {
+            UQuestHandsComponent* component = *it;
+            if(!IsGatheredComponent(component))
+            {
+                continue;
+            }
+
+            // Components in play report what changed since their last report, which catches growth they didn't report
+            FQHandMemoryFootprint footprint;
+            if(component->HasBegunPlay())
+            {
+                component->RefreshMemoryFootprint(&footprint);
+            }
+            else
+            {
+                component->GetMemoryFootprint(footprint);
+            }
+            sum.HandState += footprint.HandState;
+            sum.TrackingData += footprint.TrackingData;
+            sum.Poseables += footprint.Poseables;
+            sum.Capsules += footprint.Capsules;
+            sum.PhysicsHands += footprint.PhysicsHands;
+
+            pawnSizes.FindOrAdd(component->GetOwner()) += footprint.GetTotal();
+            worlds.Add(component->GetWorld());
+            ++numComponents;
+        }
+
+        SIZE_T poolSize = 0;
+        SIZE_T subsystemsSize = 0;
+        for(const UWorld* world : worlds)
+        {
+            SIZE_T worldPoolSize = 0;
+            subsystemsSize += GetSubsystemsSize(world, worldPoolSize);
+            poolSize += worldPoolSize;
+        }
+
+        const int64 budget = (int64)CVarMemoryBudgetPerPawnKB.GetValueOnGameThread() * 1024;
+        SIZE_T largestPawn = 0;
+        PawnsOverBudget = 0;
+        for(const TPair<const AActor*, SIZE_T>& pawnSize : pawnSizes)
+        {
+            largestPawn = FMath::Max(largestPawn, pawnSize.Value);
+            if(budget <= 0 || (int64)pawnSize.Value <= budget)
+            {
+                continue;
+            }
+
+            ++PawnsOverBudget;
+            bool alreadyWarned = false;
+            WarnedPawns.Add(FObjectKey(pawnSize.Key), &alreadyWarned);
+            if(!alreadyWarned)
+            {
+                UE_LOG(LogQuestHands, Warning, TEXT("QuestHands memory of %s is %.1f KB, over the budget of %d KB"),
+                       *GetNameSafe(pawnSize.Key), pawnSize.Value / 1024.0, CVarMemoryBudgetPerPawnKB.GetValueOnGameThread());
+            }
+        }
+
+        const SIZE_T total = sum.GetTotal() + poolSize + subsystemsSize;
+        LastSubsystemsSize = poolSize + subsystemsSize;
+        PeakTotal = FMath::Max(PeakTotal, total);
+        PeakLargestPawn = FMath::Max(PeakLargestPawn, largestPawn);
+
+        SET_MEMORY_STAT(STAT_QuestHands_MemHandState, sum.HandState);
+        SET_MEMORY_STAT(STAT_QuestHands_MemTrackingData, sum.TrackingData);
+        SET_MEMORY_STAT(STAT_QuestHands_MemPoseables, sum.Poseables);
+        SET_MEMORY_STAT(STAT_QuestHands_MemCapsules, sum.Capsules);
+        SET_MEMORY_STAT(STAT_QuestHands_MemPhysicsHands, sum.PhysicsHands);
+        SET_MEMORY_STAT(STAT_QuestHands_MemPool, poolSize);
+        SET_MEMORY_STAT(STAT_QuestHands_MemSubsystems, subsystemsSize);
+        SET_MEMORY_STAT(STAT_QuestHands_MemTotal, total);
+        SET_MEMORY_STAT(STAT_QuestHands_MemPeakTotal, PeakTotal);
+        SET_MEMORY_STAT(STAT_QuestHands_MemLargestPawn, largestPawn);
+        SET_MEMORY_STAT(STAT_QuestHands_MemPeakLargestPawn, PeakLargestPawn);
+        SET_DWORD_STAT(STAT_QuestHands_MemComponents, numComponents);
+        SET_DWORD_STAT(STAT_QuestHands_MemPawnsOverBudget, PawnsOverBudget);
+    }
+
+#if !UE_BUILD_SHIPPING
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static bool GatherFootprint(float DeltaTime)
+    {
+        if(CVarGatherMemory.GetValueOnGameThread() != 0)
+        {
+            Gather();
+        }
+        return true;
+    }
+#endif
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void DumpMemory()
+    {
+        const int32 budgetKB = CVarMemoryBudgetPerPawnKB.GetValueOnGameThread();
+        TMap<const AActor*, SIZE_T> pawnSizes;
+        TSet<const UWorld*> worlds;
+
+        UE_LOG(LogQuestHands, Log, TEXT("QuestHands memory per hands component (KB):"));
+        for(TObjectIterator<UQuestHandsComponent> it; it; ++it)
+        {
+            const UQuestHandsComponent* component = *it;
+            if(!IsGatheredComponent(component))
+            {
+                continue;
+            }
+
+            FQHandMemoryFootprint footprint;
+            component->GetMemoryFootprint(footprint);
+            UE_LOG(LogQuestHands, Log, TEXT("  %-32s state %7.1f  tracking %7.1f  poseables %7.1f  capsules %7.1f  physics %7.1f  total %7.1f"),
+                   *GetNameSafe(component->GetOwner()), footprint.HandState / 1024.0, footprint.TrackingData / 1024.0,
+                   footprint.Poseables / 1024.0, footprint.Capsules / 1024.0, footprint.PhysicsHands / 1024.0,
+                   footprint.GetTotal() / 1024.0);
+
+            pawnSizes.FindOrAdd(component->GetOwner()) += footprint.GetTotal();
+            worlds.Add(component->GetWorld());
+        }
+
+        UE_LOG(LogQuestHands, Log, TEXT("QuestHands memory per pawn (KB), budget %d KB:"), budgetKB);
+        for(const TPair<const AActor*, SIZE_T>& pawnSize : pawnSizes)
+        {
+            if(budgetKB > 0 && pawnSize.Value > (SIZE_T)budgetKB * 1024)
+            {
+                UE_LOG(LogQuestHands, Error, TEXT("  %-32s %7.1f  OVER BUDGET"), *GetNameSafe(pawnSize.Key), pawnSize.Value / 1024.0);
+            }
+            else
+            {
+                UE_LOG(LogQuestHands, Log, TEXT("  %-32s %7.1f"), *GetNameSafe(pawnSize.Key), pawnSize.Value / 1024.0);
+            }
+        }
+
+        UE_LOG(LogQuestHands, Log, TEXT("QuestHands memory per world subsystem (KB):"));
+        for(const UWorld* world : worlds)
+        {
+            UE_LOG(LogQuestHands, Log, TEXT("  %-32s grab %7.1f  poke %7.1f  pool %7.1f  governor %7.1f"), *GetNameSafe(world),
+                   GetObjectSize(world->GetSubsystem<UQuestHandsGrabSubsystem>()) / 1024.0,
+                   GetObjectSize(world->GetSubsystem<UQuestHandsPokeSubsystem>()) / 1024.0,
+                   GetObjectSize(world->GetSubsystem<UQuestHandsPoolSubsystem>()) / 1024.0,
+                   GetObjectSize(world->GetSubsystem<UQuestHandsGovernorSubsystem>()) / 1024.0);
+        }
+
+        UE_LOG(LogQuestHands, Log, TEXT("QuestHands memory peak total %.1f KB, peak largest pawn %.1f KB"),
+               PeakTotal / 1024.0, PeakLargestPawn / 1024.0);
+    }
+
+    static FAutoConsoleCommand DumpMemoryCommand(
+        TEXT("QuestHands.DumpMemory"),
+        TEXT("Log the memory footprint of every hands component, pawn and QuestHands world subsystem"),
+        FConsoleCommandDelegate::CreateStatic(&DumpMemory));
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void Startup()
+    {
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+        FLowLevelMemTracker& tracker = FLowLevelMemTracker::Get();
+        tracker.RegisterProjectTag(LLMTag_QuestHands, TEXT("QuestHands"),
+                                   QUESTHANDS_LLM_STATNAME(STAT_QuestHandsLLM), QUESTHANDS_LLM_STATNAME(STAT_QuestHandsSummaryLLM));
+        tracker.RegisterProjectTag(LLMTag_HandState, TEXT("QuestHands/HandState"),
+                                   QUESTHANDS_LLM_STATNAME(STAT_QuestHandsHandStateLLM), QUESTHANDS_LLM_STATNAME(STAT_QuestHandsSummaryLLM), LLMTag_QuestHands);
+        tracker.RegisterProjectTag(LLMTag_Components, TEXT("QuestHands/Components"),
+                                   QUESTHANDS_LLM_STATNAME(STAT_QuestHandsComponentsLLM), QUESTHANDS_LLM_STATNAME(STAT_QuestHandsSummaryLLM), LLMTag_QuestHands);
+        tracker.RegisterProjectTag(LLMTag_Physics, TEXT("QuestHands/Physics"),
+                                   QUESTHANDS_LLM_STATNAME(STAT_QuestHandsPhysicsLLM), QUESTHANDS_LLM_STATNAME(STAT_QuestHandsSummaryLLM), LLMTag_QuestHands);
+#endif
+
+#if !UE_BUILD_SHIPPING
+        if(!TickerHandle.IsValid())
+        {
+            TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&GatherFootprint), GatherInterval);
+        }
+#endif
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void Shutdown()
+    {
+        if(TickerHandle.IsValid())
+        {
+            FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+            TickerHandle.Reset();
+        }
+        WarnedPawns.Empty();
+    }
+}
+}
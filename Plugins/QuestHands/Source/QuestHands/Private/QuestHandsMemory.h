@@ -0,0 +1,73 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+/**
+  * The plugin reserves the four project LLM tags QUESTHANDS_LLM_TAG_BASE to QUESTHANDS_LLM_TAG_BASE + 3. By default they
+  * are the four below ProjectTagEnd to stay clear of the tags of the game, a game already using those moves them from its
+  * target, e.g. GlobalDefinitions.Add("QUESTHANDS_LLM_TAG_BASE=(int32)ELLMTag::ProjectTagStart + 32").
+*/
+#ifndef QUESTHANDS_LLM_TAG_BASE
+#define QUESTHANDS_LLM_TAG_BASE ((int32)ELLMTag::ProjectTagEnd - 4)
+#endif
+#endif
+
+/**
+  * Memory accounting of the plugin. Allocations are tagged for the low level memory tracker. The hands components report
+  * their footprint when they create or release what they own, which keeps the peaks true high-water marks, and outside of
+  * shipping builds the footprint of every hands component and subsystem is gathered once a second into the
+  * QuestHandsMemory stats group (QuestHands.GatherMemory). QuestHands.DumpMemory logs the footprint of every instance and
+  * checks each pawn against QuestHands.MemoryBudgetPerPawnKB.
+*/
+namespace QuestHands
+{
+namespace Memory
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+    enum ELLMTags : int32
+    {
+        LLMTag_QuestHands = QUESTHANDS_LLM_TAG_BASE,
+        LLMTag_HandState,
+        LLMTag_Components,
+        LLMTag_Physics,
+    };
+
+    static_assert(LLMTag_QuestHands >= (int32)ELLMTag::ProjectTagStart && LLMTag_Physics <= (int32)ELLMTag::ProjectTagEnd,
+                  "QUESTHANDS_LLM_TAG_BASE has to leave room for the four QuestHands tags in the project tag range");
+#endif
+
+    // Register the memory tags and start gathering the stats, called by the module
+    void Startup();
+    void Shutdown();
+
+    // The memory of an object and what it exclusively owns, in bytes
+    SIZE_T GetObjectSize(const UObject* Object);
+
+    // The number of pawns over the per pawn budget at the last check, 0 without a budget
+    int32 GetPawnsOverBudget();
+
+    // A hands component's footprint changed from PreviousBytes to Bytes, updates the live total and the peaks
+    void ReportFootprint(const class UQuestHandsComponent* Component, int64 PreviousBytes, int64 Bytes);
+
+    // Gather the footprint of every hands component and subsystem and check the pawns against the budget now
+    void Gather();
+
+    // The footprint last reported by all hands components, in bytes
+    int64 GetLiveTotal();
+
+    // The highest the total and the largest pawn have been since startup or the last reset, in bytes
+    SIZE_T GetPeakTotal();
+    SIZE_T GetPeakLargestPawn();
+    void ResetPeaks();
+}
+}
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+#define QUESTHANDS_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)QuestHands::Memory::Tag)
+#else
+#define QUESTHANDS_LLM_SCOPE(Tag)
+#endif
@@ -0,0 +1,299 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPhysicsHand.h"
+#include "QuestHandsStats.h"
+#include "QuestHandsTopology.h"
+#include "QuestHandsMemory.h"
+#include "Components/CapsuleComponent.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("PhysicsHandTargets"), STAT_QuestHands_PhysicsHandTargets, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("PhysicsHandSubstep"), STAT_QuestHands_PhysicsHandSubstep, STATGROUP_QuestHands);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Physics Hand Bodies"), STAT_QuestHands_PhysicsHandBodies, STATGROUP_QuestHands);
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FTransform UQuestHandsPhysicsHand::GetCapsuleTransform(const TArray<FTransform>& Bones, int32 BoneIndex, int32 ChildBoneIndex)
+{
+    return QuestHands::Topology::GetCapsuleTransform(Bones[BoneIndex], Bones[ChildBoneIndex]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsPhysicsHand::Build(USceneComponent* AttachParent, const FQHandSkeleton& Skeleton, const TArray<FTransform>& Bones, 
+                                   const FBodyInstance& BodyTemplate, const FQHandPhysicsHandSettings& InSettings)
+{
+    Destroy();
+
+    if(!AttachParent || !AttachParent->GetOwner() || Skeleton.Bones.Num() != QuestHands::Topology::NumBones || Bones.Num() != Skeleton.Bones.Num())
+    {
+        return false;
+    }
+
+    Settings = InSettings;
+    AActor* owner = AttachParent->GetOwner();
+
+    float worldToMeters = 100.0f;
+    AWorldSettings* worldSettings = AttachParent->GetWorld()->GetWorldSettings();
+    if(worldSettings)
+    {
+        worldToMeters = worldSettings->WorldToMeters;
+    }
+
+    // Each capsule runs from its bone to the first child of the bone
+    const int32 numBones = QuestHands::Topology::NumBones;
+    ParentBones = TArray<int32>(QuestHands::Topology::BoneParents, numBones);
+    ChildBones = TArray<int32>(QuestHands::Topology::CapsuleChildBones, numBones);
+
+    Bodies.Init(nullptr, numBones);
+    Joints.Init(nullptr, numBones);
+    RestBodyRotations.Init(FQuat::Identity, numBones);
+    BodyToBone.Init(FTransform::Identity, numBones);
+
+    for(int32 boneIndex = 0; boneIndex < Skeleton.BoneCapsules.Num() && boneIndex < numBones; ++boneIndex)
+    {
+        if(ChildBones[boneIndex] == INDEX_NONE)
+            continue;
+
+        const FQHandBoneCapsule& capsule = Skeleton.BoneCapsules[boneIndex];
+        const FTransform bodyTransform = GetCapsuleTransform(Bones, boneIndex, ChildBones[boneIndex]);
+
+        UCapsuleComponent* body = NewObject<UCapsuleComponent>(owner, UCapsuleComponent::StaticClass());
+        body->BodyInstance = BodyTemplate;
+        body->BodyInstance.bSimulatePhysics = true;
+        body->BodyInstance.bEnableGravity = false;
+        body->BodyInstance.PositionSolverIterationCount = (uint8)FMath::Clamp(Settings.PositionSolverIterations, 1, 255);
+        body->BodyInstance.VelocitySolverIterationCount = (uint8)FMath::Clamp(Settings.VelocitySolverIterations, 1, 255);
+        body->SetCapsuleSize(capsule.Radius * worldToMeters * 0.8f, ((capsule.PointB - capsule.PointA).Size() * worldToMeters) / 2.0f);
+        body->SetWorldTransform(bodyTransform);
+        body->ShapeColor = FColor::Green;
+        body->RegisterComponent();
+
+        Bodies[boneIndex] = body;
+        RestBodyRotations[boneIndex] = bodyTransform.GetRotation();
+        BodyToBone[boneIndex] = bodyTransform.GetRelativeTransform(Bones[boneIndex]);
+        INC_DWORD_STAT(STAT_QuestHands_PhysicsHandBodies);
+    }
+
+    if(!Bodies.IsValidIndex(0) || !Bodies[0])
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsPhysicsHand::Build - the skeleton has no wrist capsule to build from!"));
+        Destroy();
+        return false;
+    }
+
+    // Join every body to the closest ancestor which has a body
+    for(int32 boneIndex = 1; boneIndex < numBones; ++boneIndex)
+    {
+        if(!Bodies[boneIndex])
+            continue;
+
+        int32 parentBodyIndex = ParentBones[boneIndex];
+        while(parentBodyIndex != INDEX_NONE && !Bodies[parentBodyIndex])
+        {
+            parentBodyIndex = ParentBones[parentBodyIndex];
+        }
+        if(parentBodyIndex == INDEX_NONE)
+            continue;
+
+        UPhysicsConstraintComponent* joint = NewObject<UPhysicsConstraintComponent>(owner, UPhysicsConstraintComponent::StaticClass());
+        joint->SetWorldLocationAndRotation(Bones[boneIndex].GetLocation(), FQuat::Identity);
+        joint->SetDisableCollision(true);
+        joint->SetAngularSwing1Limit(EAngularConstraintMotion::ACM_Free, 0.0f);
+        joint->SetAngularSwing2Limit(EAngularConstraintMotion::ACM_Free, 0.0f);
+        joint->SetAngularTwistLimit(EAngularConstraintMotion::ACM_Free, 0.0f);
+        joint->SetAngularDriveMode(EAngularDriveMode::SLERP);
+        joint->SetOrientationDriveSLERP(true);
+        joint->SetAngularDriveParams(Settings.JointStiffness, Settings.JointDamping, Settings.JointMaxForce);
+        joint->RegisterComponent();
+        joint->SetConstrainedComponents(Bodies[parentBodyIndex], NAME_None, Bodies[boneIndex], NAME_None);
+
+        Joints[boneIndex] = joint;
+        ParentBones[boneIndex] = parentBodyIndex;
+    }
+
+    OnCalculateWristPhysics = FCalculateCustomPhysics::CreateUObject(this, &UQuestHandsPhysicsHand::SubstepWrist);
+    WristTarget = Bodies[0]->GetComponentTransform();
+    WasTracked = true;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPhysicsHand::Destroy()
+{
+    for(UPhysicsConstraintComponent* joint : Joints)
+    {
+        if(joint)
+        {
+            joint->DestroyComponent();
+        }
+    }
+    for(UCapsuleComponent* body : Bodies)
+    {
+        if(body)
+        {
+            body->DestroyComponent();
+            DEC_DWORD_STAT(STAT_QuestHands_PhysicsHandBodies);
+        }
+    }
+
+    Joints.Reset();
+    Bodies.Reset();
+    ParentBones.Reset();
+    ChildBones.Reset();
+    RestBodyRotations.Reset();
+    BodyToBone.Reset();
+    OnCalculateWristPhysics.Unbind();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPhysicsHand::SetTargets(const TArray<FTransform>& Bones, bool IsTracked)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PhysicsHandTargets);
+
+    if(!IsBuilt() || Bones.Num() != Bodies.Num())
+    {
+        return;
+    }
+
+    // Untracked hands sleep so they cost nothing in the solver
+    if(!IsTracked)
+    {
+        if(WasTracked && Settings.SleepWhenUntracked)
+        {
+            for(UCapsuleComponent* body : Bodies)
+            {
+                if(body)
+                {
+                    body->PutRigidBodyToSleep();
+                }
+            }
+        }
+        WasTracked = false;
+        return;
+    }
+
+    WristTarget = GetCapsuleTransform(Bones, 0, ChildBones[0]);
+
+    // Coming back into tracking or getting stuck too far away snaps the hand to the tracked pose
+    if(!WasTracked || FVector::DistSquared(Bodies[0]->GetComponentLocation(), WristTarget.GetLocation()) > FMath::Square(Settings.TeleportDistance))
+    {
+        Teleport(Bones);
+    }
+    WasTracked = true;
+
+    // Drive each joint to the relative rotation between the targets of the bodies it connects, relative to the rest pose
+    for(int32 boneIndex = 1; boneIndex < Bodies.Num(); ++boneIndex)
+    {
+        UPhysicsConstraintComponent* joint = Joints[boneIndex];
+        if(!joint)
+            continue;
+
+        const int32 parentBodyIndex = ParentBones[boneIndex];
+        const FQuat parentTarget = GetCapsuleTransform(Bones, parentBodyIndex, ChildBones[parentBodyIndex]).GetRotation();
+        const FQuat childTarget = GetCapsuleTransform(Bones, boneIndex, ChildBones[boneIndex]).GetRotation();
+        const FQuat jointTarget = RestBodyRotations[parentBodyIndex] * parentTarget.Inverse() * childTarget * RestBodyRotations[boneIndex].Inverse();
+        joint->SetAngularOrientationTarget(jointTarget.Rotator());
+    }
+
+    // Custom physics has to be requested again for every step
+    Bodies[0]->GetBodyInstance()->AddCustomPhysics(OnCalculateWristPhysics);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPhysicsHand::SubstepWrist(float DeltaTime, FBodyInstance* BodyInstance)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PhysicsHandSubstep);
+
+    const FTransform current = BodyInstance->GetUnrealWorldTransform_AssumesLocked();
+    const FVector linearVelocity = BodyInstance->GetUnrealWorldVelocity_AssumesLocked();
+    const FVector angularVelocity = BodyInstance->GetUnrealWorldAngularVelocityInRadians_AssumesLocked();
+
+    const FVector linearAccel = (WristTarget.GetLocation() - current.GetLocation()) * Settings.LinearStiffness - linearVelocity * Settings.LinearDamping;
+
+    FQuat rotationError = WristTarget.GetRotation() * current.GetRotation().Inverse();
+    rotationError.EnforceShortestArcWith(FQuat::Identity);
+    FVector errorAxis;
+    float errorAngle;
+    rotationError.ToAxisAndAngle(errorAxis, errorAngle);
+    const FVector angularAccel = errorAxis * errorAngle * Settings.AngularStiffness - angularVelocity * Settings.AngularDamping;
+
+    BodyInstance->AddForce(linearAccel, false, true);
+    BodyInstance->AddTorqueInRadians(angularAccel, false, true);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPhysicsHand::Teleport(const TArray<FTransform>& Bones)
+{
+    for(int32 boneIndex = 0; boneIndex < Bodies.Num(); ++boneIndex)
+    {
+        UCapsuleComponent* body = Bodies[boneIndex];
+        if(!body)
+            continue;
+
+        body->SetWorldTransform(GetCapsuleTransform(Bones, boneIndex, ChildBones[boneIndex]), false, nullptr, ETeleportType::ResetPhysics);
+        body->SetPhysicsLinearVelocity(FVector::ZeroVector);
+        body->SetPhysicsAngularVelocityInRadians(FVector::ZeroVector);
+        body->WakeRigidBody();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPhysicsHand::GetBoneTransforms(const TArray<FTransform>& TrackedBones, TArray<FTransform>& BonesOut) const
+{
+    BonesOut.SetNum(TrackedBones.Num());
+    for(int32 boneIndex = 0; boneIndex < TrackedBones.Num(); ++boneIndex)
+    {
+        const UCapsuleComponent* body = Bodies.IsValidIndex(boneIndex) ? Bodies[boneIndex] : nullptr;
+        if(body)
+        {
+            BonesOut[boneIndex] = BodyToBone[boneIndex].Inverse() * body->GetComponentTransform();
+            continue;
+        }
+
+        // Bones are ordered parents first so the parent is already resolved
+        const int32 parentBoneIndex = ParentBones.IsValidIndex(boneIndex) ? ParentBones[boneIndex] : INDEX_NONE;
+        if(parentBoneIndex != INDEX_NONE)
+        {
+            BonesOut[boneIndex] = TrackedBones[boneIndex].GetRelativeTransform(TrackedBones[parentBoneIndex]) * BonesOut[parentBoneIndex];
+        }
+        else
+        {
+            BonesOut[boneIndex] = TrackedBones[boneIndex];
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPhysicsHand::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T size = Bodies.GetAllocatedSize() + Joints.GetAllocatedSize() + ParentBones.GetAllocatedSize() + ChildBones.GetAllocatedSize() +
+                  RestBodyRotations.GetAllocatedSize() + BodyToBone.GetAllocatedSize();
+    for(const UCapsuleComponent* body : Bodies)
+    {
+        size += QuestHands::Memory::GetObjectSize(body);
+    }
+    for(const UPhysicsConstraintComponent* joint : Joints)
+    {
+        size += QuestHands::Memory::GetObjectSize(joint);
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(size);
+}
@@ -0,0 +1,382 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPokeSubsystem.h"
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("PokeHitTest"), STAT_QuestHands_PokeHitTest, STATGROUP_QuestHands);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Poke Panels"), STAT_QuestHands_PokePanels, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Poke Events"), STAT_QuestHands_PokeEvents, STATGROUP_QuestHands);
+
+namespace QuestHands
+{
+    template<typename LaneType>
+    void PadLane(LaneType& Lane, int32 Num, float PadValue)
+    {
+        const int32 paddedNum = Align(Num, 4);
+        Lane.SetNumUninitialized(paddedNum);
+        for(int32 index = Num; index < paddedNum; ++index)
+        {
+            Lane[index] = PadValue;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsPokeSubsystem::UQuestHandsPokeSubsystem()
+    : HoverDistance(3.0f)
+    , PressDepth(2.0f)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::Deinitialize()
+{
+    for(int32 panelIndex = 0; panelIndex < Panels.Num(); ++panelIndex)
+    {
+        if(USceneComponent* panel = Panels[panelIndex].Get())
+        {
+            panel->TransformUpdated.Remove(TransformUpdatedHandles[panelIndex]);
+        }
+    }
+    DEC_DWORD_STAT_BY(STAT_QuestHands_PokePanels, Panels.Num());
+
+    for(FPlaneLane* lane : { &NormalX, &NormalY, &NormalZ, &PlaneD, &OriginX, &OriginY, &OriginZ, &RightX, &RightY, &RightZ, &UpX, &UpY, &UpZ, &HalfWidth, &HalfHeight })
+    {
+        lane->Empty();
+    }
+    Panels.Empty();
+    PanelSizes.Empty();
+    TransformUpdatedHandles.Empty();
+    for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+    {
+        PanelStates[handIndex].Empty();
+        ActivePanels[handIndex].Empty();
+    }
+    PanelToIndex.Empty();
+
+    Super::Deinitialize();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::RegisterPokePanel(USceneComponent* Panel, FVector2D Size)
+{
+    if(!Panel)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsPokeSubsystem::RegisterPokePanel called with an invalid component!"));
+        return;
+    }
+
+    if(const int32* existingIndex = PanelToIndex.Find(Panel))
+    {
+        PanelSizes[*existingIndex] = Size;
+        UpdatePlane(*existingIndex);
+        return;
+    }
+
+    const int32 panelIndex = Panels.Add(Panel);
+    PanelSizes.Add(Size);
+    TransformUpdatedHandles.Add(Panel->TransformUpdated.AddUObject(this, &UQuestHandsPokeSubsystem::OnTransformUpdated));
+    PanelStates[0].Add(EPanelState::None);
+    PanelStates[1].Add(EPanelState::None);
+    PanelToIndex.Add(Panel, panelIndex);
+
+    // Padding panels have a negative extent so they can never be hit
+    for(FPlaneLane* lane : { &NormalX, &NormalY, &NormalZ, &PlaneD, &OriginX, &OriginY, &OriginZ, &RightX, &RightY, &RightZ, &UpX, &UpY, &UpZ })
+    {
+        QuestHands::PadLane(*lane, Panels.Num(), 0.0f);
+    }
+    QuestHands::PadLane(HalfWidth, Panels.Num(), -1.0f);
+    QuestHands::PadLane(HalfHeight, Panels.Num(), -1.0f);
+
+    UpdatePlane(panelIndex);
+
+    INC_DWORD_STAT(STAT_QuestHands_PokePanels);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::UnregisterPokePanel(USceneComponent* Panel)
+{
+    const int32* panelIndex = PanelToIndex.Find(Panel);
+    if(!panelIndex)
+    {
+        return;
+    }
+
+    const int32 removeIndex = *panelIndex;
+    if(Panel)
+    {
+        Panel->TransformUpdated.Remove(TransformUpdatedHandles[removeIndex]);
+    }
+    RemovePanelAt(removeIndex);
+
+    DEC_DWORD_STAT(STAT_QuestHands_PokePanels);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::RemovePanelAt(int32 PanelIndex)
+{
+    // Release anything still touching the panel
+    static const EControllerHand hands[2] = { EControllerHand::Left, EControllerHand::Right };
+    for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+    {
+        SetPanelState(PanelIndex, handIndex, hands[handIndex], EPanelState::None, FVector2D::ZeroVector);
+    }
+
+    PanelToIndex.Remove(Panels[PanelIndex]);
+
+    // Move the last panel into the removed slot
+    const int32 lastIndex = Panels.Num() - 1;
+    if(PanelIndex != lastIndex)
+    {
+        for(FPlaneLane* lane : { &NormalX, &NormalY, &NormalZ, &PlaneD, &OriginX, &OriginY, &OriginZ, &RightX, &RightY, &RightZ, &UpX, &UpY, &UpZ, &HalfWidth, &HalfHeight })
+        {
+            (*lane)[PanelIndex] = (*lane)[lastIndex];
+        }
+
+        PanelToIndex.Add(Panels[lastIndex], PanelIndex);
+        for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+        {
+            const int32 activeIndex = ActivePanels[handIndex].Find(lastIndex);
+            if(activeIndex != INDEX_NONE)
+            {
+                ActivePanels[handIndex][activeIndex] = PanelIndex;
+            }
+        }
+    }
+
+    Panels.RemoveAtSwap(PanelIndex, 1, false);
+    PanelSizes.RemoveAtSwap(PanelIndex, 1, false);
+    TransformUpdatedHandles.RemoveAtSwap(PanelIndex, 1, false);
+    PanelStates[0].RemoveAtSwap(PanelIndex, 1, false);
+    PanelStates[1].RemoveAtSwap(PanelIndex, 1, false);
+
+    for(FPlaneLane* lane : { &NormalX, &NormalY, &NormalZ, &PlaneD, &OriginX, &OriginY, &OriginZ, &RightX, &RightY, &RightZ, &UpX, &UpY, &UpZ })
+    {
+        QuestHands::PadLane(*lane, Panels.Num(), 0.0f);
+    }
+    QuestHands::PadLane(HalfWidth, Panels.Num(), -1.0f);
+    QuestHands::PadLane(HalfHeight, Panels.Num(), -1.0f);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::UpdatePlane(int32 PanelIndex)
+{
+    USceneComponent* panel = Panels[PanelIndex].Get();
+    if(!panel)
+    {
+        HalfWidth[PanelIndex] = -1.0f;
+        HalfHeight[PanelIndex] = -1.0f;
+        return;
+    }
+
+    const FTransform& panelTransform = panel->GetComponentTransform();
+    const FVector origin = panelTransform.GetLocation();
+    const FVector normal = panelTransform.GetUnitAxis(EAxis::X);
+    const FVector right = panelTransform.GetUnitAxis(EAxis::Y);
+    const FVector up = panelTransform.GetUnitAxis(EAxis::Z);
+    const FVector scale = panelTransform.GetScale3D().GetAbs();
+
+    NormalX[PanelIndex] = normal.X;
+    NormalY[PanelIndex] = normal.Y;
+    NormalZ[PanelIndex] = normal.Z;
+    PlaneD[PanelIndex] = FVector::DotProduct(normal, origin);
+    OriginX[PanelIndex] = origin.X;
+    OriginY[PanelIndex] = origin.Y;
+    OriginZ[PanelIndex] = origin.Z;
+    RightX[PanelIndex] = right.X;
+    RightY[PanelIndex] = right.Y;
+    RightZ[PanelIndex] = right.Z;
+    UpX[PanelIndex] = up.X;
+    UpY[PanelIndex] = up.Y;
+    UpZ[PanelIndex] = up.Z;
+    HalfWidth[PanelIndex] = PanelSizes[PanelIndex].X * 0.5f * scale.Y;
+    HalfHeight[PanelIndex] = PanelSizes[PanelIndex].Y * 0.5f * scale.Z;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::ProcessFingertip(EControllerHand Hand, const FVector& TipLocation, const FVector& TipVelocity)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PokeHitTest);
+
+    const int32 handIndex = Hand == EControllerHand::Left ? 0 : 1;
+
+    const VectorRegister tipX = VectorSetFloat1(TipLocation.X);
+    const VectorRegister tipY = VectorSetFloat1(TipLocation.Y);
+    const VectorRegister tipZ = VectorSetFloat1(TipLocation.Z);
+    const VectorRegister hoverDistance = VectorSetFloat1(HoverDistance);
+    const VectorRegister pressDepth = VectorSetFloat1(-PressDepth);
+
+    // Find every panel the tip is within the touch volume of, four panels at a time
+    TArray<int32, TInlineAllocator<8>> hitPanels;
+    const int32 paddedNum = NormalX.Num();
+    for(int32 laneIndex = 0; laneIndex < paddedNum; laneIndex += 4)
+    {
+        // Signed distance to the plane
+        VectorRegister distance = VectorMultiply(VectorLoadAligned(&NormalX[laneIndex]), tipX);
+        distance = VectorMultiplyAdd(VectorLoadAligned(&NormalY[laneIndex]), tipY, distance);
+        distance = VectorMultiplyAdd(VectorLoadAligned(&NormalZ[laneIndex]), tipZ, distance);
+        distance = VectorSubtract(distance, VectorLoadAligned(&PlaneD[laneIndex]));
+
+        // Position in the plane
+        const VectorRegister deltaX = VectorSubtract(tipX, VectorLoadAligned(&OriginX[laneIndex]));
+        const VectorRegister deltaY = VectorSubtract(tipY, VectorLoadAligned(&OriginY[laneIndex]));
+        const VectorRegister deltaZ = VectorSubtract(tipZ, VectorLoadAligned(&OriginZ[laneIndex]));
+
+        VectorRegister planeX = VectorMultiply(VectorLoadAligned(&RightX[laneIndex]), deltaX);
+        planeX = VectorMultiplyAdd(VectorLoadAligned(&RightY[laneIndex]), deltaY, planeX);
+        planeX = VectorMultiplyAdd(VectorLoadAligned(&RightZ[laneIndex]), deltaZ, planeX);
+
+        VectorRegister planeY = VectorMultiply(VectorLoadAligned(&UpX[laneIndex]), deltaX);
+        planeY = VectorMultiplyAdd(VectorLoadAligned(&UpY[laneIndex]), deltaY, planeY);
+        planeY = VectorMultiplyAdd(VectorLoadAligned(&UpZ[laneIndex]), deltaZ, planeY);
+
+        VectorRegister inside = VectorCompareGE(hoverDistance, distance);
+        inside = VectorBitwiseAnd(inside, VectorCompareGE(distance, pressDepth));
+        inside = VectorBitwiseAnd(inside, VectorCompareGE(VectorLoadAligned(&HalfWidth[laneIndex]), VectorAbs(planeX)));
+        inside = VectorBitwiseAnd(inside, VectorCompareGE(VectorLoadAligned(&HalfHeight[laneIndex]), VectorAbs(planeY)));
+
+        uint32 insideMask = (uint32)VectorMaskBits(inside);
+        while(insideMask)
+        {
+            const int32 lane = FMath::CountTrailingZeros(insideMask);
+            insideMask &= insideMask - 1;
+            hitPanels.Add(laneIndex + lane);
+        }
+    }
+
+    // Leave the panels which are no longer touched
+    for(int32 activeIndex = ActivePanels[handIndex].Num() - 1; activeIndex >= 0; --activeIndex)
+    {
+        const int32 panelIndex = ActivePanels[handIndex][activeIndex];
+        if(!hitPanels.Contains(panelIndex))
+        {
+            SetPanelState(panelIndex, handIndex, Hand, EPanelState::None, FVector2D::ZeroVector);
+        }
+    }
+
+    // Resolve the touched panels
+    for(int32 panelIndex : hitPanels)
+    {
+        const FVector normal(NormalX[panelIndex], NormalY[panelIndex], NormalZ[panelIndex]);
+        const FVector delta = TipLocation - FVector(OriginX[panelIndex], OriginY[panelIndex], OriginZ[panelIndex]);
+        const FVector2D localPosition(FVector::DotProduct(delta, FVector(RightX[panelIndex], RightY[panelIndex], RightZ[panelIndex])),
+                                      FVector::DotProduct(delta, FVector(UpX[panelIndex], UpY[panelIndex], UpZ[panelIndex])));
+        const float distance = FVector::DotProduct(normal, TipLocation) - PlaneD[panelIndex];
+
+        const EPanelState currentState = PanelStates[handIndex][panelIndex];
+        EPanelState newState = EPanelState::Hover;
+        if(distance <= 0.0f)
+        {
+            // Only presses coming from the front count, a finger entering from behind or the side doesn't press
+            const bool pushingIn = FVector::DotProduct(TipVelocity, normal) < 0.0f;
+            if(currentState == EPanelState::Pressed || (currentState == EPanelState::Hover && pushingIn))
+            {
+                newState = EPanelState::Pressed;
+            }
+            else if(currentState == EPanelState::None)
+            {
+                continue;
+            }
+        }
+
+        SetPanelState(panelIndex, handIndex, Hand, newState, localPosition);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::SetPanelState(int32 PanelIndex, int32 HandIndex, EControllerHand Hand, EPanelState NewState, const FVector2D& LocalPosition)
+{
+    const EPanelState currentState = PanelStates[HandIndex][PanelIndex];
+    if(currentState == NewState)
+    {
+        return;
+    }
+    PanelStates[HandIndex][PanelIndex] = NewState;
+
+    if(NewState == EPanelState::None)
+    {
+        ActivePanels[HandIndex].RemoveSingleSwap(PanelIndex, false);
+    }
+    else if(currentState == EPanelState::None)
+    {
+        ActivePanels[HandIndex].Add(PanelIndex);
+    }
+
+    USceneComponent* panel = Panels[PanelIndex].Get();
+    auto broadcast = [this, panel, Hand, &LocalPosition](EQHandPokeEvent pokeEvent)
+    {
+        INC_DWORD_STAT(STAT_QuestHands_PokeEvents);
+        if(OnPoke.IsBound())
+        {
+            OnPoke.Broadcast(panel, Hand, pokeEvent, LocalPosition);
+        }
+    };
+
+    if(currentState == EPanelState::Pressed)
+    {
+        broadcast(EQHandPokeEvent::PokeEvent_Release);
+    }
+    if(currentState == EPanelState::None)
+    {
+        broadcast(EQHandPokeEvent::PokeEvent_HoverBegin);
+    }
+    if(NewState == EPanelState::Pressed)
+    {
+        broadcast(EQHandPokeEvent::PokeEvent_Press);
+    }
+    if(NewState == EPanelState::None)
+    {
+        broadcast(EQHandPokeEvent::PokeEvent_HoverEnd);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+    if(const int32* panelIndex = PanelToIndex.Find(Component))
+    {
+        UpdatePlane(*panelIndex);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPokeSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    const FPlaneLane* lanes[] = { &NormalX, &NormalY, &NormalZ, &PlaneD, &OriginX, &OriginY, &OriginZ, 
+                                  &RightX, &RightY, &RightZ, &UpX, &UpY, &UpZ, &HalfWidth, &HalfHeight };
+    SIZE_T size = 0;
+    for(const FPlaneLane* lane : lanes)
+    {
+        size += lane->GetAllocatedSize();
+    }
+    size += Panels.GetAllocatedSize() + PanelSizes.GetAllocatedSize() + TransformUpdatedHandles.GetAllocatedSize() + PanelToIndex.GetAllocatedSize();
+    for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+    {
+        size += PanelStates[handIndex].GetAllocatedSize() + ActivePanels[handIndex].GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(size);
+}
@@ -0,0 +1,407 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPoolSubsystem.h"
+#include "QuestHands.h"
+#include "QuestHandsStats.h"
+#include "QuestHandsMemory.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("PoolAcquire"), STAT_QuestHands_PoolAcquire, STATGROUP_QuestHands);
+DECLARE_CYCLE_STAT(TEXT("PoolPrewarm"), STAT_QuestHands_PoolPrewarm, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Components Reused"), STAT_QuestHands_PoolHits, STATGROUP_QuestHands);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Components Created"), STAT_QuestHands_PoolMisses, STATGROUP_QuestHands);
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsPoolSubsystem::UQuestHandsPoolSubsystem()
+    : MaxCreatesPerFrame(4)
+    , MaxPooledPoseables(8)
+    , MaxPooledCapsules(8 * 19)
+    , PoolActor(nullptr)
+    , PrewarmPoseables(0)
+    , PrewarmCapsules(0)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::Deinitialize()
+{
+    // The pooled components go with the pool actor when the world is torn down
+    Poseables.Empty();
+    Capsules.Empty();
+    PoolActor = nullptr;
+    PrewarmPoseables = PrewarmCapsules = 0;
+    Super::Deinitialize();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsPoolSubsystem::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !IsTemplate() && world && world->IsGameWorld() &&
+           (Poseables.Num() < PrewarmPoseables || Capsules.Num() < PrewarmCapsules);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+TStatId UQuestHandsPoolSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UQuestHandsPoolSubsystem, STATGROUP_Tickables);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PoolPrewarm);
+    QUESTHANDS_LLM_SCOPE(LLMTag_Components);
+
+    int32 budget = FMath::Max(MaxCreatesPerFrame, 1);
+    for(; budget > 0 && Poseables.Num() < PrewarmPoseables; --budget)
+    {
+        UPoseableMeshComponent* poseable = CreatePoseable();
+        if(!poseable)
+        {
+            PrewarmPoseables = Poseables.Num();
+            break;
+        }
+        Poseables.Add(poseable);
+    }
+
+    for(; budget > 0 && Capsules.Num() < PrewarmCapsules; --budget)
+    {
+        UCapsuleComponent* capsule = CreateCapsule();
+        if(!capsule)
+        {
+            PrewarmCapsules = Capsules.Num();
+            break;
+        }
+        Capsules.Add(capsule);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::Prewarm(int32 NumPoseables, int32 NumCapsules)
+{
+    PrewarmPoseables = FMath::Clamp(NumPoseables, 0, MaxPooledPoseables);
+    PrewarmCapsules = FMath::Clamp(NumCapsules, 0, MaxPooledCapsules);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+AActor* UQuestHandsPoolSubsystem::GetPoolActor()
+{
+    if(PoolActor && !PoolActor->IsPendingKill())
+    {
+        return PoolActor;
+    }
+
+    UWorld* world = GetWorld();
+    if(!world)
+    {
+        return nullptr;
+    }
+
+    FActorSpawnParameters spawnParams;
+    spawnParams.ObjectFlags |= RF_Transient;
+    spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    PoolActor = world->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, spawnParams);
+    if(!PoolActor)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsPoolSubsystem unable to spawn the pool actor!"));
+        return nullptr;
+    }
+
+#if WITH_EDITOR
+    PoolActor->SetActorLabel(TEXT("QuestHandsPool"));
+#endif
+
+    USceneComponent* root = NewObject<USceneComponent>(PoolActor, TEXT("PoolRoot"));
+    PoolActor->SetRootComponent(root);
+    root->RegisterComponent();
+    return PoolActor;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UPoseableMeshComponent* UQuestHandsPoolSubsystem::CreatePoseable()
+{
+    AActor* poolActor = GetPoolActor();
+    if(!poolActor)
+    {
+        return nullptr;
+    }
+
+    UPoseableMeshComponent* poseable = NewObject<UPoseableMeshComponent>(poolActor, UPoseableMeshComponent::StaticClass());
+    if(!poseable)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsPoolSubsystem unable to create PoseableMeshComponent!"));
+        return nullptr;
+    }
+
+    poseable->SetVisibility(false);
+    poseable->SetComponentTickEnabled(false);
+    poseable->AttachToComponent(poolActor->GetRootComponent(), FAttachmentTransformRules::SnapToTargetIncludingScale);
+    poseable->RegisterComponent();
+    INC_DWORD_STAT(STAT_QuestHands_PoolMisses);
+    return poseable;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UCapsuleComponent* UQuestHandsPoolSubsystem::CreateCapsule()
+{
+    AActor* poolActor = GetPoolActor();
+    if(!poolActor)
+    {
+        return nullptr;
+    }
+
+    UCapsuleComponent* capsule = NewObject<UCapsuleComponent>(poolActor, UCapsuleComponent::StaticClass());
+    if(!capsule)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsPoolSubsystem unable to create UCapsuleComponent!"));
+        return nullptr;
+    }
+
+    capsule->BodyInstance.SetCollisionEnabled(ECollisionEnabled::NoCollision, false);
+    capsule->BodyInstance.bSimulatePhysics = false;
+    capsule->SetGenerateOverlapEvents(false);
+    capsule->ShapeColor = FColor::Blue;
+    capsule->AttachToComponent(poolActor->GetRootComponent(), FAttachmentTransformRules::SnapToTargetIncludingScale);
+    capsule->RegisterComponent();
+    INC_DWORD_STAT(STAT_QuestHands_PoolMisses);
+    return capsule;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::MoveToOwner(UActorComponent* Component, AActor* NewOwner)
+{
+    // Renaming into the new actor moves the component between the owned components of the actors while it stays registered
+    if(NewOwner && Component->GetOuter() != NewOwner)
+    {
+        Component->Rename(nullptr, NewOwner, REN_DontCreateRedirectors | REN_ForceNoResetLoaders | REN_NonTransactional);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UPoseableMeshComponent* UQuestHandsPoolSubsystem::AcquirePoseable(USceneComponent* Parent, USkeletalMesh* Mesh)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PoolAcquire);
+    QUESTHANDS_LLM_SCOPE(LLMTag_Components);
+
+    if(!Parent || !Parent->GetOwner())
+    {
+        return nullptr;
+    }
+
+    // Prefer a poseable already showing the mesh, it doesn't need its mesh objects reinitialized
+    UPoseableMeshComponent* poseable = nullptr;
+    for(int32 poseableIndex = Poseables.Num() - 1; poseableIndex >= 0; --poseableIndex)
+    {
+        if(Poseables[poseableIndex] && !Poseables[poseableIndex]->IsPendingKill() && Poseables[poseableIndex]->SkeletalMesh == Mesh)
+        {
+            poseable = Poseables[poseableIndex];
+            Poseables.RemoveAtSwap(poseableIndex);
+            break;
+        }
+    }
+    while(!poseable && Poseables.Num() != 0)
+    {
+        poseable = Poseables.Pop(false);
+        if(poseable && poseable->IsPendingKill())
+        {
+            poseable = nullptr;
+        }
+    }
+
+    if(!poseable)
+    {
+        poseable = NewObject<UPoseableMeshComponent>(Parent->GetOwner(), UPoseableMeshComponent::StaticClass());
+        if(!poseable)
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent unable to create PoseableMeshComponent!"));
+            return nullptr;
+        }
+        poseable->AttachToComponent(Parent, FAttachmentTransformRules::SnapToTargetIncludingScale);
+        poseable->SetSkeletalMesh(Mesh);
+        poseable->RegisterComponent();
+        INC_DWORD_STAT(STAT_QuestHands_PoolMisses);
+        return poseable;
+    }
+
+    MoveToOwner(poseable, Parent->GetOwner());
+    poseable->AttachToComponent(Parent, FAttachmentTransformRules::SnapToTargetIncludingScale);
+    if(poseable->SkeletalMesh != Mesh)
+    {
+        poseable->SetSkeletalMesh(Mesh);
+    }
+    poseable->SetComponentTickEnabled(true);
+    poseable->SetVisibility(true);
+    INC_DWORD_STAT(STAT_QuestHands_PoolHits);
+    return poseable;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UCapsuleComponent* UQuestHandsPoolSubsystem::AcquireCapsule(USceneComponent* Parent, const FBodyInstance& BodyData, bool GenerateOverlapEvents, bool CreateIfEmpty)
+{
+    SCOPE_CYCLE_COUNTER(STAT_QuestHands_PoolAcquire);
+    QUESTHANDS_LLM_SCOPE(LLMTag_Components);
+
+    if(!Parent || !Parent->GetOwner())
+    {
+        return nullptr;
+    }
+
+    UCapsuleComponent* capsule = nullptr;
+    while(!capsule && Capsules.Num() != 0)
+    {
+        capsule = Capsules.Pop(false);
+        if(capsule && capsule->IsPendingKill())
+        {
+            capsule = nullptr;
+        }
+    }
+
+    if(!capsule)
+    {
+        if(!CreateIfEmpty)
+        {
+            return nullptr;
+        }
+
+        capsule = NewObject<UCapsuleComponent>(Parent->GetOwner(), UCapsuleComponent::StaticClass());
+        if(!capsule)
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsComponent unable to create UCapsuleComponent!"));
+            return nullptr;
+        }
+        capsule->AttachToComponent(Parent, FAttachmentTransformRules::SnapToTargetIncludingScale);
+        capsule->BodyInstance = BodyData;
+        // Kinematic whatever the body data says, the hands component moves the capsules with kinematic targets
+        capsule->BodyInstance.bSimulatePhysics = false;
+        capsule->SetGenerateOverlapEvents(GenerateOverlapEvents);
+        capsule->ShapeColor = FColor::Blue;
+        capsule->RegisterComponent();
+        INC_DWORD_STAT(STAT_QuestHands_PoolMisses);
+        return capsule;
+    }
+
+    MoveToOwner(capsule, Parent->GetOwner());
+    capsule->AttachToComponent(Parent, FAttachmentTransformRules::SnapToTargetIncludingScale);
+
+    // The body has to be recreated for the collision settings of the new owner
+    capsule->DestroyPhysicsState();
+    capsule->BodyInstance = BodyData;
+    capsule->BodyInstance.bSimulatePhysics = false;
+    capsule->SetGenerateOverlapEvents(GenerateOverlapEvents);
+    capsule->CreatePhysicsState();
+    INC_DWORD_STAT(STAT_QuestHands_PoolHits);
+    return capsule;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::ReleasePoseable(UPoseableMeshComponent* Poseable)
+{
+    if(!Poseable || Poseable->IsPendingKill())
+    {
+        return;
+    }
+
+    AActor* poolActor = Poseables.Num() < MaxPooledPoseables ? GetPoolActor() : nullptr;
+    if(!poolActor)
+    {
+        Poseable->DestroyComponent();
+        return;
+    }
+
+    Poseable->SetVisibility(false);
+    Poseable->SetComponentTickEnabled(false);
+    Poseable->AttachToComponent(poolActor->GetRootComponent(), FAttachmentTransformRules::SnapToTargetIncludingScale);
+    MoveToOwner(Poseable, poolActor);
+    Poseables.Add(Poseable);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::ReleaseCapsule(UCapsuleComponent* Capsule)
+{
+    if(!Capsule || Capsule->IsPendingKill())
+    {
+        return;
+    }
+
+    AActor* poolActor = Capsules.Num() < MaxPooledCapsules ? GetPoolActor() : nullptr;
+    if(!poolActor)
+    {
+        Capsule->DestroyComponent();
+        return;
+    }
+
+    // End the overlaps while they are still reported to the previous owner, gameplay bindings belong to it
+    Capsule->ClearComponentOverlaps(true, false);
+    Capsule->OnComponentBeginOverlap.Clear();
+    Capsule->OnComponentEndOverlap.Clear();
+    Capsule->OnComponentHit.Clear();
+    Capsule->SetGenerateOverlapEvents(false);
+    Capsule->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    Capsule->AttachToComponent(poolActor->GetRootComponent(), FAttachmentTransformRules::SnapToTargetIncludingScale);
+    MoveToOwner(Capsule, poolActor);
+    Capsules.Add(Capsule);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::RequestMeshLoad(const TSoftObjectPtr<USkeletalMesh>& Mesh, FStreamableDelegate Callback)
+{
+    if(Mesh.IsNull() || Mesh.IsValid())
+    {
+        Callback.ExecuteIfBound();
+        return;
+    }
+
+    Streamable.RequestAsyncLoad(Mesh.ToSoftObjectPath(), Callback);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoolSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T size = Poseables.GetAllocatedSize() + Capsules.GetAllocatedSize();
+    for(const UPoseableMeshComponent* poseable : Poseables)
+    {
+        size += QuestHands::Memory::GetObjectSize(poseable);
+    }
+    for(const UCapsuleComponent* capsule : Capsules)
+    {
+        size += QuestHands::Memory::GetObjectSize(capsule);
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(size);
+}
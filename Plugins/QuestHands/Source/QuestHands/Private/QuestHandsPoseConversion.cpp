@@ -0,0 +1,249 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPoseConversion.h"
+#include "QuestHandsTopology.h"
+#include "QuestHands.h"
+#include "HAL/IConsoleManager.h"
+
+static_assert(QuestHands::Topology::NumBones <= QuestHands::RawMaxBones, "The raw hand state needs a rotation for every bone of the topology");
+
+namespace QuestHands
+{
+namespace PoseConversion
+{
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static FRawPose MakeRandomPose(FRandomStream& Random)
+    {
+        // Raw runtime orientations aren't always quite unit length
+        const FQuat orientation = FQuat(FRotator(Random.FRandRange(-180.0f, 180.0f), Random.FRandRange(-180.0f, 180.0f), Random.FRandRange(-180.0f, 180.0f))) *
+                                  Random.FRandRange(0.98f, 1.02f);
+
+        FRawPose pose;
+        pose.Orientation = { orientation.X, orientation.Y, orientation.Z, orientation.W };
+        pose.Position = { Random.FRandRange(-2.0f, 2.0f), Random.FRandRange(-2.0f, 2.0f), Random.FRandRange(-2.0f, 2.0f) };
+        return pose;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Converts random raw hands with random base orientations and offsets through the batches and one pose at a time,
+      * reporting the largest difference and the time of each. Doesn't need a device.
+      * QuestHands.VerifyPoseConversion [Iterations]
+    */
+    static void Verify(const TArray<FString>& Args)
+    {
+        const int32 iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+
+        // The root, pointer and bone poses of a hand
+        static constexpr int32 NumPoses = 26;
+
+        FRandomStream random(0);
+        FRawPose poses[NumPoses];
+        FQuat batchOrientations[NumPoses];
+        FVector batchPositions[NumPoses];
+        FQuat referenceOrientation;
+        FVector referencePosition;
+        float maxOrientationError = 0.0f;
+        float maxPositionError = 0.0f;
+        double batchSeconds = 0.0;
+        double referenceSeconds = 0.0;
+
+        for(int32 iteration = 0; iteration < iterations; ++iteration)
+        {
+            const FQuat baseOrientation = iteration == 0 ? FQuat::Identity : FQuat(FRotator(0.0f, random.FRandRange(-180.0f, 180.0f), 0.0f));
+            const FVector baseOffset = iteration == 0 ? FVector::ZeroVector : FVector(random.FRandRange(-1.0f, 1.0f), random.FRandRange(-1.0f, 1.0f), random.FRandRange(-1.0f, 1.0f));
+            const float worldToMeters = random.FRandRange(50.0f, 200.0f);
+            for(FRawPose& pose : poses)
+            {
+                pose = MakeRandomPose(random);
+            }
+
+            double startTime = FPlatformTime::Seconds();
+            const FPoseConversion conversion(baseOrientation, baseOffset, worldToMeters);
+            conversion.ConvertPoses(poses, NumPoses, batchOrientations, batchPositions);
+            batchSeconds += FPlatformTime::Seconds() - startTime;
+
+            for(int32 poseIndex = 0; poseIndex < NumPoses; ++poseIndex)
+            {
+                startTime = FPlatformTime::Seconds();
+                FPoseConversion::ConvertPoseReference(poses[poseIndex], baseOrientation, baseOffset, worldToMeters, referenceOrientation, referencePosition);
+                referenceSeconds += FPlatformTime::Seconds() - startTime;
+
+                maxOrientationError = FMath::Max(maxOrientationError, FMath::Abs(1.0f - FMath::Abs(batchOrientations[poseIndex] | referenceOrientation)));
+                maxPositionError = FMath::Max(maxPositionError, FVector::Dist(batchPositions[poseIndex], referencePosition));
+            }
+        }
+
+        const bool passed = maxOrientationError < KINDA_SMALL_NUMBER && maxPositionError < 0.01f;
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHands.VerifyPoseConversion %s over %d hands: largest orientation error %g, largest position error %g, ")
+                                       TEXT("batched %.3f us per hand, one pose at a time %.3f us per hand"),
+               passed ? TEXT("passed") : TEXT("FAILED"), iterations, maxOrientationError, maxPositionError,
+               batchSeconds * 1000000.0 / iterations, referenceSeconds * 1000000.0 / iterations);
+    }
+
+    static FAutoConsoleCommand VerifyCommand(
+        TEXT("QuestHands.VerifyPoseConversion"),
+        TEXT("Check the batched OVR to Unreal pose conversion against converting one pose at a time and time both. Optional iteration count."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&Verify));
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+QuestHands::FPoseConversion::FPoseConversion(const FQuat& BaseOrientation, const FVector& BaseOffset, float WorldToMeters)
+{
+    // Orientation: Inverse(BaseOrientation) * (-Z, X, Y, -W) as the columns of the quaternion product with a fixed left side
+    const FQuat base = BaseOrientation.Inverse();
+    OrientationAxes[0] = MakeVectorRegister(-base.Z,  base.W,  base.X, -base.Y);
+    OrientationAxes[1] = MakeVectorRegister( base.Y, -base.X,  base.W, -base.Z);
+    OrientationAxes[2] = MakeVectorRegister(-base.W, -base.Z,  base.Y,  base.X);
+    OrientationAxes[3] = MakeVectorRegister(-base.X, -base.Y, -base.Z, -base.W);
+
+    // Position: Inverse(BaseOrientation) rotating (-Z, X, Y) * WorldToMeters - BaseOffset * WorldToMeters
+    const FVector axisX = base.RotateVector(FVector(0.0f, 1.0f, 0.0f)) * WorldToMeters;
+    const FVector axisY = base.RotateVector(FVector(0.0f, 0.0f, 1.0f)) * WorldToMeters;
+    const FVector axisZ = base.RotateVector(FVector(-1.0f, 0.0f, 0.0f)) * WorldToMeters;
+    const FVector offset = base.RotateVector(BaseOffset) * -WorldToMeters;
+    PositionAxes[0] = MakeVectorRegister(axisX.X, axisX.Y, axisX.Z, 0.0f);
+    PositionAxes[1] = MakeVectorRegister(axisY.X, axisY.Y, axisY.Z, 0.0f);
+    PositionAxes[2] = MakeVectorRegister(axisZ.X, axisZ.Y, axisZ.Z, 0.0f);
+    PositionOffset = MakeVectorRegister(offset.X, offset.Y, offset.Z, 0.0f);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void QuestHands::FPoseConversion::ConvertPoses(const FRawPose* Poses, int32 Num, FQuat* OrientationsOut, FVector* PositionsOut) const
+{
+    const VectorRegister identity = MakeVectorRegister(0.0f, 0.0f, 0.0f, 1.0f);
+    const VectorRegister smallNumber = VectorSetFloat1(SMALL_NUMBER);
+
+    for(int32 poseIndex = 0; poseIndex < Num; ++poseIndex)
+    {
+        const FRawPose& pose = Poses[poseIndex];
+
+        const VectorRegister rawOrientation = VectorLoad(&pose.Orientation.X);
+        VectorRegister orientation = VectorMultiply(VectorReplicate(rawOrientation, 0), OrientationAxes[0]);
+        orientation = VectorMultiplyAdd(VectorReplicate(rawOrientation, 1), OrientationAxes[1], orientation);
+        orientation = VectorMultiplyAdd(VectorReplicate(rawOrientation, 2), OrientationAxes[2], orientation);
+        orientation = VectorMultiplyAdd(VectorReplicate(rawOrientation, 3), OrientationAxes[3], orientation);
+
+        // Normalized like FQuat::Normalize, degenerate orientations become the identity
+        const VectorRegister squareSum = VectorDot4(orientation, orientation);
+        const VectorRegister normalized = VectorMultiply(orientation, VectorReciprocalSqrtAccurate(squareSum));
+        VectorStore(VectorSelect(VectorCompareGE(squareSum, smallNumber), normalized, identity), &OrientationsOut[poseIndex].X);
+
+        VectorRegister position = VectorMultiplyAdd(VectorLoadFloat1(&pose.Position.X), PositionAxes[0], PositionOffset);
+        position = VectorMultiplyAdd(VectorLoadFloat1(&pose.Position.Y), PositionAxes[1], position);
+        position = VectorMultiplyAdd(VectorLoadFloat1(&pose.Position.Z), PositionAxes[2], position);
+        VectorStoreFloat3(position, &PositionsOut[poseIndex].X);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void QuestHands::FPoseConversion::ConvertRotations(const FRawQuat* Rotations, int32 Num, FQuat* RotationsOut)
+{
+    const VectorRegister signs = MakeVectorRegister(-1.0f, 1.0f, 1.0f, -1.0f);
+    for(int32 rotationIndex = 0; rotationIndex < Num; ++rotationIndex)
+    {
+        const VectorRegister rotation = VectorLoad(&Rotations[rotationIndex].X);
+        VectorStore(VectorMultiply(VectorSwizzle(rotation, 2, 0, 1, 3), signs), &RotationsOut[rotationIndex].X);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void QuestHands::FPoseConversion::ConvertHandState(const FRawHandState& State, FQHandTrackingState& StateOut) const
+{
+    // Status Out
+    StateOut.IsTracked = (State.Status & RawHandStatus_HandTracked) != 0;
+    StateOut.InputValid = (State.Status & RawHandStatus_InputValid) != 0;
+    StateOut.SystemGestureInProgress = (State.Status & RawHandStatus_SystemGestureInProgress) != 0;
+
+    // Root and Pointer Poses, converted together
+    const FRawPose rawPoses[2] = { State.RootPose, State.PointerPose };
+    FQuat orientations[2];
+    FVector positions[2];
+    ConvertPoses(rawPoses, 2, orientations, positions);
+    StateOut.RootPose.Orientation = orientations[0];
+    StateOut.RootPose.Position = positions[0];
+    StateOut.PointerPose.Orientation = orientations[1];
+    StateOut.PointerPose.Position = positions[1];
+
+    // Bone Rotations
+    StateOut.BoneRotations.SetNum(Topology::NumBones);
+    ConvertRotations(State.BoneRotations, Topology::NumBones, StateOut.BoneRotations.GetData());
+
+    // Pinch State
+    StateOut.PinchState.SetNum(RawNumFingers);
+    for(int32 pinchIndex = 0; pinchIndex < RawNumFingers; ++pinchIndex)
+    {
+        StateOut.PinchState[pinchIndex].Finger = (EQHandFinger)pinchIndex;
+        StateOut.PinchState[pinchIndex].Pinched = (State.Pinches & (1 << pinchIndex)) != 0;
+        StateOut.PinchState[pinchIndex].Strength = State.PinchStrength[pinchIndex];
+    }
+
+    // Hand Scale
+    StateOut.HandScale = State.HandScale;
+
+    // Hand Confidence
+    StateOut.HandConfidence = State.HandConfidence == RawTrackingConfidence_High ? EQHandTrackingConfidence::Confidence_High : EQHandTrackingConfidence::Confidence_Low;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void QuestHands::FPoseConversion::ConvertSkeleton(const FRawSkeleton& Skeleton, FQHandSkeleton& SkeletonOut) const
+{
+    // Bone poses, converted in one batch
+    const int32 numBones = FMath::Min((int32)Skeleton.NumBones, RawMaxBones);
+    FRawPose rawPoses[RawMaxBones];
+    FQuat orientations[RawMaxBones];
+    FVector positions[RawMaxBones];
+    for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+    {
+        rawPoses[boneIndex] = Skeleton.Bones[boneIndex].Pose;
+    }
+    ConvertPoses(rawPoses, numBones, orientations, positions);
+
+    // Bones
+    SkeletonOut.Bones.SetNum(numBones);
+    for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+    {
+        SkeletonOut.Bones[boneIndex].BoneId = (EQHandBones)Skeleton.Bones[boneIndex].BoneId;
+        SkeletonOut.Bones[boneIndex].ParentBoneIndex = Skeleton.Bones[boneIndex].ParentBoneIndex;
+        SkeletonOut.Bones[boneIndex].Pose.Orientation = orientations[boneIndex];
+        SkeletonOut.Bones[boneIndex].Pose.Position = positions[boneIndex];
+    }
+
+    // Capsules, only the axes change like OculusHMD::ToFVector
+    const int32 numCapsules = FMath::Min((int32)Skeleton.NumBoneCapsules, RawMaxBoneCapsules);
+    SkeletonOut.BoneCapsules.SetNum(numCapsules);
+    for(int32 capsuleIndex = 0; capsuleIndex < numCapsules; ++capsuleIndex)
+    {
+        const FRawBoneCapsule& capsule = Skeleton.BoneCapsules[capsuleIndex];
+        SkeletonOut.BoneCapsules[capsuleIndex].BoneIndex = capsule.BoneIndex;
+        SkeletonOut.BoneCapsules[capsuleIndex].PointA = FVector(-capsule.Points[0].Z, capsule.Points[0].X, capsule.Points[0].Y);
+        SkeletonOut.BoneCapsules[capsuleIndex].PointB = FVector(-capsule.Points[1].Z, capsule.Points[1].X, capsule.Points[1].Y);
+        SkeletonOut.BoneCapsules[capsuleIndex].Radius = capsule.Radius;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void QuestHands::FPoseConversion::ConvertPoseReference(const FRawPose& Pose, const FQuat& BaseOrientation, const FVector& BaseOffset, float WorldToMeters,
+                                                       FQuat& OrientationOut, FVector& PositionOut)
+{
+    OrientationOut = BaseOrientation.Inverse() * FQuat(-Pose.Orientation.Z, Pose.Orientation.X, Pose.Orientation.Y, -Pose.Orientation.W);
+    OrientationOut.Normalize();
+
+    PositionOut = FVector(-Pose.Position.Z, Pose.Position.X, Pose.Position.Y) * WorldToMeters - BaseOffset * WorldToMeters;
+    PositionOut = BaseOrientation.Inverse().RotateVector(PositionOut);
+}
@@ -0,0 +1,116 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuestHandsFunctions.h"
+
+namespace QuestHands
+{
+    // Plain layouts of ovrpQuatf, ovrpVector3f and ovrpPosef so raw buffers convert without the OVR headers,
+    // for example hand states captured on a device and replayed on a desktop.
+    struct FRawQuat
+    {
+        float X, Y, Z, W;
+    };
+
+    struct FRawVector
+    {
+        float X, Y, Z;
+    };
+
+    struct FRawPose
+    {
+        FRawQuat Orientation;
+        FRawVector Position;
+    };
+
+    // The ovrpHandStatus flags and ovrpTrackingConfidence values the conversion reads
+    static constexpr uint32 RawHandStatus_HandTracked = 1 << 0;
+    static constexpr uint32 RawHandStatus_InputValid = 1 << 1;
+    static constexpr uint32 RawHandStatus_SystemGestureInProgress = 1 << 6;
+    static constexpr int32 RawTrackingConfidence_High = 0x3f800000;
+
+    static constexpr int32 RawMaxBones = 24;
+    static constexpr int32 RawMaxBoneCapsules = 19;
+    static constexpr int32 RawNumFingers = 5;
+
+    // Plain layout of ovrpHandState
+    struct FRawHandState
+    {
+        uint32 Status;
+        FRawPose RootPose;
+        FRawQuat BoneRotations[RawMaxBones];
+        uint32 Pinches;
+        float PinchStrength[RawNumFingers];
+        FRawPose PointerPose;
+        float HandScale;
+        int32 HandConfidence;
+        int32 FingerConfidences[RawNumFingers];
+        double RequestedTimeStamp;
+        double SampleTimeStamp;
+    };
+
+    // Plain layouts of ovrpBone, ovrpBoneCapsule and ovrpSkeleton
+    struct FRawBone
+    {
+        int32 BoneId;
+        int16 ParentBoneIndex;
+        FRawPose Pose;
+    };
+
+    struct FRawBoneCapsule
+    {
+        int16 BoneIndex;
+        FRawVector Points[2];
+        float Radius;
+    };
+
+    struct FRawSkeleton
+    {
+        int32 Type;
+        uint32 NumBones;
+        uint32 NumBoneCapsules;
+        FRawBone Bones[RawMaxBones];
+        FRawBoneCapsule BoneCapsules[RawMaxBoneCapsules];
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Converts OVR tracking space poses to Unreal the same way FOculusHMD::ConvertPose_Internal does, in batches.
+      * The axis swap, the inverse base orientation, the base offset and the world to meters scale are folded into one
+      * matrix for the orientations and one for the positions when the conversion is made, each pose then takes a handful
+      * of vector multiply adds instead of inverting the base orientation and rotating every pose on its own.
+    */
+    class FPoseConversion
+    {
+    public:
+
+        FPoseConversion(const FQuat& BaseOrientation, const FVector& BaseOffset, float WorldToMeters);
+
+        // Poses in the tracking space, the orientations are normalized like ConvertPose_Internal normalizes them
+        void ConvertPoses(const FRawPose* Poses, int32 Num, FQuat* OrientationsOut, FVector* PositionsOut) const;
+
+        // Bone rotations relative to their parents, only the axes change like OculusHMD::ToFQuat
+        static void ConvertRotations(const FRawQuat* Rotations, int32 Num, FQuat* RotationsOut);
+
+        // One pose converted per pose, the way ConvertPose_Internal does it, to check the batches against
+        static void ConvertPoseReference(const FRawPose& Pose, const FQuat& BaseOrientation, const FVector& BaseOffset, float WorldToMeters,
+                                         FQuat& OrientationOut, FVector& PositionOut);
+
+        // A runtime hand state in Unreal space, as GetTrackingState_Internal returns it
+        void ConvertHandState(const FRawHandState& State, FQHandTrackingState& StateOut) const;
+
+        // A runtime skeleton in Unreal space, as GetHandSkeleton_Internal returns it
+        void ConvertSkeleton(const FRawSkeleton& Skeleton, FQHandSkeleton& SkeletonOut) const;
+
+    private:
+
+        // The converted orientation is the sum of these scaled by the raw X, Y, Z and W
+        VectorRegister OrientationAxes[4];
+
+        // The converted position is the sum of these scaled by the raw X, Y and Z plus the offset
+        VectorRegister PositionAxes[3];
+        VectorRegister PositionOffset;
+    };
+}
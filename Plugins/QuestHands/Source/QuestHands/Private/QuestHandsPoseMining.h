@@ -0,0 +1,42 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuestHandsPoseTemplates.h"
+
+/**
+  * The k-means clustering behind the pose templates commandlet. Poses are NumFeatures floats each, packed one after the
+  * other, and indexed in 64 bits so large sets of recordings don't overflow the offsets.
+*/
+namespace QuestHands
+{
+namespace PoseMining
+{
+    static constexpr int32 NumFeatures = UQuestHandsPoseTemplates::NumFeatures;
+
+    struct FMiningSettings
+    {
+        int32 NumClusters = 32;
+        int32 MaxIterations = 50;
+        int32 Seed = 0;
+        float RadiusPercentile = 0.95f;
+        bool IncludeLowConfidence = false;
+    };
+
+    struct FMiningResult
+    {
+        TArray<float> Centroids;
+        TArray<float> Radii;
+        TArray<int32> Counts;
+    };
+
+    // Cluster the poses of one hand
+    void MinePoseTemplates(const TArray<float>& Poses, const FMiningSettings& Settings, const TCHAR* HandName, FMiningResult& ResultOut);
+
+    // Move every cluster without poses onto the pose furthest from its closest center. DistancesSquared holds the squared
+    // distance of every pose to its closest center and is lowered after each reseed, so the next empty cluster takes
+    // another pose. Returns the number of clusters reseeded.
+    int32 ReseedEmptyClusters(const TArray<float>& Poses, const TArray<int32>& Counts, TArray<float>& Centroids, TArray<float>& DistancesSquared);
+}
+}
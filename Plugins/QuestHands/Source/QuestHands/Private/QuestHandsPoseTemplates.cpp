@@ -0,0 +1,166 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPoseTemplates.h"
+#include "QuestHands.h"
+#include "Math/VectorRegister.h"
+
+namespace QuestHands
+{
+    // Quaternion components are stored as 16 bit fixed point
+    static constexpr float PoseTemplateQuantScale = 32767.0f;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsPoseTemplates::UQuestHandsPoseTemplates()
+    : RadiusScale(1.0f)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoseTemplates::PostLoad()
+{
+    Super::PostLoad();
+
+    DecodeTemplates(0);
+    DecodeTemplates(1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsPoseTemplates::GetPoseFeatures(const FQHandTrackingState& TrackingState, float* FeaturesOut)
+{
+    if(!TrackingState.IsTracked || TrackingState.BoneRotations.Num() < FirstFeatureBone + NumFeatureBones)
+    {
+        return false;
+    }
+
+    for(int32 featureBone = 0; featureBone < NumFeatureBones; ++featureBone)
+    {
+        // q and -q are the same rotation, keep them on one hemisphere so they are close in feature space
+        FQuat rotation = TrackingState.BoneRotations[FirstFeatureBone + featureBone].GetNormalized();
+        if(rotation.W < 0.0f)
+        {
+            rotation *= -1.0f;
+        }
+
+        float* features = FeaturesOut + featureBone * 4;
+        features[0] = rotation.X;
+        features[1] = rotation.Y;
+        features[2] = rotation.Z;
+        features[3] = rotation.W;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+float UQuestHandsPoseTemplates::GetFeatureDistanceSquared(const float* FeaturesA, const float* FeaturesB)
+{
+    // Every bone rotation fills one vector register
+    VectorRegister sum = VectorZero();
+    for(int32 featureBone = 0; featureBone < NumFeatureBones; ++featureBone)
+    {
+        const VectorRegister delta = VectorSubtract(VectorLoad(FeaturesA + featureBone * 4), VectorLoad(FeaturesB + featureBone * 4));
+        sum = VectorMultiplyAdd(delta, delta, sum);
+    }
+
+    float distanceSquared;
+    VectorStoreFloat1(VectorDot4(sum, VectorOne()), &distanceSquared);
+    return distanceSquared;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoseTemplates::SetTemplates(EControllerHand Hand, const TArray<float>& Centroids, const TArray<float>& Radii, const TArray<int32>& Counts)
+{
+    check(Centroids.Num() == Radii.Num() * NumFeatures && Counts.Num() == Radii.Num());
+
+    const int32 handIndex = Hand == EControllerHand::Left ? 0 : 1;
+    FQHandPoseTemplateSet& templateSet = handIndex == 0 ? LeftHand : RightHand;
+
+    templateSet.Centroids.SetNumUninitialized(Centroids.Num());
+    for(int32 index = 0; index < Centroids.Num(); ++index)
+    {
+        templateSet.Centroids[index] = (int16)FMath::RoundToInt(FMath::Clamp(Centroids[index], -1.0f, 1.0f) * QuestHands::PoseTemplateQuantScale);
+    }
+    templateSet.Radii = Radii;
+    templateSet.Counts = Counts;
+
+    DecodeTemplates(handIndex);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsPoseTemplates::DecodeTemplates(int32 HandIndex)
+{
+    const FQHandPoseTemplateSet& templateSet = GetTemplateSet(HandIndex);
+    TArray<float>& decoded = DecodedCentroids[HandIndex];
+
+    if(templateSet.Centroids.Num() != templateSet.Radii.Num() * NumFeatures)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsPoseTemplates %s has mismatched templates, ignoring them"), *GetName());
+        decoded.Reset();
+        return;
+    }
+
+    decoded.SetNumUninitialized(templateSet.Centroids.Num());
+    for(int32 index = 0; index < templateSet.Centroids.Num(); ++index)
+    {
+        decoded[index] = templateSet.Centroids[index] / QuestHands::PoseTemplateQuantScale;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int32 UQuestHandsPoseTemplates::FindClosestTemplate(EControllerHand Hand, const FQHandTrackingState& TrackingState, float& DistanceOut) const
+{
+    DistanceOut = 0.0f;
+
+    float features[NumFeatures];
+    if(!GetPoseFeatures(TrackingState, features))
+    {
+        return INDEX_NONE;
+    }
+
+    const int32 handIndex = Hand == EControllerHand::Left ? 0 : 1;
+    const FQHandPoseTemplateSet& templateSet = GetTemplateSet(handIndex);
+    const TArray<float>& centroids = DecodedCentroids[handIndex];
+    const int32 numTemplates = centroids.Num() / NumFeatures;
+
+    int32 closest = INDEX_NONE;
+    float closestDistanceSquared = MAX_flt;
+    for(int32 templateIndex = 0; templateIndex < numTemplates; ++templateIndex)
+    {
+        const float distanceSquared = GetFeatureDistanceSquared(features, centroids.GetData() + templateIndex * NumFeatures);
+        if(distanceSquared < closestDistanceSquared)
+        {
+            closestDistanceSquared = distanceSquared;
+            closest = templateIndex;
+        }
+    }
+
+    if(closest == INDEX_NONE)
+    {
+        return INDEX_NONE;
+    }
+
+    DistanceOut = FMath::Sqrt(closestDistanceSquared);
+    return DistanceOut <= templateSet.Radii[closest] * RadiusScale ? closest : INDEX_NONE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int32 UQuestHandsPoseTemplates::GetNumTemplates(EControllerHand Hand) const
+{
+    return DecodedCentroids[Hand == EControllerHand::Left ? 0 : 1].Num() / NumFeatures;
+}
@@ -0,0 +1,522 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPoseTemplatesCommandlet.h"
+#include "QuestHands.h"
+#include "QuestHandsRecording.h"
+#include "QuestHandsPoseTemplates.h"
+#include "QuestHandsPoseMining.h"
+#include "Async/ParallelFor.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+namespace QuestHands
+{
+namespace PoseMining
+{
+    // Poses are assigned in chunks of this size per task, each chunk accumulating its own cluster sums
+    static constexpr int32 ChunkSize = 16384;
+
+    // Iterations stop once fewer than this fraction of the poses change cluster
+    static constexpr float ConvergedFraction = 0.001f;
+
+    // The cluster sums of one chunk of poses for an iteration
+    struct FChunkAccumulator
+    {
+        TArray<double> Sums;
+        TArray<int32> Counts;
+        double Inertia = 0.0;
+        int32 NumChanged = 0;
+
+        void Reset(int32 NumClusters)
+        {
+            Sums.Reset();
+            Sums.AddZeroed(NumClusters * NumFeatures);
+            Counts.Reset();
+            Counts.AddZeroed(NumClusters);
+            Inertia = 0.0;
+            NumChanged = 0;
+        }
+    };
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static const float* GetPose(const TArray<float>& Poses, int32 PoseIndex)
+    {
+        return Poses.GetData() + (int64)PoseIndex * NumFeatures;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static int32 FindClosestCentroid(const float* Features, const TArray<float>& Centroids, int32 NumClusters, float& DistanceSquaredOut)
+    {
+        int32 closest = 0;
+        DistanceSquaredOut = MAX_flt;
+        for(int32 cluster = 0; cluster < NumClusters; ++cluster)
+        {
+            const float distanceSquared = UQuestHandsPoseTemplates::GetFeatureDistanceSquared(Features, Centroids.GetData() + cluster * NumFeatures);
+            if(distanceSquared < DistanceSquaredOut)
+            {
+                DistanceSquaredOut = distanceSquared;
+                closest = cluster;
+            }
+        }
+        return closest;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void CopyPose(const TArray<float>& Poses, int32 PoseIndex, TArray<float>& Centroids, int32 Cluster)
+    {
+        FMemory::Memcpy(Centroids.GetData() + Cluster * NumFeatures, GetPose(Poses, PoseIndex), NumFeatures * sizeof(float));
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void LoadPoses(const TArray<FString>& Files, const FMiningSettings& Settings, TArray<float> (&PosesOut)[2])
+    {
+        TArray<TArray<float>> filePoses[2];
+        filePoses[0].SetNum(Files.Num());
+        filePoses[1].SetNum(Files.Num());
+
+        ParallelFor(Files.Num(), [&Files, &Settings, &filePoses](int32 fileIndex)
+        {
+            FQHandRecordingReader reader;
+            if(!reader.Open(Files[fileIndex]))
+            {
+                return;
+            }
+
+            FQHandRecordingFrame frame;
+            float features[NumFeatures];
+            while(reader.ReadFrame(frame))
+            {
+                for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+                {
+                    const FQHandTrackingState& state = frame.Hands[handIndex];
+                    if(state.HandScale <= 0.0f || (!Settings.IncludeLowConfidence && state.HandConfidence != EQHandTrackingConfidence::Confidence_High))
+                    {
+                        continue;
+                    }
+
+                    if(UQuestHandsPoseTemplates::GetPoseFeatures(state, features))
+                    {
+                        filePoses[handIndex][fileIndex].Append(features, NumFeatures);
+                    }
+                }
+            }
+        });
+
+        for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+        {
+            int32 numFeatures = 0;
+            for(const TArray<float>& poses : filePoses[handIndex])
+            {
+                numFeatures += poses.Num();
+            }
+
+            PosesOut[handIndex].Reserve(numFeatures);
+            for(TArray<float>& poses : filePoses[handIndex])
+            {
+                PosesOut[handIndex].Append(poses);
+                poses.Empty();
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void SeedCentroids(const TArray<float>& Poses, int32 NumClusters, FRandomStream& Random, TArray<float>& CentroidsOut)
+    {
+        // k-means++, every next center is picked with a probability proportional to its squared distance to the closest center
+        const int32 numPoses = Poses.Num() / NumFeatures;
+        const int32 numChunks = FMath::DivideAndRoundUp(numPoses, ChunkSize);
+
+        TArray<float> distances;
+        distances.Init(MAX_flt, numPoses);
+        TArray<double> chunkSums;
+        chunkSums.SetNumZeroed(numChunks);
+
+        CentroidsOut.SetNumUninitialized(NumClusters * NumFeatures);
+        CopyPose(Poses, Random.RandRange(0, numPoses - 1), CentroidsOut, 0);
+
+        for(int32 cluster = 1; cluster < NumClusters; ++cluster)
+        {
+            const float* lastCentroid = CentroidsOut.GetData() + (cluster - 1) * NumFeatures;
+            ParallelFor(numChunks, [&Poses, &distances, &chunkSums, lastCentroid, numPoses](int32 chunk)
+            {
+                double chunkSum = 0.0;
+                const int32 lastPose = FMath::Min((chunk + 1) * ChunkSize, numPoses);
+                for(int32 poseIndex = chunk * ChunkSize; poseIndex < lastPose; ++poseIndex)
+                {
+                    const float distanceSquared = UQuestHandsPoseTemplates::GetFeatureDistanceSquared(GetPose(Poses, poseIndex), lastCentroid);
+                    distances[poseIndex] = FMath::Min(distances[poseIndex], distanceSquared);
+                    chunkSum += distances[poseIndex];
+                }
+                chunkSums[chunk] = chunkSum;
+            });
+
+            double total = 0.0;
+            for(double chunkSum : chunkSums)
+            {
+                total += chunkSum;
+            }
+
+            // Walk the chunks first so only one chunk of poses is scanned for the pick
+            double target = Random.FRand() * total;
+            int32 picked = numPoses - 1;
+            for(int32 chunk = 0; chunk < numChunks; ++chunk)
+            {
+                if(target > chunkSums[chunk])
+                {
+                    target -= chunkSums[chunk];
+                    continue;
+                }
+
+                const int32 lastPose = FMath::Min((chunk + 1) * ChunkSize, numPoses);
+                for(int32 poseIndex = chunk * ChunkSize; poseIndex < lastPose; ++poseIndex)
+                {
+                    target -= distances[poseIndex];
+                    if(target <= 0.0)
+                    {
+                        picked = poseIndex;
+                        break;
+                    }
+                }
+                break;
+            }
+            CopyPose(Poses, picked, CentroidsOut, cluster);
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void UpdateCentroids(const TArray<FChunkAccumulator>& Accumulators, int32 NumClusters, TArray<float>& Centroids, TArray<int32>& CountsOut)
+    {
+        TArray<double> sums;
+        sums.SetNumZeroed(NumClusters * NumFeatures);
+        CountsOut.Reset();
+        CountsOut.AddZeroed(NumClusters);
+
+        for(const FChunkAccumulator& accumulator : Accumulators)
+        {
+            for(int32 index = 0; index < sums.Num(); ++index)
+            {
+                sums[index] += accumulator.Sums[index];
+            }
+            for(int32 cluster = 0; cluster < NumClusters; ++cluster)
+            {
+                CountsOut[cluster] += accumulator.Counts[cluster];
+            }
+        }
+
+        for(int32 cluster = 0; cluster < NumClusters; ++cluster)
+        {
+            // Empty clusters are reseeded once all the centers have moved
+            if(CountsOut[cluster] == 0)
+            {
+                continue;
+            }
+
+            // The mean of unit quaternions on one hemisphere, renormalised, is the center of the bone rotations
+            float* centroid = Centroids.GetData() + cluster * NumFeatures;
+            const double* sum = sums.GetData() + cluster * NumFeatures;
+            for(int32 featureBone = 0; featureBone < UQuestHandsPoseTemplates::NumFeatureBones; ++featureBone)
+            {
+                FQuat rotation((float)sum[featureBone * 4], (float)sum[featureBone * 4 + 1], (float)sum[featureBone * 4 + 2], (float)sum[featureBone * 4 + 3]);
+                rotation.Normalize();
+                centroid[featureBone * 4] = rotation.X;
+                centroid[featureBone * 4 + 1] = rotation.Y;
+                centroid[featureBone * 4 + 2] = rotation.Z;
+                centroid[featureBone * 4 + 3] = rotation.W;
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    int32 ReseedEmptyClusters(const TArray<float>& Poses, const TArray<int32>& Counts, TArray<float>& Centroids, TArray<float>& DistancesSquared)
+    {
+        const int32 numPoses = Poses.Num() / NumFeatures;
+        const int32 numChunks = FMath::DivideAndRoundUp(numPoses, ChunkSize);
+        TArray<int32> chunkFurthest;
+        chunkFurthest.SetNumUninitialized(numChunks);
+
+        int32 numReseeded = 0;
+        for(int32 cluster = 0; cluster < Counts.Num(); ++cluster)
+        {
+            if(Counts[cluster] != 0)
+            {
+                continue;
+            }
+
+            // The worst fitting pose, a new center elsewhere has to take it
+            ParallelFor(numChunks, [&DistancesSquared, &chunkFurthest, numPoses](int32 chunk)
+            {
+                int32 furthest = chunk * ChunkSize;
+                const int32 lastPose = FMath::Min((chunk + 1) * ChunkSize, numPoses);
+                for(int32 poseIndex = furthest + 1; poseIndex < lastPose; ++poseIndex)
+                {
+                    if(DistancesSquared[poseIndex] > DistancesSquared[furthest])
+                    {
+                        furthest = poseIndex;
+                    }
+                }
+                chunkFurthest[chunk] = furthest;
+            });
+
+            int32 furthest = INDEX_NONE;
+            for(int32 chunkPose : chunkFurthest)
+            {
+                if(furthest == INDEX_NONE || DistancesSquared[chunkPose] > DistancesSquared[furthest])
+                {
+                    furthest = chunkPose;
+                }
+            }
+
+            // Every pose sits on a center, there is nothing left for the cluster to take
+            if(furthest == INDEX_NONE || DistancesSquared[furthest] <= 0.0f)
+            {
+                break;
+            }
+
+            CopyPose(Poses, furthest, Centroids, cluster);
+            ++numReseeded;
+
+            // The poses closer to the new center no longer count as badly fitting for the next empty cluster
+            const float* centroid = Centroids.GetData() + cluster * NumFeatures;
+            ParallelFor(numChunks, [&Poses, &DistancesSquared, centroid, numPoses](int32 chunk)
+            {
+                const int32 lastPose = FMath::Min((chunk + 1) * ChunkSize, numPoses);
+                for(int32 poseIndex = chunk * ChunkSize; poseIndex < lastPose; ++poseIndex)
+                {
+                    DistancesSquared[poseIndex] = FMath::Min(DistancesSquared[poseIndex], UQuestHandsPoseTemplates::GetFeatureDistanceSquared(GetPose(Poses, poseIndex), centroid));
+                }
+            });
+        }
+        return numReseeded;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void MinePoseTemplates(const TArray<float>& Poses, const FMiningSettings& Settings, const TCHAR* HandName, FMiningResult& ResultOut)
+    {
+        const int32 numPoses = Poses.Num() / NumFeatures;
+        const int32 numClusters = FMath::Min(Settings.NumClusters, numPoses);
+        const int32 numChunks = FMath::DivideAndRoundUp(numPoses, ChunkSize);
+        if(numClusters == 0)
+        {
+            return;
+        }
+
+        FRandomStream random(Settings.Seed);
+        TArray<float>& centroids = ResultOut.Centroids;
+
+        double startTime = FPlatformTime::Seconds();
+        SeedCentroids(Poses, numClusters, random, centroids);
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsPoseTemplates : %s hand, seeded %d clusters from %d poses in %.1f ms"),
+               HandName, numClusters, numPoses, (FPlatformTime::Seconds() - startTime) * 1000.0);
+
+        TArray<int32> assignments;
+        assignments.Init(INDEX_NONE, numPoses);
+        TArray<float> distancesSquared;
+        distancesSquared.SetNumUninitialized(numPoses);
+        TArray<FChunkAccumulator> accumulators;
+        accumulators.SetNum(numChunks);
+
+        for(int32 iteration = 0; iteration < Settings.MaxIterations; ++iteration)
+        {
+            startTime = FPlatformTime::Seconds();
+
+            ParallelFor(numChunks, [&Poses, &centroids, &assignments, &distancesSquared, &accumulators, numClusters, numPoses](int32 chunk)
+            {
+                FChunkAccumulator& accumulator = accumulators[chunk];
+                accumulator.Reset(numClusters);
+
+                const int32 lastPose = FMath::Min((chunk + 1) * ChunkSize, numPoses);
+                for(int32 poseIndex = chunk * ChunkSize; poseIndex < lastPose; ++poseIndex)
+                {
+                    const float* features = GetPose(Poses, poseIndex);
+                    float distanceSquared;
+                    const int32 cluster = FindClosestCentroid(features, centroids, numClusters, distanceSquared);
+                    distancesSquared[poseIndex] = distanceSquared;
+                    if(assignments[poseIndex] != cluster)
+                    {
+                        assignments[poseIndex] = cluster;
+                        ++accumulator.NumChanged;
+                    }
+
+                    double* sum = accumulator.Sums.GetData() + cluster * NumFeatures;
+                    for(int32 feature = 0; feature < NumFeatures; ++feature)
+                    {
+                        sum[feature] += features[feature];
+                    }
+                    ++accumulator.Counts[cluster];
+                    accumulator.Inertia += distanceSquared;
+                }
+            });
+
+            UpdateCentroids(accumulators, numClusters, centroids, ResultOut.Counts);
+
+            // An empty cluster takes over the worst fitting poses rather than being lost
+            const int32 numReseeded = ReseedEmptyClusters(Poses, ResultOut.Counts, centroids, distancesSquared);
+
+            int32 numChanged = 0;
+            double inertia = 0.0;
+            for(const FChunkAccumulator& accumulator : accumulators)
+            {
+                numChanged += accumulator.NumChanged;
+                inertia += accumulator.Inertia;
+            }
+
+            UE_LOG(LogQuestHands, Display, TEXT("QuestHandsPoseTemplates : %s hand, iteration %d took %.1f ms, %d poses changed cluster, %d empty clusters reseeded, mean squared distance %.5f"),
+                   HandName, iteration, (FPlatformTime::Seconds() - startTime) * 1000.0, numChanged, numReseeded, inertia / numPoses);
+
+            // A reseeded center has no poses yet, it needs another iteration to gather them
+            if(numReseeded == 0 && numChanged <= numPoses * ConvergedFraction)
+            {
+                break;
+            }
+        }
+
+        // The radius of a cluster is the percentile of the distances of its poses to the final centers
+        startTime = FPlatformTime::Seconds();
+        TArray<float> poseDistances;
+        poseDistances.SetNumUninitialized(numPoses);
+        ParallelFor(numChunks, [&Poses, &centroids, &assignments, &poseDistances, numClusters, numPoses](int32 chunk)
+        {
+            const int32 lastPose = FMath::Min((chunk + 1) * ChunkSize, numPoses);
+            for(int32 poseIndex = chunk * ChunkSize; poseIndex < lastPose; ++poseIndex)
+            {
+                float distanceSquared;
+                assignments[poseIndex] = FindClosestCentroid(GetPose(Poses, poseIndex), centroids, numClusters, distanceSquared);
+                poseDistances[poseIndex] = FMath::Sqrt(distanceSquared);
+            }
+        });
+
+        TArray<TArray<float>> clusterDistances;
+        clusterDistances.SetNum(numClusters);
+        for(int32 poseIndex = 0; poseIndex < numPoses; ++poseIndex)
+        {
+            clusterDistances[assignments[poseIndex]].Add(poseDistances[poseIndex]);
+        }
+
+        ResultOut.Radii.SetNumZeroed(numClusters);
+        ResultOut.Counts.SetNumZeroed(numClusters);
+        ParallelFor(numClusters, [&clusterDistances, &ResultOut, &Settings](int32 cluster)
+        {
+            TArray<float>& distances = clusterDistances[cluster];
+            ResultOut.Counts[cluster] = distances.Num();
+            if(distances.Num() > 0)
+            {
+                distances.Sort();
+                ResultOut.Radii[cluster] = distances[FMath::Clamp(FMath::CeilToInt(distances.Num() * Settings.RadiusPercentile) - 1, 0, distances.Num() - 1)];
+            }
+        });
+
+        UE_LOG(LogQuestHands, Display, TEXT("QuestHandsPoseTemplates : %s hand, measured the cluster radii in %.1f ms"),
+               HandName, (FPlatformTime::Seconds() - startTime) * 1000.0);
+    }
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsPoseTemplatesCommandlet::UQuestHandsPoseTemplatesCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+int32 UQuestHandsPoseTemplatesCommandlet::Main(const FString& Params)
+{
+    using namespace QuestHands::PoseMining;
+
+    FString inputParam;
+    FString packageName;
+    if(!FParse::Value(*Params, TEXT("Input="), inputParam, false) || !FParse::Value(*Params, TEXT("Asset="), packageName, false))
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsPoseTemplates : Use -Input=<dir>[+<dir>...] -Asset=/Game/Path/PoseTemplates"));
+        return 1;
+    }
+
+    FText packageNameError;
+    if(!FPackageName::IsValidLongPackageName(packageName, false, &packageNameError))
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsPoseTemplates : %s"), *packageNameError.ToString());
+        return 1;
+    }
+
+    FMiningSettings settings;
+    FParse::Value(*Params, TEXT("Clusters="), settings.NumClusters);
+    FParse::Value(*Params, TEXT("Iterations="), settings.MaxIterations);
+    FParse::Value(*Params, TEXT("Seed="), settings.Seed);
+    FParse::Value(*Params, TEXT("RadiusPercentile="), settings.RadiusPercentile);
+    settings.IncludeLowConfidence = FParse::Param(*Params, TEXT("IncludeLowConfidence"));
+    settings.NumClusters = FMath::Max(settings.NumClusters, 1);
+    settings.RadiusPercentile = FMath::Clamp(settings.RadiusPercentile, 0.0f, 1.0f);
+
+    TArray<FString> files;
+    QuestHands::Recording::FindRecordings(inputParam, files);
+    if(files.Num() == 0)
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsPoseTemplates : No recordings found in %s"), *inputParam);
+        return 1;
+    }
+
+    const double startTime = FPlatformTime::Seconds();
+    TArray<float> poses[2];
+    LoadPoses(files, settings, poses);
+
+    const int32 numPoses = (poses[0].Num() + poses[1].Num()) / NumFeatures;
+    const double loadSeconds = FPlatformTime::Seconds() - startTime;
+    UE_LOG(LogQuestHands, Display, TEXT("QuestHandsPoseTemplates : Loaded %d poses from %d recordings in %.2f s (%.0f poses/s)"),
+           numPoses, files.Num(), loadSeconds, loadSeconds > 0.0 ? numPoses / loadSeconds : 0.0);
+
+    FMiningResult results[2];
+    MinePoseTemplates(poses[0], settings, TEXT("Left"), results[0]);
+    MinePoseTemplates(poses[1], settings, TEXT("Right"), results[1]);
+
+    UE_LOG(LogQuestHands, Display, TEXT("QuestHandsPoseTemplates : Mined %d left and %d right templates in %.2f s"),
+           results[0].Radii.Num(), results[1].Radii.Num(), FPlatformTime::Seconds() - startTime);
+
+#if WITH_EDITOR
+    UPackage* package = CreatePackage(nullptr, *packageName);
+    const FString assetName = FPackageName::GetLongPackageAssetName(packageName);
+    UQuestHandsPoseTemplates* templates = FindObject<UQuestHandsPoseTemplates>(package, *assetName);
+    if(!templates)
+    {
+        templates = NewObject<UQuestHandsPoseTemplates>(package, *assetName, RF_Public | RF_Standalone);
+    }
+
+    templates->SetTemplates(EControllerHand::Left, results[0].Centroids, results[0].Radii, results[0].Counts);
+    templates->SetTemplates(EControllerHand::Right, results[1].Centroids, results[1].Radii, results[1].Counts);
+    package->MarkPackageDirty();
+
+    const FString fileName = FPackageName::LongPackageNameToFilename(packageName, FPackageName::GetAssetPackageExtension());
+    if(!UPackage::SavePackage(package, templates, RF_Public | RF_Standalone, *fileName))
+    {
+        UE_LOG(LogQuestHands, Error, TEXT("QuestHandsPoseTemplates : Unable to save %s"), *fileName);
+        return 1;
+    }
+
+    UE_LOG(LogQuestHands, Display, TEXT("QuestHandsPoseTemplates : Saved %s"), *fileName);
+    return 0;
+#else
+    UE_LOG(LogQuestHands, Error, TEXT("QuestHandsPoseTemplates : Saving the templates asset needs an editor build"));
+    return 1;
+#endif
+}
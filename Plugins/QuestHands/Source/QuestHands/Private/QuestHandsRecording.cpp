@@ -0,0 +1,352 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsRecording.h"
+#include "QuestHands.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Async/Async.h"
+
+namespace QuestHands
+{
+namespace Recording
+{
+    const TCHAR* FileExtension = TEXT("qhrec");
+
+    // 'QHRC', followed by the version of the layout
+    static const uint32 FileMagic = 0x43524851;
+
+    // 1 serialized the reflected structs, 2 writes every field explicitly
+    static const int32 FileVersion_Reflected = 1;
+    static const int32 FileVersion = 2;
+
+    // More elements than any hand has, a larger count means the file is corrupt
+    static const int32 MaxArrayNum = 256;
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    FString GetRecordingsDir()
+    {
+        return FPaths::ProjectSavedDir() / TEXT("HandRecordings");
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    void FindRecordings(const FString& InputPaths, TArray<FString>& FilesOut)
+    {
+        TArray<FString> paths;
+        InputPaths.ParseIntoArray(paths, TEXT("+"));
+
+        const FString wildcard = FString::Printf(TEXT("*.%s"), FileExtension);
+        for(const FString& path : paths)
+        {
+            if(FPaths::FileExists(path))
+            {
+                FilesOut.Add(path);
+            }
+            else
+            {
+                IFileManager::Get().FindFilesRecursive(FilesOut, *path, *wildcard, true, false, false);
+            }
+        }
+
+        // Sorted so whatever is derived from the recordings comes out in the same order every run
+        FilesOut.Sort();
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    template<typename ElementType, typename SerializeElementType>
+    static void SerializeArray(FArchive& Ar, TArray<ElementType>& Array, SerializeElementType SerializeElement)
+    {
+        int32 num = Array.Num();
+        Ar << num;
+        if(Ar.IsLoading())
+        {
+            if(num < 0 || num > MaxArrayNum)
+            {
+                Ar.SetError();
+                return;
+            }
+            Array.SetNum(num);
+        }
+
+        for(ElementType& element : Array)
+        {
+            SerializeElement(Ar, element);
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    template<typename EnumType>
+    static void SerializeEnum(FArchive& Ar, EnumType& Value)
+    {
+        uint8 value = (uint8)Value;
+        Ar << value;
+        Value = (EnumType)value;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void SerializePose(FArchive& Ar, FOculusPose& Pose)
+    {
+        Ar << Pose.Orientation;
+        Ar << Pose.Position;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void SerializeSkeleton(FArchive& Ar, FQHandSkeleton& Skeleton)
+    {
+        SerializeArray(Ar, Skeleton.Bones, [](FArchive& ElementAr, FQHandBone& Bone)
+        {
+            SerializeEnum(ElementAr, Bone.BoneId);
+            ElementAr << Bone.ParentBoneIndex;
+            SerializePose(ElementAr, Bone.Pose);
+        });
+        SerializeArray(Ar, Skeleton.BoneCapsules, [](FArchive& ElementAr, FQHandBoneCapsule& Capsule)
+        {
+            ElementAr << Capsule.BoneIndex;
+            ElementAr << Capsule.PointA;
+            ElementAr << Capsule.PointB;
+            ElementAr << Capsule.Radius;
+        });
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void SerializeTrackingState(FArchive& Ar, FQHandTrackingState& State)
+    {
+        Ar << State.IsTracked;
+        Ar << State.InputValid;
+        Ar << State.SystemGestureInProgress;
+        SerializePose(Ar, State.RootPose);
+        SerializeArray(Ar, State.BoneRotations, [](FArchive& ElementAr, FQuat& Rotation)
+        {
+            ElementAr << Rotation;
+        });
+        SerializeArray(Ar, State.PinchState, [](FArchive& ElementAr, FQHandPinchState& Pinch)
+        {
+            SerializeEnum(ElementAr, Pinch.Finger);
+            ElementAr << Pinch.Pinched;
+            ElementAr << Pinch.Strength;
+        });
+        SerializePose(Ar, State.PointerPose);
+        Ar << State.HandScale;
+        SerializeEnum(Ar, State.HandConfidence);
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void SerializeSkeletons(FArchive& Ar, int32 Version, FQHandSkeleton& LeftSkeleton, FQHandSkeleton& RightSkeleton)
+    {
+        if(Version == FileVersion_Reflected)
+        {
+            FQHandSkeleton::StaticStruct()->SerializeBin(Ar, &LeftSkeleton);
+            FQHandSkeleton::StaticStruct()->SerializeBin(Ar, &RightSkeleton);
+            return;
+        }
+
+        SerializeSkeleton(Ar, LeftSkeleton);
+        SerializeSkeleton(Ar, RightSkeleton);
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void SerializeFrame(FArchive& Ar, int32 Version, FQHandRecordingFrame& Frame)
+    {
+        Ar << Frame.Time;
+        if(Version == FileVersion_Reflected)
+        {
+            FQHandTrackingState::StaticStruct()->SerializeBin(Ar, &Frame.Hands[0]);
+            FQHandTrackingState::StaticStruct()->SerializeBin(Ar, &Frame.Hands[1]);
+            return;
+        }
+
+        SerializeTrackingState(Ar, Frame.Hands[0]);
+        SerializeTrackingState(Ar, Frame.Hands[1]);
+    }
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FQHandRecordingWriter::~FQHandRecordingWriter()
+{
+    Close();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandRecordingWriter::Open(const FString& InFilePath, const FQHandSkeleton& LeftSkeleton, const FQHandSkeleton& RightSkeleton)
+{
+    Close();
+
+    Archive.Reset(IFileManager::Get().CreateFileWriter(*InFilePath));
+    if(!Archive.IsValid())
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("FQHandRecordingWriter : Unable to create recording %s"), *InFilePath);
+        return false;
+    }
+
+    FilePath = InFilePath;
+    NumFrames = 0;
+    Buffer.Reset(FlushBytes + FlushBytes / 4);
+
+    FMemoryWriter writer(Buffer);
+    uint32 magic = QuestHands::Recording::FileMagic;
+    int32 version = QuestHands::Recording::FileVersion;
+    writer << magic;
+    writer << version;
+
+    FQHandSkeleton leftSkeleton = LeftSkeleton;
+    FQHandSkeleton rightSkeleton = RightSkeleton;
+    QuestHands::Recording::SerializeSkeletons(writer, version, leftSkeleton, rightSkeleton);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandRecordingWriter::Close()
+{
+    if(Archive.IsValid())
+    {
+        Flush();
+        if(PendingWrite.IsValid())
+        {
+            PendingWrite.Wait();
+            PendingWrite = TFuture<void>();
+        }
+
+        Archive->Close();
+        Archive.Reset();
+    }
+    Buffer.Empty();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandRecordingWriter::WriteFrame(FQHandRecordingFrame& Frame)
+{
+    if(Archive.IsValid())
+    {
+        FMemoryWriter writer(Buffer, false, true);
+        QuestHands::Recording::SerializeFrame(writer, QuestHands::Recording::FileVersion, Frame);
+        ++NumFrames;
+
+        if(Buffer.Num() >= FlushBytes)
+        {
+            Flush();
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandRecordingWriter::Flush()
+{
+    if(Buffer.Num() == 0)
+    {
+        return;
+    }
+
+    // A write takes well under the time it takes to fill the buffer again, the wait is only there to keep the order
+    if(PendingWrite.IsValid())
+    {
+        PendingWrite.Wait();
+    }
+
+    FArchive* archive = Archive.Get();
+    PendingWrite = Async(EAsyncExecution::ThreadPool, [archive, bytes = MoveTemp(Buffer)]() mutable
+    {
+        archive->Serialize(bytes.GetData(), bytes.Num());
+    });
+
+    Buffer.Reset(FlushBytes + FlushBytes / 4);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FQHandRecordingReader::~FQHandRecordingReader()
+{
+    Close();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandRecordingReader::Open(const FString& FilePath)
+{
+    Close();
+
+    Archive.Reset(IFileManager::Get().CreateFileReader(*FilePath));
+    if(!Archive.IsValid())
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("FQHandRecordingReader : Unable to open recording %s"), *FilePath);
+        return false;
+    }
+
+    uint32 magic = 0;
+    Version = 0;
+    *Archive << magic;
+    *Archive << Version;
+    if(magic != QuestHands::Recording::FileMagic || Version < QuestHands::Recording::FileVersion_Reflected || Version > QuestHands::Recording::FileVersion)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("FQHandRecordingReader : %s is not a hand recording of version %d or older"), *FilePath, QuestHands::Recording::FileVersion);
+        Close();
+        return false;
+    }
+
+    QuestHands::Recording::SerializeSkeletons(*Archive, Version, Skeletons[0], Skeletons[1]);
+    if(Archive->IsError())
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("FQHandRecordingReader : %s is truncated"), *FilePath);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandRecordingReader::Close()
+{
+    if(Archive.IsValid())
+    {
+        Archive->Close();
+        Archive.Reset();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandRecordingReader::ReadFrame(FQHandRecordingFrame& FrameOut)
+{
+    if(!Archive.IsValid() || Archive->AtEnd())
+    {
+        return false;
+    }
+
+    QuestHands::Recording::SerializeFrame(*Archive, Version, FrameOut);
+
+    // A recording cut short by the app being killed ends in a partial frame, drop it
+    return !Archive->IsError();
+}
@@ -0,0 +1,219 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsRetarget.h"
+#include "QuestHands.h"
+#include "QuestHandsTopology.h"
+#include "Engine/SkeletalMesh.h"
+#include "Components/PoseableMeshComponent.h"
+
+namespace QuestHands
+{
+namespace Retarget
+{
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void GetComponentSpaceRestPose(const FReferenceSkeleton& Skeleton, TArray<FTransform>& TransformsOut)
+    {
+        const TArray<FTransform>& localPose = Skeleton.GetRefBonePose();
+        TransformsOut.SetNumUninitialized(localPose.Num());
+        for(int32 boneIndex = 0; boneIndex < localPose.Num(); ++boneIndex)
+        {
+            const int32 parentIndex = Skeleton.GetParentIndex(boneIndex);
+            TransformsOut[boneIndex] = parentIndex != INDEX_NONE ? localPose[boneIndex] * TransformsOut[parentIndex] : localPose[boneIndex];
+        }
+    }
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+UQuestHandsRetarget::UQuestHandsRetarget()
+    : SourceMesh(nullptr)
+    , LeftSourceRotationOffset(0.0f, 90.0f, 90.0f)
+    , RightSourceRotationOffset(0.0f, 90.0f, 90.0f)
+    , LeftTargetMesh(nullptr)
+    , RightTargetMesh(nullptr)
+    , MatchBoneLengths(true)
+    , LeftBakedMesh(nullptr)
+    , RightBakedMesh(nullptr)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsRetarget::Bake()
+{
+    const bool leftBaked = BakeHand(true);
+    const bool rightBaked = BakeHand(false);
+    if(leftBaked && rightBaked)
+    {
+        UE_LOG(LogQuestHands, Log, TEXT("UQuestHandsRetarget %s baked, %d left and %d right bones mapped"), *GetName(), LeftBaked.NumMappedBones, RightBaked.NumMappedBones);
+    }
+    MarkPackageDirty();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsRetarget::BakeHand(bool LeftHand)
+{
+    using namespace QuestHands;
+
+    FQHandRetargetBaked& baked = LeftHand ? LeftBaked : RightBaked;
+    USkeletalMesh*& bakedMesh = LeftHand ? LeftBakedMesh : RightBakedMesh;
+    baked = FQHandRetargetBaked();
+    bakedMesh = nullptr;
+
+    USkeletalMesh* targetMesh = LeftHand ? LeftTargetMesh : RightTargetMesh;
+    if(!targetMesh)
+    {
+        return true;
+    }
+    if(!SourceMesh)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsRetarget %s needs a SourceMesh to bake against"), *GetName());
+        return false;
+    }
+
+    const FReferenceSkeleton& sourceSkeleton = SourceMesh->RefSkeleton;
+    const FReferenceSkeleton& targetSkeleton = targetMesh->RefSkeleton;
+
+    TArray<FTransform> sourceRest;
+    TArray<FTransform> targetRest;
+    Retarget::GetComponentSpaceRestPose(sourceSkeleton, sourceRest);
+    Retarget::GetComponentSpaceRestPose(targetSkeleton, targetRest);
+
+    // The bones of both meshes for each hand bone, explicit mappings first and matching names for the rest
+    int32 sourceBones[Topology::NumBones];
+    int32 targetBones[Topology::NumBones];
+    for(int32 boneIndex = 0; boneIndex < Topology::NumBones; ++boneIndex)
+    {
+        const FName& boneName = Topology::GetBoneFName(boneIndex, LeftHand);
+        sourceBones[boneIndex] = sourceSkeleton.FindBoneIndex(boneName);
+        targetBones[boneIndex] = targetSkeleton.FindBoneIndex(boneName);
+    }
+    for(const FQHandRetargetBone& mapping : LeftHand ? LeftBones : RightBones)
+    {
+        const int32 boneIndex = (int32)mapping.Bone;
+        if(boneIndex < Topology::NumBones)
+        {
+            targetBones[boneIndex] = mapping.TargetBone.IsNone() ? INDEX_NONE : targetSkeleton.FindBoneIndex(mapping.TargetBone);
+            if(!mapping.TargetBone.IsNone() && targetBones[boneIndex] == INDEX_NONE)
+            {
+                UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsRetarget %s : %s has no bone named %s"), *GetName(), *targetMesh->GetName(), *mapping.TargetBone.ToString());
+            }
+        }
+    }
+
+    const int32 numTargetBones = targetSkeleton.GetNum();
+    baked.SourceBones.Init(INDEX_NONE, numTargetBones);
+    baked.ParentBones.SetNumUninitialized(numTargetBones);
+    baked.Corrections.Init(FTransform::Identity, numTargetBones);
+    for(int32 targetIndex = 0; targetIndex < numTargetBones; ++targetIndex)
+    {
+        baked.ParentBones[targetIndex] = targetSkeleton.GetParentIndex(targetIndex);
+    }
+
+    // The tracked rotation of a bone at rest is the source rest rotation without the offset the source mesh was driven with,
+    // the correction takes it to the target rest rotation
+    const FQuat sourceOffset = (LeftHand ? LeftSourceRotationOffset : RightSourceRotationOffset).Quaternion();
+    float boneScales[Topology::NumBones];
+    for(int32 boneIndex = 0; boneIndex < Topology::NumBones; ++boneIndex)
+    {
+        const int32 parentIndex = Topology::BoneParents[boneIndex];
+        boneScales[boneIndex] = parentIndex != -1 ? boneScales[parentIndex] : 1.0f;
+
+        const int32 sourceIndex = sourceBones[boneIndex];
+        const int32 targetIndex = targetBones[boneIndex];
+        if(sourceIndex == INDEX_NONE || targetIndex == INDEX_NONE)
+        {
+            continue;
+        }
+        if(baked.SourceBones[targetIndex] != INDEX_NONE)
+        {
+            UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsRetarget %s : %s is mapped to more than one hand bone, keeping the first"),
+                   *GetName(), *targetSkeleton.GetBoneName(targetIndex).ToString());
+            continue;
+        }
+
+        // Scale the target bone so it reaches as far as the source bone towards their first child
+        if(MatchBoneLengths)
+        {
+            for(int32 childIndex = boneIndex + 1; childIndex < Topology::NumBones; ++childIndex)
+            {
+                if(Topology::BoneParents[childIndex] != boneIndex || sourceBones[childIndex] == INDEX_NONE || targetBones[childIndex] == INDEX_NONE)
+                {
+                    continue;
+                }
+
+                const float sourceLength = FVector::Dist(sourceRest[sourceBones[childIndex]].GetLocation(), sourceRest[sourceIndex].GetLocation());
+                const float targetLength = FVector::Dist(targetRest[targetBones[childIndex]].GetLocation(), targetRest[targetIndex].GetLocation());
+                if(targetLength > KINDA_SMALL_NUMBER)
+                {
+                    boneScales[boneIndex] = sourceLength / targetLength;
+                }
+                break;
+            }
+        }
+
+        const FQuat correction = sourceOffset * sourceRest[sourceIndex].GetRotation().Inverse() * targetRest[targetIndex].GetRotation();
+        baked.SourceBones[targetIndex] = boneIndex;
+        baked.Corrections[targetIndex] = FTransform(correction.GetNormalized(), FVector::ZeroVector, FVector(boneScales[boneIndex]));
+        ++baked.NumMappedBones;
+    }
+
+    if(baked.NumMappedBones == 0)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("UQuestHandsRetarget %s : No hand bones could be mapped to %s"), *GetName(), *targetMesh->GetName());
+        baked = FQHandRetargetBaked();
+        return false;
+    }
+
+    bakedMesh = targetMesh;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool UQuestHandsRetarget::CanApply(const UPoseableMeshComponent* Poseable, bool LeftHand) const
+{
+    const FQHandRetargetBaked& baked = LeftHand ? LeftBaked : RightBaked;
+    return Poseable && baked.IsValid() && Poseable->SkeletalMesh == (LeftHand ? LeftBakedMesh : RightBakedMesh) &&
+           Poseable->BoneSpaceTransforms.Num() == baked.SourceBones.Num();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void UQuestHandsRetarget::Apply(UPoseableMeshComponent* Poseable, const TArray<FTransform>& HandBones, bool LeftHand) const
+{
+    const FQHandRetargetBaked& baked = LeftHand ? LeftBaked : RightBaked;
+    TArray<FTransform>& boneSpaceTransforms = Poseable->BoneSpaceTransforms;
+    const FTransform worldToComponent = Poseable->GetComponentTransform().Inverse();
+
+    // Bones are ordered parents first, unmapped bones keep their local transform and follow their parent
+    const int32 numBones = baked.SourceBones.Num();
+    TArray<FTransform, TInlineAllocator<64>> componentSpace;
+    componentSpace.SetNumUninitialized(numBones);
+    for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+    {
+        const int32 sourceIndex = baked.SourceBones[boneIndex];
+        const int32 parentIndex = baked.ParentBones[boneIndex];
+        if(sourceIndex != INDEX_NONE && HandBones.IsValidIndex(sourceIndex))
+        {
+            componentSpace[boneIndex] = baked.Corrections[boneIndex] * HandBones[sourceIndex] * worldToComponent;
+            boneSpaceTransforms[boneIndex] = parentIndex != INDEX_NONE ? componentSpace[boneIndex].GetRelativeTransform(componentSpace[parentIndex])
+                                                                       : componentSpace[boneIndex];
+        }
+        else
+        {
+            componentSpace[boneIndex] = parentIndex != INDEX_NONE ? boneSpaceTransforms[boneIndex] * componentSpace[parentIndex] : boneSpaceTransforms[boneIndex];
+        }
+    }
+
+    Poseable->MarkRefreshTransformDirty();
+}
@@ -0,0 +1,154 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsSharedFrames.h"
+#include "QuestHands.h"
+
+namespace QuestHands
+{
+namespace SharedFrames
+{
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void WriteHand(QuestHandsShared::FHand& HandOut, const FQHandTrackingState& State, const TArray<FTransform>& Bones)
+    {
+        using namespace QuestHandsShared;
+
+        HandOut.Flags = (State.IsTracked ? HandFlag_Tracked : 0) |
+                        (State.InputValid ? HandFlag_InputValid : 0) |
+                        (State.SystemGestureInProgress ? HandFlag_SystemGesture : 0) |
+                        (State.HandConfidence == EQHandTrackingConfidence::Confidence_High ? HandFlag_HighConfidence : 0) |
+                        (Bones.Num() == NumBones ? HandFlag_BonesValid : 0);
+        HandOut.HandScale = State.HandScale;
+
+        HandOut.Pinches = 0;
+        for(uint32 fingerIndex = 0; fingerIndex < NumFingers; ++fingerIndex)
+        {
+            const bool hasPinch = State.PinchState.IsValidIndex(fingerIndex);
+            HandOut.Pinches |= (hasPinch && State.PinchState[fingerIndex].Pinched) ? (1u << fingerIndex) : 0u;
+            HandOut.PinchStrength[fingerIndex] = hasPinch ? State.PinchState[fingerIndex].Strength : 0.0f;
+        }
+
+        const FOculusPose* poses[2] = { &State.RootPose, &State.PointerPose };
+        FPose* posesOut[2] = { &HandOut.RootPose, &HandOut.PointerPose };
+        for(int32 poseIndex = 0; poseIndex < 2; ++poseIndex)
+        {
+            const FQuat& orientation = poses[poseIndex]->Orientation;
+            const FVector& position = poses[poseIndex]->Position;
+            FPose& poseOut = *posesOut[poseIndex];
+            poseOut.Orientation[0] = orientation.X; poseOut.Orientation[1] = orientation.Y; poseOut.Orientation[2] = orientation.Z; poseOut.Orientation[3] = orientation.W;
+            poseOut.Position[0] = position.X; poseOut.Position[1] = position.Y; poseOut.Position[2] = position.Z;
+            poseOut.Padding = 0.0f;
+        }
+
+        if((HandOut.Flags & HandFlag_BonesValid) == 0)
+        {
+            return;
+        }
+
+        for(uint32 boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+        {
+            const FTransform& bone = Bones[boneIndex];
+            const FQuat rotation = bone.GetRotation();
+            const FVector location = bone.GetLocation();
+            FBone& boneOut = HandOut.Bones[boneIndex];
+            boneOut.Rotation[0] = rotation.X; boneOut.Rotation[1] = rotation.Y; boneOut.Rotation[2] = rotation.Z; boneOut.Rotation[3] = rotation.W;
+            boneOut.Location[0] = location.X; boneOut.Location[1] = location.Y; boneOut.Location[2] = location.Z;
+            boneOut.Scale = bone.GetScale3D().X;
+        }
+    }
+}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FQHandSharedFrameWriter::~FQHandSharedFrameWriter()
+{
+    Close();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandSharedFrameWriter::Open(const FString& InRegionName)
+{
+    using namespace QuestHandsShared;
+
+    Close();
+
+    const uint32 access = (uint32)FPlatformMemory::ESharedMemoryAccess::Read | (uint32)FPlatformMemory::ESharedMemoryAccess::Write;
+    SharedMemory = FPlatformMemory::MapNamedSharedMemoryRegion(InRegionName, true, access, sizeof(FRegion));
+    if(!SharedMemory)
+    {
+        UE_LOG(LogQuestHands, Warning, TEXT("FQHandSharedFrameWriter unable to create the shared memory region %s!"), *InRegionName);
+        return false;
+    }
+
+    RegionName = InRegionName;
+    NumFrames = 0;
+
+    // Slots start even and empty, the header is filled in last so readers only accept a complete region
+    Region = static_cast<FRegion*>(SharedMemory->GetAddress());
+    FMemory::Memzero(Region, sizeof(FRegion));
+    Region->Header.Version = Version;
+    Region->Header.HeaderSize = sizeof(FHeader);
+    Region->Header.SlotSize = sizeof(FSlot);
+    Region->Header.NumSlots = NumSlots;
+    Region->Header.NumBones = NumBones;
+    Region->Header.ProducerActive = 1;
+    FPlatformMisc::MemoryBarrier();
+    Region->Header.Magic = Magic;
+    FPlatformMisc::MemoryBarrier();
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandSharedFrameWriter::Close()
+{
+    if(Region)
+    {
+        FPlatformAtomics::InterlockedExchange((volatile int32*)&Region->Header.ProducerActive, 0);
+        Region = nullptr;
+    }
+    if(SharedMemory)
+    {
+        FPlatformMemory::UnmapNamedSharedMemoryRegion(SharedMemory);
+        SharedMemory = nullptr;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandSharedFrameWriter::WriteFrame(double Time, const FQHandTrackingState& LeftState, const TArray<FTransform>& LeftBones,
+                                         const FQHandTrackingState& RightState, const TArray<FTransform>& RightBones)
+{
+    if(!Region)
+    {
+        return;
+    }
+
+    QuestHandsShared::FSlot& slot = Region->Slots[NumFrames % QuestHandsShared::NumSlots];
+
+    // Odd while writing. The barriers keep the frame stores between the two sequence changes and ahead of the write
+    // count on every platform, rather than relying on the exchanges ordering the plain stores around them.
+    const int32 sequence = (int32)slot.Sequence;
+    FPlatformAtomics::InterlockedExchange((volatile int32*)&slot.Sequence, sequence + 1);
+    FPlatformMisc::MemoryBarrier();
+
+    slot.Frame.FrameIndex = NumFrames + 1;
+    slot.Frame.EngineFrame = GFrameCounter;
+    slot.Frame.Time = Time;
+    QuestHands::SharedFrames::WriteHand(slot.Frame.Hands[0], LeftState, LeftBones);
+    QuestHands::SharedFrames::WriteHand(slot.Frame.Hands[1], RightState, RightBones);
+
+    FPlatformMisc::MemoryBarrier();
+    FPlatformAtomics::InterlockedExchange((volatile int32*)&slot.Sequence, sequence + 2);
+
+    ++NumFrames;
+    FPlatformMisc::MemoryBarrier();
+    FPlatformAtomics::InterlockedExchange((volatile int64*)&Region->Header.WriteCount, (int64)NumFrames);
+}
@@ -0,0 +1,8 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Quest Hands"), STATGROUP_QuestHands, STATCAT_Advanced);
+DECLARE_STATS_GROUP(TEXT("Quest Hands Memory"), STATGROUP_QuestHandsMemory, STATCAT_Advanced);
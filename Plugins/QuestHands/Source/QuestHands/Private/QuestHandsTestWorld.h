@@ -0,0 +1,169 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuestHandsComponent.h"
+#include "QuestHandsDataSource.h"
+#include "Engine/Engine.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/App.h"
+#include "Tickable.h"
+#include "UObject/UObjectGlobals.h"
+
+/**
+  * Headless game worlds ticked at a fixed rate with hands pawns driven by a data source. Shared by the load test
+  * commandlet and the automation tests, which run them with -nullrhi.
+*/
+namespace QuestHands
+{
+namespace TestWorld
+{
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * A game world which has begun play, check HasBegunPlay before using it.
+    */
+    inline UWorld* CreateTestWorld(const FString& WorldName)
+    {
+        UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, *WorldName);
+        FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+        worldContext.SetCurrentWorld(world);
+
+        world->InitializeActorsForPlay(FURL());
+        world->GetWorldSettings()->NotifyBeginPlay();
+        return world;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    inline void DestroyTestWorld(UWorld* World)
+    {
+        GEngine->DestroyWorldContext(World);
+        World->DestroyWorld(false);
+        CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Tick the world one frame, the app time the data sources sample moves on with it. The tickable objects are ticked
+      * after the world as the engine does, so the plugin subsystems such as the pool prewarm and the ghost flush run.
+    */
+    inline void AdvanceFrame(UWorld* World, float DeltaTime)
+    {
+        GFrameCounter++;
+        FApp::SetDeltaTime(DeltaTime);
+        FApp::SetCurrentTime(FApp::GetCurrentTime() + DeltaTime);
+        World->Tick(LEVELTICK_All, DeltaTime);
+        FTickableGameObject::TickObjects(World, LEVELTICK_All, false, DeltaTime);
+    }
+
+    /**
+      * Measures the wall time of the physics scene of a world, from the start of the simulation to the end of the EndPhysics
+      * tick group which waits for it. Game thread work in TG_DuringPhysics overlaps the simulation and is included when it
+      * takes longer, the test worlds keep it small.
+    */
+    class FPhysicsSceneTimer
+    {
+    public:
+        FPhysicsSceneTimer()
+            : TotalMs(0.0)
+            , StartSeconds(0.0)
+        {
+            StartTick.Timer = this;
+            EndTick.Timer = this;
+        }
+
+        ~FPhysicsSceneTimer()
+        {
+            Unregister();
+        }
+
+        void Register(UWorld* World)
+        {
+            StartTick.TickGroup = TG_StartPhysics;
+            StartTick.bCanEverTick = true;
+            StartTick.AddPrerequisite(World, World->StartPhysicsTickFunction);
+            StartTick.RegisterTickFunction(World->PersistentLevel);
+
+            EndTick.TickGroup = TG_EndPhysics;
+            EndTick.bCanEverTick = true;
+            EndTick.AddPrerequisite(World, World->EndPhysicsTickFunction);
+            EndTick.RegisterTickFunction(World->PersistentLevel);
+        }
+
+        // Unregister before destroying the world
+        void Unregister()
+        {
+            if(StartTick.IsTickFunctionRegistered())
+            {
+                StartTick.UnRegisterTickFunction();
+            }
+            if(EndTick.IsTickFunctionRegistered())
+            {
+                EndTick.UnRegisterTickFunction();
+            }
+        }
+
+        // Physics scene time of every frame since registering, in milliseconds
+        double GetTotalMs() const { return TotalMs; }
+
+    private:
+        struct FStartTick : public FTickFunction
+        {
+            FPhysicsSceneTimer* Timer = nullptr;
+
+            virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override
+            {
+                Timer->StartSeconds = FPlatformTime::Seconds();
+            }
+            virtual FString DiagnosticMessage() override { return TEXT("FPhysicsSceneTimer start"); }
+        };
+
+        struct FEndTick : public FTickFunction
+        {
+            FPhysicsSceneTimer* Timer = nullptr;
+
+            virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override
+            {
+                Timer->TotalMs += (FPlatformTime::Seconds() - Timer->StartSeconds) * 1000.0;
+            }
+            virtual FString DiagnosticMessage() override { return TEXT("FPhysicsSceneTimer end"); }
+        };
+
+        FStartTick StartTick;
+        FEndTick EndTick;
+        double TotalMs;
+        double StartSeconds;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Spawn a pawn with a hands component reading DataSource. Configure sets up the component before it begins play.
+    */
+    inline UQuestHandsComponent* SpawnHandsPawn(UWorld* World, const FVector& Location, TSharedPtr<IQuestHandsDataSource> DataSource,
+                                                TFunctionRef<void(UQuestHandsComponent*)> Configure)
+    {
+        FActorSpawnParameters spawnParams;
+        spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+        APawn* pawn = World->SpawnActor<APawn>(APawn::StaticClass(), FTransform(Location), spawnParams);
+        if(!pawn)
+        {
+            return nullptr;
+        }
+
+        // The data source has to be in place before the component begins play, which registering does for a playing actor
+        UQuestHandsComponent* handsComponent = NewObject<UQuestHandsComponent>(pawn, TEXT("QuestHands"));
+        handsComponent->SetDataSource(DataSource);
+        Configure(handsComponent);
+        pawn->SetRootComponent(handsComponent);
+        handsComponent->SetWorldLocation(Location);
+        handsComponent->RegisterComponent();
+        return handsComponent;
+    }
+}
+}
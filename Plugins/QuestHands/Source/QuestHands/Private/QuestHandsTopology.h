@@ -0,0 +1,244 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuestHandsFunctions.h"
+
+/**
+  * The Oculus hand skeleton topology known at compile time. The runtime skeleton only supplies the rest offsets of the
+  * bones, the hierarchy, names and capsule placement come from here so the hot paths can be unrolled over it.
+*/
+namespace QuestHands
+{
+namespace Topology
+{
+    static constexpr int32 NumBones = (int32)EQHandBones::Hand_PinkyTip + 1;
+
+    // The parent of each bone, bones are ordered parents first
+    static constexpr int32 BoneParents[NumBones] =
+    {
+        -1, // Hand_Wrist
+        0,  // Hand_Forearm_Stub
+        0,  // Hand_Thumb0
+        2,  // Hand_Thumb1
+        3,  // Hand_Thumb2
+        4,  // Hand_Thumb3
+        0,  // Hand_Index1
+        6,  // Hand_Index2
+        7,  // Hand_Index3
+        0,  // Hand_Middle1
+        9,  // Hand_Middle2
+        10, // Hand_Middle3
+        0,  // Hand_Ring1
+        12, // Hand_Ring2
+        13, // Hand_Ring3
+        0,  // Hand_Pinky0
+        15, // Hand_Pinky1
+        16, // Hand_Pinky2
+        17, // Hand_Pinky3
+        5,  // Hand_ThumbTip
+        8,  // Hand_IndexTip
+        11, // Hand_MiddleTip
+        14, // Hand_RingTip
+        18, // Hand_PinkyTip
+    };
+
+    // The child each bone capsule extends towards, which is the first child of the bone. -1 for bones without a capsule.
+    static constexpr int32 CapsuleChildBones[NumBones] =
+    {
+        1, -1, 3, 4, 5, 19, 7, 8, 20, 10, 11, 21, 13, 14, 22, 16, 17, 18, 23, -1, -1, -1, -1, -1
+    };
+
+    static constexpr const TCHAR* LeftBoneNames[NumBones] =
+    {
+        TEXT("b_l_wrist"), TEXT("b_l_forearm_stub"),
+        TEXT("b_l_thumb0"), TEXT("b_l_thumb1"), TEXT("b_l_thumb2"), TEXT("b_l_thumb3"),
+        TEXT("b_l_index1"), TEXT("b_l_index2"), TEXT("b_l_index3"),
+        TEXT("b_l_middle1"), TEXT("b_l_middle2"), TEXT("b_l_middle3"),
+        TEXT("b_l_ring1"), TEXT("b_l_ring2"), TEXT("b_l_ring3"),
+        TEXT("b_l_pinky0"), TEXT("b_l_pinky1"), TEXT("b_l_pinky2"), TEXT("b_l_pinky3"),
+        TEXT("l_thumb_finger_tip_marker"), TEXT("l_index_finger_tip_marker"), TEXT("l_middle_finger_tip_marker"),
+        TEXT("l_ring_finger_tip_marker"), TEXT("l_pinky_finger_tip_marker"),
+    };
+
+    static constexpr const TCHAR* RightBoneNames[NumBones] =
+    {
+        TEXT("b_r_wrist"), TEXT("b_r_forearm_stub"),
+        TEXT("b_r_thumb0"), TEXT("b_r_thumb1"), TEXT("b_r_thumb2"), TEXT("b_r_thumb3"),
+        TEXT("b_r_index1"), TEXT("b_r_index2"), TEXT("b_r_index3"),
+        TEXT("b_r_middle1"), TEXT("b_r_middle2"), TEXT("b_r_middle3"),
+        TEXT("b_r_ring1"), TEXT("b_r_ring2"), TEXT("b_r_ring3"),
+        TEXT("b_r_pinky0"), TEXT("b_r_pinky1"), TEXT("b_r_pinky2"), TEXT("b_r_pinky3"),
+        TEXT("r_thumb_finger_tip_marker"), TEXT("r_index_finger_tip_marker"), TEXT("r_middle_finger_tip_marker"),
+        TEXT("r_ring_finger_tip_marker"), TEXT("r_pinky_finger_tip_marker"),
+    };
+
+    static constexpr bool IsTopologyValid(int32 BoneIndex = 1)
+    {
+        return BoneIndex >= NumBones ? true :
+               (BoneParents[BoneIndex] >= 0 && BoneParents[BoneIndex] < BoneIndex &&
+                (CapsuleChildBones[BoneIndex] == -1 || BoneParents[CapsuleChildBones[BoneIndex]] == BoneIndex) &&
+                IsTopologyValid(BoneIndex + 1));
+    }
+
+    static constexpr bool HasCapsule(int32 BoneIndex)
+    {
+        return BoneIndex < NumBones && CapsuleChildBones[BoneIndex] != -1;
+    }
+
+    static constexpr int32 CountCapsules(int32 BoneIndex = 0)
+    {
+        return BoneIndex >= NumBones ? 0 : (HasCapsule(BoneIndex) ? 1 : 0) + CountCapsules(BoneIndex + 1);
+    }
+
+    // Number of bones with a capsule
+    static constexpr int32 NumCapsules = CountCapsules();
+
+    static_assert(BoneParents[0] == -1, "The wrist must be the root of the hand skeleton");
+    static_assert(IsTopologyValid(), "Hand bones must be ordered parents first and capsules must extend towards a child bone");
+
+    // Bone names as FNames, created once
+    inline const FName& GetBoneFName(int32 BoneIndex, bool Left)
+    {
+        struct FBoneNames
+        {
+            FName Names[2][NumBones];
+            FBoneNames()
+            {
+                for(int32 boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+                {
+                    Names[0][boneIndex] = FName(RightBoneNames[boneIndex]);
+                    Names[1][boneIndex] = FName(LeftBoneNames[boneIndex]);
+                }
+            }
+        };
+        static const FBoneNames boneNames;
+        return boneNames.Names[Left ? 1 : 0][BoneIndex];
+    }
+
+    /**
+     * Does a runtime skeleton have the compile time topology? Skeletons which don't, such as hand edited dumps or a runtime
+     * with another hierarchy, take the generic paths through their own parent indices.
+    */
+    inline bool MatchesSkeleton(const FQHandSkeleton& Skeleton)
+    {
+        if(Skeleton.Bones.Num() != NumBones)
+        {
+            return false;
+        }
+
+        for(int32 boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+        {
+            if(Skeleton.Bones[boneIndex].ParentBoneIndex != BoneParents[boneIndex])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The capsule of a bone sits between the bone and its child, rotated to lie along the bone
+    FORCEINLINE FTransform GetCapsuleTransform(const FTransform& Bone, const FTransform& ChildBone)
+    {
+        static const FQuat capsuleRotationOffset = FRotator(0.0f, 0.0f, 90.0f).Quaternion();
+        const FVector bonePos = Bone.GetLocation();
+        return FTransform(Bone.GetRotation() * capsuleRotationOffset, bonePos + (ChildBone.GetLocation() - bonePos) / 2.8f);
+    }
+
+    /**
+     * Forward kinematics over the topology, unrolled at compile time so every parent index is a constant.
+     * LocalBones are relative to their parent and WorldBones[0] must already hold the root.
+    */
+    template<int32 BoneIndex>
+    struct TSolveFK
+    {
+        static FORCEINLINE void Solve(const FTransform* LocalBones, FTransform* WorldBones)
+        {
+            FTransform::Multiply(&WorldBones[BoneIndex], &LocalBones[BoneIndex], &WorldBones[BoneParents[BoneIndex]]);
+            TSolveFK<BoneIndex + 1>::Solve(LocalBones, WorldBones);
+        }
+    };
+
+    template<>
+    struct TSolveFK<NumBones>
+    {
+        static FORCEINLINE void Solve(const FTransform* LocalBones, FTransform* WorldBones) {}
+    };
+
+    FORCEINLINE void SolveFK(const FTransform* LocalBones, FTransform* WorldBones)
+    {
+        TSolveFK<1>::Solve(LocalBones, WorldBones);
+    }
+
+    /**
+     * Forward kinematics through the parent indices of a skeleton, for skeletons not matching the topology.
+     * Bones whose parent isn't before them in the skeleton are placed relative to the root.
+    */
+    inline void SolveFKGeneric(const FQHandSkeleton& Skeleton, const FTransform* LocalBones, const FTransform& RootTransform, FTransform* WorldBones)
+    {
+        for(int32 boneIndex = 0; boneIndex < Skeleton.Bones.Num(); ++boneIndex)
+        {
+            const int32 parentIndex = Skeleton.Bones[boneIndex].ParentBoneIndex;
+            const FTransform& parentTransform = (parentIndex >= 0 && parentIndex < boneIndex) ? WorldBones[parentIndex] : RootTransform;
+            FTransform::Multiply(&WorldBones[boneIndex], &LocalBones[boneIndex], &parentTransform);
+        }
+    }
+
+    /**
+     * Capsule placement through the parent indices of a skeleton, for skeletons not matching the topology. The capsule of
+     * a bone extends towards its first child, HasCapsuleOut is false for bones without a child.
+    */
+    inline void PlaceCapsulesGeneric(const FQHandSkeleton& Skeleton, const FTransform* WorldBones, FTransform* CapsulesOut, bool* HasCapsuleOut)
+    {
+        const int32 numBones = Skeleton.Bones.Num();
+        for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+        {
+            HasCapsuleOut[boneIndex] = false;
+        }
+
+        for(int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+        {
+            const int32 parentIndex = Skeleton.Bones[boneIndex].ParentBoneIndex;
+            if(parentIndex < 0 || parentIndex >= numBones || HasCapsuleOut[parentIndex])
+                continue;
+
+            CapsulesOut[parentIndex] = GetCapsuleTransform(WorldBones[parentIndex], WorldBones[boneIndex]);
+            HasCapsuleOut[parentIndex] = true;
+        }
+    }
+
+    /**
+     * Capsule placement over the topology, unrolled at compile time. Capsules of bones without a child are left untouched.
+    */
+    template<int32 BoneIndex, bool bHasCapsule = HasCapsule(BoneIndex)>
+    struct TPlaceCapsules
+    {
+        static FORCEINLINE void Place(const FTransform* WorldBones, FTransform* CapsulesOut)
+        {
+            CapsulesOut[BoneIndex] = GetCapsuleTransform(WorldBones[BoneIndex], WorldBones[CapsuleChildBones[BoneIndex]]);
+            TPlaceCapsules<BoneIndex + 1>::Place(WorldBones, CapsulesOut);
+        }
+    };
+
+    template<int32 BoneIndex>
+    struct TPlaceCapsules<BoneIndex, false>
+    {
+        static FORCEINLINE void Place(const FTransform* WorldBones, FTransform* CapsulesOut)
+        {
+            TPlaceCapsules<BoneIndex + 1>::Place(WorldBones, CapsulesOut);
+        }
+    };
+
+    template<>
+    struct TPlaceCapsules<NumBones, false>
+    {
+        static FORCEINLINE void Place(const FTransform* WorldBones, FTransform* CapsulesOut) {}
+    };
+
+    FORCEINLINE void PlaceCapsules(const FTransform* WorldBones, FTransform* CapsulesOut)
+    {
+        TPlaceCapsules<0>::Place(WorldBones, CapsulesOut);
+    }
+}
+}
@@ -0,0 +1,98 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsWaits.h"
+#include "QuestHands.h"
+#include "QuestHandsPoseTemplates.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+bool FQHandWaitCondition::IsMet(const FQHandTrackingState& TrackingState) const
+{
+    switch(Condition)
+    {
+        case EQHandWaitCondition::WaitCondition_Tracked:
+            return TrackingState.IsTracked;
+        case EQHandWaitCondition::WaitCondition_Untracked:
+            return !TrackingState.IsTracked;
+        case EQHandWaitCondition::WaitCondition_Pinched:
+        case EQHandWaitCondition::WaitCondition_Released:
+        {
+            const bool pinched = TrackingState.InputValid &&
+                                 TrackingState.PinchState.IsValidIndex((int32)Finger) && TrackingState.PinchState[(int32)Finger].Pinched;
+            return pinched == (Condition == EQHandWaitCondition::WaitCondition_Pinched);
+        }
+        case EQHandWaitCondition::WaitCondition_Pose:
+        {
+            float distance;
+            return PoseTemplates && PoseTemplates->FindClosestTemplate(Hand, TrackingState, distance) == PoseIndex;
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+FQHandWaitTask::FQHandWaitTask(const FQHandWaitCondition& InCondition, TFunction<void(bool)> InOnDone)
+    : Condition(InCondition)
+    , OnDone(MoveTemp(InOnDone))
+    , MetSince(-1.0)
+    , State(EState::Waiting)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandWaitTask::Cancel()
+{
+    Finish(EState::Cancelled);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandWaitTask::Update(const FQHandTrackingState& TrackingState, double Time)
+{
+    if(IsDone())
+    {
+        return;
+    }
+
+    if(!Condition.IsMet(TrackingState))
+    {
+        MetSince = -1.0;
+        return;
+    }
+
+    if(MetSince < 0.0)
+    {
+        MetSince = Time;
+    }
+    if(Time - MetSince >= Condition.HoldTime)
+    {
+        Finish(EState::Met);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+*/
+void FQHandWaitTask::Finish(EState InState)
+{
+    if(IsDone())
+    {
+        return;
+    }
+
+    State = InState;
+
+    // The callback may start another wait or drop the last reference to this one, so release it before calling
+    TFunction<void(bool)> onDone = MoveTemp(OnDone);
+    OnDone = nullptr;
+    if(onDone)
+    {
+        onDone(State == EState::Met);
+    }
+}
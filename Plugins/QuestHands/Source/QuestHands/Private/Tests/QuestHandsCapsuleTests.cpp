@@ -0,0 +1,200 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsTestWorld.h"
+#include "Misc/AutomationTest.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace CapsuleTests
+{
+    // A fast real hand swipe, in world units per second, back and forth across a pane this far either side of it
+    static constexpr float SwipeSpeed = 1000.0f;
+    static constexpr float SwipeHalfWidth = 30.0f;
+
+    // The pane the right hand swipes through, thicker than a substep of the swipe but much thinner than a frame of it
+    static const FVector PaneLocation(50.0f, 0.0f, 40.0f);
+    static const FVector PaneExtent(15.0f, 1.5f, 10.0f);
+
+    static constexpr float FrameRate = 72.0f;
+    static constexpr int32 WarmupFrames = 10;
+    static constexpr int32 TestFrames = 360;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Side to side offset of the swipe at a time, a triangle wave at a constant speed
+    */
+    static float GetSwipeOffset(double Time)
+    {
+        const float phase = FMath::Fmod((float)Time * SwipeSpeed, 4.0f * SwipeHalfWidth);
+        return phase < 2.0f * SwipeHalfWidth ? phase - SwipeHalfWidth : 3.0f * SwipeHalfWidth - phase;
+    }
+
+    // The synthetic hands held flat and always tracked, the right hand swiping through the pane and the left hand well away from it
+    class FSwipeDataSource : public FQHandSyntheticDataSource
+    {
+    public:
+        FSwipeDataSource()
+            : FQHandSyntheticDataSource(0)
+        {}
+
+        virtual bool GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters) override
+        {
+            FQHandSyntheticDataSource::GetTrackingState(Hand, Step, StateOut, WorldToMeters);
+            StateOut.IsTracked = true;
+            StateOut.InputValid = true;
+            StateOut.RootPose.Orientation = FQuat::Identity;
+            StateOut.RootPose.Position = Hand == EControllerHand::Right ? FVector(40.0f, GetSwipeOffset(FApp::GetCurrentTime()), PaneLocation.Z) :
+                                                                           FVector(40.0f, 0.0f, -200.0f);
+            return true;
+        }
+    };
+
+    struct FTunnellingResult
+    {
+        int32 Crossings = 0;
+        int32 Missed = 0;
+
+        float GetRate() const { return Crossings > 0 ? (float)Missed / Crossings : 0.0f; }
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Swipe the right hand through a free floating pane and count the crossings which didn't push it
+    */
+    static bool RunSwipe(bool Substepping, float CapsuleUpdateRate, FTunnellingResult& ResultOut)
+    {
+        using namespace TestWorld;
+
+        ResultOut = FTunnellingResult();
+
+        UPhysicsSettings* physicsSettings = UPhysicsSettings::Get();
+        const bool previousSubstepping = physicsSettings->bSubstepping;
+        const float previousMaxSubstepDeltaTime = physicsSettings->MaxSubstepDeltaTime;
+        const int32 previousMaxSubsteps = physicsSettings->MaxSubsteps;
+        const double previousTime = FApp::GetCurrentTime();
+        physicsSettings->bSubstepping = Substepping;
+        physicsSettings->MaxSubstepDeltaTime = 1.0f / 300.0f;
+        physicsSettings->MaxSubsteps = 8;
+        FApp::SetCurrentTime(0.0);
+
+        bool success = false;
+        UWorld* world = CreateTestWorld(TEXT("QuestHandsTunnellingTest"));
+        UQuestHandsComponent* handsComponent = nullptr;
+        if(world->HasBegunPlay())
+        {
+            handsComponent = SpawnHandsPawn(world, FVector::ZeroVector, MakeShared<FSwipeDataSource>(), [CapsuleUpdateRate](UQuestHandsComponent* component)
+            {
+                component->CreateHandMeshComponents = false;
+                component->UsePooledComponents = false;
+                component->UseUpdateLOD = false;
+                component->UseGovernor = false;
+                component->CapsuleUpdateRate = CapsuleUpdateRate;
+                component->CapsuleBodyData.SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+            });
+        }
+
+        AActor* paneActor = handsComponent ? world->SpawnActor<AActor>() : nullptr;
+        if(paneActor)
+        {
+            UBoxComponent* pane = NewObject<UBoxComponent>(paneActor, TEXT("Pane"));
+            pane->SetBoxExtent(PaneExtent);
+            pane->SetCollisionProfileName(UCollisionProfile::PhysicsActor_ProfileName);
+            pane->BodyInstance.bSimulatePhysics = true;
+            pane->BodyInstance.bEnableGravity = false;
+            paneActor->SetRootComponent(pane);
+            pane->SetWorldLocation(PaneLocation);
+            pane->RegisterComponent();
+
+            const float deltaTime = 1.0f / FrameRate;
+            for(int32 frame = 0; frame < WarmupFrames; ++frame)
+            {
+                AdvanceFrame(world, deltaTime);
+            }
+
+            // A crossing counts as touched if the pane was pushed any time before the hand crosses back
+            bool touched = true;
+            for(int32 frame = 0; frame < TestFrames; ++frame)
+            {
+                const float previousOffset = GetSwipeOffset(FApp::GetCurrentTime());
+                AdvanceFrame(world, deltaTime);
+                const float offset = GetSwipeOffset(FApp::GetCurrentTime());
+
+                if(FMath::Sign(previousOffset) != FMath::Sign(offset))
+                {
+                    ResultOut.Missed += touched ? 0 : 1;
+                    ++ResultOut.Crossings;
+                    touched = false;
+                }
+
+                if(pane->GetPhysicsLinearVelocity().SizeSquared() > 1.0f || !pane->GetComponentLocation().Equals(PaneLocation, 0.1f))
+                {
+                    touched = true;
+                    pane->SetWorldLocationAndRotation(PaneLocation, FQuat::Identity, false, nullptr, ETeleportType::ResetPhysics);
+                    pane->SetPhysicsLinearVelocity(FVector::ZeroVector);
+                    pane->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+                }
+            }
+
+            // The last crossing may not have had the frames to push the pane yet
+            success = ResultOut.Crossings > 1;
+            if(success && !touched)
+            {
+                --ResultOut.Crossings;
+            }
+        }
+
+        DestroyTestWorld(world);
+
+        physicsSettings->bSubstepping = previousSubstepping;
+        physicsSettings->MaxSubstepDeltaTime = previousMaxSubstepDeltaTime;
+        physicsSettings->MaxSubsteps = previousMaxSubsteps;
+        FApp::SetCurrentTime(previousTime);
+        return success;
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsCapsuleTunnellingTest, "QuestHands.Capsules.Tunnelling", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Fast swipes against a pane thinner than a frame of the swipe. With substepping the capsules are moved along the path
+  * to their one kinematic target per physics tick, so the pane is pushed by every crossing. Without substepping the
+  * capsules jump a frame at a time and mostly pass through it, which is reported for comparison.
+*/
+bool FQuestHandsCapsuleTunnellingTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::CapsuleTests;
+
+    FTunnellingResult frameResult;
+    if(!RunSwipe(false, 0.0f, frameResult))
+    {
+        AddError(TEXT("The swipe didn't run, the test world or the hands pawn couldn't be set up"));
+        return false;
+    }
+    AddInfo(FString::Printf(TEXT("Without substepping %d of %d crossings tunnelled (%.0f%%)"), frameResult.Missed, frameResult.Crossings, frameResult.GetRate() * 100.0f));
+
+    // Once per physics tick, and at a fixed rate above the frame rate
+    const float capsuleUpdateRates[] = { 0.0f, 120.0f };
+    for(float capsuleUpdateRate : capsuleUpdateRates)
+    {
+        FTunnellingResult substepResult;
+        if(!RunSwipe(true, capsuleUpdateRate, substepResult))
+        {
+            AddError(TEXT("The swipe didn't run, the test world or the hands pawn couldn't be set up"));
+            return false;
+        }
+
+        AddInfo(FString::Printf(TEXT("Substepping at capsule update rate %.0f: %d of %d crossings tunnelled (%.0f%%)"),
+                                capsuleUpdateRate, substepResult.Missed, substepResult.Crossings, substepResult.GetRate() * 100.0f));
+        TestTrue(FString::Printf(TEXT("Tunnelling rate with substepping at capsule update rate %.0f"), capsuleUpdateRate), substepResult.GetRate() <= 0.05f);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,239 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuestHandsPoseConversion.h"
+
+/**
+  * A right hand state and skeleton in the layouts the runtime returns them, ovrpHandState and ovrpSkeleton, and the
+  * Unreal values FOculusHMD::ConvertPose_Internal, OculusHMD::ToFQuat and OculusHMD::ToFVector make of them. The
+  * expected values were worked out apart from the plugin, so the conversion is checked against fixed numbers rather
+  * than against itself. The raw orientations aren't quite unit length, as the runtime's aren't.
+*/
+namespace QuestHands
+{
+namespace CapturedHand
+{
+    static const FRawHandState HandState =
+    {
+        // Status, tracked and input valid
+        0x3,
+        // RootPose
+        { { -0.330226f, -0.0661473f, -0.296968f, 0.897999f }, { 0.18f, 1.21f, -0.32f } },
+        // BoneRotations
+        {
+            { -0.25422f, 0.171915f, 0.0959391f, 0.946897f },
+            { 0.25145f, 0.0724794f, 0.0518427f, 0.963759f },
+            { -0.142688f, -0.205587f, -0.0435888f, 0.967199f },
+            { 0.39576f, -0.336448f, -0.147347f, 0.841704f },
+            { 0.228603f, 0.306468f, 0.357102f, 0.85223f },
+            { -0.0941528f, 0.0866561f, -0.13925f, 0.981955f },
+            { 0.0797895f, -0.151301f, -0.0103691f, 0.985208f },
+            { -0.370077f, -0.0949829f, 0.16936f, 0.908481f },
+            { -0.000110242f, -0.115356f, 0.444568f, 0.888286f },
+            { 0.0213688f, 0.0188272f, -0.156383f, 0.987286f },
+            { -0.0508781f, 0.0541465f, 0.04026f, 0.996423f },
+            { 0.195486f, -0.127376f, 0.166039f, 0.958119f },
+            { -0.0874479f, -0.216376f, -0.155986f, 0.959793f },
+            { 0.291495f, -0.458599f, -0.0808923f, 0.835568f },
+            { -0.291461f, -0.0680814f, 0.260497f, 0.917909f },
+            { 0.163825f, 0.0379101f, 0.0534762f, 0.984309f },
+            { -0.0983182f, 0.0262222f, 0.392759f, 0.913995f },
+            { -0.132865f, 0.394953f, 0.118365f, 0.901304f },
+            { -0.221607f, -0.161321f, 0.0658096f, 0.959445f },
+            { -0.149312f, 0.256608f, 0.282144f, 0.912279f },
+            { 0.105565f, 0.049269f, -0.00982437f, 0.993143f },
+            { 0.0693567f, 0.429169f, 0.0752655f, 0.897407f },
+            { -0.0595921f, -0.229073f, 0.00553166f, 0.971568f },
+            { 0.0527591f, 0.378791f, 0.360057f, 0.850936f }
+        },
+        // Pinches, thumb and index
+        0x3,
+        // PinchStrength
+        { 0.92f, 0.87f, 0.12f, 0.03f, 0.0f },
+        // PointerPose
+        { { 0.00771715f, -0.307949f, -0.311276f, 0.89567f }, { 0.15f, 1.25f, -0.36f } },
+        // HandScale
+        1.031f,
+        // HandConfidence, high
+        0x3f800000,
+        // FingerConfidences
+        { 0x3f800000, 0x3f800000, 0x3f800000, 0x3f800000, 0 },
+        // RequestedTimeStamp, SampleTimeStamp
+        1843.102671, 1843.091558
+    };
+
+    static const FRawSkeleton Skeleton =
+    {
+        // Type, right hand
+        1,
+        // NumBones, NumBoneCapsules
+        24, 18,
+        // Bones
+        {
+            { 0, -1, { { 0.502367f, 0.0910551f, 0.13113f, 0.849789f }, { 0.0f, 0.0f, 0.0f } } },
+            { 1, 0, { { -0.027439f, 0.269584f, 0.221826f, 0.936678f }, { -0.0393291f, -0.00933205f, 0.0223351f } } },
+            { 2, 0, { { -0.225443f, -0.35781f, -0.262038f, 0.867458f }, { 0.036187f, 0.00446577f, 0.0445005f } } },
+            { 3, 2, { { -0.170651f, -0.393775f, 0.141666f, 0.892048f }, { 0.0305272f, 0.001845f, 0.0245885f } } },
+            { 4, 3, { { -0.0207195f, -0.0412868f, -0.0555838f, 0.997385f }, { 0.0286855f, 0.00209425f, 0.029362f } } },
+            { 5, 4, { { 0.181467f, 0.00385117f, -0.0866451f, 0.979565f }, { -0.0300795f, 0.00834176f, 0.0352216f } } },
+            { 6, 0, { { 0.0631646f, -0.13813f, 0.0488184f, 0.987192f }, { -0.00244815f, 0.00281783f, 0.028824f } } },
+            { 7, 6, { { -0.244747f, -0.418094f, 0.204293f, 0.850624f }, { -0.0299437f, 0.00649307f, 0.0426601f } } },
+            { 8, 7, { { -0.115292f, -0.196523f, 0.0869593f, 0.969806f }, { -0.0322719f, 0.00906106f, 0.0431176f } } },
+            { 9, 0, { { -0.0292112f, 0.0104468f, 0.0786027f, 0.996423f }, { -0.017988f, 0.00949395f, 0.0239479f } } },
+            { 10, 9, { { -0.119672f, -0.0233595f, -0.100465f, 0.987441f }, { -0.0345024f, -0.00830761f, 0.0273439f } } },
+            { 11, 10, { { -0.189768f, -0.200728f, -0.0205964f, 0.96087f }, { 0.00440423f, -0.0064245f, 0.0287873f } } },
+            { 12, 0, { { -0.376544f, 0.224505f, 0.130154f, 0.88931f }, { 0.0113932f, 0.00830947f, 0.0423713f } } },
+            { 13, 12, { { 0.0913332f, -0.0854837f, -0.0714656f, 0.989567f }, { -0.0390891f, -0.00433948f, 0.0477104f } } },
+            { 14, 13, { { -0.00526344f, 0.143194f, 0.100428f, 0.984572f }, { -0.0134994f, 0.00856045f, 0.0312376f } } },
+            { 15, 0, { { -0.035634f, 0.513654f, -0.0204132f, 0.857014f }, { 0.0109466f, -0.00397645f, 0.0258147f } } },
+            { 16, 15, { { -0.34516f, 0.311037f, -0.0656624f, 0.883068f }, { -0.00047605f, -0.00791464f, 0.0490341f } } },
+            { 17, 16, { { -0.13861f, -0.135746f, -0.124539f, 0.973062f }, { 0.038619f, -0.00638856f, 0.0483253f } } },
+            { 18, 17, { { 0.00307035f, -0.000801222f, -0.099609f, 0.995022f }, { 0.001783f, -0.00574215f, 0.0417913f } } },
+            { 19, 5, { { -0.00365695f, -0.284088f, -0.0164579f, 0.95865f }, { 0.0164368f, 0.00639233f, 0.0490774f } } },
+            { 20, 8, { { -0.127981f, 0.023056f, -0.144638f, 0.980902f }, { 0.00145782f, 0.000464523f, 0.0309581f } } },
+            { 21, 11, { { 0.0449001f, -0.333316f, 0.00853683f, 0.941707f }, { -0.017333f, 0.00383444f, 0.0379135f } } },
+            { 22, 14, { { -0.29886f, -0.276262f, -0.163342f, 0.898711f }, { 0.0175112f, 0.00355732f, 0.0358462f } } },
+            { 23, 18, { { 0.293002f, -0.036418f, -0.15354f, 0.943f }, { -0.0252838f, -0.00294206f, 0.0418993f } } }
+        },
+        // BoneCapsules
+        {
+            { 0, { { 0.0f, 0.0f, 0.0f }, { -0.0393291f, -0.00933205f, 0.0223351f } }, 0.008558f },
+            { 2, { { 0.0f, 0.0f, 0.0f }, { 0.0305272f, 0.001845f, 0.0245885f } }, 0.0104194f },
+            { 3, { { 0.0f, 0.0f, 0.0f }, { 0.0286855f, 0.00209425f, 0.029362f } }, 0.0109466f },
+            { 4, { { 0.0f, 0.0f, 0.0f }, { -0.0300795f, 0.00834176f, 0.0352216f } }, 0.00646519f },
+            { 5, { { 0.0f, 0.0f, 0.0f }, { 0.0164368f, 0.00639233f, 0.0490774f } }, 0.00652753f },
+            { 6, { { 0.0f, 0.0f, 0.0f }, { -0.0299437f, 0.00649307f, 0.0426601f } }, 0.0092193f },
+            { 7, { { 0.0f, 0.0f, 0.0f }, { -0.0322719f, 0.00906106f, 0.0431176f } }, 0.00887766f },
+            { 8, { { 0.0f, 0.0f, 0.0f }, { 0.00145782f, 0.000464523f, 0.0309581f } }, 0.00959807f },
+            { 9, { { 0.0f, 0.0f, 0.0f }, { -0.0345024f, -0.00830761f, 0.0273439f } }, 0.00683473f },
+            { 10, { { 0.0f, 0.0f, 0.0f }, { 0.00440423f, -0.0064245f, 0.0287873f } }, 0.00695474f },
+            { 11, { { 0.0f, 0.0f, 0.0f }, { -0.017333f, 0.00383444f, 0.0379135f } }, 0.0056978f },
+            { 12, { { 0.0f, 0.0f, 0.0f }, { -0.0390891f, -0.00433948f, 0.0477104f } }, 0.00700829f },
+            { 13, { { 0.0f, 0.0f, 0.0f }, { -0.0134994f, 0.00856045f, 0.0312376f } }, 0.00894765f },
+            { 14, { { 0.0f, 0.0f, 0.0f }, { 0.0175112f, 0.00355732f, 0.0358462f } }, 0.00592391f },
+            { 15, { { 0.0f, 0.0f, 0.0f }, { -0.00047605f, -0.00791464f, 0.0490341f } }, 0.0119525f },
+            { 16, { { 0.0f, 0.0f, 0.0f }, { 0.038619f, -0.00638856f, 0.0483253f } }, 0.00648751f },
+            { 17, { { 0.0f, 0.0f, 0.0f }, { 0.001783f, -0.00574215f, 0.0417913f } }, 0.0103394f },
+            { 18, { { 0.0f, 0.0f, 0.0f }, { -0.0252838f, -0.00294206f, 0.0418993f } }, 0.00750781f }
+        }
+    };
+
+    // The base the hand state is converted with
+    static const FQuat BaseOrientation(0.0f, 0.0f, 0.707107f, 0.707107f);
+    static const FVector BaseOffset(0.1f, -0.2f, 0.05f);
+    static constexpr float WorldToMeters = 100.0f;
+
+    static const FQuat ExpectedRootOrientation = FQuat(-0.023423f, -0.441726f, 0.585864f, -0.679038f);
+    static const FVector ExpectedRootPosition = FVector(38.000024f, -22.000014f, 116.000072f);
+    static const FQuat ExpectedPointerOrientation = FQuat(0.226241f, -0.215294f, 0.416832f, -0.853648f);
+    static const FVector ExpectedPointerPosition = FVector(35.000022f, -26.000016f, 120.000074f);
+
+    static const FQuat ExpectedBoneRotations[24] =
+    {
+        FQuat(-0.095939f, -0.25422f, 0.171915f, -0.946897f),
+        FQuat(-0.051843f, 0.25145f, 0.072479f, -0.963759f),
+        FQuat(0.043589f, -0.142688f, -0.205587f, -0.967199f),
+        FQuat(0.147347f, 0.39576f, -0.336448f, -0.841704f),
+        FQuat(-0.357102f, 0.228603f, 0.306468f, -0.85223f),
+        FQuat(0.13925f, -0.094153f, 0.086656f, -0.981955f),
+        FQuat(0.010369f, 0.079789f, -0.151301f, -0.985208f),
+        FQuat(-0.16936f, -0.370077f, -0.094983f, -0.908481f),
+        FQuat(-0.444568f, -0.00011f, -0.115356f, -0.888286f),
+        FQuat(0.156383f, 0.021369f, 0.018827f, -0.987286f),
+        FQuat(-0.04026f, -0.050878f, 0.054147f, -0.996423f),
+        FQuat(-0.166039f, 0.195486f, -0.127376f, -0.958119f),
+        FQuat(0.155986f, -0.087448f, -0.216376f, -0.959793f),
+        FQuat(0.080892f, 0.291495f, -0.458599f, -0.835568f),
+        FQuat(-0.260497f, -0.291461f, -0.068081f, -0.917909f),
+        FQuat(-0.053476f, 0.163825f, 0.03791f, -0.984309f),
+        FQuat(-0.392759f, -0.098318f, 0.026222f, -0.913995f),
+        FQuat(-0.118365f, -0.132865f, 0.394953f, -0.901304f),
+        FQuat(-0.06581f, -0.221607f, -0.161321f, -0.959445f),
+        FQuat(-0.282144f, -0.149312f, 0.256608f, -0.912279f),
+        FQuat(0.009824f, 0.105565f, 0.049269f, -0.993143f),
+        FQuat(-0.075265f, 0.069357f, 0.429169f, -0.897407f),
+        FQuat(-0.005532f, -0.059592f, -0.229073f, -0.971568f),
+        FQuat(-0.360057f, 0.052759f, 0.378791f, -0.850936f)
+    };
+
+    static const FQuat ExpectedSkeletonOrientations[24] =
+    {
+        FQuat(-0.13113f, 0.502367f, 0.091055f, -0.849789f),
+        FQuat(-0.221826f, -0.027439f, 0.269584f, -0.936678f),
+        FQuat(0.262038f, -0.225443f, -0.35781f, -0.867458f),
+        FQuat(-0.141666f, -0.170651f, -0.393775f, -0.892048f),
+        FQuat(0.055584f, -0.020719f, -0.041287f, -0.997385f),
+        FQuat(0.086645f, 0.181467f, 0.003851f, -0.979565f),
+        FQuat(-0.048818f, 0.063165f, -0.13813f, -0.987192f),
+        FQuat(-0.204293f, -0.244747f, -0.418094f, -0.850624f),
+        FQuat(-0.086959f, -0.115292f, -0.196523f, -0.969806f),
+        FQuat(-0.078603f, -0.029211f, 0.010447f, -0.996423f),
+        FQuat(0.100465f, -0.119672f, -0.02336f, -0.987441f),
+        FQuat(0.020596f, -0.189768f, -0.200728f, -0.96087f),
+        FQuat(-0.130154f, -0.376544f, 0.224505f, -0.88931f),
+        FQuat(0.071466f, 0.091333f, -0.085484f, -0.989567f),
+        FQuat(-0.100428f, -0.005263f, 0.143194f, -0.984572f),
+        FQuat(0.020413f, -0.035634f, 0.513654f, -0.857014f),
+        FQuat(0.065662f, -0.34516f, 0.311037f, -0.883068f),
+        FQuat(0.124539f, -0.13861f, -0.135746f, -0.973062f),
+        FQuat(0.099609f, 0.00307f, -0.000801f, -0.995022f),
+        FQuat(0.016458f, -0.003657f, -0.284088f, -0.95865f),
+        FQuat(0.144638f, -0.127981f, 0.023056f, -0.980902f),
+        FQuat(-0.008537f, 0.0449f, -0.333316f, -0.941707f),
+        FQuat(0.163342f, -0.29886f, -0.276262f, -0.898711f),
+        FQuat(0.15354f, 0.293002f, -0.036418f, -0.943f)
+    };
+
+    static const FVector ExpectedSkeletonPositions[24] =
+    {
+        FVector(0.0f, 0.0f, 0.0f),
+        FVector(-2.23351f, -3.93291f, -0.933205f),
+        FVector(-4.45005f, 3.6187f, 0.446577f),
+        FVector(-2.45885f, 3.05272f, 0.1845f),
+        FVector(-2.9362f, 2.86855f, 0.209425f),
+        FVector(-3.52216f, -3.00795f, 0.834176f),
+        FVector(-2.8824f, -0.244815f, 0.281783f),
+        FVector(-4.26601f, -2.99437f, 0.649307f),
+        FVector(-4.31176f, -3.22719f, 0.906106f),
+        FVector(-2.39479f, -1.7988f, 0.949395f),
+        FVector(-2.73439f, -3.45024f, -0.830761f),
+        FVector(-2.87873f, 0.440423f, -0.64245f),
+        FVector(-4.23713f, 1.13932f, 0.830947f),
+        FVector(-4.77104f, -3.90891f, -0.433948f),
+        FVector(-3.12376f, -1.34994f, 0.856045f),
+        FVector(-2.58147f, 1.09466f, -0.397645f),
+        FVector(-4.90341f, -0.047605f, -0.791464f),
+        FVector(-4.83253f, 3.8619f, -0.638856f),
+        FVector(-4.17913f, 0.1783f, -0.574215f),
+        FVector(-4.90774f, 1.64368f, 0.639233f),
+        FVector(-3.09581f, 0.145782f, 0.046452f),
+        FVector(-3.79135f, -1.7333f, 0.383444f),
+        FVector(-3.58462f, 1.75112f, 0.355732f),
+        FVector(-4.18993f, -2.52838f, -0.294206f)
+    };
+
+    static const FVector ExpectedCapsuleEnds[18] =
+    {
+        FVector(-0.022335f, -0.039329f, -0.009332f),
+        FVector(-0.024588f, 0.030527f, 0.001845f),
+        FVector(-0.029362f, 0.028685f, 0.002094f),
+        FVector(-0.035222f, -0.030079f, 0.008342f),
+        FVector(-0.049077f, 0.016437f, 0.006392f),
+        FVector(-0.04266f, -0.029944f, 0.006493f),
+        FVector(-0.043118f, -0.032272f, 0.009061f),
+        FVector(-0.030958f, 0.001458f, 0.000465f),
+        FVector(-0.027344f, -0.034502f, -0.008308f),
+        FVector(-0.028787f, 0.004404f, -0.006424f),
+        FVector(-0.037914f, -0.017333f, 0.003834f),
+        FVector(-0.04771f, -0.039089f, -0.004339f),
+        FVector(-0.031238f, -0.013499f, 0.00856f),
+        FVector(-0.035846f, 0.017511f, 0.003557f),
+        FVector(-0.049034f, -0.000476f, -0.007915f),
+        FVector(-0.048325f, 0.038619f, -0.006389f),
+        FVector(-0.041791f, 0.001783f, -0.005742f),
+        FVector(-0.041899f, -0.025284f, -0.002942f)
+    };
+}
+}
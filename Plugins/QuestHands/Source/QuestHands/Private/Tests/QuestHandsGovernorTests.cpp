@@ -0,0 +1,142 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsTestWorld.h"
+#include "QuestHandsGovernorSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace GovernorTests
+{
+    static constexpr float FrameRate = 72.0f;
+
+    // Simulated seconds the governor runs for, long enough for several lower delays
+    static constexpr float TestSeconds = 30.0f;
+
+    // The level has to have settled for this long at the end of the run
+    static constexpr float SettledSeconds = 15.0f;
+
+    // Frame and hands time of each governor level. Every step saves hands time, level 1 leaves enough headroom under the
+    // band that a governor ignoring the hands time would step back to level 0 and then straight up again.
+    static constexpr float LevelFrameTimes[] = { 16.0f, 10.5f, 9.5f, 9.0f };
+    static constexpr float LevelHandsTimes[] = { 6.0f, 0.5f, 0.3f, 0.2f };
+
+    // Frame timings of the current governor level and a record of the foveation applied
+    class FFakePerformancePlatform : public IQuestHandsPerformancePlatform
+    {
+    public:
+        FFakePerformancePlatform(const UQuestHandsGovernorSubsystem* InGovernor)
+            : Governor(InGovernor)
+        {}
+
+        virtual float GetFrameTimeMs() const override
+        {
+            return LevelFrameTimes[FMath::Clamp(Governor->GetLevel(), 0, (int32)UE_ARRAY_COUNT(LevelFrameTimes) - 1)];
+        }
+
+        virtual bool SetFoveationLevel(int32 Level) override
+        {
+            FoveationLevels.Add(Level);
+            return true;
+        }
+
+        const UQuestHandsGovernorSubsystem* Governor;
+        TArray<int32> FoveationLevels;
+    };
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsGovernorConvergenceTest, "QuestHands.Governor.Convergence", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * The governor against simulated timings, ticked headless. It has to be off until enabled and leave the foveation
+  * alone while off, even when a level is forced. Enabled it has to step down from the over budget level 0, settle on
+  * the first level within budget without stepping back and forth, and apply the foveation of every level it steps to
+  * but not of level 0, which leaves the foveation to the project.
+*/
+bool FQuestHandsGovernorConvergenceTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::GovernorTests;
+    using namespace QuestHands::TestWorld;
+
+    UWorld* world = CreateTestWorld(TEXT("QuestHandsGovernorTest"));
+    UQuestHandsGovernorSubsystem* governor = world->GetSubsystem<UQuestHandsGovernorSubsystem>();
+    if(!governor)
+    {
+        AddError(TEXT("The test world has no governor"));
+        DestroyTestWorld(world);
+        return false;
+    }
+
+    TestFalse(TEXT("The governor is enabled by default"), governor->Enabled);
+    TestEqual(TEXT("Level 0 foveation"), governor->Levels[0].FoveationLevel, -1);
+
+    TSharedRef<FFakePerformancePlatform> platform = MakeShared<FFakePerformancePlatform>(governor);
+    governor->SetPlatform(platform);
+    governor->TargetFrameTime = 1000.0f / FrameRate;
+
+    // Disabled, neither ticking nor a forced level touch the foveation
+    const float deltaTime = 1.0f / FrameRate;
+    for(int32 frame = 0; frame < FMath::RoundToInt(FrameRate); ++frame)
+    {
+        governor->Tick(deltaTime);
+    }
+    governor->SetLevel(2);
+    TestEqual(TEXT("Forced level while disabled"), governor->GetLevel(), 2);
+    TestEqual(TEXT("Foveation changes while disabled"), platform->FoveationLevels.Num(), 0);
+    governor->SetLevel(0);
+
+    governor->Enabled = true;
+
+    TArray<int32> levelChanges;
+    const int32 numFrames = FMath::RoundToInt(TestSeconds * FrameRate);
+    const int32 settledFrame = numFrames - FMath::RoundToInt(SettledSeconds * FrameRate);
+    int32 settledLevel = INDEX_NONE;
+    bool settled = true;
+    for(int32 frame = 0; frame < numFrames; ++frame)
+    {
+        // The world isn't ticked, the hands components are simulated by the time they report
+        const int32 previousLevel = governor->GetLevel();
+        governor->ReportHandsWork(LevelHandsTimes[previousLevel], EQHandUpdateStep::UpdateStep_Render);
+        governor->Tick(deltaTime);
+
+        if(governor->GetLevel() != previousLevel)
+        {
+            levelChanges.Add(governor->GetLevel());
+        }
+        if(frame == settledFrame)
+        {
+            settledLevel = governor->GetLevel();
+        }
+        else if(frame > settledFrame && governor->GetLevel() != settledLevel)
+        {
+            settled = false;
+        }
+    }
+
+    FString changes;
+    for(int32 level : levelChanges)
+    {
+        changes += FString::Printf(TEXT(" %d"), level);
+    }
+    AddInfo(FString::Printf(TEXT("Level changes:%s"), *changes));
+
+    TestEqual(TEXT("Settled level"), governor->GetLevel(), 1);
+    TestTrue(TEXT("The level stayed put at the end of the run"), settled);
+    TestEqual(TEXT("Level changes"), levelChanges.Num(), 1);
+
+    const FQHandGovernorLevel& finalLevel = governor->Levels[governor->GetLevel()];
+    if(TestEqual(TEXT("Foveation changes"), platform->FoveationLevels.Num(), 1))
+    {
+        TestEqual(TEXT("Settled foveation"), platform->FoveationLevels[0], finalLevel.FoveationLevel);
+    }
+
+    governor->SetPlatform(nullptr);
+    DestroyTestWorld(world);
+    return true;
+}
+
+#endif
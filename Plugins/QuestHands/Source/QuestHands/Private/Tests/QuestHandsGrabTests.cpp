@@ -0,0 +1,126 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsTestWorld.h"
+#include "QuestHandsGrabSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace GrabTests
+{
+    struct FTestInteractable
+    {
+        USceneComponent* Component;
+        float Radius;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * The interactables within SearchRadius of any probe point, by testing every one of them
+    */
+    static TSet<USceneComponent*> FindBruteForce(const TArray<FTestInteractable>& Interactables, const TArray<FVector>& ProbePoints, float SearchRadius)
+    {
+        TSet<USceneComponent*> found;
+        for(const FTestInteractable& interactable : Interactables)
+        {
+            for(const FVector& probePoint : ProbePoints)
+            {
+                if(FVector::Dist(probePoint, interactable.Component->GetComponentLocation()) - interactable.Radius <= SearchRadius)
+                {
+                    found.Add(interactable.Component);
+                    break;
+                }
+            }
+        }
+        return found;
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsGrabIndexTest, "QuestHands.Grab.SpatialIndex", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Grab candidate queries against a brute force search, with interactables too large for the hash, interactables moving
+  * between cells and search radii from nothing to far beyond the cells.
+*/
+bool FQuestHandsGrabIndexTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::GrabTests;
+    using namespace QuestHands::TestWorld;
+
+    UWorld* world = CreateTestWorld(TEXT("QuestHandsGrabTest"));
+    UQuestHandsGrabSubsystem* grab = world->GetSubsystem<UQuestHandsGrabSubsystem>();
+    AActor* actor = world->HasBegunPlay() ? world->SpawnActor<AActor>() : nullptr;
+    if(!grab || !actor)
+    {
+        AddError(TEXT("The test world couldn't be set up"));
+        DestroyTestWorld(world);
+        return false;
+    }
+
+    FRandomStream random(1234);
+    auto randomPoint = [&random]()
+    {
+        return FVector(random.FRandRange(-500.0f, 500.0f), random.FRandRange(-500.0f, 500.0f), random.FRandRange(-500.0f, 500.0f));
+    };
+    TArray<FTestInteractable> interactables;
+    for(int32 index = 0; index < 400; ++index)
+    {
+        // Mostly hand sized, a few spanning many cells and a couple larger than the whole area
+        const float radius = index % 50 == 0 ? 2000.0f : index % 10 == 0 ? random.FRandRange(100.0f, 400.0f) : random.FRandRange(1.0f, 15.0f);
+
+        USceneComponent* component = NewObject<USceneComponent>(actor);
+        component->SetWorldLocation(randomPoint());
+        component->RegisterComponent();
+        grab->RegisterInteractable(component, radius);
+        interactables.Add({ component, radius });
+    }
+
+    const float searchRadii[] = { 0.0f, 5.0f, 30.0f, 250.0f, 1.0e7f };
+    int32 mismatches = 0;
+    TArray<FQHandGrabCandidate> candidates;
+    for(int32 round = 0; round < 20; ++round)
+    {
+        // Move some of them, across cells as well as within them
+        for(int32 move = 0; move < 40; ++move)
+        {
+            USceneComponent* component = interactables[random.RandHelper(interactables.Num())].Component;
+            component->SetWorldLocation(component->GetComponentLocation() + random.GetUnitVector() * random.FRandRange(0.0f, 60.0f));
+        }
+
+        TArray<FVector> probePoints;
+        const FVector handLocation = randomPoint();
+        for(int32 probe = 0; probe < 5; ++probe)
+        {
+            probePoints.Add(handLocation + random.GetUnitVector() * 8.0f);
+        }
+
+        for(float searchRadius : searchRadii)
+        {
+            grab->FindGrabCandidates(probePoints, handLocation, 0.5f, searchRadius, candidates);
+            TSet<USceneComponent*> found;
+            for(const FQHandGrabCandidate& candidate : candidates)
+            {
+                found.Add(candidate.Component);
+            }
+
+            const TSet<USceneComponent*> expected = FindBruteForce(interactables, probePoints, searchRadius);
+            if(found.Num() != candidates.Num() || found.Num() != expected.Num() || found.Difference(expected).Num() != 0)
+            {
+                AddError(FString::Printf(TEXT("Round %d, search radius %g: found %d candidates (%d unique), expected %d"),
+                                         round, searchRadius, candidates.Num(), found.Num(), expected.Num()));
+                ++mismatches;
+            }
+        }
+    }
+
+    TestEqual(TEXT("Queries disagreeing with the brute force search"), mismatches, 0);
+
+    DestroyTestWorld(world);
+    return true;
+}
+
+#endif
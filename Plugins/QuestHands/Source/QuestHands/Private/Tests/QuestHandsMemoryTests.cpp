@@ -0,0 +1,120 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsTestWorld.h"
+#include "QuestHandsMemory.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/IConsoleManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace MemoryTests
+{
+    static constexpr float FrameRate = 72.0f;
+    static constexpr int32 NumPawns = 4;
+
+    // Enough frames for the capsules to be created within MaxCapsuleCreatesPerFrame
+    static constexpr int32 SetupFrames = 30;
+
+    // A budget every pawn is over and one none of them gets near
+    static constexpr int32 TinyBudgetKB = 1;
+    static constexpr int32 HugeBudgetKB = 1024 * 1024;
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsMemoryBudgetTest, "QuestHands.Memory.Budget", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Pawns with capsule hands against the per pawn budget, headless. The peaks have to be raised as the components set up
+  * without waiting for a gather and have to hold after the pawns are gone, and the budget check has to count every pawn
+  * over a tiny budget and none under a huge one.
+*/
+bool FQuestHandsMemoryBudgetTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::MemoryTests;
+    using namespace QuestHands::TestWorld;
+    namespace Memory = QuestHands::Memory;
+
+    IConsoleVariable* budgetVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("QuestHands.MemoryBudgetPerPawnKB"));
+    if(!budgetVariable)
+    {
+        AddError(TEXT("QuestHands.MemoryBudgetPerPawnKB isn't registered"));
+        return false;
+    }
+    const int32 previousBudgetKB = budgetVariable->GetInt();
+
+    UWorld* world = CreateTestWorld(TEXT("QuestHandsMemoryTest"));
+    const int64 liveBefore = Memory::GetLiveTotal();
+    Memory::ResetPeaks();
+    const SIZE_T peakBefore = Memory::GetPeakTotal();
+
+    TSharedPtr<IQuestHandsDataSource> dataSource = MakeShared<FQHandSyntheticDataSource>(0);
+    TArray<UQuestHandsComponent*> components;
+    for(int32 pawnIndex = 0; pawnIndex < NumPawns; ++pawnIndex)
+    {
+        UQuestHandsComponent* component = SpawnHandsPawn(world, FVector(pawnIndex * 200.0f, 0.0f, 100.0f), dataSource,
+                                                         [](UQuestHandsComponent* Component)
+                                                         {
+                                                             Component->UpdateHandMeshComponents = true;
+                                                             Component->UpdatePhysicsCapsules = true;
+                                                         });
+        if(component)
+        {
+            components.Add(component);
+        }
+    }
+    if(!TestEqual(TEXT("Spawned pawns"), components.Num(), NumPawns))
+    {
+        DestroyTestWorld(world);
+        return false;
+    }
+
+    for(int32 frame = 0; frame < SetupFrames; ++frame)
+    {
+        AdvanceFrame(world, 1.0f / FrameRate);
+    }
+
+    // Nothing gathered yet, the peaks come from what the components reported as they set up
+    int64 pawnsTotal = 0;
+    int64 largestPawn = 0;
+    for(UQuestHandsComponent* component : components)
+    {
+        const int64 footprint = component->GetReportedMemoryBytes();
+        pawnsTotal += footprint;
+        largestPawn = FMath::Max(largestPawn, footprint);
+    }
+    TestTrue(TEXT("The pawns have a footprint"), pawnsTotal > 0);
+    TestEqual(TEXT("Live total"), Memory::GetLiveTotal() - liveBefore, pawnsTotal);
+    TestTrue(TEXT("Peak total raised before a gather"), (int64)(Memory::GetPeakTotal() - peakBefore) >= pawnsTotal);
+    TestTrue(TEXT("Peak largest pawn raised before a gather"), (int64)Memory::GetPeakLargestPawn() >= largestPawn);
+
+    AddExpectedError(TEXT("over the budget"), EAutomationExpectedErrorFlags::Contains, NumPawns);
+    budgetVariable->Set(TinyBudgetKB, ECVF_SetByCode);
+    Memory::Gather();
+    TestEqual(TEXT("Pawns over a tiny budget"), Memory::GetPawnsOverBudget(), NumPawns);
+
+    budgetVariable->Set(HugeBudgetKB, ECVF_SetByCode);
+    Memory::Gather();
+    TestEqual(TEXT("Pawns over a huge budget"), Memory::GetPawnsOverBudget(), 0);
+
+    // The peaks are high-water marks, taking the pawns down leaves them where they were
+    const SIZE_T peakTotal = Memory::GetPeakTotal();
+    const SIZE_T peakLargestPawn = Memory::GetPeakLargestPawn();
+    for(UQuestHandsComponent* component : components)
+    {
+        world->DestroyActor(component->GetOwner());
+    }
+    AdvanceFrame(world, 1.0f / FrameRate);
+
+    TestEqual(TEXT("Live total after the pawns are gone"), Memory::GetLiveTotal(), liveBefore);
+    TestEqual(TEXT("Peak total after the pawns are gone"), (int64)Memory::GetPeakTotal(), (int64)peakTotal);
+    TestEqual(TEXT("Peak largest pawn after the pawns are gone"), (int64)Memory::GetPeakLargestPawn(), (int64)peakLargestPawn);
+
+    budgetVariable->Set(previousBudgetKB, ECVF_SetByCode);
+    DestroyTestWorld(world);
+    return true;
+}
+
+#endif
@@ -0,0 +1,163 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsTestWorld.h"
+#include "QuestHandsLoadTestActors.h"
+#include "Misc/AutomationTest.h"
+#include "Components/BoxComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace OverlapTests
+{
+    // The right hand moves side to side through the box at this speed, this far either side of it
+    static constexpr float SwipeSpeed = 100.0f;
+    static constexpr float SwipeHalfWidth = 40.0f;
+
+    static const FVector BoxLocation(50.0f, 0.0f, 40.0f);
+    static const FVector BoxExtent(15.0f, 4.0f, 10.0f);
+
+    static constexpr float FrameRate = 72.0f;
+    static constexpr int32 TestFrames = 432;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Side to side offset of the swipe at a time, a triangle wave at a constant speed
+    */
+    static float GetSwipeOffset(double Time)
+    {
+        const float phase = FMath::Fmod((float)Time * SwipeSpeed, 4.0f * SwipeHalfWidth);
+        return phase < 2.0f * SwipeHalfWidth ? phase - SwipeHalfWidth : 3.0f * SwipeHalfWidth - phase;
+    }
+
+    // The synthetic hands held flat and always tracked, the right hand moving through the box and the left hand well away from it
+    class FSwipeDataSource : public FQHandSyntheticDataSource
+    {
+    public:
+        FSwipeDataSource()
+            : FQHandSyntheticDataSource(0)
+        {}
+
+        virtual bool GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters) override
+        {
+            FQHandSyntheticDataSource::GetTrackingState(Hand, Step, StateOut, WorldToMeters);
+            StateOut.IsTracked = true;
+            StateOut.InputValid = true;
+            StateOut.RootPose.Orientation = FQuat::Identity;
+            StateOut.RootPose.Position = Hand == EControllerHand::Right ? FVector(40.0f, GetSwipeOffset(FApp::GetCurrentTime()), BoxLocation.Z) :
+                                                                           FVector(40.0f, 0.0f, -200.0f);
+            return true;
+        }
+    };
+
+    struct FOverlapCounts
+    {
+        int32 ComponentBegins = 0;
+        int32 ComponentEnds = 0;
+        int32 ActorBegins = 0;
+        int32 ActorEnds = 0;
+
+        // Frames where the overlap state queried through the actors disagreed with the events received so far
+        int32 InconsistentFrames = 0;
+
+        // Frames where the hand overlapped the box
+        int32 OverlappingFrames = 0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Move the right hand through the box and count the overlap events the box gets
+    */
+    static bool RunSwipe(bool BatchCapsuleOverlaps, FOverlapCounts& CountsOut)
+    {
+        using namespace TestWorld;
+
+        CountsOut = FOverlapCounts();
+        const double previousTime = FApp::GetCurrentTime();
+        FApp::SetCurrentTime(0.0);
+
+        bool success = false;
+        UWorld* world = CreateTestWorld(TEXT("QuestHandsOverlapTest"));
+        UQuestHandsComponent* handsComponent = nullptr;
+        if(world->HasBegunPlay())
+        {
+            handsComponent = SpawnHandsPawn(world, FVector::ZeroVector, MakeShared<FSwipeDataSource>(), [BatchCapsuleOverlaps](UQuestHandsComponent* component)
+            {
+                component->CreateHandMeshComponents = false;
+                component->UsePooledComponents = false;
+                component->UseUpdateLOD = false;
+                component->UseGovernor = false;
+                component->BatchCapsuleOverlaps = BatchCapsuleOverlaps;
+                component->CapsuleBodyData.SetCollisionProfileName(TEXT("OverlapAllDynamic"));
+            });
+        }
+
+        AQuestHandsOverlapCounter* counter = handsComponent ? world->SpawnActor<AQuestHandsOverlapCounter>(BoxLocation, FRotator::ZeroRotator) : nullptr;
+        if(counter)
+        {
+            counter->Box->SetBoxExtent(BoxExtent);
+
+            AActor* handsActor = handsComponent->GetOwner();
+            const float deltaTime = 1.0f / FrameRate;
+            for(int32 frame = 0; frame < TestFrames; ++frame)
+            {
+                AdvanceFrame(world, deltaTime);
+
+                // What GetOverlappingActors and IsOverlappingActor see has to follow the events
+                const bool overlappingByEvents = counter->NumActorBeginOverlaps > counter->NumActorEndOverlaps;
+                const bool overlappingByQuery = counter->IsOverlappingActor(handsActor) && handsActor->IsOverlappingActor(counter);
+                CountsOut.InconsistentFrames += overlappingByEvents != overlappingByQuery ? 1 : 0;
+                CountsOut.OverlappingFrames += overlappingByQuery ? 1 : 0;
+            }
+
+            CountsOut.ComponentBegins = counter->NumComponentBeginOverlaps;
+            CountsOut.ComponentEnds = counter->NumComponentEndOverlaps;
+            CountsOut.ActorBegins = counter->NumActorBeginOverlaps;
+            CountsOut.ActorEnds = counter->NumActorEndOverlaps;
+            success = true;
+        }
+
+        DestroyTestWorld(world);
+        FApp::SetCurrentTime(previousTime);
+        return success;
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsBatchedOverlapsTest, "QuestHands.Capsules.BatchedOverlaps", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * The same hand motion through a box with overlaps updated per capsule move and with batched overlaps. The box has to get
+  * the same component and actor events either way, and the overlap state of both actors has to agree with the events.
+*/
+bool FQuestHandsBatchedOverlapsTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::OverlapTests;
+
+    FOverlapCounts perCapsule;
+    FOverlapCounts batched;
+    if(!RunSwipe(false, perCapsule) || !RunSwipe(true, batched))
+    {
+        AddError(TEXT("The swipe didn't run, the test world or the actors couldn't be set up"));
+        return false;
+    }
+
+    AddInfo(FString::Printf(TEXT("Per capsule: %d/%d component and %d/%d actor begin/end overlaps"),
+                            perCapsule.ComponentBegins, perCapsule.ComponentEnds, perCapsule.ActorBegins, perCapsule.ActorEnds));
+    AddInfo(FString::Printf(TEXT("Batched: %d/%d component and %d/%d actor begin/end overlaps"),
+                            batched.ComponentBegins, batched.ComponentEnds, batched.ActorBegins, batched.ActorEnds));
+
+    TestTrue(TEXT("The hand overlapped the box"), perCapsule.OverlappingFrames > 0 && perCapsule.ActorBegins > 1);
+    TestEqual(TEXT("Component begin overlaps"), batched.ComponentBegins, perCapsule.ComponentBegins);
+    TestEqual(TEXT("Component end overlaps"), batched.ComponentEnds, perCapsule.ComponentEnds);
+    TestEqual(TEXT("Actor begin overlaps"), batched.ActorBegins, perCapsule.ActorBegins);
+    TestEqual(TEXT("Actor end overlaps"), batched.ActorEnds, perCapsule.ActorEnds);
+    TestEqual(TEXT("Frames overlapping the box"), batched.OverlappingFrames, perCapsule.OverlappingFrames);
+    TestEqual(TEXT("Per capsule frames with the overlap state disagreeing with the events"), perCapsule.InconsistentFrames, 0);
+    TestEqual(TEXT("Batched frames with the overlap state disagreeing with the events"), batched.InconsistentFrames, 0);
+    return true;
+}
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPoseConversion.h"
+#include "QuestHandsCapturedHand.h"
+#include "QuestHandsTopology.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace PoseConversionTests
+{
+    static constexpr float OrientationTolerance = 1.0e-4f;
+    static constexpr float PositionTolerance = 1.0e-3f;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Orientations match when they rotate the same way, whichever sign they have
+    */
+    static void TestOrientation(FAutomationTestBase& Test, const FString& What, const FQuat& Actual, const FQuat& Expected)
+    {
+        if(1.0f - FMath::Abs(Actual | Expected) > OrientationTolerance)
+        {
+            Test.AddError(FString::Printf(TEXT("%s is %s, expected %s"), *What, *Actual.ToString(), *Expected.ToString()));
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void TestPosition(FAutomationTestBase& Test, const FString& What, const FVector& Actual, const FVector& Expected)
+    {
+        if(!Actual.Equals(Expected, PositionTolerance))
+        {
+            Test.AddError(FString::Printf(TEXT("%s is %s, expected %s"), *What, *Actual.ToString(), *Expected.ToString()));
+        }
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsPoseConversionHandStateTest, "QuestHands.PoseConversion.HandState", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * The fixture hand state converted under a turned and offset base gives the fixed Unreal poses, bone rotations,
+  * pinches and confidence. Converting the same state twice into one output must not grow its arrays, and converting into
+  * an output holding more entries shrinks them to one hand.
+*/
+bool FQuestHandsPoseConversionHandStateTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands;
+    using namespace QuestHands::PoseConversionTests;
+
+    const FPoseConversion conversion(CapturedHand::BaseOrientation, CapturedHand::BaseOffset, CapturedHand::WorldToMeters);
+    FQHandTrackingState state;
+    conversion.ConvertHandState(CapturedHand::HandState, state);
+
+    TestTrue(TEXT("Tracked"), state.IsTracked);
+    TestTrue(TEXT("Input valid"), state.InputValid);
+    TestFalse(TEXT("System gesture in progress"), state.SystemGestureInProgress);
+    TestOrientation(*this, TEXT("Root orientation"), state.RootPose.Orientation, CapturedHand::ExpectedRootOrientation);
+    TestPosition(*this, TEXT("Root position"), state.RootPose.Position, CapturedHand::ExpectedRootPosition);
+    TestOrientation(*this, TEXT("Pointer orientation"), state.PointerPose.Orientation, CapturedHand::ExpectedPointerOrientation);
+    TestPosition(*this, TEXT("Pointer position"), state.PointerPose.Position, CapturedHand::ExpectedPointerPosition);
+
+    if(TestEqual(TEXT("Bone rotations"), state.BoneRotations.Num(), (int32)UE_ARRAY_COUNT(CapturedHand::ExpectedBoneRotations)))
+    {
+        for(int32 boneIndex = 0; boneIndex < state.BoneRotations.Num(); ++boneIndex)
+        {
+            TestOrientation(*this, FString::Printf(TEXT("Bone %d rotation"), boneIndex), state.BoneRotations[boneIndex], CapturedHand::ExpectedBoneRotations[boneIndex]);
+        }
+    }
+
+    if(TestEqual(TEXT("Pinch states"), state.PinchState.Num(), RawNumFingers))
+    {
+        for(int32 finger = 0; finger < RawNumFingers; ++finger)
+        {
+            TestEqual(FString::Printf(TEXT("Finger %d"), finger), (int32)state.PinchState[finger].Finger, finger);
+            TestEqual(FString::Printf(TEXT("Finger %d pinched"), finger), state.PinchState[finger].Pinched, finger < 2);
+            TestEqual(FString::Printf(TEXT("Finger %d pinch strength"), finger), state.PinchState[finger].Strength, CapturedHand::HandState.PinchStrength[finger]);
+        }
+    }
+    TestEqual(TEXT("Hand scale"), state.HandScale, CapturedHand::HandState.HandScale);
+    TestEqual(TEXT("Hand confidence"), (int32)state.HandConfidence, (int32)EQHandTrackingConfidence::Confidence_High);
+
+    conversion.ConvertHandState(CapturedHand::HandState, state);
+    TestEqual(TEXT("Bone rotations converted again"), state.BoneRotations.Num(), (int32)UE_ARRAY_COUNT(CapturedHand::ExpectedBoneRotations));
+    TestEqual(TEXT("Pinch states converted again"), state.PinchState.Num(), RawNumFingers);
+
+    // A state holding more than a hand, such as one loaded from a data dump, is cut down to one
+    FQHandTrackingState oversized;
+    oversized.BoneRotations.SetNum(Topology::NumBones + 6);
+    oversized.PinchState.SetNum(RawNumFingers + 2);
+    conversion.ConvertHandState(CapturedHand::HandState, oversized);
+    TestEqual(TEXT("Bone rotations converted into a larger state"), oversized.BoneRotations.Num(), (int32)UE_ARRAY_COUNT(CapturedHand::ExpectedBoneRotations));
+    TestEqual(TEXT("Pinch states converted into a larger state"), oversized.PinchState.Num(), RawNumFingers);
+
+    // A lost hand with low confidence
+    FRawHandState lost = CapturedHand::HandState;
+    lost.Status = RawHandStatus_SystemGestureInProgress;
+    lost.Pinches = 0;
+    lost.HandConfidence = 0;
+    conversion.ConvertHandState(lost, state);
+    TestFalse(TEXT("Lost hand tracked"), state.IsTracked);
+    TestFalse(TEXT("Lost hand input valid"), state.InputValid);
+    TestTrue(TEXT("Lost hand system gesture in progress"), state.SystemGestureInProgress);
+    TestFalse(TEXT("Lost hand index pinched"), state.PinchState[1].Pinched);
+    TestEqual(TEXT("Lost hand confidence"), (int32)state.HandConfidence, (int32)EQHandTrackingConfidence::Confidence_Low);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsPoseConversionSkeletonTest, "QuestHands.PoseConversion.Skeleton", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * The fixture skeleton converted under the identity base gives the fixed Unreal bone poses and capsules, and every bone
+  * pose matches converting it one at a time the way ConvertPose_Internal does.
+*/
+bool FQuestHandsPoseConversionSkeletonTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands;
+    using namespace QuestHands::PoseConversionTests;
+
+    const FPoseConversion conversion(FQuat::Identity, FVector::ZeroVector, CapturedHand::WorldToMeters);
+    FQHandSkeleton skeleton;
+    conversion.ConvertSkeleton(CapturedHand::Skeleton, skeleton);
+
+    if(TestEqual(TEXT("Bones"), skeleton.Bones.Num(), (int32)UE_ARRAY_COUNT(CapturedHand::ExpectedSkeletonOrientations)))
+    {
+        FQuat referenceOrientation;
+        FVector referencePosition;
+        for(int32 boneIndex = 0; boneIndex < skeleton.Bones.Num(); ++boneIndex)
+        {
+            const FQHandBone& bone = skeleton.Bones[boneIndex];
+            TestEqual(FString::Printf(TEXT("Bone %d id"), boneIndex), (int32)bone.BoneId, CapturedHand::Skeleton.Bones[boneIndex].BoneId);
+            TestEqual(FString::Printf(TEXT("Bone %d parent"), boneIndex), bone.ParentBoneIndex, (int32)CapturedHand::Skeleton.Bones[boneIndex].ParentBoneIndex);
+            TestOrientation(*this, FString::Printf(TEXT("Bone %d orientation"), boneIndex), bone.Pose.Orientation, CapturedHand::ExpectedSkeletonOrientations[boneIndex]);
+            TestPosition(*this, FString::Printf(TEXT("Bone %d position"), boneIndex), bone.Pose.Position, CapturedHand::ExpectedSkeletonPositions[boneIndex]);
+
+            FPoseConversion::ConvertPoseReference(CapturedHand::Skeleton.Bones[boneIndex].Pose, FQuat::Identity, FVector::ZeroVector, CapturedHand::WorldToMeters,
+                                                  referenceOrientation, referencePosition);
+            TestOrientation(*this, FString::Printf(TEXT("Bone %d orientation one at a time"), boneIndex), bone.Pose.Orientation, referenceOrientation);
+            TestPosition(*this, FString::Printf(TEXT("Bone %d position one at a time"), boneIndex), bone.Pose.Position, referencePosition);
+        }
+    }
+
+    if(TestEqual(TEXT("Capsules"), skeleton.BoneCapsules.Num(), (int32)UE_ARRAY_COUNT(CapturedHand::ExpectedCapsuleEnds)))
+    {
+        for(int32 capsuleIndex = 0; capsuleIndex < skeleton.BoneCapsules.Num(); ++capsuleIndex)
+        {
+            const FQHandBoneCapsule& capsule = skeleton.BoneCapsules[capsuleIndex];
+            TestEqual(FString::Printf(TEXT("Capsule %d bone"), capsuleIndex), capsule.BoneIndex, (int32)CapturedHand::Skeleton.BoneCapsules[capsuleIndex].BoneIndex);
+            TestPosition(*this, FString::Printf(TEXT("Capsule %d start"), capsuleIndex), capsule.PointA, FVector::ZeroVector);
+            TestPosition(*this, FString::Printf(TEXT("Capsule %d end"), capsuleIndex), capsule.PointB, CapturedHand::ExpectedCapsuleEnds[capsuleIndex]);
+            TestEqual(FString::Printf(TEXT("Capsule %d radius"), capsuleIndex), capsule.Radius, CapturedHand::Skeleton.BoneCapsules[capsuleIndex].Radius);
+        }
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,182 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsPoseMining.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace PoseMiningTests
+{
+    // Rotation noise of the poses around the center of their group, in radians
+    static constexpr float PoseNoise = 0.05f;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * A random pose, every feature bone a unit quaternion on the positive W hemisphere
+    */
+    static void MakeCenter(FRandomStream& Random, float* FeaturesOut)
+    {
+        for(int32 featureBone = 0; featureBone < UQuestHandsPoseTemplates::NumFeatureBones; ++featureBone)
+        {
+            FQuat rotation(Random.GetUnitVector(), Random.FRandRange(0.5f, 2.5f));
+            if(rotation.W < 0.0f)
+            {
+                rotation *= -1.0f;
+            }
+            FeaturesOut[featureBone * 4] = rotation.X;
+            FeaturesOut[featureBone * 4 + 1] = rotation.Y;
+            FeaturesOut[featureBone * 4 + 2] = rotation.Z;
+            FeaturesOut[featureBone * 4 + 3] = rotation.W;
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Append Count poses scattered around a center
+    */
+    static void AddGroup(FRandomStream& Random, const float* Center, int32 Count, TArray<float>& PosesOut)
+    {
+        for(int32 poseIndex = 0; poseIndex < Count; ++poseIndex)
+        {
+            for(int32 featureBone = 0; featureBone < UQuestHandsPoseTemplates::NumFeatureBones; ++featureBone)
+            {
+                const float* center = Center + featureBone * 4;
+                FQuat rotation = FQuat(Random.GetUnitVector(), Random.FRandRange(0.0f, PoseNoise)) * FQuat(center[0], center[1], center[2], center[3]);
+                if(rotation.W < 0.0f)
+                {
+                    rotation *= -1.0f;
+                }
+                PosesOut.Add(rotation.X);
+                PosesOut.Add(rotation.Y);
+                PosesOut.Add(rotation.Z);
+                PosesOut.Add(rotation.W);
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * The group whose center is closest to a centroid
+    */
+    static int32 FindClosestGroup(const float* Centroid, const TArray<float>& Centers)
+    {
+        int32 closest = INDEX_NONE;
+        float closestDistanceSquared = MAX_flt;
+        for(int32 group = 0; group < Centers.Num() / PoseMining::NumFeatures; ++group)
+        {
+            const float distanceSquared = UQuestHandsPoseTemplates::GetFeatureDistanceSquared(Centroid, Centers.GetData() + group * PoseMining::NumFeatures);
+            if(distanceSquared < closestDistanceSquared)
+            {
+                closestDistanceSquared = distanceSquared;
+                closest = group;
+            }
+        }
+        return closest;
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsPoseMiningReseedTest, "QuestHands.PoseMining.Reseed", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Two empty clusters next to one cluster holding every pose of three groups. Each has to be reseeded into a different
+  * group the occupied cluster fits badly, rather than both onto the same worst fitting pose.
+*/
+bool FQuestHandsPoseMiningReseedTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::PoseMining;
+    using namespace QuestHands::PoseMiningTests;
+
+    FRandomStream random(11);
+    TArray<float> centers;
+    centers.SetNumUninitialized(3 * NumFeatures);
+    for(int32 group = 0; group < 3; ++group)
+    {
+        MakeCenter(random, centers.GetData() + group * NumFeatures);
+    }
+
+    TArray<float> poses;
+    AddGroup(random, centers.GetData(), 200, poses);
+    AddGroup(random, centers.GetData() + NumFeatures, 20, poses);
+    AddGroup(random, centers.GetData() + 2 * NumFeatures, 20, poses);
+    const int32 numPoses = poses.Num() / NumFeatures;
+
+    // Every center on the first group, the first cluster took all the poses
+    TArray<float> centroids;
+    centroids.SetNumUninitialized(3 * NumFeatures);
+    for(int32 cluster = 0; cluster < 3; ++cluster)
+    {
+        FMemory::Memcpy(centroids.GetData() + cluster * NumFeatures, centers.GetData(), NumFeatures * sizeof(float));
+    }
+    TArray<int32> counts = { numPoses, 0, 0 };
+    TArray<float> distancesSquared;
+    distancesSquared.SetNumUninitialized(numPoses);
+    for(int32 poseIndex = 0; poseIndex < numPoses; ++poseIndex)
+    {
+        distancesSquared[poseIndex] = UQuestHandsPoseTemplates::GetFeatureDistanceSquared(poses.GetData() + poseIndex * NumFeatures, centroids.GetData());
+    }
+
+    TestEqual(TEXT("Clusters reseeded"), ReseedEmptyClusters(poses, counts, centroids, distancesSquared), 2);
+
+    const int32 firstGroup = FindClosestGroup(centroids.GetData() + NumFeatures, centers);
+    const int32 secondGroup = FindClosestGroup(centroids.GetData() + 2 * NumFeatures, centers);
+    TestNotEqual(TEXT("First reseeded cluster left the occupied group"), firstGroup, 0);
+    TestNotEqual(TEXT("Second reseeded cluster left the occupied group"), secondGroup, 0);
+    TestNotEqual(TEXT("Reseeded clusters in different groups"), firstGroup, secondGroup);
+
+    // With every pose on a center there is nothing to reseed from
+    FMemory::Memzero(distancesSquared.GetData(), distancesSquared.Num() * sizeof(float));
+    TestEqual(TEXT("Clusters reseeded without badly fitting poses"), ReseedEmptyClusters(poses, counts, centroids, distancesSquared), 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsPoseMiningClustersTest, "QuestHands.PoseMining.Clusters", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Mining well separated groups of poses finds one template per group, holding all of its poses.
+*/
+bool FQuestHandsPoseMiningClustersTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::PoseMining;
+    using namespace QuestHands::PoseMiningTests;
+
+    static constexpr int32 NumGroups = 4;
+    static constexpr int32 PosesPerGroup = 500;
+
+    FRandomStream random(5);
+    TArray<float> centers;
+    centers.SetNumUninitialized(NumGroups * NumFeatures);
+    TArray<float> poses;
+    for(int32 group = 0; group < NumGroups; ++group)
+    {
+        MakeCenter(random, centers.GetData() + group * NumFeatures);
+        AddGroup(random, centers.GetData() + group * NumFeatures, PosesPerGroup, poses);
+    }
+
+    FMiningSettings settings;
+    settings.NumClusters = NumGroups;
+    settings.Seed = 3;
+    FMiningResult result;
+    MinePoseTemplates(poses, settings, TEXT("Test"), result);
+    if(!TestEqual(TEXT("Templates"), result.Radii.Num(), NumGroups))
+    {
+        return false;
+    }
+
+    TArray<bool> groupsFound;
+    groupsFound.Init(false, NumGroups);
+    for(int32 cluster = 0; cluster < NumGroups; ++cluster)
+    {
+        const int32 group = FindClosestGroup(result.Centroids.GetData() + cluster * NumFeatures, centers);
+        TestFalse(FString::Printf(TEXT("Template %d on a group another template found"), cluster), groupsFound[group]);
+        groupsFound[group] = true;
+        TestEqual(FString::Printf(TEXT("Template %d poses"), cluster), result.Counts[cluster], PosesPerGroup);
+    }
+    return true;
+}
+
+#endif
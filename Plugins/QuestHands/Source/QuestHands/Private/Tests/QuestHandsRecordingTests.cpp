@@ -0,0 +1,202 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsRecording.h"
+#include "QuestHandsDataSource.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace RecordingTests
+{
+    // Enough frames for the writer to hand several buffers to the thread pool
+    static constexpr int32 NumFrames = 300;
+    static constexpr double FrameInterval = 1.0 / 72.0;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * The synthetic hands moved along a little every frame, so every frame of a recording differs
+    */
+    static void MakeFrames(int32 Count, TArray<FQHandRecordingFrame>& FramesOut)
+    {
+        FQHandSyntheticDataSource dataSource(3);
+        FramesOut.SetNum(Count);
+        for(int32 frameIndex = 0; frameIndex < Count; ++frameIndex)
+        {
+            FQHandRecordingFrame& frame = FramesOut[frameIndex];
+            frame.Time = frameIndex * FrameInterval;
+            for(int32 handIndex = 0; handIndex < 2; ++handIndex)
+            {
+                FQHandTrackingState& state = frame.Hands[handIndex];
+                dataSource.GetTrackingState(handIndex == 0 ? EControllerHand::Left : EControllerHand::Right, EQHandUpdateStep::UpdateStep_Render, state, 100.0f);
+                state.RootPose.Position.X += frameIndex * 0.5f;
+                state.IsTracked = (frameIndex % 17) != 0;
+                state.HandConfidence = (frameIndex % 5) != 0 ? EQHandTrackingConfidence::Confidence_High : EQHandTrackingConfidence::Confidence_Low;
+                if(state.BoneRotations.Num() > 0)
+                {
+                    state.BoneRotations[frameIndex % state.BoneRotations.Num()] = FQuat(FVector::UpVector, frameIndex * 0.01f);
+                }
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    template<typename StructType>
+    static bool AreIdentical(const StructType& A, const StructType& B)
+    {
+        return StructType::StaticStruct()->CompareScriptStruct(&A, &B, PPF_None);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Read a recording back and compare it to what was written, returns the number of frames read
+    */
+    static int32 ReadAndCompare(FAutomationTestBase& Test, const FString& FilePath, const FQHandSkeleton (&Skeletons)[2],
+                                const TArray<FQHandRecordingFrame>& Frames, int32 ExpectedVersion)
+    {
+        FQHandRecordingReader reader;
+        if(!Test.TestTrue(TEXT("Recording opens"), reader.Open(FilePath)))
+        {
+            return 0;
+        }
+
+        Test.TestEqual(TEXT("Recording version"), reader.GetVersion(), ExpectedVersion);
+        Test.TestTrue(TEXT("Left skeleton"), AreIdentical(reader.GetSkeleton(0), Skeletons[0]));
+        Test.TestTrue(TEXT("Right skeleton"), AreIdentical(reader.GetSkeleton(1), Skeletons[1]));
+
+        int32 numRead = 0;
+        FQHandRecordingFrame frame;
+        while(reader.ReadFrame(frame))
+        {
+            if(!Frames.IsValidIndex(numRead))
+            {
+                Test.AddError(TEXT("More frames read than were written"));
+                break;
+            }
+
+            const FQHandRecordingFrame& written = Frames[numRead];
+            if(frame.Time != written.Time || !AreIdentical(frame.Hands[0], written.Hands[0]) || !AreIdentical(frame.Hands[1], written.Hands[1]))
+            {
+                Test.AddError(FString::Printf(TEXT("Frame %d differs from the frame written"), numRead));
+            }
+            ++numRead;
+        }
+        return numRead;
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsRecordingRoundTripTest, "QuestHands.Recording.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Frames written through the buffered writer read back identical and in order, a recording cut short drops only its
+  * partial last frame, and a file which isn't a recording is refused.
+*/
+bool FQuestHandsRecordingRoundTripTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::RecordingTests;
+
+    const FString filePath = FPaths::AutomationTransientDir() / TEXT("QuestHandsRoundTrip.qhrec");
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(filePath), true);
+
+    FQHandSyntheticDataSource dataSource(3);
+    FQHandSkeleton skeletons[2];
+    dataSource.GetHandSkeleton(EControllerHand::Left, skeletons[0], 100.0f);
+    dataSource.GetHandSkeleton(EControllerHand::Right, skeletons[1], 100.0f);
+
+    TArray<FQHandRecordingFrame> frames;
+    MakeFrames(NumFrames, frames);
+
+    {
+        FQHandRecordingWriter writer;
+        if(!TestTrue(TEXT("Recording created"), writer.Open(filePath, skeletons[0], skeletons[1])))
+        {
+            return false;
+        }
+        for(FQHandRecordingFrame& frame : frames)
+        {
+            writer.WriteFrame(frame);
+        }
+        TestEqual(TEXT("Frames written"), writer.GetNumFrames(), NumFrames);
+        writer.Close();
+    }
+
+    TestEqual(TEXT("Frames read"), ReadAndCompare(*this, filePath, skeletons, frames, 2), NumFrames);
+
+    // Cut into the last frame as a killed app would
+    TArray<uint8> bytes;
+    if(TestTrue(TEXT("Recording loads as bytes"), FFileHelper::LoadFileToArray(bytes, *filePath)))
+    {
+        bytes.SetNum(bytes.Num() - 10);
+        FFileHelper::SaveArrayToFile(bytes, *filePath);
+        AddExpectedError(TEXT("bytes remain"), EAutomationExpectedErrorFlags::Contains, 0);
+        TestEqual(TEXT("Frames read from a truncated recording"), ReadAndCompare(*this, filePath, skeletons, frames, 2), NumFrames - 1);
+
+        // Not a recording at all
+        bytes[0] ^= 0xFF;
+        FFileHelper::SaveArrayToFile(bytes, *filePath);
+        AddExpectedError(TEXT("is not a hand recording"), EAutomationExpectedErrorFlags::Contains, 1);
+        FQHandRecordingReader reader;
+        TestFalse(TEXT("A file with the wrong magic opens"), reader.Open(filePath));
+    }
+
+    IFileManager::Get().Delete(*filePath);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsRecordingVersion1Test, "QuestHands.Recording.Version1", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Recordings of version 1, written from the reflected layout of the structs, still read back.
+*/
+bool FQuestHandsRecordingVersion1Test::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::RecordingTests;
+
+    const FString filePath = FPaths::AutomationTransientDir() / TEXT("QuestHandsVersion1.qhrec");
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(filePath), true);
+
+    FQHandSyntheticDataSource dataSource(5);
+    FQHandSkeleton skeletons[2];
+    dataSource.GetHandSkeleton(EControllerHand::Left, skeletons[0], 100.0f);
+    dataSource.GetHandSkeleton(EControllerHand::Right, skeletons[1], 100.0f);
+
+    TArray<FQHandRecordingFrame> frames;
+    MakeFrames(10, frames);
+
+    // The layout the writer used before the fields were written explicitly
+    TArray<uint8> bytes;
+    FMemoryWriter writer(bytes);
+    uint32 magic = 0x43524851;
+    int32 version = 1;
+    writer << magic;
+    writer << version;
+    FQHandSkeleton::StaticStruct()->SerializeBin(writer, &skeletons[0]);
+    FQHandSkeleton::StaticStruct()->SerializeBin(writer, &skeletons[1]);
+    for(FQHandRecordingFrame& frame : frames)
+    {
+        writer << frame.Time;
+        FQHandTrackingState::StaticStruct()->SerializeBin(writer, &frame.Hands[0]);
+        FQHandTrackingState::StaticStruct()->SerializeBin(writer, &frame.Hands[1]);
+    }
+
+    if(!TestTrue(TEXT("Version 1 recording saved"), FFileHelper::SaveArrayToFile(bytes, *filePath)))
+    {
+        return false;
+    }
+
+    TestEqual(TEXT("Frames read"), ReadAndCompare(*this, filePath, skeletons, frames, 1), frames.Num());
+    IFileManager::Get().Delete(*filePath);
+    return true;
+}
+
+#endif
@@ -0,0 +1,119 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsTopology.h"
+#include "QuestHandsDataSource.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace TopologyTests
+{
+    static constexpr float Tolerance = 1.0e-3f;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Local bone transforms of a synthetic hand pose over the rest offsets of a skeleton
+    */
+    static void GetLocalBones(const FQHandSkeleton& Skeleton, const FQHandTrackingState& State, TArray<FTransform>& LocalBonesOut)
+    {
+        LocalBonesOut.SetNum(Skeleton.Bones.Num());
+        for(int32 boneIndex = 0; boneIndex < Skeleton.Bones.Num(); ++boneIndex)
+        {
+            LocalBonesOut[boneIndex].SetComponents(State.BoneRotations[boneIndex], Skeleton.Bones[boneIndex].Pose.Position, FVector::OneVector);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+      * Forward kinematics the slow way, each bone walking up its parents to the root
+    */
+    static FTransform GetWorldBoneByWalking(const FQHandSkeleton& Skeleton, const TArray<FTransform>& LocalBones, const FTransform& RootTransform, int32 BoneIndex)
+    {
+        FTransform world = LocalBones[BoneIndex];
+        for(int32 parentIndex = Skeleton.Bones[BoneIndex].ParentBoneIndex; parentIndex >= 0; parentIndex = Skeleton.Bones[parentIndex].ParentBoneIndex)
+        {
+            world *= LocalBones[parentIndex];
+        }
+        return world * RootTransform;
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsTopologyFKTest, "QuestHands.Topology.FK", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * The unrolled forward kinematics and capsule placement against the generic paths and against walking the parents of each
+  * bone, for the synthetic skeleton and for the same skeleton with a changed hierarchy which has to take the generic paths.
+*/
+bool FQuestHandsTopologyFKTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::TopologyTests;
+    using namespace QuestHands::Topology;
+
+    FQHandSyntheticDataSource dataSource(7);
+    FQHandSkeleton skeleton;
+    FQHandTrackingState state;
+    dataSource.GetHandSkeleton(EControllerHand::Right, skeleton, 100.0f);
+    dataSource.GetTrackingState(EControllerHand::Right, EQHandUpdateStep::UpdateStep_Render, state, 100.0f);
+    if(!TestEqual(TEXT("Synthetic bone rotations"), state.BoneRotations.Num(), skeleton.Bones.Num()))
+    {
+        return false;
+    }
+
+    TestTrue(TEXT("The synthetic skeleton matches the topology"), MatchesSkeleton(skeleton));
+
+    const FTransform rootTransform(FRotator(10.0f, 70.0f, -30.0f), FVector(40.0f, -12.0f, 110.0f), FVector(1.1f));
+    TArray<FTransform> localBones;
+    GetLocalBones(skeleton, state, localBones);
+
+    // Unrolled against generic against walking the parents
+    FTransform unrolled[NumBones];
+    FTransform generic[NumBones];
+    FTransform::Multiply(&unrolled[0], &localBones[0], &rootTransform);
+    SolveFK(localBones.GetData(), unrolled);
+    SolveFKGeneric(skeleton, localBones.GetData(), rootTransform, generic);
+    for(int32 boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+    {
+        const FTransform walked = GetWorldBoneByWalking(skeleton, localBones, rootTransform, boneIndex);
+        TestTrue(FString::Printf(TEXT("Bone %d unrolled FK"), boneIndex), unrolled[boneIndex].Equals(walked, Tolerance));
+        TestTrue(FString::Printf(TEXT("Bone %d generic FK"), boneIndex), generic[boneIndex].Equals(walked, Tolerance));
+    }
+
+    // Both capsule placements agree on the topology
+    FTransform unrolledCapsules[NumBones];
+    FTransform genericCapsules[NumBones];
+    bool hasCapsule[NumBones];
+    PlaceCapsules(unrolled, unrolledCapsules);
+    PlaceCapsulesGeneric(skeleton, unrolled, genericCapsules, hasCapsule);
+    for(int32 boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+    {
+        TestEqual(FString::Printf(TEXT("Bone %d has a capsule"), boneIndex), hasCapsule[boneIndex], HasCapsule(boneIndex));
+        if(hasCapsule[boneIndex] && HasCapsule(boneIndex))
+        {
+            TestTrue(FString::Printf(TEXT("Bone %d capsule"), boneIndex), genericCapsules[boneIndex].Equals(unrolledCapsules[boneIndex], Tolerance));
+        }
+    }
+
+    // Same bone count with the index finger hung off the thumb, which only the generic path follows
+    FQHandSkeleton changedSkeleton = skeleton;
+    changedSkeleton.Bones[(int32)EQHandBones::Hand_Index1].ParentBoneIndex = (int32)EQHandBones::Hand_Thumb1;
+    TestFalse(TEXT("A skeleton with a changed parent matches the topology"), MatchesSkeleton(changedSkeleton));
+
+    SolveFKGeneric(changedSkeleton, localBones.GetData(), rootTransform, generic);
+    for(int32 boneIndex = 0; boneIndex < NumBones; ++boneIndex)
+    {
+        const FTransform walked = GetWorldBoneByWalking(changedSkeleton, localBones, rootTransform, boneIndex);
+        TestTrue(FString::Printf(TEXT("Changed skeleton bone %d generic FK"), boneIndex), generic[boneIndex].Equals(walked, Tolerance));
+    }
+
+    // Missing bones never match
+    FQHandSkeleton shortSkeleton = skeleton;
+    shortSkeleton.Bones.SetNum(NumBones - 5);
+    TestFalse(TEXT("A skeleton with fewer bones matches the topology"), MatchesSkeleton(shortSkeleton));
+    return true;
+}
+
+#endif
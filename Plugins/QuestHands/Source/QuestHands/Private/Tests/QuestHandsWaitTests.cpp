@@ -0,0 +1,156 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#include "QuestHandsTestWorld.h"
+#include "QuestHandsWaits.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuestHands
+{
+namespace WaitTests
+{
+    static constexpr float FrameRate = 72.0f;
+    static constexpr int32 NumFrames = 10;
+
+    // The synthetic hands, always tracked while hand tracking is enabled
+    class FSwitchedDataSource : public FQHandSyntheticDataSource
+    {
+    public:
+        FSwitchedDataSource()
+            : FQHandSyntheticDataSource(0)
+        {}
+
+        virtual bool IsHandTrackingEnabled() const override { return Enabled; }
+
+        virtual bool GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters) override
+        {
+            FQHandSyntheticDataSource::GetTrackingState(Hand, Step, StateOut, WorldToMeters);
+            StateOut.IsTracked = true;
+            StateOut.InputValid = true;
+            return true;
+        }
+
+        bool Enabled = true;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /**
+    */
+    static void AdvanceFrames(UWorld* World, int32 Count)
+    {
+        for(int32 frame = 0; frame < Count; ++frame)
+        {
+            TestWorld::AdvanceFrame(World, 1.0f / FrameRate);
+        }
+    }
+}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsWaitTrackingLostTest, "QuestHands.Waits.TrackingLost", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Waits keep being evaluated while hand tracking is off, with the hands counting as lost. A wait for a lost hand has to
+  * complete when tracking is switched off, and a wait for a tracked hand must not complete on the last sample taken
+  * before it was.
+*/
+bool FQuestHandsWaitTrackingLostTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::WaitTests;
+    using namespace QuestHands::TestWorld;
+
+    UWorld* world = CreateTestWorld(TEXT("QuestHandsWaitTest"));
+    TSharedRef<FSwitchedDataSource> dataSource = MakeShared<FSwitchedDataSource>();
+    UQuestHandsComponent* hands = SpawnHandsPawn(world, FVector::ZeroVector, dataSource, [](UQuestHandsComponent* Component) {});
+    if(!hands)
+    {
+        AddError(TEXT("Unable to spawn the hands pawn"));
+        DestroyTestWorld(world);
+        return false;
+    }
+
+    AdvanceFrames(world, NumFrames);
+
+    FQHandWaitCondition untracked;
+    untracked.Condition = EQHandWaitCondition::WaitCondition_Untracked;
+    untracked.Hand = EControllerHand::Right;
+    TSharedRef<FQHandWaitTask> untrackedWait = hands->StartHandWait(untracked);
+
+    AdvanceFrames(world, NumFrames);
+    TestFalse(TEXT("Wait for a lost hand done while tracked"), untrackedWait->IsDone());
+
+    dataSource->Enabled = false;
+    AdvanceFrames(world, 1);
+    TestTrue(TEXT("Wait for a lost hand met once tracking is off"), untrackedWait->WasMet());
+
+    FQHandWaitCondition tracked;
+    tracked.Condition = EQHandWaitCondition::WaitCondition_Tracked;
+    tracked.Hand = EControllerHand::Left;
+    TSharedRef<FQHandWaitTask> trackedWait = hands->StartHandWait(tracked);
+
+    AdvanceFrames(world, NumFrames);
+    TestFalse(TEXT("Wait for a tracked hand done while tracking is off"), trackedWait->IsDone());
+
+    dataSource->Enabled = true;
+    AdvanceFrames(world, NumFrames);
+    TestTrue(TEXT("Wait for a tracked hand met once tracking is back"), trackedWait->WasMet());
+
+    DestroyTestWorld(world);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuestHandsWaitDestroyOwnerTest, "QuestHands.Waits.DestroyOwner", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * A wait callback that destroys the pawn ends play for the hands component while its waits are being evaluated. The
+  * waits after it are cancelled rather than evaluated, and the component stops evaluating them.
+*/
+bool FQuestHandsWaitDestroyOwnerTest::RunTest(const FString& Parameters)
+{
+    using namespace QuestHands::WaitTests;
+    using namespace QuestHands::TestWorld;
+
+    UWorld* world = CreateTestWorld(TEXT("QuestHandsWaitDestroyOwnerTest"));
+    TSharedRef<FSwitchedDataSource> dataSource = MakeShared<FSwitchedDataSource>();
+    UQuestHandsComponent* hands = SpawnHandsPawn(world, FVector::ZeroVector, dataSource, [](UQuestHandsComponent* Component) {});
+    if(!hands)
+    {
+        AddError(TEXT("Unable to spawn the hands pawn"));
+        DestroyTestWorld(world);
+        return false;
+    }
+
+    AdvanceFrames(world, NumFrames);
+
+    FQHandWaitCondition tracked;
+    tracked.Condition = EQHandWaitCondition::WaitCondition_Tracked;
+    tracked.Hand = EControllerHand::Right;
+
+    TWeakObjectPtr<AActor> owner = hands->GetOwner();
+    bool destroyed = false;
+    TSharedRef<FQHandWaitTask> destroyingWait = hands->StartHandWait(tracked, [owner, &destroyed](bool Met)
+    {
+        if(Met && owner.IsValid())
+        {
+            destroyed = owner->Destroy();
+        }
+    });
+
+    tracked.Hand = EControllerHand::Left;
+    TSharedRef<FQHandWaitTask> laterWait = hands->StartHandWait(tracked);
+
+    AdvanceFrames(world, 1);
+    TestTrue(TEXT("Wait destroying the owner met"), destroyingWait->WasMet());
+    TestTrue(TEXT("Owner destroyed by the wait callback"), destroyed);
+    TestTrue(TEXT("Later wait done"), laterWait->IsDone());
+    TestFalse(TEXT("Later wait met after the owner was destroyed"), laterWait->WasMet());
+
+    AdvanceFrames(world, NumFrames);
+
+    DestroyTestWorld(world);
+    return true;
+}
+
+#endif
@@ -0,0 +1,30 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "QuestHandsAnalyticsCommandlet.generated.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Offline analytics over directories of hand tracking recordings. Recordings are analysed in parallel, one per task,
+  * and summarised per session and hand: tracking loss, confidence, per bone jitter spectra, pinch durations and hand
+  * scale drift.
+  *
+  * UE4Editor-Cmd <Project> -run=QuestHandsAnalytics -Input=<dir>[+<dir>...] [-Output=<path without extension>]
+  *
+  * Writes <Output>.csv with a row per session and hand and <Output>.json with the full per bone breakdown. Output
+  * defaults to QuestHandsAnalytics in the Saved directory.
+*/
+UCLASS()
+class UQuestHandsAnalyticsCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsAnalyticsCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
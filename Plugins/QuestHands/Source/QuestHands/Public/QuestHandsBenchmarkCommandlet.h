@@ -0,0 +1,41 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "QuestHandsBenchmarkCommandlet.generated.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Micro benchmarks of the hands systems, each run in a headless game world. Every benchmark logs a line per case and
+  * writes <Output>_<Benchmark>.csv. Runs headless with -nullrhi.
+  *
+  *   Probes    Game thread cost of the fingertip probes per frame, async sweeps issued one frame and collected the next
+  *             against the same sweeps run synchronously, for -Hands= hands among static boxes.
+  *   Grab      Grab candidate queries and spatial index updates for -Interactables= interactables with a share of them
+  *             moving every frame, against the same queries testing every interactable.
+  *   Poke      Fingertip hit-testing of the poke subsystem for -Panels= panels, against testing the panels one at a time
+  *             from their transforms.
+  *   PhysicsHands  Physics scene time per simulated physics hand for -Pawns= pawns and -SolverIterations= position solver
+  *             iterations, over the kinematic capsules of the same hands.
+  *   FK        Forward kinematics and capsule placement per hand unrolled over the hand topology, against the generic paths
+  *             skeletons with another hierarchy take, for -Hands= hands.
+  *   Tick      Frame time and memory per hands component for -Pawns= pawns with the hand state kept native, against
+  *             copying the state into the reflected Blueprint properties every frame as the components used to.
+  *
+  * UE4Editor-Cmd <Project> -run=QuestHandsBenchmark -nullrhi [-Bench=Probes+Grab+Poke+PhysicsHands+FK+Tick] [-Frames=600] [-FrameRate=72]
+  *     [-Seed=0] [-Hands=1+8+32] [-Interactables=100+1000+10000] [-Panels=1+10+50+100+500] [-Pawns=1+4+16] [-SolverIterations=8+4]
+  *     [-Output=<path without extension>]
+*/
+UCLASS()
+class UQuestHandsBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsBenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -6,13 +6,284 @@
 #include "Components/SceneComponent.h"
 #include "Engine/SkeletalMesh.h"
 #include "PhysicsEngine/BodyInstance.h"
+#include "WorldCollision.h"
 #include "QuestHandsFunctions.h"
+#include "QuestHandsGrabSubsystem.h"
+#include "QuestHandsPhysicsHand.h"
+#include "QuestHandsGovernorSubsystem.h"
+#include "QuestHandsPoolSubsystem.h"
+#include "QuestHandsGhostSubsystem.h"
+#include "QuestHandsRecording.h"
+#include "QuestHandsSharedFrames.h"
+#include "QuestHandsDataSource.h"
+#include "QuestHandsWaits.h"
+#include "Engine/LatentActionManager.h"
 
 #include "QuestHands.h"
 
 #include "QuestHandsComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnQHandsPreApplyTransformsDelegate, float, DeltaTime);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnQHandsFingertipTouchDelegate, EControllerHand, Hand, EQHandBones, Bone, UPrimitiveComponent*, Component);
+
+UENUM(BlueprintType, DisplayName = "Hand Update LOD")
+enum class EQHandUpdateLOD : uint8
+{
+    // Hands are sampled and posed every frame. Always used for the local player.
+    UpdateLOD_Full,
+
+    // Hands are far from the viewer, sampled at a reduced rate and interpolated in between samples.
+    UpdateLOD_Reduced,
+
+    // Hands have not been rendered recently, pose updates are skipped entirely.
+    UpdateLOD_Skipped
+};
+
+UENUM(BlueprintType, DisplayName = "Hand Bone Space")
+enum class EQHandBoneSpace : uint8
+{
+    // Relative to the parent bone. The wrist is relative to the component.
+    BoneSpace_Local,
+
+    // Relative to the hands component, the tracking space of the hands.
+    BoneSpace_Component,
+
+    // Relative to the wrist bone, where the fingers are regardless of where the hand is.
+    BoneSpace_Wrist,
+
+    // World space, the space the hand bones are kept in.
+    BoneSpace_World,
+
+    BoneSpace_Max UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType, DisplayName = "Hand Fingertip Probe")
+struct FQHandFingertipProbe
+{
+    GENERATED_BODY()
+
+    // The bone the probe is centered on, usually one of the tip bones
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FingertipProbe")
+    EQHandBones Bone;
+
+    // The radius of the probe sphere in world units
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "FingertipProbe", meta = (ClampMin = "0.0"))
+    float Radius;
+
+    FQHandFingertipProbe()
+        : Bone(EQHandBones::Hand_IndexTip)
+        , Radius(1.0f)
+    {}
+
+    FQHandFingertipProbe(EQHandBones InBone, float InRadius)
+        : Bone(InBone)
+        , Radius(InRadius)
+    {}
+};
+
+USTRUCT(BlueprintType, DisplayName = "Hand Fingertip Contact")
+struct FQHandFingertipContact
+{
+    GENERATED_BODY()
+
+    // The probed bone which is touching
+    UPROPERTY(BlueprintReadOnly, Category = "FingertipContact")
+    EQHandBones Bone;
+
+    // The component being touched
+    UPROPERTY(BlueprintReadOnly, Category = "FingertipContact")
+    UPrimitiveComponent* Component;
+
+    FQHandFingertipContact()
+        : Bone(EQHandBones::Hand_IndexTip)
+        , Component(nullptr)
+    {}
+
+    FQHandFingertipContact(EQHandBones InBone, UPrimitiveComponent* InComponent)
+        : Bone(InBone)
+        , Component(InComponent)
+    {}
+
+    bool operator==(const FQHandFingertipContact& Other) const
+    {
+        return Bone == Other.Bone && Component == Other.Component;
+    }
+};
+
+USTRUCT(BlueprintType, DisplayName = "Hand Pointer Trace")
+struct FQHandPointerTrace
+{
+    GENERATED_BODY()
+
+    // Was the pointer pose valid when the trace was issued? Nothing is traced if not.
+    UPROPERTY(BlueprintReadOnly, Category = "PointerTrace")
+    bool Valid;
+
+    // Did the trace hit something?
+    UPROPERTY(BlueprintReadOnly, Category = "PointerTrace")
+    bool Hit;
+
+    // World space start of the pointer ray
+    UPROPERTY(BlueprintReadOnly, Category = "PointerTrace")
+    FVector Start;
+
+    // World space end of the pointer ray, the impact point if something was hit
+    UPROPERTY(BlueprintReadOnly, Category = "PointerTrace")
+    FVector End;
+
+    // The hit information of the trace
+    UPROPERTY(BlueprintReadOnly, Category = "PointerTrace")
+    FHitResult HitResult;
+
+    FQHandPointerTrace()
+        : Valid(false)
+        , Hit(false)
+        , Start(ForceInitToZero)
+        , End(ForceInitToZero)
+    {}
+};
+
+/**
+  * The bone transforms of a hand in one space, split into an array per part so bulk reads of only the translations or
+  * rotations stay contiguous. Filled on the first query of the space in a frame.
+*/
+struct FQHandBoneSpaceBuffer
+{
+    TArray<FQuat> Rotations;
+    TArray<FVector> Translations;
+    TArray<FVector> Scales;
+
+    // The hand state revision and frame the buffer was filled at
+    uint32 Revision;
+    uint64 Frame;
+
+    FQHandBoneSpaceBuffer()
+        : Revision(0)
+        , Frame(0)
+    {}
+
+    int32 Num() const { return Rotations.Num(); }
+    FTransform GetTransform(int32 BoneIndex) const { return FTransform(Rotations[BoneIndex], Translations[BoneIndex], Scales[BoneIndex]); }
+    SIZE_T GetAllocatedSize() const { return Rotations.GetAllocatedSize() + Translations.GetAllocatedSize() + Scales.GetAllocatedSize(); }
+};
+
+/**
+  * The per hand state the component ticks mutate. Kept native and ordered by access so reflection stays out of the hot
+  * path, Blueprint reads it through lazily refreshed mirror properties on the component.
+*/
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FQHandRuntimeState
+{
+    // Touched every tick
+    FQHandTrackingState TrackingState;
+    TArray<FTransform> Bones;
+    FQHandFeatures Features;
+
+    // Bumped whenever the state is written so the Blueprint mirrors know when to refresh
+    uint32 Revision;
+
+#if QUESTHANDS_LATENCY_TRACING
+    // When and in which frame the tracking state was sampled, carried through the pipeline for latency tracing
+    double SampleTime;
+    uint64 SampleFrame;
+#endif
+
+    // The index tip location of the previous poke update, used for the tip velocity
+    FVector PokeTipPrevious;
+
+    // In flight pointer trace
+    FTraceHandle PointerTraceHandle;
+
+    // The frame the pointer trace was last read, used to count the traces saved by sharing the result. Only bookkeeping,
+    // so the const pointer trace query may update it.
+    mutable uint64 PointerTraceReadFrame;
+
+    // The previous sample of bone transforms, interpolated from at the reduced LOD
+    TArray<FTransform> BonesPrevious;
+
+    // Interpolated bone transforms applied to the poseables at the reduced LOD
+    TArray<FTransform> BonesInterpolated;
+
+    // The bone transforms of the latest and the previous physics samples, the capsule targets are interpolated between them.
+    // Bones can't be used as the latest sample, the render samples replace it in between physics ticks.
+    TArray<FTransform> BonesPhysics;
+    TArray<FTransform> BonesPhysicsPrevious;
+
+    // Scratch bone transforms for the interpolated capsule targets
+    TArray<FTransform> BonesCapsuleTarget;
+
+    // Bone transforms following the physics hand, applied to the poseables with PoseMeshesFromPhysicsHands
+    TArray<FTransform> BonesPhysicsHand;
+
+    // Capsule components, referenced through UQuestHandsComponent::AddReferencedObjects
+    TArray<class UCapsuleComponent*> Capsules;
+
+    // Number of entries in Capsules still waiting to be created
+    int32 NumMissingCapsules;
+
+    // In flight fingertip probes, one per entry in FingertipProbes
+    TArray<FTraceHandle> FingertipProbeHandles;
+
+    // Where each fingertip probe was issued last, the probes sweep from there to the current tip position
+    TArray<FVector> FingertipProbePositions;
+
+    // The current fingertip contacts, referenced through UQuestHandsComponent::AddReferencedObjects
+    TArray<FQHandFingertipContact> FingertipContacts;
+
+    // The latest completed pointer trace
+    FQHandPointerTrace PointerTrace;
+
+    // The bones in each space, filled lazily by the bone queries of the component which may be const
+    mutable FQHandBoneSpaceBuffer BoneSpaces[(int32)EQHandBoneSpace::BoneSpace_Max];
+
+    // Changes rarely, only when the runtime reports a new skeleton
+    FQHandSkeleton Skeleton;
+
+    FQHandRuntimeState()
+        : Revision(1)
+        , PokeTipPrevious(ForceInitToZero)
+        , PointerTraceReadFrame(0)
+        , NumMissingCapsules(0)
+    {
+#if QUESTHANDS_LATENCY_TRACING
+        SampleTime = 0.0;
+        SampleFrame = 0;
+#endif
+    }
+
+    SIZE_T GetAllocatedSize() const;
+
+    // The part of GetAllocatedSize holding the skeleton and tracking state read from the runtime
+    SIZE_T GetTrackingDataAllocatedSize() const;
+};
+
+// Memory used by a hands component and the components it created, in bytes
+struct FQHandMemoryFootprint
+{
+    // The component and its native hand state buffers
+    SIZE_T HandState;
+
+    // The skeletons and tracking states
+    SIZE_T TrackingData;
+
+    // The hand mesh components, excluding the shared mesh assets
+    SIZE_T Poseables;
+
+    // The capsule components with their body instances
+    SIZE_T Capsules;
+
+    // The simulated physics hands with their bodies and joints
+    SIZE_T PhysicsHands;
+
+    FQHandMemoryFootprint()
+        : HandState(0)
+        , TrackingData(0)
+        , Poseables(0)
+        , Capsules(0)
+        , PhysicsHands(0)
+    {}
+
+    SIZE_T GetTotal() const { return HandState + TrackingData + Poseables + Capsules + PhysicsHands; }
+};
 
 /**
 * Tick function that does post physics work on skeletal mesh component. This executes in EndPhysics (after physics is done)
@@ -63,6 +334,9 @@ public:
     virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
 
     // Is hand tracking currently enabled by the user? Returns false if the user has hand tracking disabled on their Oculus Dashboard.
     UFUNCTION(BlueprintPure, Category = "QuestHands")
@@ -77,6 +351,54 @@ public:
     UFUNCTION(BlueprintCallable, Category = "QuestHands")
     bool LoadHandDataDump();
 
+    // Start recording every hand tracking sample to RecordingName.qhrec in the HandRecordings directory of the Saved directory
+    // for the game. Recordings can be analysed offline with the QuestHandsAnalytics commandlet.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Recording")
+    bool StartHandRecording(const FString& RecordingName);
+
+    // Stop the recording started with StartHandRecording and close the file
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Recording")
+    void StopHandRecording();
+
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Recording")
+    bool IsHandRecording() const { return Recorder.IsOpen(); }
+
+    // Start publishing every hand tracking sample to a named shared memory region for external tools to read live,
+    // see QuestHandsSharedFrameLayout.h. An empty name uses QuestHandsFrames. Not available on Android.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Recording")
+    bool StartSharedFrameExport(const FString& RegionName);
+
+    // Stop the export started with StartSharedFrameExport, readers keep the last frames until they let go of the region
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Recording")
+    void StopSharedFrameExport();
+
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Recording")
+    bool IsSharedFrameExporting() const { return SharedFrameWriter.IsOpen(); }
+
+    // Read the hands from a data source instead of the OVR runtime, such as synthetic or recorded hands.
+    // Set this before the component begins play, null goes back to the OVR runtime.
+    void SetDataSource(TSharedPtr<IQuestHandsDataSource> InDataSource) { DataSource = InDataSource; }
+
+    // Start a native wait on a hand condition, see FQHandWaitTask. Waits are evaluated every time the hands are sampled.
+    TSharedRef<FQHandWaitTask> StartHandWait(const FQHandWaitCondition& Condition, TFunction<void(bool)> OnDone = nullptr);
+
+    // Cancel every wait on the hands of this component
+    void CancelHandWaits();
+
+    // Wait until a hand condition holds, such as a pose held for half a second. The hands component evaluates the condition
+    // when it samples the hands, so the waiting actor doesn't need to tick. The wait ends without completing if the
+    // component stops playing.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Wait", meta = (Latent, LatentInfo = "LatentInfo"))
+    void WaitForHandCondition(const FQHandWaitCondition& Condition, FLatentActionInfo LatentInfo);
+
+    // Wait until a hand is tracked
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Wait", meta = (Latent, LatentInfo = "LatentInfo"))
+    void WaitForHandTracked(EControllerHand Hand, FLatentActionInfo LatentInfo);
+
+    // Wait until a finger pinches the thumb for HoldTime seconds
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Wait", meta = (Latent, LatentInfo = "LatentInfo"))
+    void WaitForPinch(EControllerHand Hand, EQHandFinger Finger, float HoldTime, FLatentActionInfo LatentInfo);
+
     // Create poseable mesh components and assign LeftHandMesh and RightHandMesh
     // If this is disabled you need to supply your own mesh components parented to this QuestHands component and set the names to look for with
     // LeftHandMeshComponentName and RightHandMeshComponentName fields.
@@ -98,13 +420,33 @@ public:
     FString RightHandMeshComponentName;
 
     // The mesh to use for the left hand (Needs to conform to Oculus's example hand mesh bone structure OR you will get errors)
+    // Loaded asynchronously when play begins, the hand mesh components are created once it is loaded.
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "CreateHandMeshComponents"))
-    USkeletalMesh* LeftHandMesh;
+    TSoftObjectPtr<USkeletalMesh> LeftHandMeshAsset;
 
     // The mesh to use for the right hand (Needs to conform to Oculus's example hand mesh bone structure OR you will get errors)
+    // Loaded asynchronously when play begins, the hand mesh components are created once it is loaded.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "CreateHandMeshComponents"))
+    TSoftObjectPtr<USkeletalMesh> RightHandMeshAsset;
+
+    // A loaded mesh to use for the left hand instead of LeftHandMeshAsset
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "CreateHandMeshComponents"))
+    USkeletalMesh* LeftHandMesh;
+
+    // A loaded mesh to use for the right hand instead of RightHandMeshAsset
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "CreateHandMeshComponents"))
     USkeletalMesh* RightHandMesh;
 
+    // Take the created hand mesh and capsule components from the worlds pool (see UQuestHandsPoolSubsystem) and return them when destroyed.
+    // Makes spawning and destroying hands pawns cheap, for example when players join or replay ghosts appear.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands")
+    bool UsePooledComponents;
+
+    // Draw the hands as instanced bone segments of the worlds ghost hands (see UQuestHandsGhostSubsystem) instead of hand meshes.
+    // Much cheaper per hand for crowds of remote players or replay ghosts, but only shows the shape of the bones.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands")
+    bool UseGhostHands;
+
     // Should the hand mesh scale update based on what the OVR API thinks the users hand size is in relation to the standard hand mesh?
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "UpdateHandMeshComponents"))
     bool UpdateHandScale;
@@ -113,10 +455,105 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "UpdateHandMeshComponents"))
     bool UpdatePhysicsCapsules;
 
-	// Physics scene information for the generated capsules
+	// Physics scene information for the generated capsules. Simulate Physics is ignored, the capsules are always kinematic and
+	// follow the hands, use UsePhysicsHands for simulated hands. Enable CCD here to keep fast hands from passing through thin
+	// objects when physics substepping is off.
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "QuestHands", meta = (SkipUCSModifiedProperties, EditCondition = "UpdatePhysicsCapsules"))
 	FBodyInstance CapsuleBodyData;
 
+    // Fixed number of capsule updates per second, independent of the render framerate. 0 updates the capsules once per physics tick.
+    // The capsules are given one kinematic target per physics tick, the hand pose at the last fixed update within the tick
+    // interpolated between the previous and current physics samples. Physics keeps a single kinematic target per simulation,
+    // with substepping enabled the physics scene moves the capsules to it along the way over the substeps.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "UpdatePhysicsCapsules", ClampMin = "0.0"))
+    float CapsuleUpdateRate;
+
+    // Skip the overlap update of each capsule move and resolve the overlaps of a hand with one aggregated query afterwards.
+    // The overlaps are kept by the engine as usual, with begin and end overlap events per capsule and per actor,
+    // but overlaps between the hand capsules themselves are ignored.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "UpdatePhysicsCapsules"))
+    bool BatchCapsuleOverlaps;
+
+    // The maximum number of capsule components created in a frame, spreading the cost of setting up the capsules over a few frames.
+    // 0 creates all of them at once, as does LoadHandDataDump.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands", meta = (EditCondition = "UpdatePhysicsCapsules", ClampMin = "0"))
+    int32 MaxCapsuleCreatesPerFrame;
+
+    // Should the update rate of this component scale with its significance?
+    // The local player is always updated at the full rate, other hands are updated at a reduced rate with distance and
+    // skip pose updates entirely when their meshes have not been rendered recently.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|LOD")
+    bool UseUpdateLOD;
+
+    // Force the full update rate even if this component doesn't belong to the locally controlled pawn
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|LOD", meta = (EditCondition = "UseUpdateLOD"))
+    bool ForceFullUpdateLOD;
+
+    // Distance from the viewer in world units after which the hands are updated at the reduced rate
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|LOD", meta = (EditCondition = "UseUpdateLOD", ClampMin = "0.0"))
+    float ReducedLODDistance;
+
+    // Samples per second of the hand pose at the reduced LOD. The meshes are interpolated between samples.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|LOD", meta = (EditCondition = "UseUpdateLOD", ClampMin = "1.0"))
+    float ReducedLODUpdateRate;
+
+    // Capsule updates per second when not at the full LOD. Scales independently of the mesh update rate.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|LOD", meta = (EditCondition = "UseUpdateLOD", ClampMin = "1.0"))
+    float ReducedLODCapsuleUpdateRate;
+
+    // Time in seconds the hand meshes can go without being rendered before pose updates are skipped
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|LOD", meta = (EditCondition = "UseUpdateLOD", ClampMin = "0.0"))
+    float SkippedLODRenderTimeout;
+
+    // Should this component follow the levels of the worlds performance governor (see UQuestHandsGovernorSubsystem)?
+    // The governor only lowers the capsule and reduced LOD update rates set here, it never raises them.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|LOD")
+    bool UseGovernor;
+
+    // Replace the kinematic capsules with simulated articulated hands which follow the tracked hands through drives.
+    // Physics hands are stopped by the world and can push objects. They use CapsuleBodyData for their collision settings.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|PhysicsHand", meta = (EditCondition = "UpdatePhysicsCapsules"))
+    bool UsePhysicsHands;
+
+    // Should the hand meshes follow the simulated physics hands instead of the tracked hands?
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|PhysicsHand", meta = (EditCondition = "UsePhysicsHands"))
+    bool PoseMeshesFromPhysicsHands;
+
+    // Drive, solver and sleep settings of the physics hands. Applied when the physics hands are built.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|PhysicsHand", meta = (EditCondition = "UsePhysicsHands"))
+    FQHandPhysicsHandSettings PhysicsHandSettings;
+
+    // Should the fingertips be probed for touches with the world?
+    // Probes are issued as async queries after the physics tick and the results are delivered on the next frame.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Fingertips")
+    bool UseFingertipProbes;
+
+    // The bones to probe and their radii, used for both hands
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Fingertips", meta = (EditCondition = "UseFingertipProbes"))
+    TArray<FQHandFingertipProbe> FingertipProbes;
+
+    // The collision channel the fingertip probes query against
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Fingertips", meta = (EditCondition = "UseFingertipProbes"))
+    TEnumAsByte<ECollisionChannel> FingertipProbeChannel;
+
+    // Should this component trace from the pointer pose of each hand?
+    // One async line trace is issued per hand per frame while the hand input is valid and the result is shared by every
+    // consumer through GetPointerTrace, so laser FX, widget interaction and selection don't need to trace themselves.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Pointer")
+    bool UsePointerTraces;
+
+    // The collision channel the pointer traces query against
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Pointer", meta = (EditCondition = "UsePointerTraces"))
+    TEnumAsByte<ECollisionChannel> PointerTraceChannel;
+
+    // The length of the pointer traces in world units
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Pointer", meta = (EditCondition = "UsePointerTraces", ClampMin = "0.0"))
+    float PointerTraceDistance;
+
+    // Should the index fingertips poke the panels registered with the poke subsystem?
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Poke")
+    bool UsePokeInteraction;
+
     // Used to correct the rotation from the Oculus hand bone rotations to conform to your mesh
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands")
     FRotator LeftHandBoneRotationOffset;
@@ -125,21 +562,89 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands")
     FRotator RightHandBoneRotationOffset;
 
+    // Drives hand meshes with their own skeletons, used instead of the rotation offsets for the meshes it was baked for
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands")
+    class UQuestHandsRetarget* HandRetarget;
+
     // The current left hand skeleton data
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    FQHandSkeleton LeftHandSkeletonData;
+    UPROPERTY(BlueprintGetter = GetLeftHandSkeletonData, BlueprintSetter = SetLeftHandSkeletonData, Category = "QuestHands")
+    mutable FQHandSkeleton LeftHandSkeletonData;
 
     // The current right hand skeleton data
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    FQHandSkeleton RightHandSkeletonData;
+    UPROPERTY(BlueprintGetter = GetRightHandSkeletonData, BlueprintSetter = SetRightHandSkeletonData, Category = "QuestHands")
+    mutable FQHandSkeleton RightHandSkeletonData;
 
     // The current left hand tracking data
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    FQHandTrackingState LeftHandTrackingData;
+    UPROPERTY(BlueprintGetter = GetLeftHandTrackingData, BlueprintSetter = SetLeftHandTrackingData, Category = "QuestHands")
+    mutable FQHandTrackingState LeftHandTrackingData;
 
     // The current right hand tracking data
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    FQHandTrackingState RightHandTrackingData;
+    UPROPERTY(BlueprintGetter = GetRightHandTrackingData, BlueprintSetter = SetRightHandTrackingData, Category = "QuestHands")
+    mutable FQHandTrackingState RightHandTrackingData;
+
+    // The features of the left hand computed with each tracking update
+    UPROPERTY(BlueprintGetter = GetLeftHandFeatures, Category = "QuestHands")
+    mutable FQHandFeatures LeftHandFeatures;
+
+    // The features of the right hand computed with each tracking update
+    UPROPERTY(BlueprintGetter = GetRightHandFeatures, Category = "QuestHands")
+    mutable FQHandFeatures RightHandFeatures;
+
+    // Blueprint accessors of the hand state. The properties above are only refreshed from the native state when read after it changed.
+    UFUNCTION(BlueprintGetter)
+    const FQHandSkeleton& GetLeftHandSkeletonData() const;
+    UFUNCTION(BlueprintSetter)
+    void SetLeftHandSkeletonData(const FQHandSkeleton& SkeletonData);
+    UFUNCTION(BlueprintGetter)
+    const FQHandSkeleton& GetRightHandSkeletonData() const;
+    UFUNCTION(BlueprintSetter)
+    void SetRightHandSkeletonData(const FQHandSkeleton& SkeletonData);
+    UFUNCTION(BlueprintGetter)
+    const FQHandTrackingState& GetLeftHandTrackingData() const;
+    UFUNCTION(BlueprintSetter)
+    void SetLeftHandTrackingData(const FQHandTrackingState& TrackingData);
+    UFUNCTION(BlueprintGetter)
+    const FQHandTrackingState& GetRightHandTrackingData() const;
+    UFUNCTION(BlueprintSetter)
+    void SetRightHandTrackingData(const FQHandTrackingState& TrackingData);
+    UFUNCTION(BlueprintGetter)
+    const FQHandFeatures& GetLeftHandFeatures() const;
+    UFUNCTION(BlueprintGetter)
+    const FQHandFeatures& GetRightHandFeatures() const;
+    UFUNCTION(BlueprintGetter)
+    const TArray<FTransform>& GetLeftHandBones() const;
+    UFUNCTION(BlueprintSetter)
+    void SetLeftHandBones(const TArray<FTransform>& Bones);
+    UFUNCTION(BlueprintGetter)
+    const TArray<FTransform>& GetRightHandBones() const;
+    UFUNCTION(BlueprintSetter)
+    void SetRightHandBones(const TArray<FTransform>& Bones);
+    UFUNCTION(BlueprintGetter)
+    const TArray<class UCapsuleComponent*>& GetLeftCapsules() const;
+    UFUNCTION(BlueprintGetter)
+    const TArray<class UCapsuleComponent*>& GetRightCapsules() const;
+
+    // Native access to the hand state without going through the Blueprint mirrors
+    const FQHandSkeleton& GetHandSkeleton(EControllerHand Hand) const { return GetHandState(Hand).Skeleton; }
+    const FQHandTrackingState& GetHandTrackingState(EControllerHand Hand) const { return GetHandState(Hand).TrackingState; }
+    const TArray<FTransform>& GetHandBones(EControllerHand Hand) const { return GetHandState(Hand).Bones; }
+    const TArray<class UCapsuleComponent*>& GetHandCapsules(EControllerHand Hand) const { return GetHandState(Hand).Capsules; }
+
+    // The transform of a bone in a space. Each space is worked out from the world space bones on its first query in a frame
+    // and cached, further queries that frame are lookups.
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Bones")
+    FTransform GetBoneTransform(EControllerHand Hand, EQHandBones Bone, EQHandBoneSpace Space) const;
+
+    // The transforms of every bone of a hand in a space, indexed by EQHandBones
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Bones")
+    void GetBoneTransforms(EControllerHand Hand, EQHandBoneSpace Space, TArray<FTransform>& TransformsOut) const;
+
+    // The locations of a set of bones in a space, such as the fingertips relative to the wrist
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Bones")
+    void GetBoneLocations(EControllerHand Hand, const TArray<EQHandBones>& Bones, EQHandBoneSpace Space, TArray<FVector>& LocationsOut) const;
+
+    // Native access to the cached bones of a space, valid until the hand state changes or the next frame
+    const FQHandBoneSpaceBuffer& GetBoneSpace(EControllerHand Hand, EQHandBoneSpace Space) const;
 
     // An event called just before the latest rendering hand state is applied to the poseable meshes.
     // This gives you an opportunity to update the leftHandBones or rightHandBones transforms before they are applied.
@@ -150,6 +655,63 @@ public:
     // This gives you an opportunity to update the leftHandBones or rightHandBones transforms before they are applied.
     UPROPERTY(BlueprintAssignable, SkipSerialization)
     FOnQHandsPreApplyTransformsDelegate OnPreCapsulesUpdate;
+
+    // An event called when a fingertip probe starts touching a component
+    UPROPERTY(BlueprintAssignable, SkipSerialization)
+    FOnQHandsFingertipTouchDelegate OnFingertipTouchBegin;
+
+    // An event called when a fingertip probe stops touching a component
+    UPROPERTY(BlueprintAssignable, SkipSerialization)
+    FOnQHandsFingertipTouchDelegate OnFingertipTouchEnd;
+
+    // The fingertip contacts of a hand from the latest completed probes
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Fingertips")
+    const TArray<FQHandFingertipContact>& GetFingertipContacts(EControllerHand Hand) const;
+
+    // The latest completed pointer trace of a hand. The trace is issued one frame before the result is available.
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Pointer")
+    const FQHandPointerTrace& GetPointerTrace(EControllerHand Hand) const;
+
+    // Find the interactables registered with the grab subsystem which are within SearchRadius of the wrist or fingertips of a hand.
+    // Candidates are ranked by distance, favoring those near the thumb and index tips as the index pinch strengthens.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Grab")
+    bool FindGrabCandidates(EControllerHand Hand, float SearchRadius, TArray<FQHandGrabCandidate>& CandidatesOut);
+
+    // The update LOD this component was last ticked at
+    UFUNCTION(BlueprintPure, Category = "QuestHands|LOD")
+    EQHandUpdateLOD GetUpdateLOD() const { return CurrentUpdateLOD; }
+
+    // The memory used by this component and the components it created
+    void GetMemoryFootprint(FQHandMemoryFootprint& FootprintOut) const;
+
+    // The total memory in bytes used by this component and the components it created
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Memory")
+    int64 GetMemoryFootprintBytes() const;
+
+    // Report the footprint to the memory accounting if it changed since it was last reported, see QuestHandsMemory.h
+    void RefreshMemoryFootprint(FQHandMemoryFootprint* FootprintOut = nullptr);
+
+    // The footprint in bytes this component last reported to the memory accounting
+    int64 GetReportedMemoryBytes() const { return ReportedMemoryBytes; }
+
+    // Called by the governor when it changes level
+    void SetGovernorLevel(const FQHandGovernorLevel& Level) { GovernorLevel = Level; }
+
+    // The features of a hand computed with the latest tracking update
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Features")
+    const FQHandFeatures& GetHandFeatures(EControllerHand Hand) const;
+
+    // Curl of a finger from the latest tracking update, 0 is straight and 1 is fully curled
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Features")
+    float GetFingerCurl(EControllerHand Hand, EQHandFinger Finger) const;
+
+    // Splay in degrees between a finger and the next finger towards the pinky. Returns 0 for the pinky.
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Features")
+    float GetFingerSplay(EControllerHand Hand, EQHandFinger Finger) const;
+
+    // World space distance between the thumb tip and the tip of a finger. Returns 0 for the thumb.
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Features")
+    float GetTipToThumbDistance(EControllerHand Hand, EQHandFinger Finger) const;
 protected:
 
     // Left hand poseable mesh components (Usually just 1 but can contain multiple meshes for outline meshes)
@@ -160,29 +722,37 @@ protected:
     UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
     TArray<class UPoseableMeshComponent*> rightPoseables;
 
-    // Left hand bone transforms in world space
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    TArray<FTransform> leftHandBones;
+    // Left hand bone transforms in world space. Mirror of the native hand state, use GetHandBones from C++.
+    UPROPERTY(BlueprintGetter = GetLeftHandBones, BlueprintSetter = SetLeftHandBones, Category = "QuestHands")
+    mutable TArray<FTransform> leftHandBones;
 
     // Left hand bone centers in world space
     UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
     TArray<FVector> leftHandBoneCenters;
 
-    // Right hand bone transforms in world space
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    TArray<FTransform> rightHandBones;
+    // Right hand bone transforms in world space. Mirror of the native hand state, use GetHandBones from C++.
+    UPROPERTY(BlueprintGetter = GetRightHandBones, BlueprintSetter = SetRightHandBones, Category = "QuestHands")
+    mutable TArray<FTransform> rightHandBones;
 
     // Left hand bone centers in world space
     UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
     TArray<FVector> rightHandBoneCenters;
 
-    // Capsules on the left hand
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    TArray<class UCapsuleComponent*> leftCapsules;
+    // Capsules on the left hand. Mirror of the native hand state, use GetHandCapsules from C++.
+    UPROPERTY(BlueprintGetter = GetLeftCapsules, Category = "QuestHands")
+    mutable TArray<class UCapsuleComponent*> leftCapsules;
 
-    // Capsules on the right hand
-    UPROPERTY(BlueprintReadWrite, Category = "QuestHands")
-    TArray<class UCapsuleComponent*> rightCapsules;
+    // Capsules on the right hand. Mirror of the native hand state, use GetHandCapsules from C++.
+    UPROPERTY(BlueprintGetter = GetRightCapsules, Category = "QuestHands")
+    mutable TArray<class UCapsuleComponent*> rightCapsules;
+
+    // Simulated left hand if UsePhysicsHands is enabled
+    UPROPERTY(BlueprintReadOnly, Transient, Category = "QuestHands")
+    UQuestHandsPhysicsHand* leftPhysicsHand;
+
+    // Simulated right hand if UsePhysicsHands is enabled
+    UPROPERTY(BlueprintReadOnly, Transient, Category = "QuestHands")
+    UQuestHandsPhysicsHand* rightPhysicsHand;
 
 private:
 
@@ -194,8 +764,111 @@ private:
     void SetupBoneTransforms(const FQHandSkeleton& skeleton, const FQHandTrackingState& trackingState, TArray<FTransform>& boneTransforms, bool leftHand);
     void UpdatePoseableWithBoneTransforms(class UPoseableMeshComponent* poseable, const TArray<FTransform>& boneTransforms);
     void DoUpdateHandMeshComponents(bool visualComponents, bool physicsComponents);
-    void SetupCapsuleComponents();
-    void UpdateCapsules(const TArray<FTransform>& bones, TArray<UCapsuleComponent*>& capsules, const FQHandSkeleton& skeleton);
+    void SetupCapsuleComponents(bool useCreateBudget = true);
+    bool NeedsCapsuleSetup() const;
+    void ReleaseHandComponents();
+    void RequestHandPoseable(bool leftHand);
+    void OnHandMeshLoaded(bool leftHand);
+    void CreateHandPoseable(bool leftHand, USkeletalMesh* mesh);
+    void UpdateCapsules(const TArray<FTransform>& bones, FQHandRuntimeState& handState);
+    void StepCapsules(float SampleDeltaTime);
+    void UpdatePhysicsHand(UQuestHandsPhysicsHand*& physicsHand, const FQHandRuntimeState& handState);
+    void ResolveBatchedCapsuleOverlaps(FQHandRuntimeState& handState);
+
+    void IssueFingertipProbes(FQHandRuntimeState& handState);
+    void CollectFingertipProbes(EControllerHand hand, FQHandRuntimeState& handState);
+
+    void UpdatePoke(EControllerHand hand, FQHandRuntimeState& handState, float DeltaTime);
+    void IssuePointerTrace(FQHandRuntimeState& handState);
+    void CollectPointerTrace(FQHandRuntimeState& handState);
+
+    EQHandUpdateLOD EvaluateUpdateLOD() const;
+    float GetEffectiveCapsuleUpdateRate() const;
+    float GetEffectiveReducedLODUpdateRate() const;
+    bool IsLocallyControlled() const;
+    bool WereHandMeshesRecentlyRendered() const;
+    void InterpolateBoneTransforms(const TArray<FTransform>& fromBones, const TArray<FTransform>& toBones, float alpha, TArray<FTransform>& bonesOut);
+    void FillBoneSpace(const FQHandRuntimeState& handState, EQHandBoneSpace space, FQHandBoneSpaceBuffer& buffer) const;
+
+    FQHandRuntimeState& GetHandState(EControllerHand Hand) { return HandStates[Hand == EControllerHand::Left ? 0 : 1]; }
+    const FQHandRuntimeState& GetHandState(EControllerHand Hand) const { return HandStates[Hand == EControllerHand::Left ? 0 : 1]; }
+
+    // The Blueprint mirror properties of the hand state
+    enum EHandMirror
+    {
+        HandMirror_Skeleton,
+        HandMirror_TrackingState,
+        HandMirror_Bones,
+        HandMirror_Capsules,
+        HandMirror_Features,
+        HandMirror_Max
+    };
+
+    // Copy a mirror property from the native hand state if the state changed since it was last copied
+    template<typename T>
+    const T& RefreshMirror(EControllerHand Hand, EHandMirror Mirror, const T& Source, T& MirrorProperty) const;
+
+    // Write a mirror property back into the native hand state
+    template<typename T>
+    void WriteMirror(EControllerHand Hand, EHandMirror Mirror, T& Target, T& MirrorProperty, const T& Value);
+
+    // Native state of the left (0) and right (1) hands
+    FQHandRuntimeState HandStates[2];
+
+    // The hand state revision each mirror property was last refreshed at
+    mutable uint32 MirrorRevisions[2][HandMirror_Max];
+
+    // The LOD evaluated at the last render tick
+    EQHandUpdateLOD CurrentUpdateLOD;
+
+    // Time accumulated since the last hand sample at a reduced LOD
+    float RenderLODAccumulator;
+
+    // Time accumulated since the last capsule update at a reduced LOD
+    float CapsuleLODAccumulator;
+
+    // Time accumulated towards the next fixed rate capsule update
+    float CapsuleUpdateAccumulator;
+
+    // The footprint last reported to the memory accounting, 0 outside of play
+    int64 ReportedMemoryBytes;
+
+    // The pool hand components are taken from and meshes are loaded through
+    UPROPERTY(Transient)
+    UQuestHandsPoolSubsystem* Pool;
+
+    // The governor this component is registered with
+    UPROPERTY(Transient)
+    UQuestHandsGovernorSubsystem* Governor;
+
+    // The ghost hands drawing the hands when UseGhostHands is set, and the handles of the left (0) and right (1) hands
+    UPROPERTY(Transient)
+    UQuestHandsGhostSubsystem* Ghosts;
+    int32 GhostHandles[2];
+
+    // The governor level settings last applied to this component
+    FQHandGovernorLevel GovernorLevel;
+
+    // Writes the tracking samples while recording
+    FQHandRecordingWriter Recorder;
+
+    // When the recording was started, recorded frame times are relative to it
+    double RecordingStartTime;
+
+    // Publishes the tracking samples while exporting to shared memory
+    FQHandSharedFrameWriter SharedFrameWriter;
+
+    // Where the hands are read from when not the OVR runtime
+    TSharedPtr<IQuestHandsDataSource> DataSource;
+
+    // Pending waits on hand conditions, referenced through UQuestHandsComponent::AddReferencedObjects
+    TArray<TSharedRef<FQHandWaitTask>> HandWaits;
+
+    // Evaluate the waits against the latest hand sample
+    void UpdateHandWaits();
+
+    // Is there hand data to read from the data source or the OVR runtime?
+    bool IsTrackingEnabled() const { return DataSource.IsValid() ? DataSource->IsHandTrackingEnabled() : UQuestHandsFunctions::IsHandTrackingEnabled(); }
 };
 
 // Special class for dumping hand tracking data out to a configuration file
@@ -0,0 +1,70 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputCoreTypes.h"
+#include "QuestHandsFunctions.h"
+#include "QuestHandsRecording.h"
+
+/**
+  * Where a hands component reads its hand data from. Without a data source set the component reads the OVR runtime,
+  * replace it to drive the hands from synthetic or recorded data, such as remote players or load tests.
+*/
+class QUESTHANDS_API IQuestHandsDataSource
+{
+public:
+    virtual ~IQuestHandsDataSource() {}
+
+    // Is there hand data to read? The component doesn't update while this is false.
+    virtual bool IsHandTrackingEnabled() const = 0;
+
+    virtual bool GetHandSkeleton(EControllerHand Hand, FQHandSkeleton& SkeletonOut, float WorldToMeters) = 0;
+    virtual bool GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters) = 0;
+};
+
+/**
+  * Procedural hands on a generic skeleton. The hands drift around in front of the tracking origin while the fingers curl
+  * and pinch, and tracking drops out now and then. Every seed moves differently.
+*/
+class QUESTHANDS_API FQHandSyntheticDataSource : public IQuestHandsDataSource
+{
+public:
+    explicit FQHandSyntheticDataSource(int32 Seed);
+
+    virtual bool IsHandTrackingEnabled() const override { return true; }
+    virtual bool GetHandSkeleton(EControllerHand Hand, FQHandSkeleton& SkeletonOut, float WorldToMeters) override;
+    virtual bool GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters) override;
+
+private:
+    // Phases and rates of the motions of each hand
+    float Phases[2][8];
+    float Rates[2][8];
+    float HandScales[2];
+};
+
+// A recording loaded whole, shared by every data source playing it back
+struct QUESTHANDS_API FQHandRecordingClip
+{
+    FQHandSkeleton Skeletons[2];
+    TArray<FQHandRecordingFrame> Frames;
+
+    bool Load(const FString& FilePath);
+    double GetDuration() const { return Frames.Num() > 1 ? Frames.Last().Time - Frames[0].Time : 0.0; }
+};
+
+// Plays a recording back in a loop, starting TimeOffset seconds into it so sources sharing a clip don't move in lockstep
+class QUESTHANDS_API FQHandRecordingDataSource : public IQuestHandsDataSource
+{
+public:
+    FQHandRecordingDataSource(TSharedRef<const FQHandRecordingClip> InClip, double InTimeOffset);
+
+    virtual bool IsHandTrackingEnabled() const override { return Clip->Frames.Num() > 0; }
+    virtual bool GetHandSkeleton(EControllerHand Hand, FQHandSkeleton& SkeletonOut, float WorldToMeters) override;
+    virtual bool GetTrackingState(EControllerHand Hand, EQHandUpdateStep Step, FQHandTrackingState& StateOut, float WorldToMeters) override;
+
+private:
+    TSharedRef<const FQHandRecordingClip> Clip;
+    double TimeOffset;
+    double StartTime;
+};
@@ -0,0 +1,49 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "QuestHandsFunctions.h"
+
+#include "QuestHandsFrameSubsystem.generated.h"
+
+class USceneComponent;
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Reads both hands from the runtime once per update step in a frame and shares the result with every caller that frame.
+  * The skeletons are cached and only read again when a hand starts being tracked, the world to meters scale is read
+  * once per fill and nothing is logged when hand tracking isn't available.
+*/
+UCLASS()
+class QUESTHANDS_API UQuestHandsFrameSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+public:
+
+    // The hands of this frame for a step, filled on the first call of the step in the frame
+    const FQHandsFrame& GetHandsFrame(EQHandUpdateStep Step);
+
+    // Where the tracking space is in the world, the bones are placed relative to it and scaled by the hand scale. Without an
+    // origin the bones are placed like the hands component of the first local player's pawn places its own, relative to
+    // that component and following its UpdateHandScale, or relative to the pawn without a hands component.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands")
+    void SetTrackingOrigin(USceneComponent* Origin);
+
+    // Make the next GetHandsFrame of each step read the hands again
+    void InvalidateHandsFrames();
+
+private:
+
+    void FillHandsFrame(EQHandUpdateStep Step, FQHandsFrame& Frame);
+    FTransform GetTrackingToWorld(bool& UseHandScaleOut) const;
+
+    FQHandsFrame Frames[2];
+
+    // The cached skeletons of the left (0) and right (1) hands
+    FQHandSkeleton Skeletons[2];
+
+    UPROPERTY(Transient)
+    TWeakObjectPtr<USceneComponent> TrackingOrigin;
+};
@@ -186,6 +186,52 @@ struct FQHandSkeleton
     TArray<FQHandBoneCapsule> BoneCapsules;
 };
 
+// Per hand features derived from the bone transforms once per update so gameplay code doesn't have to recompute them
+USTRUCT(BlueprintType, DisplayName = "Hand Features")
+struct FQHandFeatures
+{
+    GENERATED_BODY()
+
+    // Was the hand tracked when the features were computed?
+    UPROPERTY(BlueprintReadOnly, Category = "HandFeatures")
+    bool Valid;
+
+    // Curl per finger (in Hand Finger order), 0 is straight and 1 is fully curled
+    UPROPERTY()
+    float FingerCurl[5];
+
+    // Splay in degrees between neighboring fingers in the palm plane: thumb-index, index-middle, middle-ring, ring-pinky
+    UPROPERTY()
+    float FingerSplay[4];
+
+    // World space distance from the thumb tip to the index, middle, ring and pinky tips
+    UPROPERTY()
+    float TipToThumbDistance[4];
+
+    // World space normal pointing out of the palm
+    UPROPERTY(BlueprintReadOnly, Category = "HandFeatures")
+    FVector PalmNormal;
+
+    // World space center of the palm
+    UPROPERTY(BlueprintReadOnly, Category = "HandFeatures")
+    FVector PalmCenter;
+
+    // World space aim direction of the pointer pose
+    UPROPERTY(BlueprintReadOnly, Category = "HandFeatures")
+    FVector AimDirection;
+
+    FQHandFeatures()
+        : Valid(false)
+        , PalmNormal(ForceInitToZero)
+        , PalmCenter(ForceInitToZero)
+        , AimDirection(ForceInitToZero)
+    {
+        FMemory::Memzero(FingerCurl);
+        FMemory::Memzero(FingerSplay);
+        FMemory::Memzero(TipToThumbDistance);
+    }
+};
+
 UENUM(BlueprintType, DisplayName = "Hand Update Step")
 enum class EQHandUpdateStep : uint8
 {
@@ -196,6 +242,59 @@ enum class EQHandUpdateStep : uint8
     UpdateStep_Physics
 };
 
+// One hand of a hands frame
+USTRUCT(BlueprintType, DisplayName = "Hand Frame")
+struct FQHandFrame
+{
+    GENERATED_BODY()
+
+    // The tracking state of the hand, including its pinches
+    UPROPERTY(BlueprintReadOnly, Category = "HandsFrame")
+    FQHandTrackingState TrackingState;
+
+    // World space bone transforms corresponding with the Enum Hand Bones, empty while the hand isn't tracked
+    UPROPERTY(BlueprintReadOnly, Category = "HandsFrame")
+    TArray<FTransform> Bones;
+
+    // The skeleton the bones were posed with, cached by UQuestHandsFrameSubsystem. Native only.
+    const FQHandSkeleton* Skeleton;
+
+    FQHandFrame()
+        : Skeleton(nullptr)
+    {}
+};
+
+// Both hands read for one update step of a frame, see UQuestHandsFrameSubsystem
+USTRUCT(BlueprintType, DisplayName = "Hands Frame")
+struct FQHandsFrame
+{
+    GENERATED_BODY()
+
+    // Was hand tracking available when the frame was read?
+    UPROPERTY(BlueprintReadOnly, Category = "HandsFrame")
+    bool Valid;
+
+    UPROPERTY(BlueprintReadOnly, Category = "HandsFrame")
+    EQHandUpdateStep Step;
+
+    UPROPERTY(BlueprintReadOnly, Category = "HandsFrame")
+    FQHandFrame LeftHand;
+
+    UPROPERTY(BlueprintReadOnly, Category = "HandsFrame")
+    FQHandFrame RightHand;
+
+    // The engine frame the hands were read in
+    uint64 FrameNumber;
+
+    FQHandsFrame()
+        : Valid(false)
+        , Step(EQHandUpdateStep::UpdateStep_Render)
+        , FrameNumber(0)
+    {}
+
+    const FQHandFrame& GetHand(EControllerHand Hand) const { return Hand == EControllerHand::Left ? LeftHand : RightHand; }
+};
+
 //---------------------------------------------------------------------------------------------------------------------
 /**
   * Blueprint Functions for querying the Oculus Hands Interface
@@ -218,7 +317,9 @@ public:
     static bool GetTrackingState(const UObject* WorldContextObject, const EControllerHand Hand, const EQHandUpdateStep Step, FQHandTrackingState& stateOut);
 
     // Internal version for native, not blueprint accessible!
-    static bool GetTrackingState_Internal(const EControllerHand Hand, const EQHandUpdateStep Step, FQHandTrackingState& stateOut, const float worldToMeters);
+    // sampleTimeOut receives when the runtime sampled the hand, in FPlatformTime::Seconds.
+    static bool GetTrackingState_Internal(const EControllerHand Hand, const EQHandUpdateStep Step, FQHandTrackingState& stateOut, const float worldToMeters, 
+                                          double* sampleTimeOut = nullptr);
 
     /**
      * Get the hand skeleton in its reference pose.
@@ -230,6 +331,22 @@ public:
     // Internal version for native, not blueprint accessible!
     static bool GetHandSkeleton_Internal(const EControllerHand Hand, FQHandSkeleton& skeletonOut, const float worldToMeters);
 
+    /**
+     * Get both hands in one call: their tracking states, pinches and world space bones.
+     * The hands are read once per update step in a frame and shared by every caller, use this instead of calling
+     * GetHandSkeleton and GetTrackingState for each hand. Native code can use UQuestHandsFrameSubsystem to avoid the copy.
+    */
+    UFUNCTION(BlueprintCallable, Category = "QuestHands", meta = (WorldContext = "WorldContextObject"))
+    static bool GetHandsFrame(const UObject* WorldContextObject, const EQHandUpdateStep Step, FQHandsFrame& frameOut);
+
+    /**
+     * Compute the features of a hand from its world space bone transforms (see UQuestHandsComponent) and tracking state.
+     * TrackingToWorld converts the tracking space poses of the tracking state, such as the pointer pose, to world space.
+    */
+    UFUNCTION(BlueprintCallable, Category = "QuestHands")
+    static void ComputeHandFeatures(const TArray<FTransform>& Bones, const FQHandTrackingState& TrackingState, const FTransform& TrackingToWorld, 
+                                    bool Left, FQHandFeatures& FeaturesOut);
+
     /** From the bone enum value return the standard bone name that would have been assigned to the Oculus example hand skeletal mesh */
     UFUNCTION(BlueprintPure, Category = "QuestHands", meta = (WorldContext = "WorldContextObject"))
     static FString GetHandBoneName(const EQHandBones bone, bool left);
@@ -243,4 +360,12 @@ public:
     */
     UFUNCTION(BlueprintCallable, Category="QuestHands")
     static bool SetDynamicFixedFoveatedEnabled(bool enabled);
+
+    /**
+     * Set the fixed foveated rendering level, 0 (off) to 4 (high top).
+     * With dynamic foveation enabled this is the maximum level the runtime may use.
+     * Results if the success value from the OVR API
+    */
+    UFUNCTION(BlueprintCallable, Category="QuestHands")
+    static bool SetFixedFoveatedLevel(int32 level);
 };
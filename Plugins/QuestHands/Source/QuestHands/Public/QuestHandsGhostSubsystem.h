@@ -0,0 +1,92 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+
+#include "QuestHandsGhostSubsystem.generated.h"
+
+class UStaticMesh;
+class UMaterialInterface;
+class UInstancedStaticMeshComponent;
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Per world lightweight rendering of many hands, such as remote players or replay ghosts. Every ghost hand is a block
+  * of instances of one segment mesh, one per bone capsule, all in a single instanced static mesh. Hands write their
+  * segment transforms straight from their bone arrays and the instances are updated in bulk once per frame, instead of a
+  * poseable mesh with its own bone updates and draw calls per hand. The instances move every frame, so they aren't kept in
+  * a hierarchical instanced mesh whose cluster tree would be rebuilt after every update.
+*/
+UCLASS()
+class QUESTHANDS_API UQuestHandsGhostSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsGhostSubsystem();
+
+    virtual void Deinitialize() override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual bool IsTickableWhenPaused() const override { return true; }
+    virtual TStatId GetStatId() const override;
+
+    // Add a hidden ghost hand, returns the handle to update and remove it with
+    int32 AddGhostHand();
+
+    // Remove a ghost hand, its instances are reused by the next hand added
+    void RemoveGhostHand(int32 Handle);
+
+    // Place the segments of a ghost hand from world space bones indexed by EQHandBones, the bone scale scales the segments
+    void UpdateGhostHand(int32 Handle, const TArray<FTransform>& Bones);
+
+    // Stop drawing a ghost hand until it is updated again
+    void HideGhostHand(int32 Handle);
+
+    int32 GetNumGhostHands() const { return NumSlots - FreeSlots.Num(); }
+
+    // Time spent writing the instances to the instanced mesh and its render state since the subsystem was created, for benchmarks
+    double GetTotalFlushMs() const { return TotalFlushMs; }
+
+    // The mesh drawn for each bone segment, stretched from its bounds to the segment. Defaults to the engine cylinder.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Ghosts")
+    UStaticMesh* SegmentMesh;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Ghosts")
+    UMaterialInterface* SegmentMaterial;
+
+    // Radius of the segments in world units at a bone scale of 1
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Ghosts", meta = (ClampMin = "0.0"))
+    float SegmentRadius;
+
+private:
+
+    UInstancedStaticMeshComponent* GetInstances();
+
+    UPROPERTY(Transient)
+    AActor* InstancesActor;
+
+    UPROPERTY(Transient)
+    UInstancedStaticMeshComponent* Instances;
+
+    // Center of the segment mesh bounds and the scale taking the mesh to a unit radius and length
+    FVector MeshOrigin;
+    FVector MeshSizeInv;
+
+    // The world transform of every instance, NumCapsules per slot, written to the instanced mesh in one batch
+    TArray<FTransform> InstanceTransforms;
+
+    // Slots of removed hands, reused before the instances grow
+    TArray<int32> FreeSlots;
+    int32 NumSlots;
+
+    // Have the instance transforms changed since the last flush?
+    bool InstancesDirty;
+
+    double TotalFlushMs;
+};
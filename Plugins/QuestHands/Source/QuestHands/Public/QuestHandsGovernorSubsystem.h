@@ -0,0 +1,194 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "QuestHandsFunctions.h"
+
+#include "QuestHandsGovernorSubsystem.generated.h"
+
+// The cost settings of one governor level, applied to every hands component and the foveation of the device
+USTRUCT(BlueprintType, DisplayName = "Hand Governor Level")
+struct FQHandGovernorLevel
+{
+    GENERATED_BODY()
+
+    // Fixed capsule update rate to cap the hands components at, 0 leaves the components setting alone
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GovernorLevel", meta = (ClampMin = "0.0"))
+    float CapsuleUpdateRate;
+
+    // Scale of the distance after which hands drop to the reduced update LOD, lower switches sooner
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GovernorLevel", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float ReducedLODDistanceScale;
+
+    // Sample rate to cap the reduced update LOD at, 0 leaves the components setting alone
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GovernorLevel", meta = (ClampMin = "0.0"))
+    float ReducedLODUpdateRate;
+
+    // Fixed foveation level, 0 (off) to 4 (high top). -1 leaves the foveation alone, as the project or the last level
+    // that set it left it.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GovernorLevel", meta = (ClampMin = "-1", ClampMax = "4"))
+    int32 FoveationLevel;
+
+    FQHandGovernorLevel()
+        : CapsuleUpdateRate(0.0f)
+        , ReducedLODDistanceScale(1.0f)
+        , ReducedLODUpdateRate(0.0f)
+        , FoveationLevel(-1)
+    {}
+
+    FQHandGovernorLevel(float InCapsuleUpdateRate, float InReducedLODDistanceScale, float InReducedLODUpdateRate, int32 InFoveationLevel)
+        : CapsuleUpdateRate(InCapsuleUpdateRate)
+        , ReducedLODDistanceScale(InReducedLODDistanceScale)
+        , ReducedLODUpdateRate(InReducedLODUpdateRate)
+        , FoveationLevel(InFoveationLevel)
+    {}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnQHandsGovernorLevelChangedDelegate, int32, Level);
+
+/**
+  * The platform side of the governor. The default implementation reads the engine thread timings and sets the
+  * foveation through the OVR API, replace it to run the governor against simulated timings.
+*/
+class QUESTHANDS_API IQuestHandsPerformancePlatform
+{
+public:
+    virtual ~IQuestHandsPerformancePlatform() {}
+
+    // The cost of the last frame in milliseconds, the slowest of the game, render and GPU timings
+    virtual float GetFrameTimeMs() const = 0;
+
+    // Set the fixed foveation level, 0 (off) to 4 (high top)
+    virtual bool SetFoveationLevel(int32 Level) = 0;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Per world adaptive performance governor. Watches the frame timings and the cost of the hands components and steps
+  * through the cost levels to hold a target frame time. Steps are taken only after the frame time stayed outside of
+  * the hysteresis band for a while and never closer together than the cooldown, so the level doesn't oscillate.
+  * Stepping back to a better level also has to leave room for the hands time that level cost when it was left.
+  * Level 0 is full quality, every level after it is cheaper.
+*/
+UCLASS()
+class QUESTHANDS_API UQuestHandsGovernorSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsGovernorSubsystem();
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+
+    // Replace the platform the timings are read from and the foveation is applied to. Null restores the default platform.
+    void SetPlatform(TSharedPtr<IQuestHandsPerformancePlatform> InPlatform);
+
+    // Components report here to be stepped with the governor level
+    void RegisterHandsComponent(class UQuestHandsComponent* Component);
+    void UnregisterHandsComponent(class UQuestHandsComponent* Component);
+
+    // Add time spent in a hands component tick this frame, Step tells the render tick from the physics tick
+    void ReportHandsWork(float Milliseconds, EQHandUpdateStep Step)
+    {
+        HandsWorkThisFrame += Milliseconds;
+        TotalHandsWork[Step == EQHandUpdateStep::UpdateStep_Render ? 0 : 1] += Milliseconds;
+    }
+
+    // All the time reported for the ticks of a step since the governor was created, for load tests
+    double GetTotalHandsWorkMs(EQHandUpdateStep Step) const { return TotalHandsWork[Step == EQHandUpdateStep::UpdateStep_Render ? 0 : 1]; }
+
+    // Force a level, clamped to the available levels. The components follow it straight away, the foveation of the level
+    // only once the governor is enabled. The governor continues stepping from there if enabled.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Governor")
+    void SetLevel(int32 NewLevel);
+
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Governor")
+    int32 GetLevel() const { return Level; }
+
+    // The smoothed frame time the governor is acting on
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Governor")
+    float GetSmoothedFrameTimeMs() const { return SmoothedFrameTime; }
+
+    // The smoothed time spent in the hands components per frame
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Governor")
+    float GetSmoothedHandsTimeMs() const { return SmoothedHandsTime; }
+
+    // The settings of the current level
+    const FQHandGovernorLevel& GetCurrentLevelSettings() const;
+
+    // Should the governor step the levels and apply their foveation? Off by default, disabled it keeps the current level
+    // and leaves the foveation alone.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor")
+    bool Enabled;
+
+    // The frame time in milliseconds to hold
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor", meta = (ClampMin = "1.0"))
+    float TargetFrameTime;
+
+    // Fraction above the target the smoothed frame time has to stay for RaiseDelay before a cheaper level is used
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor", meta = (ClampMin = "0.0"))
+    float OverBudgetMargin;
+
+    // Fraction below the target the smoothed frame time has to stay for LowerDelay before a better level is used
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float UnderBudgetMargin;
+
+    // Seconds over budget before stepping to a cheaper level
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor", meta = (ClampMin = "0.0"))
+    float RaiseDelay;
+
+    // Seconds under budget before stepping to a better level, longer than RaiseDelay so quality comes back cautiously
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor", meta = (ClampMin = "0.0"))
+    float LowerDelay;
+
+    // Minimum seconds between two level changes, lets a change show up in the timings before the next one
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor", meta = (ClampMin = "0.0"))
+    float Cooldown;
+
+    // Weight of the newest frame in the smoothed timings
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor", meta = (ClampMin = "0.01", ClampMax = "1.0"))
+    float SmoothingFactor;
+
+    // The cost levels from full quality to cheapest
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Governor")
+    TArray<FQHandGovernorLevel> Levels;
+
+    // Called when the governor changes level
+    UPROPERTY(BlueprintAssignable, Category = "QuestHands|Governor")
+    FOnQHandsGovernorLevelChangedDelegate OnLevelChanged;
+
+private:
+
+    void ApplyLevel();
+    void ApplyFoveation();
+
+    TSharedPtr<IQuestHandsPerformancePlatform> Platform;
+
+    UPROPERTY(Transient)
+    TArray<class UQuestHandsComponent*> HandsComponents;
+
+    int32 Level;
+    float SmoothedFrameTime;
+    float SmoothedHandsTime;
+    float HandsWorkThisFrame;
+    double TotalHandsWork[2];
+    float OverBudgetTime;
+    float UnderBudgetTime;
+    float TimeSinceLevelChange;
+    int32 AppliedFoveationLevel;
+
+    // Is the foveation of the current level still to be applied? Set for the initial level and whenever the platform changes.
+    bool FoveationPending;
+
+    // The smoothed hands time measured at each level when the governor last stepped to a cheaper one, 0 if not known yet
+    TArray<float> LevelHandsTime;
+};
@@ -0,0 +1,113 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SceneComponent.h"
+
+#include "QuestHandsGrabSubsystem.generated.h"
+
+USTRUCT(BlueprintType, DisplayName = "Hand Grab Candidate")
+struct FQHandGrabCandidate
+{
+    GENERATED_BODY()
+
+    // The registered interactable
+    UPROPERTY(BlueprintReadOnly, Category = "GrabCandidate")
+    USceneComponent* Component;
+
+    // Distance from the closest probe point to the surface of the interactables bounding sphere
+    UPROPERTY(BlueprintReadOnly, Category = "GrabCandidate")
+    float Distance;
+
+    // The ranking score, lower is better. Blends from Distance towards the distance to the pinch point as the pinch strengthens.
+    UPROPERTY(BlueprintReadOnly, Category = "GrabCandidate")
+    float Score;
+
+    FQHandGrabCandidate()
+        : Component(nullptr)
+        , Distance(0.0f)
+        , Score(0.0f)
+    {}
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * A per world index of grabbable interactables in a uniform spatial hash.
+  * Interactables are rehashed incrementally as they move and can be queried with hand probe points to find grab candidates
+  * without checking every interactable against every hand.
+*/
+UCLASS()
+class QUESTHANDS_API UQuestHandsGrabSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsGrabSubsystem();
+
+    virtual void Deinitialize() override;
+
+    // Register a component as an interactable with the radius of its bounding sphere. Registering again updates the radius.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Grab")
+    void RegisterInteractable(USceneComponent* Component, float Radius);
+
+    // Remove a component from the interactables
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Grab")
+    void UnregisterInteractable(USceneComponent* Component);
+
+    /**
+     * Find the interactables within SearchRadius of any of the probe points, ranked by their score.
+     * As PinchStrength goes to 1 the ranking favors interactables close to PinchPoint.
+     * A SearchRadius covering more cells than there are interactables tests every interactable instead of the hash.
+    */
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Grab")
+    void FindGrabCandidates(const TArray<FVector>& ProbePoints, const FVector& PinchPoint, float PinchStrength, float SearchRadius,
+                            TArray<FQHandGrabCandidate>& CandidatesOut);
+
+    // The number of registered interactables
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Grab")
+    int32 GetNumInteractables() const { return Interactables.Num(); }
+
+    // The edge length of the hash cells in world units. Changing it rehashes every interactable.
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Grab")
+    void SetCellSize(float NewCellSize);
+
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+private:
+
+    struct FInteractable
+    {
+        TWeakObjectPtr<USceneComponent> Component;
+        FVector Location;
+        float Radius;
+        FIntVector MinCell;
+        FIntVector MaxCell;
+        FDelegateHandle TransformUpdatedHandle;
+        uint32 QueryStamp;
+
+        // Too large for the hash, kept in LargeInteractables instead of the cells
+        bool Large;
+    };
+
+    FIntVector GetCell(const FVector& Location) const;
+    bool GetCellRange(const FVector& Location, float Radius, FIntVector& MinCellOut, FIntVector& MaxCellOut) const;
+    void VisitInteractable(int32 InteractableIndex, TArray<int32, TInlineAllocator<64>>& VisitedOut);
+    void AddToCells(int32 InteractableIndex);
+    void RemoveFromCells(int32 InteractableIndex);
+    void OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+    // Edge length of a hash cell
+    float CellSize;
+
+    // Incremented per query, used to visit each interactable once per query
+    uint32 QueryStamp;
+
+    TSparseArray<FInteractable> Interactables;
+    TMap<TWeakObjectPtr<USceneComponent>, int32> ComponentToInteractable;
+    TMap<FIntVector, TArray<int32>> Cells;
+
+    // Interactables spanning too many cells to hash, tested by every query
+    TArray<int32> LargeInteractables;
+};
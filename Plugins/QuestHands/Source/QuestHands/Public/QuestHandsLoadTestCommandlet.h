@@ -0,0 +1,46 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "QuestHandsLoadTestCommandlet.generated.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Measures how the hands scale with the number of players. For every pawn count a game world is created with that many
+  * pawns carrying a hands component, driven by synthetic hands or by a recording played back from a different point per
+  * pawn. The world is ticked at a fixed rate for the duration and the frame time, the time of the render and physics
+  * ticks of the hands, the time of the physics scene and the memory are compared to an empty world to give the cost per
+  * hand. Runs headless with -nullrhi.
+  *
+  * With -Waiters=N the pawn counts are replaced by a comparison of N actors waiting on a pinch by polling the hands from
+  * their tick with N actors using hand waits with their tick disabled, reporting the actor ticks of each.
+  *
+  * With -SpawnHitch=N the pawn counts are replaced by N pawns joining a running world in one frame, once with all their
+  * capsules created at once and once with -CapsuleBudget= capsules created per frame (MaxCapsuleCreatesPerFrame),
+  * reporting the spawn frame, the worst frame after it and the frames until the capsules are set up. Both are run with
+  * the components created for the pawns, taken from the pool after N pawns left and taken from a prewarmed pool
+  * (UQuestHandsPoolSubsystem::Prewarm), so the pooled and unpooled hitch can be compared.
+  *
+  * With -Ghosts the pawns draw their hands as ghost hands (see UQuestHandsGhostSubsystem) and the time of the instance
+  * flush is reported with the other costs, -Pawns=1+10+50+100 covers 2 to 200 hands.
+  *
+  * With -Export=<region> the hands of the first pawn are exported to shared memory while the test runs, to try readers
+  * such as Extras/QuestHandsSharedFrameReader without a device.
+  *
+  * UE4Editor-Cmd <Project> -run=QuestHandsLoadTest -nullrhi [-Pawns=1+8+32+64+128+256] [-Duration=10] [-FrameRate=72]
+  *     [-Recording=<file>] [-Seed=0] [-NoLOD] [-Ghosts] [-Export=QuestHandsFrames] [-Waiters=200]
+  *     [-SpawnHitch=16] [-CapsuleBudget=8] [-Output=<path without extension>]
+*/
+UCLASS()
+class UQuestHandsLoadTestCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsLoadTestCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
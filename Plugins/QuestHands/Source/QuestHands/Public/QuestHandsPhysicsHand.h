@@ -0,0 +1,139 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "QuestHandsFunctions.h"
+
+#include "QuestHandsPhysicsHand.generated.h"
+
+USTRUCT(BlueprintType, DisplayName = "Hand Physics Hand Settings")
+struct FQHandPhysicsHandSettings
+{
+    GENERATED_BODY()
+
+    // Stiffness of the drive pulling the wrist body towards the tracked wrist, as an acceleration per unit of error
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float LinearStiffness;
+
+    // Damping of the wrist position drive
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float LinearDamping;
+
+    // Stiffness of the drive rotating the wrist body towards the tracked wrist
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float AngularStiffness;
+
+    // Damping of the wrist rotation drive
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float AngularDamping;
+
+    // Stiffness of the joint drives following the tracked bone rotations
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float JointStiffness;
+
+    // Damping of the joint drives
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float JointDamping;
+
+    // Maximum force of the joint drives, 0 is unlimited
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float JointMaxForce;
+
+    // Position solver iterations of each hand body, lower is cheaper but the fingers get springier
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "1", ClampMax = "255"))
+    int32 PositionSolverIterations;
+
+    // Velocity solver iterations of each hand body
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "1", ClampMax = "255"))
+    int32 VelocitySolverIterations;
+
+    // Put the hand bodies to sleep while the hand isn't tracked
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand")
+    bool SleepWhenUntracked;
+
+    // If the wrist body gets further than this from the tracked wrist the whole hand is teleported to the tracked pose
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PhysicsHand", meta = (ClampMin = "0.0"))
+    float TeleportDistance;
+
+    FQHandPhysicsHandSettings()
+        : LinearStiffness(2000.0f)
+        , LinearDamping(90.0f)
+        , AngularStiffness(2000.0f)
+        , AngularDamping(90.0f)
+        , JointStiffness(5000.0f)
+        , JointDamping(100.0f)
+        , JointMaxForce(0.0f)
+        , PositionSolverIterations(8)
+        , VelocitySolverIterations(2)
+        , SleepWhenUntracked(true)
+        , TeleportDistance(30.0f)
+    {}
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * A simulated articulated hand. One rigid body per bone capsule is chained with joints following the hand skeleton.
+  * The joints are driven towards the tracked bone rotations and the wrist body is pulled towards the tracked wrist by
+  * a PD drive evaluated every physics substep, so the hand can push objects and is stopped by the world.
+*/
+UCLASS()
+class QUESTHANDS_API UQuestHandsPhysicsHand : public UObject
+{
+    GENERATED_BODY()
+public:
+
+    // Create the bodies and joints from the skeleton, placed at the supplied world space bone transforms
+    bool Build(USceneComponent* AttachParent, const FQHandSkeleton& Skeleton, const TArray<FTransform>& Bones, const FBodyInstance& BodyTemplate,
+               const FQHandPhysicsHandSettings& InSettings);
+
+    // Destroy all bodies and joints
+    void Destroy();
+
+    // Set the drive targets from the world space tracked bone transforms. Must be called before each physics step.
+    void SetTargets(const TArray<FTransform>& Bones, bool IsTracked);
+
+    // Get world space bone transforms following the simulated bodies. Bones without a body keep their tracked pose relative to their parent.
+    void GetBoneTransforms(const TArray<FTransform>& TrackedBones, TArray<FTransform>& BonesOut) const;
+
+    bool IsBuilt() const { return Bodies.Num() != 0; }
+
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    // The world transform of the capsule placed along a bone towards its child, from world space bone transforms
+    static FTransform GetCapsuleTransform(const TArray<FTransform>& Bones, int32 BoneIndex, int32 ChildBoneIndex);
+
+private:
+
+    void SubstepWrist(float DeltaTime, FBodyInstance* BodyInstance);
+    void Teleport(const TArray<FTransform>& Bones);
+
+    // Bodies indexed by bone, null for bones without a body
+    UPROPERTY(Transient)
+    TArray<class UCapsuleComponent*> Bodies;
+
+    // Joints indexed by the child bone, null for bones without a joint
+    UPROPERTY(Transient)
+    TArray<class UPhysicsConstraintComponent*> Joints;
+
+    // The bone each body follows, parent chain of the bodies and their child bone for placement
+    TArray<int32> ParentBones;
+    TArray<int32> ChildBones;
+
+    // Body rotations in the pose the joints were created in
+    TArray<FQuat> RestBodyRotations;
+
+    // The transform of each body relative to its bone
+    TArray<FTransform> BodyToBone;
+
+    FQHandPhysicsHandSettings Settings;
+
+    // The wrist body target read from the physics substeps
+    FTransform WristTarget;
+
+    FCalculateCustomPhysics OnCalculateWristPhysics;
+
+    bool WasTracked;
+};
@@ -0,0 +1,107 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "InputCoreTypes.h"
+
+#include "QuestHandsPokeSubsystem.generated.h"
+
+UENUM(BlueprintType, DisplayName = "Hand Poke Event")
+enum class EQHandPokeEvent : uint8
+{
+    // The fingertip started hovering in front of the panel
+    PokeEvent_HoverBegin,
+
+    // The fingertip pushed through the front of the panel
+    PokeEvent_Press,
+
+    // The fingertip pulled back out of a pressed panel
+    PokeEvent_Release,
+
+    // The fingertip is no longer in front of the panel
+    PokeEvent_HoverEnd
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnQHandsPokeDelegate, USceneComponent*, Panel, EControllerHand, Hand, EQHandPokeEvent, Event, FVector2D, LocalPosition);
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Per world fingertip poke hit-testing for flat panels such as 3D widgets.
+  * Registered panels are kept as precomputed plane equations in a compact structure of arrays which is tested against a
+  * fingertip four panels at a time. Press, release and hover events are synthesised only for the panels being touched.
+*/
+UCLASS()
+class QUESTHANDS_API UQuestHandsPokeSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsPokeSubsystem();
+
+    virtual void Deinitialize() override;
+
+    /**
+     * Register a panel to be poked. The panel faces along the components X axis and spans Size along its Y and Z axes, centered on the component,
+     * which matches the layout of a widget component with its draw size.
+    */
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Poke")
+    void RegisterPokePanel(USceneComponent* Panel, FVector2D Size);
+
+    // Remove a panel, releasing any hand pressing it
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Poke")
+    void UnregisterPokePanel(USceneComponent* Panel);
+
+    // Test a fingertip of a hand against every registered panel and broadcast the resulting events
+    void ProcessFingertip(EControllerHand Hand, const FVector& TipLocation, const FVector& TipVelocity);
+
+    // Called when a fingertip hovers, presses or releases a panel. LocalPosition is relative to the panel center along its Y and Z axes.
+    UPROPERTY(BlueprintAssignable, Category = "QuestHands|Poke")
+    FOnQHandsPokeDelegate OnPoke;
+
+    // Distance in front of a panel in which the fingertip hovers it
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Poke")
+    float HoverDistance;
+
+    // Depth behind the front of a panel the fingertip can go before the panel is no longer considered touched
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Poke")
+    float PressDepth;
+
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+private:
+
+    enum class EPanelState : uint8
+    {
+        None,
+        Hover,
+        Pressed
+    };
+
+    void UpdatePlane(int32 PanelIndex);
+    void RemovePanelAt(int32 PanelIndex);
+    void SetPanelState(int32 PanelIndex, int32 HandIndex, EControllerHand Hand, EPanelState NewState, const FVector2D& LocalPosition);
+    void OnTransformUpdated(USceneComponent* Component, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+    typedef TArray<float, TAlignedHeapAllocator<16>> FPlaneLane;
+
+    // Plane equations, panel origins, in plane axes and half extents, padded to a multiple of four panels
+    FPlaneLane NormalX, NormalY, NormalZ, PlaneD;
+    FPlaneLane OriginX, OriginY, OriginZ;
+    FPlaneLane RightX, RightY, RightZ;
+    FPlaneLane UpX, UpY, UpZ;
+    FPlaneLane HalfWidth, HalfHeight;
+
+    // Per panel data which is only touched for hits
+    TArray<TWeakObjectPtr<USceneComponent>> Panels;
+    TArray<FVector2D> PanelSizes;
+    TArray<FDelegateHandle> TransformUpdatedHandles;
+    TArray<EPanelState> PanelStates[2];
+
+    // The panels each hand is currently hovering or pressing
+    TArray<int32> ActivePanels[2];
+
+    TMap<TWeakObjectPtr<USceneComponent>, int32> PanelToIndex;
+};
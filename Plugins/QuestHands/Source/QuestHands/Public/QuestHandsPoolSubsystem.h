@@ -0,0 +1,92 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Engine/StreamableManager.h"
+
+#include "QuestHandsPoolSubsystem.generated.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Per world pool of registered hand components so spawning a hands pawn doesn't have to create and register them.
+  * Released components stay registered to a hidden pool actor with their collision and visibility turned off, acquiring
+  * one moves it to the new owner and attaches it in place. The pool can be prewarmed, components are then created a few
+  * per frame. Also loads the hand meshes asynchronously for the hands components.
+*/
+UCLASS()
+class QUESTHANDS_API UQuestHandsPoolSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsPoolSubsystem();
+
+    virtual void Deinitialize() override;
+
+    // FTickableGameObject
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+
+    // Grow the pool to at least these numbers of components, created MaxCreatesPerFrame at a time
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|Pool")
+    void Prewarm(int32 NumPoseables, int32 NumCapsules);
+
+    // Take a poseable mesh component from the pool, or create one, attached to Parent and showing Mesh
+    class UPoseableMeshComponent* AcquirePoseable(USceneComponent* Parent, USkeletalMesh* Mesh);
+
+    // Take a capsule component from the pool attached to Parent. Null if the pool is empty and CreateIfEmpty is false.
+    class UCapsuleComponent* AcquireCapsule(USceneComponent* Parent, const FBodyInstance& BodyData, bool GenerateOverlapEvents, bool CreateIfEmpty);
+
+    // Return components to the pool
+    void ReleasePoseable(class UPoseableMeshComponent* Poseable);
+    void ReleaseCapsule(class UCapsuleComponent* Capsule);
+
+    // Load a hand mesh asynchronously, Callback is called once the mesh is loaded or straight away if it already is
+    void RequestMeshLoad(const TSoftObjectPtr<USkeletalMesh>& Mesh, FStreamableDelegate Callback);
+
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Pool")
+    int32 GetNumPooledPoseables() const { return Poseables.Num(); }
+
+    UFUNCTION(BlueprintPure, Category = "QuestHands|Pool")
+    int32 GetNumPooledCapsules() const { return Capsules.Num(); }
+
+    // The maximum number of components the pool creates in a frame while prewarming
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Pool", meta = (ClampMin = "1"))
+    int32 MaxCreatesPerFrame;
+
+    // Released components beyond these numbers are destroyed instead of pooled
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Pool", meta = (ClampMin = "0"))
+    int32 MaxPooledPoseables;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "QuestHands|Pool", meta = (ClampMin = "0"))
+    int32 MaxPooledCapsules;
+
+    // The pooled components are included, they are owned by the pool until acquired
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+private:
+
+    AActor* GetPoolActor();
+    class UPoseableMeshComponent* CreatePoseable();
+    class UCapsuleComponent* CreateCapsule();
+    void MoveToOwner(UActorComponent* Component, AActor* NewOwner);
+
+    // The actor owning the pooled components
+    UPROPERTY(Transient)
+    AActor* PoolActor;
+
+    UPROPERTY(Transient)
+    TArray<class UPoseableMeshComponent*> Poseables;
+
+    UPROPERTY(Transient)
+    TArray<class UCapsuleComponent*> Capsules;
+
+    int32 PrewarmPoseables;
+    int32 PrewarmCapsules;
+
+    FStreamableManager Streamable;
+};
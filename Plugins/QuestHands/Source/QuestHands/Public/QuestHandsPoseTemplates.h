@@ -0,0 +1,86 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "InputCoreTypes.h"
+#include "QuestHandsFunctions.h"
+
+#include "QuestHandsPoseTemplates.generated.h"
+
+// The pose templates of one hand
+USTRUCT()
+struct FQHandPoseTemplateSet
+{
+    GENERATED_BODY()
+
+    // Template centers, NumFeatures quantised quaternion components per template
+    UPROPERTY()
+    TArray<int16> Centroids;
+
+    // Feature distance from each center within which most of the recorded poses of the template fell
+    UPROPERTY(VisibleAnywhere, Category = "PoseTemplates")
+    TArray<float> Radii;
+
+    // Number of recorded poses each template was mined from
+    UPROPERTY(VisibleAnywhere, Category = "PoseTemplates")
+    TArray<int32> Counts;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Hand pose templates mined from recordings by the QuestHandsPoseTemplates commandlet. A pose is described by the
+  * local rotations of the finger bones, which are relative to the wrist and independent of the hand scale, so a
+  * template matches the same pose whatever the hand size or orientation.
+*/
+UCLASS(BlueprintType)
+class QUESTHANDS_API UQuestHandsPoseTemplates : public UDataAsset
+{
+    GENERATED_BODY()
+public:
+
+    // The finger bones describing a pose, Hand_Thumb0 to Hand_Pinky3
+    static constexpr int32 FirstFeatureBone = (int32)EQHandBones::Hand_Thumb0;
+    static constexpr int32 NumFeatureBones = (int32)EQHandBones::Hand_Pinky3 - FirstFeatureBone + 1;
+    static constexpr int32 NumFeatures = NumFeatureBones * 4;
+
+    UQuestHandsPoseTemplates();
+
+    virtual void PostLoad() override;
+
+    // Write the pose features of a tracking state, NumFeatures floats. False if the hand isn't tracked.
+    static bool GetPoseFeatures(const FQHandTrackingState& TrackingState, float* FeaturesOut);
+
+    // Squared distance between two sets of pose features
+    static float GetFeatureDistanceSquared(const float* FeaturesA, const float* FeaturesB);
+
+    // Replace the templates of a hand, Centroids holds NumFeatures floats per template
+    void SetTemplates(EControllerHand Hand, const TArray<float>& Centroids, const TArray<float>& Radii, const TArray<int32>& Counts);
+
+    // The template closest to the pose of a tracking state, INDEX_NONE if the pose is outside the radius of every template
+    UFUNCTION(BlueprintCallable, Category = "QuestHands|PoseTemplates")
+    int32 FindClosestTemplate(EControllerHand Hand, const FQHandTrackingState& TrackingState, float& DistanceOut) const;
+
+    UFUNCTION(BlueprintPure, Category = "QuestHands|PoseTemplates")
+    int32 GetNumTemplates(EControllerHand Hand) const;
+
+    // Scale of the template radii when matching, raise it to match looser poses
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PoseTemplates", meta = (ClampMin = "0.0"))
+    float RadiusScale;
+
+    UPROPERTY(VisibleAnywhere, Category = "PoseTemplates")
+    FQHandPoseTemplateSet LeftHand;
+
+    UPROPERTY(VisibleAnywhere, Category = "PoseTemplates")
+    FQHandPoseTemplateSet RightHand;
+
+private:
+
+    void DecodeTemplates(int32 HandIndex);
+
+    const FQHandPoseTemplateSet& GetTemplateSet(int32 HandIndex) const { return HandIndex == 0 ? LeftHand : RightHand; }
+
+    // The template centers dequantised on load, left (0) and right (1)
+    TArray<float> DecodedCentroids[2];
+};
@@ -0,0 +1,29 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "QuestHandsPoseTemplatesCommandlet.generated.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Mines hand pose templates from directories of hand tracking recordings. The tracked poses of each hand are
+  * clustered with k-means (k-means++ seeding) over the finger bone rotations, every iteration runs in parallel over
+  * chunks of poses with vectorised distances. Clusters left empty are reseeded one at a time on the worst fitting poses.
+  * The cluster centers and radii are saved as a UQuestHandsPoseTemplates asset.
+  *
+  * UE4Editor-Cmd <Project> -run=QuestHandsPoseTemplates -Input=<dir>[+<dir>...] -Asset=/Game/Path/PoseTemplates
+  *     [-Clusters=32] [-Iterations=50] [-Seed=0] [-RadiusPercentile=0.95] [-IncludeLowConfidence]
+*/
+UCLASS()
+class UQuestHandsPoseTemplatesCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsPoseTemplatesCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
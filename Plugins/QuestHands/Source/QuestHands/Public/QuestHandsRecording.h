@@ -0,0 +1,106 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuestHandsFunctions.h"
+#include "Async/Future.h"
+
+/**
+  * Hand tracking recordings. A recording is a binary file holding the skeletons of both hands followed by the tracking
+  * states of every sampled frame, written by UQuestHandsComponent::StartHandRecording and read back frame by frame so
+  * long sessions never have to be loaded whole. Recordings use the .qhrec extension.
+  *
+  * Every field is written explicitly so a recording doesn't depend on the layout of the reflected structs. Version 1
+  * recordings were written from the reflected layout and are still read as long as the structs keep it.
+*/
+
+// One recorded sample of both hands
+struct FQHandRecordingFrame
+{
+    // Seconds since the recording started
+    double Time;
+
+    // Tracking states of the left (0) and right (1) hands
+    FQHandTrackingState Hands[2];
+
+    FQHandRecordingFrame()
+        : Time(0.0)
+    {}
+};
+
+// Streams frames to a recording file. Frames are serialized into a buffer by the caller and the full buffer is written
+// to the file on the thread pool, so recording doesn't put file writes on the game thread.
+class QUESTHANDS_API FQHandRecordingWriter
+{
+public:
+    ~FQHandRecordingWriter();
+
+    // Create the file and buffer the header, false if the file couldn't be created
+    bool Open(const FString& FilePath, const FQHandSkeleton& LeftSkeleton, const FQHandSkeleton& RightSkeleton);
+
+    // Write what is buffered and close the file, waits for the writes still in flight
+    void Close();
+    bool IsOpen() const { return Archive.IsValid(); }
+
+    void WriteFrame(FQHandRecordingFrame& Frame);
+
+    int32 GetNumFrames() const { return NumFrames; }
+    const FString& GetFilePath() const { return FilePath; }
+
+    // Size the buffer is handed to the thread pool at, about a second of frames at 72 Hz
+    static constexpr int32 FlushBytes = 64 * 1024;
+
+private:
+    // Hand the buffer to the thread pool once the previous write is done
+    void Flush();
+
+    TUniquePtr<FArchive> Archive;
+    FString FilePath;
+    int32 NumFrames = 0;
+
+    // Serialized frames waiting to be written
+    TArray<uint8> Buffer;
+
+    // The write on the thread pool, only one is in flight so the file is written in order
+    TFuture<void> PendingWrite;
+};
+
+// Reads the frames of a recording file in order
+class QUESTHANDS_API FQHandRecordingReader
+{
+public:
+    ~FQHandRecordingReader();
+
+    // Open the file and read the header, false if it isn't a recording of a supported version
+    bool Open(const FString& FilePath);
+    void Close();
+
+    // Read the next frame, false at the end of the recording
+    bool ReadFrame(FQHandRecordingFrame& FrameOut);
+
+    const FQHandSkeleton& GetSkeleton(int32 HandIndex) const { return Skeletons[HandIndex]; }
+
+    // The layout version of the open recording
+    int32 GetVersion() const { return Version; }
+
+private:
+    TUniquePtr<FArchive> Archive;
+    FQHandSkeleton Skeletons[2];
+    int32 Version = 0;
+};
+
+namespace QuestHands
+{
+namespace Recording
+{
+    // File extension of recordings, without the dot
+    QUESTHANDS_API extern const TCHAR* FileExtension;
+
+    // Default directory recordings are written to
+    QUESTHANDS_API FString GetRecordingsDir();
+
+    // Gather the recordings in a '+' separated list of files and directories searched recursively, sorted by path
+    QUESTHANDS_API void FindRecordings(const FString& InputPaths, TArray<FString>& FilesOut);
+}
+}
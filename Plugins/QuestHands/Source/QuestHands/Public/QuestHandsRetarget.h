@@ -0,0 +1,130 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "QuestHandsFunctions.h"
+
+#include "QuestHandsRetarget.generated.h"
+
+class USkeletalMesh;
+class UPoseableMeshComponent;
+
+// Which bone of the target mesh follows a hand bone
+USTRUCT(BlueprintType, DisplayName = "Hand Retarget Bone")
+struct FQHandRetargetBone
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    EQHandBones Bone;
+
+    // The bone of the target mesh, none leaves the hand bone unused
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    FName TargetBone;
+
+    FQHandRetargetBone()
+        : Bone(EQHandBones::Hand_Wrist)
+    {}
+};
+
+// The baked retarget of one hand, every array is indexed by the bone index of the target mesh
+USTRUCT()
+struct FQHandRetargetBaked
+{
+    GENERATED_BODY()
+
+    // The hand bone driving each target bone, -1 for bones following their parent
+    UPROPERTY()
+    TArray<int32> SourceBones;
+
+    // Parent of each target bone in the target mesh
+    UPROPERTY()
+    TArray<int32> ParentBones;
+
+    // Applied in the hand bone space before the hand bone transform: the rest pose rotation correction and scale of the bone
+    UPROPERTY()
+    TArray<FTransform> Corrections;
+
+    // Number of target bones mapped to a hand bone
+    UPROPERTY(VisibleAnywhere, Category = "Retarget")
+    int32 NumMappedBones = 0;
+
+    bool IsValid() const { return SourceBones.Num() > 0; }
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+/**
+  * Drives hand meshes which don't follow the bone naming and rest pose of the Oculus hand meshes. The hand bones are
+  * mapped to bones of the target meshes and the rest pose differences to a source mesh with the Oculus skeleton are
+  * baked into a rotation and scale correction per bone with Bake. At runtime every bone takes one multiply with its
+  * correction and the pose is written straight into the bone space transforms of the mesh, without name lookups.
+  *
+  * Set it as the HandRetarget of a hands component using the target meshes.
+*/
+UCLASS(BlueprintType)
+class QUESTHANDS_API UQuestHandsRetarget : public UDataAsset
+{
+    GENERATED_BODY()
+public:
+
+    UQuestHandsRetarget();
+
+    // A mesh with the Oculus hand skeleton and naming, the rest pose the hand bones are tracked relative to
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    USkeletalMesh* SourceMesh;
+
+    // The rotation offset the source mesh was driven with, LeftHandBoneRotationOffset of the hands component
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    FRotator LeftSourceRotationOffset;
+
+    // The rotation offset the source mesh was driven with, RightHandBoneRotationOffset of the hands component
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    FRotator RightSourceRotationOffset;
+
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    USkeletalMesh* LeftTargetMesh;
+
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    USkeletalMesh* RightTargetMesh;
+
+    // The target bones of the left hand bones. Hand bones left out are matched to target bones of the same name.
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    TArray<FQHandRetargetBone> LeftBones;
+
+    // The target bones of the right hand bones. Hand bones left out are matched to target bones of the same name.
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    TArray<FQHandRetargetBone> RightBones;
+
+    // Scale the target bones so their lengths match the tracked bones, for rigs proportioned differently from the source
+    UPROPERTY(EditAnywhere, Category = "Retarget")
+    bool MatchBoneLengths;
+
+    // Bake the bone mapping and the corrections from the meshes, needs to be done after changing any of the above
+    UFUNCTION(CallInEditor, Category = "Retarget")
+    void Bake();
+
+    // Can the baked retarget pose the mesh of a poseable?
+    bool CanApply(const UPoseableMeshComponent* Poseable, bool LeftHand) const;
+
+    // Pose the mesh of a poseable from world space hand bones
+    void Apply(UPoseableMeshComponent* Poseable, const TArray<FTransform>& HandBones, bool LeftHand) const;
+
+private:
+
+    bool BakeHand(bool LeftHand);
+
+    UPROPERTY(VisibleAnywhere, Category = "Retarget")
+    FQHandRetargetBaked LeftBaked;
+
+    UPROPERTY(VisibleAnywhere, Category = "Retarget")
+    FQHandRetargetBaked RightBaked;
+
+    // The meshes the retarget was baked for, applying to other meshes would scramble them
+    UPROPERTY()
+    USkeletalMesh* LeftBakedMesh;
+
+    UPROPERTY()
+    USkeletalMesh* RightBakedMesh;
+};
@@ -0,0 +1,123 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+// Plain C++ on purpose, this header is shared with the external reader in Extras/QuestHandsSharedFrameReader
+#include <stdint.h>
+
+/**
+  * Layout of the shared memory hand frames exported by UQuestHandsComponent::StartSharedFrameExport.
+  *
+  * The region is an FRegion: a header followed by a ring of NumSlots frame slots. Every exported frame goes to the slot
+  * after the previous one and WriteCount is raised once the slot is complete, so the latest frame is in slot
+  * (WriteCount - 1) % NumSlots. Slots are guarded seqlock style: the producer makes Sequence odd before writing a slot
+  * and even again after, a reader copies the slot and only keeps the copy when Sequence was the same even number before
+  * and after. Readers never block the producer, a slow reader loses frames instead and sees it in the frame indices.
+  *
+  * Everything is in the native byte order of the producer. Any change to the layout needs a new Version.
+*/
+namespace QuestHandsShared
+{
+    // 'QHSF'
+    static const uint32_t Magic = 0x46534851;
+    static const uint32_t Version = 1;
+
+    static const uint32_t NumSlots = 64;
+    static const uint32_t NumBones = 24;
+    static const uint32_t NumFingers = 5;
+
+    // The region name used when an export isn't given one. Windows file mapping name, or /QuestHandsFrames for shm_open.
+    static const char* const DefaultName = "QuestHandsFrames";
+
+    enum EHandFlags : uint32_t
+    {
+        HandFlag_Tracked = 1 << 0,
+        HandFlag_InputValid = 1 << 1,
+        HandFlag_SystemGesture = 1 << 2,
+        HandFlag_HighConfidence = 1 << 3,
+
+        // Bones holds a pose, the skeleton of the hand had been read
+        HandFlag_BonesValid = 1 << 4,
+    };
+
+    // Quaternion X, Y, Z, W and a position in the Unreal world space and units
+    struct FPose
+    {
+        float Orientation[4];
+        float Position[3];
+        float Padding;
+    };
+
+    // World space bone transform, the scale is uniform
+    struct FBone
+    {
+        float Rotation[4];
+        float Location[3];
+        float Scale;
+    };
+
+    struct FHand
+    {
+        // EHandFlags
+        uint32_t Flags;
+
+        // Bit per finger in Hand Finger order
+        uint32_t Pinches;
+        float PinchStrength[NumFingers];
+        float HandScale;
+
+        FPose RootPose;
+        FPose PointerPose;
+
+        // In Hand Bones order
+        FBone Bones[NumBones];
+    };
+
+    struct FFrame
+    {
+        // Counts the exported frames from 1, a gap between frames read in order means frames were lost
+        uint64_t FrameIndex;
+
+        // Engine frame and seconds of the producer clock the hands were sampled in
+        uint64_t EngineFrame;
+        double Time;
+
+        // Left (0) and right (1) hands
+        FHand Hands[2];
+    };
+
+    struct alignas(64) FSlot
+    {
+        // Odd while the producer writes the slot
+        volatile uint32_t Sequence;
+        uint32_t Padding;
+
+        FFrame Frame;
+    };
+
+    struct alignas(64) FHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t HeaderSize;
+        uint32_t SlotSize;
+        uint32_t NumSlots;
+        uint32_t NumBones;
+
+        // Frames completely written, raised after each frame
+        volatile uint64_t WriteCount;
+
+        // Set while the producer is exporting, cleared when it stops
+        volatile uint32_t ProducerActive;
+    };
+
+    struct FRegion
+    {
+        FHeader Header;
+        FSlot Slots[NumSlots];
+    };
+
+    static_assert(sizeof(FPose) == 32 && sizeof(FBone) == 32, "QuestHandsShared poses need to keep their layout");
+    static_assert(sizeof(FHand) == 864 && sizeof(FFrame) == 1752, "QuestHandsShared frames need to keep their layout");
+    static_assert(sizeof(FHeader) == 64 && sizeof(FSlot) == 1792, "QuestHandsShared slots need to keep their layout");
+}
@@ -0,0 +1,39 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "QuestHandsFunctions.h"
+#include "QuestHandsSharedFrameLayout.h"
+
+/**
+  * Live export of hand frames to other processes through a named shared memory ring, see QuestHandsSharedFrameLayout.h
+  * for the layout and Extras/QuestHandsSharedFrameReader for a reader. Frames are written straight into the mapped
+  * region, exporting a frame takes no copies, allocations or system calls. Named shared memory is available on Windows,
+  * Linux and Mac, not on Android.
+*/
+
+// Publishes frames into a shared memory region
+class QUESTHANDS_API FQHandSharedFrameWriter
+{
+public:
+    ~FQHandSharedFrameWriter();
+
+    // Create and map the region, false if it couldn't be created
+    bool Open(const FString& RegionName);
+    void Close();
+    bool IsOpen() const { return Region != nullptr; }
+
+    // Publish the hands to the next slot of the ring, bones are world space in Hand Bones order
+    void WriteFrame(double Time, const FQHandTrackingState& LeftState, const TArray<FTransform>& LeftBones,
+                    const FQHandTrackingState& RightState, const TArray<FTransform>& RightBones);
+
+    uint64 GetNumFrames() const { return NumFrames; }
+    const FString& GetRegionName() const { return RegionName; }
+
+private:
+    FPlatformMemory::FSharedMemoryRegion* SharedMemory = nullptr;
+    QuestHandsShared::FRegion* Region = nullptr;
+    FString RegionName;
+    uint64 NumFrames = 0;
+};
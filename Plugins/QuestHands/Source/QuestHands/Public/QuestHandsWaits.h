@@ -0,0 +1,110 @@
+// Copyright(c) 2020 Sheffer Online Services
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputCoreTypes.h"
+#include "QuestHandsFunctions.h"
+
+#include "QuestHandsWaits.generated.h"
+
+class UQuestHandsPoseTemplates;
+
+UENUM(BlueprintType, DisplayName = "Hand Wait Condition")
+enum class EQHandWaitCondition : uint8
+{
+    // The hand is tracked.
+    WaitCondition_Tracked,
+
+    // The hand lost tracking.
+    WaitCondition_Untracked,
+
+    // The finger pinches the thumb.
+    WaitCondition_Pinched,
+
+    // The finger doesn't pinch the thumb.
+    WaitCondition_Released,
+
+    // The hand is in a pose of a pose templates asset.
+    WaitCondition_Pose
+};
+
+// A hand condition to wait for, evaluated by the hands component every time it samples the hands
+USTRUCT(BlueprintType, DisplayName = "Hand Wait Condition")
+struct QUESTHANDS_API FQHandWaitCondition
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HandWait")
+    EQHandWaitCondition Condition;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HandWait")
+    EControllerHand Hand;
+
+    // The finger of the pinch conditions
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HandWait")
+    EQHandFinger Finger;
+
+    // The templates and the index of the pose of the pose condition
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HandWait")
+    UQuestHandsPoseTemplates* PoseTemplates;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HandWait")
+    int32 PoseIndex;
+
+    // How long in seconds the condition has to hold before the wait completes, 0 completes on the first sample meeting it
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "HandWait", meta = (ClampMin = "0.0"))
+    float HoldTime;
+
+    FQHandWaitCondition()
+        : Condition(EQHandWaitCondition::WaitCondition_Tracked)
+        , Hand(EControllerHand::Right)
+        , Finger(EQHandFinger::HandFinger_Index)
+        , PoseTemplates(nullptr)
+        , PoseIndex(0)
+        , HoldTime(0.0f)
+    {}
+
+    // Does a tracking state of Hand meet the condition, ignoring the hold time?
+    bool IsMet(const FQHandTrackingState& TrackingState) const;
+};
+
+/**
+  * A native wait on a hand condition, started with UQuestHandsComponent::StartHandWait. Waiting costs nothing outside of
+  * the hands component tick, so waiting objects don't need to tick themselves. OnDone runs on the game thread once with
+  * true when the condition was met, or false when the wait was cancelled or the component stopped playing.
+*/
+class QUESTHANDS_API FQHandWaitTask
+{
+public:
+    FQHandWaitTask(const FQHandWaitCondition& InCondition, TFunction<void(bool)> InOnDone);
+
+    bool IsDone() const { return State != EState::Waiting; }
+    bool WasMet() const { return State == EState::Met; }
+    const FQHandWaitCondition& GetCondition() const { return Condition; }
+
+    // Stop waiting, OnDone runs with false if the wait wasn't done yet
+    void Cancel();
+
+    // Evaluate the condition against the latest tracking state of the hand sampled at Time, in seconds
+    void Update(const FQHandTrackingState& TrackingState, double Time);
+
+private:
+    enum class EState : uint8
+    {
+        Waiting,
+        Met,
+        Cancelled
+    };
+
+    void Finish(EState InState);
+
+    FQHandWaitCondition Condition;
+    TFunction<void(bool)> OnDone;
+
+    // When the condition started holding, negative while it doesn't
+    double MetSince;
+    EState State;
+
+    friend class UQuestHandsComponent;
+};
@@ -28,8 +28,13 @@ public class QuestHands : ModuleRules
 				"OculusHMD",
 				"OculusInput",
 				"InputDevice",
+				"RenderCore",
+				"Json",
 			});
 
+		// Sample to apply latency tracing of the hand pipeline, compiled out of shipping builds
+		PublicDefinitions.Add("QUESTHANDS_LATENCY_TRACING=" + (Target.Configuration == UnrealTargetConfiguration.Shipping ? "0" : "1"));
+
 		PrivateIncludePaths.AddRange(
 				new string[] {
 					// Oculus's naughty little hack in the plugin... Access the private headers.